@@ -31,6 +31,7 @@ let package = Package(
     .library(name: "TurboDraftMarkdown", targets: ["TurboDraftMarkdown"]),
     .library(name: "TurboDraftAgent", targets: ["TurboDraftAgent"]),
     .executable(name: "turbodraft-bench", targets: ["TurboDraftCLI"]),
+    .executable(name: "turbodraft-microbench", targets: ["TurboDraftMicrobench"]),
     .executable(name: "turbodraft", targets: ["TurboDraftOpen"]),
     .executable(name: "turbodraft-app", targets: ["TurboDraftApp"]),
   ],
@@ -65,7 +66,11 @@ let package = Package(
     ),
     .executableTarget(
       name: "TurboDraftCLI",
-      dependencies: ["TurboDraftConfig", "TurboDraftTransport", "TurboDraftProtocol", "TurboDraftMarkdown"]
+      dependencies: ["TurboDraftConfig", "TurboDraftCore", "TurboDraftTransport", "TurboDraftProtocol", "TurboDraftMarkdown"]
+    ),
+    .executableTarget(
+      name: "TurboDraftMicrobench",
+      dependencies: ["TurboDraftCore", "TurboDraftMarkdown", "TurboDraftTransport"]
     ),
     .executableTarget(
       name: "TurboDraftOpen"
@@ -74,6 +79,10 @@ let package = Package(
       name: "TurboDraftApp",
       dependencies: turboDraftAppDependencies
     ),
+    .target(
+      name: "TurboDraftTestSupport",
+      path: "Tests/TurboDraftTestSupport"
+    ),
     .testTarget(
       name: "TurboDraftProtocolTests",
       dependencies: ["TurboDraftProtocol"]
@@ -84,15 +93,15 @@ let package = Package(
     ),
     .testTarget(
       name: "TurboDraftCoreTests",
-      dependencies: ["TurboDraftCore"]
+      dependencies: ["TurboDraftCore", "TurboDraftTestSupport"]
     ),
     .testTarget(
       name: "TurboDraftAgentTests",
-      dependencies: ["TurboDraftAgent"]
+      dependencies: ["TurboDraftAgent", "TurboDraftTestSupport"]
     ),
     .testTarget(
       name: "TurboDraftMarkdownTests",
-      dependencies: ["TurboDraftMarkdown"]
+      dependencies: ["TurboDraftMarkdown", "TurboDraftTestSupport"]
     ),
     .testTarget(
       name: "TurboDraftConfigTests",
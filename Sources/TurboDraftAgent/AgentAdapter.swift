@@ -1,7 +1,20 @@
 import Foundation
 
+/// Progress from a streaming prompt-engineer run.
+public enum AgentDraftEvent: Sendable, Equatable {
+  /// More text of the current attempt.
+  case delta(String)
+  /// The attempt so far failed the output guard; a repair turn follows and its deltas replace it.
+  case restart(reasons: [String])
+  /// The finished draft, as `draft` would return it. Always the last event.
+  case completed(String)
+}
+
 public protocol AgentAdapting: Sendable {
   func draft(prompt: String, instruction: String, images: [URL], cwd: String?) async throws -> String
+
+  /// Like `draft`, but reports the output as it is generated. Ending iteration early stops the run.
+  func draftStream(prompt: String, instruction: String, images: [URL], cwd: String?) -> AsyncThrowingStream<AgentDraftEvent, Error>
 }
 
 extension AgentAdapting {
@@ -14,4 +27,49 @@ extension AgentAdapting {
   public func draft(prompt: String, instruction: String, images: [URL]) async throws -> String {
     try await draft(prompt: prompt, instruction: instruction, images: images, cwd: nil)
   }
+
+  /// For backends that can't stream: one `.completed` once `draft` returns.
+  public func draftStream(prompt: String, instruction: String, images: [URL], cwd: String?) -> AsyncThrowingStream<AgentDraftEvent, Error> {
+    AsyncThrowingStream { continuation in
+      let task = Task {
+        do {
+          let out = try await draft(prompt: prompt, instruction: instruction, images: images, cwd: cwd)
+          continuation.yield(.completed(out))
+          continuation.finish()
+        } catch {
+          continuation.finish(throwing: error)
+        }
+      }
+      continuation.onTermination = { _ in task.cancel() }
+    }
+  }
+
+  /// `draft` for backends that implement `draftStream`: the `.completed` text.
+  func collectDraft(prompt: String, instruction: String, images: [URL], cwd: String?) async throws -> String {
+    var out = ""
+    for try await event in draftStream(prompt: prompt, instruction: instruction, images: images, cwd: cwd) {
+      if case let .completed(text) = event {
+        out = text
+      }
+    }
+    return out
+  }
+}
+
+/// Set when the consumer of a `draftStream` stops listening; blocking run loops poll it.
+final class AgentRunCancellation: @unchecked Sendable {
+  private let lock = NSLock()
+  private var cancelled = false
+
+  var isCancelled: Bool {
+    lock.lock()
+    defer { lock.unlock() }
+    return cancelled
+  }
+
+  func cancel() {
+    lock.lock()
+    cancelled = true
+    lock.unlock()
+  }
 }
@@ -0,0 +1,691 @@
+import Darwin
+import Foundation
+import TurboDraftCore
+import os
+
+public enum AgentProcessPoolError: Error {
+  case commandNotFound
+  case spawnFailed(errno: Int32)
+}
+
+/// How to start an agent CLI run. Runs with equal specs can share a pre-spawned process.
+///
+/// Any argument equal to `AgentProcessPool.scratchPathPlaceholder` is replaced, per process, by a
+/// temp path the run may write to (e.g. Codex's `--output-last-message`); its contents come back
+/// as `AgentProcessResult.scratchOutput`.
+public struct AgentProcessSpec: Hashable, Sendable {
+  /// A file the processes read by path, such as a system prompt. The pool writes it before the
+  /// first process for the spec starts and removes it once none is left, idle or running.
+  /// Files compare by URL alone, so name them by their contents.
+  public struct File: Hashable, Sendable {
+    public var url: URL
+    public var contents: Data
+
+    public init(url: URL, contents: Data) {
+      self.url = url
+      self.contents = contents
+    }
+
+    public static func == (lhs: File, rhs: File) -> Bool {
+      lhs.url == rhs.url
+    }
+
+    public func hash(into hasher: inout Hasher) {
+      hasher.combine(url)
+    }
+  }
+
+  public var executablePath: String
+  public var arguments: [String]
+  public var cwd: String?
+  public var files: [File]
+
+  public init(executablePath: String, arguments: [String], cwd: String? = nil, files: [File] = []) {
+    self.executablePath = executablePath
+    self.arguments = arguments
+    self.cwd = cwd
+    self.files = files
+  }
+}
+
+public struct AgentProcessResult: Sendable {
+  public var exitCode: Int32
+  /// Combined stdout and stderr, capped at the run's `maxOutputBytes`.
+  public var output: Data
+  public var didTimeout: Bool
+  /// Whether the run was killed because `shouldStop` returned true.
+  public var wasStopped: Bool
+  /// Contents of the scratch file after the run, if the process wrote one.
+  public var scratchOutput: Data?
+  /// Whether the run used a pre-spawned process.
+  public var poolHit: Bool
+}
+
+/// Pre-spawned agent CLI processes, shared by the prompt-engineer backends.
+///
+/// A run takes an idle process started with the same spec, already past exec, runtime boot and
+/// auth and blocked reading stdin. It writes the prompt, closes stdin and collects the output. A
+/// miss spawns on demand, as before. After each run a replacement is spawned in the background, so
+/// the next run (a repair turn, the next Improve) hits. Idle processes are killed after `idleTTL`,
+/// and the oldest go first when there are more than `maxIdleProcesses` or their combined physical
+/// footprint exceeds `maxIdleFootprintBytes`.
+///
+/// A waiting process must never see its stdin close without a prompt: the CLIs take that as an
+/// empty prompt and start a billable run. So each one runs in its own process group next to a
+/// watchdog `sh` that holds a second copy of the process's stdin and reads a lifeline pipe only
+/// this process can write. The pool writes a newline to release it once the prompt is in; if
+/// this process goes away first, however it goes (crash, SIGKILL, no `drain`), the lifeline
+/// reads EOF and the watchdog SIGKILLs the group before its copy of stdin closes.
+public final class AgentProcessPool: @unchecked Sendable {
+  public static let shared = AgentProcessPool()
+  public static let scratchPathPlaceholder = "{turbodraft-scratch}"
+
+  public struct Stats: Sendable, Equatable {
+    public var hits: Int
+    public var misses: Int
+    public var idleProcesses: Int
+    public var idleFootprintBytes: UInt64
+  }
+
+  private final class Worker {
+    let spec: AgentProcessSpec
+    let pid: pid_t
+    let stdinFd: Int32
+    let outputFd: Int32
+    let scratchURL: URL
+    let watchdogPid: pid_t
+    let lifelineFd: Int32
+    let spawnedNs: UInt64
+
+    init(
+      spec: AgentProcessSpec,
+      pid: pid_t,
+      stdinFd: Int32,
+      outputFd: Int32,
+      scratchURL: URL,
+      watchdogPid: pid_t,
+      lifelineFd: Int32
+    ) {
+      self.spec = spec
+      self.pid = pid
+      self.stdinFd = stdinFd
+      self.outputFd = outputFd
+      self.scratchURL = scratchURL
+      self.watchdogPid = watchdogPid
+      self.lifelineFd = lifelineFd
+      self.spawnedNs = DispatchTime.now().uptimeNanoseconds
+    }
+  }
+
+  /// Run as `sh -c watchdogScript sh <pgid>` with the lifeline on stdin and the worker's stdin
+  /// on fd 3. A line means the prompt is in: exit, dropping fd 3. EOF means the pool's process
+  /// is gone: kill the group first.
+  private static let watchdogScript = #"if IFS= read -r _; then exit 0; fi; kill -KILL -- "-$1""#
+
+  private static let log = Logger(subsystem: "com.turbodraft", category: "AgentProcessPool")
+
+  private let idleTTLNs: UInt64
+  private let maxIdleProcesses: Int
+  private let maxIdleFootprintBytes: UInt64
+  private let queue = DispatchQueue(label: "turbodraft.agentpool", qos: .utility)
+  private let lock = NSLock()
+  /// Oldest first.
+  private var idle: [Worker] = []
+  private var refilling: Set<AgentProcessSpec> = []
+  /// Processes per spec with `files`, idle, starting or running; the files exist while it's
+  /// above zero.
+  private var fileHolders: [AgentProcessSpec: Int] = [:]
+  private var hits = 0
+  private var misses = 0
+  private var reapTimer: DispatchSourceTimer?
+  private var isDrained = false
+
+  public init(idleTTLMs: Int = 10 * 60_000, maxIdleProcesses: Int = 2, maxIdleFootprintBytes: UInt64 = 768 * 1024 * 1024) {
+    self.idleTTLNs = UInt64(max(0, idleTTLMs)) * 1_000_000
+    self.maxIdleProcesses = max(0, maxIdleProcesses)
+    self.maxIdleFootprintBytes = maxIdleFootprintBytes
+  }
+
+  deinit {
+    drain()
+  }
+
+  public func stats() -> Stats {
+    lock.lock()
+    var stats = Stats(hits: hits, misses: misses, idleProcesses: idle.count, idleFootprintBytes: 0)
+    let pids = idle.map(\.pid)
+    lock.unlock()
+    stats.idleFootprintBytes = pids.reduce(0) { $0 + Self.footprintBytes(of: $1) }
+    return stats
+  }
+
+  /// Runs `spec` with `stdin` as its input, blocking until it exits or `timeoutMs` passes (the
+  /// clock starts when the input is written, not at spawn). With `keepWarm`, a replacement for
+  /// `spec` is spawned in the background for the next run.
+  ///
+  /// `onOutput` sees every chunk of output as it is read, including any past `maxOutputBytes`.
+  /// `shouldStop` is polled between reads; once it returns true the process is killed.
+  public func run(
+    _ spec: AgentProcessSpec,
+    stdin: Data,
+    timeoutMs: Int,
+    maxOutputBytes: Int,
+    keepWarm: Bool = true,
+    onOutput: ((Data) -> Void)? = nil,
+    shouldStop: (() -> Bool)? = nil
+  ) throws -> AgentProcessResult {
+    let (process, hit) = try checkout(spec)
+    if keepWarm {
+      refill(spec)
+    }
+    defer {
+      try? FileManager.default.removeItem(at: process.scratchURL)
+      releaseFiles(of: spec)
+    }
+
+    do { try writeAll(fd: process.stdinFd, data: stdin) } catch { /* the exit status reports it */ }
+    close(process.stdinFd)
+    Self.dismissWatchdog(process, releasing: true)
+    let collected = Self.collect(
+      process,
+      timeoutMs: timeoutMs,
+      maxOutputBytes: maxOutputBytes,
+      onOutput: onOutput,
+      shouldStop: shouldStop
+    )
+    return AgentProcessResult(
+      exitCode: collected.exitCode,
+      output: collected.output,
+      didTimeout: collected.didTimeout,
+      wasStopped: collected.wasStopped,
+      scratchOutput: try? Data(contentsOf: process.scratchURL),
+      poolHit: hit
+    )
+  }
+
+  /// Kills every idle process and stops pre-spawning. Call before the app exits; the watchdogs
+  /// only cover exits that skip it.
+  public func drain() {
+    lock.lock()
+    isDrained = true
+    let processes = idle
+    idle.removeAll()
+    reapTimer?.cancel()
+    reapTimer = nil
+    lock.unlock()
+    for process in processes {
+      retire(process, wait: true)
+    }
+  }
+
+  /// Kills every idle process but keeps pre-spawning, so the next run misses and refills. For
+  /// memory pressure, when a warm process isn't worth its footprint.
+  public func evictIdle() {
+    lock.lock()
+    let processes = idle
+    idle.removeAll()
+    reapTimer?.cancel()
+    reapTimer = nil
+    lock.unlock()
+    for process in processes {
+      retire(process, wait: false)
+    }
+  }
+
+  // MARK: - Idle set
+
+  private func checkout(_ spec: AgentProcessSpec) throws -> (Worker, hit: Bool) {
+    let now = DispatchTime.now().uptimeNanoseconds
+    lock.lock()
+    var expired: [Worker] = []
+    var found: Worker?
+    idle.removeAll { process in
+      guard found == nil || process.spec != spec else { return false }
+      if now - process.spawnedNs > idleTTLNs || !Self.isRunning(process.pid) {
+        expired.append(process)
+        return true
+      }
+      if process.spec == spec, found == nil {
+        found = process
+        return true
+      }
+      return false
+    }
+    if found != nil {
+      hits += 1
+    } else {
+      misses += 1
+    }
+    lock.unlock()
+
+    for process in expired {
+      retire(process, wait: false)
+    }
+    if let found {
+      return (found, true)
+    }
+    return (try spawnWorker(spec), false)
+  }
+
+  private func refill(_ spec: AgentProcessSpec) {
+    lock.lock()
+    guard !isDrained, maxIdleProcesses > 0, !refilling.contains(spec), !idle.contains(where: { $0.spec == spec }) else {
+      lock.unlock()
+      return
+    }
+    refilling.insert(spec)
+    lock.unlock()
+
+    queue.async { [self] in
+      let process: Worker?
+      do {
+        process = try spawnWorker(spec)
+      } catch {
+        Self.log.warning("Pre-spawn failed: \(String(describing: error), privacy: .public)")
+        process = nil
+      }
+      lock.lock()
+      refilling.remove(spec)
+      var evicted: [Worker] = []
+      if let process {
+        if isDrained {
+          evicted.append(process)
+        } else {
+          idle.append(process)
+        }
+      }
+      while idle.count > maxIdleProcesses {
+        evicted.append(idle.removeFirst())
+      }
+      var footprint = idle.reduce(UInt64(0)) { $0 + Self.footprintBytes(of: $1.pid) }
+      while footprint > maxIdleFootprintBytes, !idle.isEmpty {
+        let oldest = idle.removeFirst()
+        footprint -= min(footprint, Self.footprintBytes(of: oldest.pid))
+        evicted.append(oldest)
+      }
+      scheduleReapLocked()
+      lock.unlock()
+      for process in evicted {
+        retire(process, wait: false)
+      }
+    }
+  }
+
+  /// Starts the TTL sweep while anything is idle. Caller holds `lock`.
+  private func scheduleReapLocked() {
+    guard reapTimer == nil, !idle.isEmpty else { return }
+    let timer = DispatchSource.makeTimerSource(queue: queue)
+    let intervalNs = max(1_000_000_000, idleTTLNs / 4)
+    timer.schedule(deadline: .now() + .nanoseconds(Int(intervalNs)), repeating: .nanoseconds(Int(intervalNs)))
+    timer.setEventHandler { [weak self] in self?.reapExpired() }
+    reapTimer = timer
+    timer.resume()
+  }
+
+  private func reapExpired() {
+    let now = DispatchTime.now().uptimeNanoseconds
+    lock.lock()
+    var expired: [Worker] = []
+    idle.removeAll { process in
+      guard now - process.spawnedNs > idleTTLNs || !Self.isRunning(process.pid) else { return false }
+      expired.append(process)
+      return true
+    }
+    if idle.isEmpty {
+      reapTimer?.cancel()
+      reapTimer = nil
+    }
+    lock.unlock()
+    for process in expired {
+      retire(process, wait: false)
+    }
+  }
+
+  // MARK: - Spec files
+
+  private func spawnWorker(_ spec: AgentProcessSpec) throws -> Worker {
+    retainFiles(of: spec)
+    do {
+      return try Self.spawn(spec)
+    } catch {
+      releaseFiles(of: spec)
+      throw error
+    }
+  }
+
+  private func retire(_ process: Worker, wait: Bool) {
+    Self.terminate(process, wait: wait)
+    releaseFiles(of: process.spec)
+  }
+
+  /// Under `lock`, so a file is never removed between another run's write and its spawn.
+  private func retainFiles(of spec: AgentProcessSpec) {
+    guard !spec.files.isEmpty else { return }
+    lock.lock()
+    defer { lock.unlock() }
+    let holders = fileHolders[spec, default: 0]
+    fileHolders[spec] = holders + 1
+    guard holders == 0 else { return }
+    for file in spec.files {
+      do {
+        try file.contents.write(to: file.url, options: [.atomic])
+      } catch {
+        Self.log.warning("Writing \(file.url.path, privacy: .public) failed: \(String(describing: error), privacy: .public)")
+      }
+    }
+  }
+
+  private func releaseFiles(of spec: AgentProcessSpec) {
+    guard !spec.files.isEmpty else { return }
+    lock.lock()
+    defer { lock.unlock() }
+    let holders = fileHolders[spec, default: 1] - 1
+    guard holders <= 0 else {
+      fileHolders[spec] = holders
+      return
+    }
+    fileHolders.removeValue(forKey: spec)
+    for file in spec.files {
+      try? FileManager.default.removeItem(at: file.url)
+    }
+  }
+
+  // MARK: - Processes
+
+  private static func isRunning(_ pid: pid_t) -> Bool {
+    var status: Int32 = 0
+    return waitpid(pid, &status, WNOHANG) == 0
+  }
+
+  private static func footprintBytes(of pid: pid_t) -> UInt64 {
+    var info = rusage_info_v2()
+    let rc = withUnsafeMutablePointer(to: &info) { ptr in
+      ptr.withMemoryRebound(to: rusage_info_t?.self, capacity: 1) {
+        proc_pid_rusage(pid, RUSAGE_INFO_V2, $0)
+      }
+    }
+    return rc == 0 ? info.ri_phys_footprint : 0
+  }
+
+  /// Releasing, the watchdog lets go of the worker's stdin and exits, and the worker sees EOF
+  /// once the pool's copy is closed too. Otherwise it SIGKILLs the worker's group first.
+  private static func dismissWatchdog(_ process: Worker, releasing: Bool) {
+    if releasing {
+      var newline = UInt8(ascii: "\n")
+      _ = write(process.lifelineFd, &newline, 1)
+    }
+    close(process.lifelineFd)
+    let watchdog = process.watchdogPid
+    DispatchQueue.global(qos: .utility).async {
+      var status: Int32 = 0
+      _ = waitpid(watchdog, &status, 0)
+    }
+  }
+
+  /// Signals the group before stdin can close, so the process never sees EOF and starts an
+  /// empty run; the dismissed watchdog follows up with SIGKILL.
+  private static func terminate(_ process: Worker, wait: Bool) {
+    kill(-process.pid, SIGTERM)
+    dismissWatchdog(process, releasing: false)
+    close(process.stdinFd)
+    close(process.outputFd)
+    try? FileManager.default.removeItem(at: process.scratchURL)
+    let pid = process.pid
+    let reap = {
+      let deadline = DispatchTime.now().uptimeNanoseconds + 1_000_000_000
+      var status: Int32 = 0
+      while waitpid(pid, &status, WNOHANG) == 0 {
+        if DispatchTime.now().uptimeNanoseconds > deadline {
+          kill(-pid, SIGKILL)
+          _ = waitpid(pid, &status, 0)
+          return
+        }
+        usleep(10_000)
+      }
+    }
+    if wait {
+      reap()
+    } else {
+      DispatchQueue.global(qos: .utility).async(execute: reap)
+    }
+  }
+
+  private static func spawn(_ spec: AgentProcessSpec) throws -> Worker {
+    let scratchURL = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+      .appendingPathComponent("turbodraft-agent-\(UUID().uuidString).txt")
+    let arguments = spec.arguments.map { $0 == scratchPathPlaceholder ? scratchURL.path : $0 }
+
+    var inFds: [Int32] = [0, 0]
+    guard pipe(&inFds) == 0 else { throw AgentProcessPoolError.spawnFailed(errno: errno) }
+    var outFds: [Int32] = [0, 0]
+    guard pipe(&outFds) == 0 else {
+      close(inFds[0]); close(inFds[1])
+      throw AgentProcessPoolError.spawnFailed(errno: errno)
+    }
+
+    setCloExec(inFds[0]); setCloExec(inFds[1])
+    setCloExec(outFds[0]); setCloExec(outFds[1])
+
+    var actions: posix_spawn_file_actions_t? = nil
+    posix_spawn_file_actions_init(&actions)
+    defer { posix_spawn_file_actions_destroy(&actions) }
+
+    posix_spawn_file_actions_adddup2(&actions, inFds[0], STDIN_FILENO)
+    posix_spawn_file_actions_adddup2(&actions, outFds[1], STDOUT_FILENO)
+    posix_spawn_file_actions_adddup2(&actions, outFds[1], STDERR_FILENO)
+
+    posix_spawn_file_actions_addclose(&actions, inFds[1])
+    posix_spawn_file_actions_addclose(&actions, outFds[0])
+    posix_spawn_file_actions_addclose(&actions, inFds[0])
+    posix_spawn_file_actions_addclose(&actions, outFds[1])
+
+    if let cwd = spec.cwd, !cwd.isEmpty {
+      posix_spawn_file_actions_addchdir_np(&actions, cwd)
+    }
+
+    // Its own group, so the watchdog can take down whatever it spawns along with it.
+    var attr: posix_spawnattr_t? = nil
+    posix_spawnattr_init(&attr)
+    defer { posix_spawnattr_destroy(&attr) }
+    posix_spawnattr_setflags(&attr, Int16(POSIX_SPAWN_SETPGROUP))
+    posix_spawnattr_setpgroup(&attr, 0)
+
+    var pid: pid_t = 0
+    let argv = [spec.executablePath] + arguments
+    var cArgs: [UnsafeMutablePointer<CChar>?] = argv.map { strdup($0) }
+    cArgs.append(nil)
+    defer {
+      for p in cArgs where p != nil { free(p) }
+    }
+
+    // Prepend the executable's own directory to PATH so that shebang interpreters
+    // (e.g. `#!/usr/bin/env node`) resolve when running under a LaunchAgent whose
+    // PATH omits nvm/fnm-managed bin directories.
+    let execDir = URL(fileURLWithPath: spec.executablePath).deletingLastPathComponent().path
+    var cEnv: [UnsafeMutablePointer<CChar>?] = CommandResolver.buildEnv(prependingToPath: execDir).map { strdup($0) }
+    cEnv.append(nil)
+    defer { for p in cEnv where p != nil { free(p) } }
+
+    let rc = posix_spawn(&pid, spec.executablePath, &actions, &attr, &cArgs, &cEnv)
+    if rc != 0 {
+      close(inFds[0]); close(inFds[1]); close(outFds[0]); close(outFds[1])
+      if rc == ENOENT {
+        throw AgentProcessPoolError.commandNotFound
+      }
+      throw AgentProcessPoolError.spawnFailed(errno: Int32(rc))
+    }
+
+    close(inFds[0])
+    close(outFds[1])
+    let watchdog: (pid: pid_t, lifelineFd: Int32)
+    do {
+      watchdog = try spawnWatchdog(group: pid, holding: inFds[1])
+    } catch {
+      // Killed before its stdin closes.
+      kill(-pid, SIGKILL)
+      close(inFds[1])
+      close(outFds[0])
+      var status: Int32 = 0
+      _ = waitpid(pid, &status, 0)
+      throw error
+    }
+    setNonBlocking(outFds[0])
+    return Worker(
+      spec: spec,
+      pid: pid,
+      stdinFd: inFds[1],
+      outputFd: outFds[0],
+      scratchURL: scratchURL,
+      watchdogPid: watchdog.pid,
+      lifelineFd: watchdog.lifelineFd
+    )
+  }
+
+  /// Starts the watchdog for the worker leading process group `group`, with `stdinFd` (the
+  /// worker's stdin) as its fd 3. Returns its pid and the lifeline's write end.
+  private static func spawnWatchdog(group: pid_t, holding stdinFd: Int32) throws -> (pid: pid_t, lifelineFd: Int32) {
+    var lifeFds: [Int32] = [0, 0]
+    guard pipe(&lifeFds) == 0 else { throw AgentProcessPoolError.spawnFailed(errno: errno) }
+    setCloExec(lifeFds[0]); setCloExec(lifeFds[1])
+    // The watchdog is only gone early if something killed it; never die of SIGPIPE for that.
+    _ = fcntl(lifeFds[1], F_SETNOSIGPIPE, 1)
+
+    var actions: posix_spawn_file_actions_t? = nil
+    posix_spawn_file_actions_init(&actions)
+    defer { posix_spawn_file_actions_destroy(&actions) }
+    posix_spawn_file_actions_adddup2(&actions, lifeFds[0], STDIN_FILENO)
+    posix_spawn_file_actions_adddup2(&actions, stdinFd, 3)
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0)
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0)
+
+    // In the worker's group, out of reach of a terminal's ^C: dying before the worker would
+    // hand it the EOF this is here to prevent.
+    var attr: posix_spawnattr_t? = nil
+    posix_spawnattr_init(&attr)
+    defer { posix_spawnattr_destroy(&attr) }
+    posix_spawnattr_setflags(&attr, Int16(POSIX_SPAWN_SETPGROUP))
+    posix_spawnattr_setpgroup(&attr, group)
+
+    var pid: pid_t = 0
+    var cArgs: [UnsafeMutablePointer<CChar>?] = ["/bin/sh", "-c", watchdogScript, "sh", String(group)].map { strdup($0) }
+    cArgs.append(nil)
+    defer { for p in cArgs where p != nil { free(p) } }
+    let rc = posix_spawn(&pid, "/bin/sh", &actions, &attr, &cArgs, nil)
+    close(lifeFds[0])
+    guard rc == 0 else {
+      close(lifeFds[1])
+      throw AgentProcessPoolError.spawnFailed(errno: Int32(rc))
+    }
+    return (pid, lifeFds[1])
+  }
+
+  /// Drains the process's output until it exits, killing it after `timeoutMs` or once `shouldStop`
+  /// says so.
+  private static func collect(
+    _ process: Worker,
+    timeoutMs: Int,
+    maxOutputBytes: Int,
+    onOutput: ((Data) -> Void)?,
+    shouldStop: (() -> Bool)?
+  ) -> (exitCode: Int32, output: Data, didTimeout: Bool, wasStopped: Bool) {
+    let pid = process.pid
+    let outFd = process.outputFd
+    let startNs = DispatchTime.now().uptimeNanoseconds
+    let timeoutNs = UInt64(max(0, timeoutMs)) * 1_000_000
+
+    var didTimeout = false
+    var wasStopped = false
+    var status: Int32? = nil
+    var sawEOF = false
+    var output = Data()
+    output.reserveCapacity(min(maxOutputBytes, 32 * 1024))
+
+    func drainOutput() {
+      if sawEOF { return }
+      var buf = [UInt8](repeating: 0, count: 8192)
+      while output.count < maxOutputBytes || onOutput != nil {
+        let n: Int = buf.withUnsafeMutableBytes { raw in
+          guard let base = raw.baseAddress else { return -1 }
+          return Darwin.read(outFd, base, raw.count)
+        }
+        if n > 0 {
+          if output.count < maxOutputBytes {
+            output.append(contentsOf: buf[0..<min(n, maxOutputBytes - output.count)])
+          }
+          onOutput?(Data(buf[0..<n]))
+          continue
+        }
+        if n == 0 {
+          sawEOF = true
+          break
+        }
+        if errno == EAGAIN || errno == EWOULDBLOCK {
+          break
+        }
+        sawEOF = true
+        break
+      }
+    }
+
+    while true {
+      drainOutput()
+
+      if status == nil {
+        var st: Int32 = 0
+        let w = waitpid(pid, &st, WNOHANG)
+        if w == pid {
+          status = st
+        }
+      }
+
+      if status != nil, sawEOF {
+        break
+      }
+
+      let elapsedNs = DispatchTime.now().uptimeNanoseconds - startNs
+      if status == nil, !didTimeout, !wasStopped, shouldStop?() == true {
+        wasStopped = true
+        kill(pid, SIGTERM)
+      }
+      if status == nil, elapsedNs > timeoutNs, !didTimeout {
+        didTimeout = true
+        kill(pid, SIGTERM)
+
+        let graceStart = DispatchTime.now().uptimeNanoseconds
+        while DispatchTime.now().uptimeNanoseconds - graceStart < 1_000_000_000 {
+          drainOutput()
+          var st: Int32 = 0
+          let w = waitpid(pid, &st, WNOHANG)
+          if w == pid {
+            status = st
+            break
+          }
+          var pfd = pollfd(fd: outFd, events: Int16(POLLIN | POLLHUP | POLLERR), revents: 0)
+          _ = poll(&pfd, 1, 20)
+        }
+
+        if status == nil {
+          kill(pid, SIGKILL)
+          var st: Int32 = 0
+          _ = waitpid(pid, &st, 0)
+          status = st
+        }
+      }
+
+      var pfd = pollfd(fd: outFd, events: Int16(POLLIN | POLLHUP | POLLERR), revents: 0)
+      _ = poll(&pfd, 1, 50)
+    }
+
+    close(outFd)
+
+    let st = status ?? 0
+    let wstatus = st & 0x7F
+    let exitCode: Int32
+    if wstatus == 0 {
+      exitCode = (st >> 8) & 0xFF
+    } else {
+      exitCode = 128 + wstatus
+    }
+    return (exitCode, output, didTimeout, wasStopped)
+  }
+}
@@ -25,8 +25,10 @@ public enum ClaudePromptEngineerError: Error, CustomStringConvertible {
 
 /// Prompt engineering agent powered by the Claude Code CLI (`claude --print`).
 ///
-/// Spawns `claude -p` per turn with a system prompt (the preamble) and the
-/// user turn text piped via stdin. Output is read directly from stdout.
+/// Runs `claude -p` per turn with a system prompt (the preamble) and the
+/// user turn text piped via stdin, taking a pre-spawned process from
+/// `AgentProcessPool` when one is ready. Output is read from stdout as
+/// `stream-json`, so text deltas reach `draftStream` while the turn runs.
 public final class ClaudePromptEngineerAdapter: AgentAdapting, @unchecked Sendable {
   private let command: String
   private let model: String
@@ -66,38 +68,91 @@ public final class ClaudePromptEngineerAdapter: AgentAdapting, @unchecked Sendab
   }
 
   public func draft(prompt: String, instruction: String, images: [URL], cwd: String?) async throws -> String {
-    if !images.isEmpty {
-      Self.adapterLog.warning("ClaudePromptEngineerAdapter does not yet support images; \(images.count) image(s) will be ignored")
-    }
-    guard let resolved = CommandResolver.resolveInPATH(command) else {
-      throw ClaudePromptEngineerError.commandNotFound
+    try await collectDraft(prompt: prompt, instruction: instruction, images: images, cwd: cwd)
+  }
+
+  public func draftStream(prompt: String, instruction: String, images: [URL], cwd: String?) -> AsyncThrowingStream<AgentDraftEvent, Error> {
+    AsyncThrowingStream { continuation in
+      if !images.isEmpty {
+        Self.adapterLog.warning("ClaudePromptEngineerAdapter does not yet support images; \(images.count) image(s) will be ignored")
+      }
+      guard let resolved = CommandResolver.resolveInPATH(command) else {
+        continuation.finish(throwing: ClaudePromptEngineerError.commandNotFound)
+        return
+      }
+      let cancellation = AgentRunCancellation()
+      continuation.onTermination = { _ in cancellation.cancel() }
+      let adapter = self
+      Task.detached {
+        do {
+          let out = try adapter.draftBlocking(
+            resolved: resolved,
+            prompt: prompt,
+            instruction: instruction,
+            cwd: cwd,
+            cancellation: cancellation,
+            emit: { continuation.yield($0) }
+          )
+          continuation.yield(.completed(out))
+          continuation.finish()
+        } catch {
+          continuation.finish(throwing: error)
+        }
+      }
     }
-    let adapter = self
-    return try await Task.detached {
-      try await adapter.draftBlocking(resolved: resolved, prompt: prompt, instruction: instruction, cwd: cwd)
-    }.value
   }
 
-  private func draftBlocking(resolved: String, prompt: String, instruction: String, cwd: String?) async throws -> String {
+  private func draftBlocking(
+    resolved: String,
+    prompt: String,
+    instruction: String,
+    cwd: String?,
+    cancellation: AgentRunCancellation,
+    emit: @escaping (AgentDraftEvent) -> Void
+  ) throws -> String {
     let profile = PromptEngineerPrompts.Profile(rawValue: promptProfile) ?? .largeOpt
     let preamble = PromptEngineerPrompts.preamble(for: profile)
     let userText = PromptEngineerPrompts.userTurnText(prompt: prompt, instruction: instruction)
 
-    let out1 = try runClaude(resolved: resolved, systemPrompt: preamble, userMessage: userText, cwd: cwd)
+    let turn1 = try runClaude(
+      resolved: resolved,
+      systemPrompt: preamble,
+      userMessage: userText,
+      cwd: cwd,
+      cancellation: cancellation,
+      stopOnSettledReasons: true,
+      emit: emit
+    )
 
-    let normalized1 = PromptEngineerOutputGuard.normalize(output: out1).trimmingCharacters(in: .whitespacesAndNewlines)
-    let check = PromptEngineerOutputGuard.check(draft: prompt, output: normalized1)
-    if !check.needsRepair {
-      return normalized1
+    let reasons: [String]
+    if let settled = turn1.settledReasons {
+      // The guard already rejected the partial output; don't wait for the rest of it.
+      reasons = settled
+    } else {
+      let normalized1 = PromptEngineerOutputGuard.normalize(output: turn1.text).trimmingCharacters(in: .whitespacesAndNewlines)
+      let check = PromptEngineerOutputGuard.check(draft: prompt, output: normalized1)
+      if !check.needsRepair {
+        return normalized1
+      }
+      reasons = check.reasons
     }
+    emit(.restart(reasons: reasons))
 
     // Repair turn with the repair instruction.
     let repairUserText = PromptEngineerPrompts.userTurnText(
       prompt: prompt,
       instruction: PromptEngineerPrompts.repairInstruction
     )
-    let out2Raw = try runClaude(resolved: resolved, systemPrompt: preamble, userMessage: repairUserText, cwd: cwd)
-    let out2 = PromptEngineerOutputGuard.normalize(output: out2Raw).trimmingCharacters(in: .whitespacesAndNewlines)
+    let turn2 = try runClaude(
+      resolved: resolved,
+      systemPrompt: preamble,
+      userMessage: repairUserText,
+      cwd: cwd,
+      cancellation: cancellation,
+      stopOnSettledReasons: false,
+      emit: emit
+    )
+    let out2 = PromptEngineerOutputGuard.normalize(output: turn2.text).trimmingCharacters(in: .whitespacesAndNewlines)
     let check2 = PromptEngineerOutputGuard.check(draft: prompt, output: out2)
     if check2.reasons.contains("missing_actionable_numbered_step_section") {
       throw ClaudePromptEngineerError.invalidOutput(check2.reasons)
@@ -105,18 +160,29 @@ public final class ClaudePromptEngineerAdapter: AgentAdapting, @unchecked Sendab
     return out2
   }
 
-  private func runClaude(resolved: String, systemPrompt: String, userMessage: String, cwd: String?) throws -> String {
-    // Write system prompt to temp file to avoid ARG_MAX issues with long preambles.
-    let preambleURL = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
-      .appendingPathComponent("turbodraft-claude-\(UUID().uuidString).txt")
-    try Data(systemPrompt.utf8).write(to: preambleURL, options: [.atomic])
-    defer { try? FileManager.default.removeItem(at: preambleURL) }
+  /// One `claude -p` turn. `settledReasons` is set when the run was cut short because the
+  /// streamed text already failed the output guard.
+  private func runClaude(
+    resolved: String,
+    systemPrompt: String,
+    userMessage: String,
+    cwd: String?,
+    cancellation: AgentRunCancellation,
+    stopOnSettledReasons: Bool,
+    emit: @escaping (AgentDraftEvent) -> Void
+  ) throws -> (text: String, settledReasons: [String]?) {
+    // System prompt goes in a file to avoid ARG_MAX issues with long preambles. The file is named
+    // by its content so the arguments stay the same from run to run and a pre-spawned process fits;
+    // the pool writes it and removes it with the last process that reads it.
+    let preamble = Self.preambleFile(for: systemPrompt)
 
     var args: [String] = [
       "-p",
       "--model", model,
-      "--system-prompt-file", preambleURL.path,
-      "--output-format", "text",
+      "--system-prompt-file", preamble.url.path,
+      "--output-format", "stream-json",
+      "--include-partial-messages",
+      "--verbose",
       "--effort", Self.claudeEffort(reasoningEffort),
       "--tools", "",
       "--max-turns", "1",
@@ -124,26 +190,60 @@ public final class ClaudePromptEngineerAdapter: AgentAdapting, @unchecked Sendab
     ]
     args.append(contentsOf: extraArgs)
 
-    let res = try spawnAndCapture(
-      executablePath: resolved,
-      arguments: args,
-      stdin: Data(userMessage.utf8),
-      timeoutMs: timeoutMs,
-      maxOutputBytes: maxOutputBytes,
-      cwd: cwd
-    )
+    var stream = ClaudeStreamParser()
+    var guardCheck = PromptEngineerOutputGuard.StreamingCheck()
+    var settled: [String]? = nil
+    let res: AgentProcessResult
+    do {
+      res = try AgentProcessPool.shared.run(
+        AgentProcessSpec(executablePath: resolved, arguments: args, cwd: cwd, files: [preamble]),
+        stdin: Data(userMessage.utf8),
+        timeoutMs: timeoutMs,
+        maxOutputBytes: maxOutputBytes,
+        onOutput: { chunk in
+          for delta in stream.append(chunk) {
+            emit(.delta(delta))
+            guard stopOnSettledReasons, settled == nil else { continue }
+            guardCheck.append(delta)
+            let reasons = guardCheck.settledReasons
+            if !reasons.isEmpty {
+              settled = reasons
+            }
+          }
+        },
+        shouldStop: { settled != nil || cancellation.isCancelled }
+      )
+    } catch AgentProcessPoolError.commandNotFound {
+      throw ClaudePromptEngineerError.commandNotFound
+    } catch let AgentProcessPoolError.spawnFailed(e) {
+      throw ClaudePromptEngineerError.spawnFailed(errno: e)
+    }
+    if cancellation.isCancelled {
+      throw CancellationError()
+    }
+    if res.wasStopped, let settled {
+      return (stream.text, settled)
+    }
     if res.didTimeout {
       throw ClaudePromptEngineerError.timedOut
     }
-    guard res.exitCode == 0 else {
-      let msg = summarizeFailureOutput(res.output)
+    guard res.exitCode == 0, !stream.isError else {
+      let msg = stream.isError ? (stream.result ?? "") : summarizeFailureOutput(res.output)
       throw ClaudePromptEngineerError.nonZeroExit(res.exitCode, msg.isEmpty ? "claude failed" : msg)
     }
 
-    if res.output.count > maxOutputBytes {
+    let text = stream.result ?? stream.text
+    if text.utf8.count > maxOutputBytes {
       throw ClaudePromptEngineerError.outputTooLarge
     }
-    return String(decoding: res.output, as: UTF8.self)
+    return (text, nil)
+  }
+
+  private static func preambleFile(for systemPrompt: String) -> AgentProcessSpec.File {
+    let fp = ContentFingerprint(text: systemPrompt)
+    let url = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+      .appendingPathComponent("turbodraft-claude-\(String(fp.high, radix: 16))\(String(fp.low, radix: 16)).txt")
+    return AgentProcessSpec.File(url: url, contents: Data(systemPrompt.utf8))
   }
 
   private func summarizeFailureOutput(_ data: Data) -> String {
@@ -166,161 +266,67 @@ public final class ClaudePromptEngineerAdapter: AgentAdapting, @unchecked Sendab
     return tail
   }
 
-  private struct SpawnResult {
-    var exitCode: Int32
-    var output: Data
-    var didTimeout: Bool
-  }
-
-  private func spawnAndCapture(executablePath: String, arguments: [String], stdin: Data, timeoutMs: Int, maxOutputBytes: Int, cwd: String? = nil) throws -> SpawnResult {
-    var inFds: [Int32] = [0, 0]
-    guard pipe(&inFds) == 0 else { throw ClaudePromptEngineerError.spawnFailed(errno: errno) }
-    var outFds: [Int32] = [0, 0]
-    guard pipe(&outFds) == 0 else {
-      close(inFds[0]); close(inFds[1])
-      throw ClaudePromptEngineerError.spawnFailed(errno: errno)
-    }
-
-    setCloExec(inFds[0]); setCloExec(inFds[1])
-    setCloExec(outFds[0]); setCloExec(outFds[1])
-
-    var actions: posix_spawn_file_actions_t? = nil
-    posix_spawn_file_actions_init(&actions)
-    defer { posix_spawn_file_actions_destroy(&actions) }
-
-    posix_spawn_file_actions_adddup2(&actions, inFds[0], STDIN_FILENO)
-    posix_spawn_file_actions_adddup2(&actions, outFds[1], STDOUT_FILENO)
-    posix_spawn_file_actions_adddup2(&actions, outFds[1], STDERR_FILENO)
-
-    posix_spawn_file_actions_addclose(&actions, inFds[1])
-    posix_spawn_file_actions_addclose(&actions, outFds[0])
-    posix_spawn_file_actions_addclose(&actions, inFds[0])
-    posix_spawn_file_actions_addclose(&actions, outFds[1])
-
-    if let cwd, !cwd.isEmpty {
-      posix_spawn_file_actions_addchdir_np(&actions, cwd)
-    }
-
-    var pid: pid_t = 0
-    let argv = [executablePath] + arguments
-    var cArgs: [UnsafeMutablePointer<CChar>?] = argv.map { strdup($0) }
-    cArgs.append(nil)
-    defer {
-      for p in cArgs where p != nil { free(p) }
-    }
-
-    let execDir = URL(fileURLWithPath: executablePath).deletingLastPathComponent().path
-    var cEnv: [UnsafeMutablePointer<CChar>?] = CommandResolver.buildEnv(prependingToPath: execDir).map { strdup($0) }
-    cEnv.append(nil)
-    defer { for p in cEnv where p != nil { free(p) } }
-
-    let rc = posix_spawn(&pid, executablePath, &actions, nil, &cArgs, &cEnv)
-    if rc != 0 {
-      close(inFds[0]); close(inFds[1]); close(outFds[0]); close(outFds[1])
-      if rc == ENOENT {
-        throw ClaudePromptEngineerError.commandNotFound
-      }
-      throw ClaudePromptEngineerError.spawnFailed(errno: Int32(rc))
-    }
-
-    close(inFds[0])
-    close(outFds[1])
-
-    do { try writeAll(fd: inFds[1], data: stdin) } catch { /* ignore */ }
-    close(inFds[1])
-
-    setNonBlocking(outFds[0])
-
-    let startNs = DispatchTime.now().uptimeNanoseconds
-    let timeoutNs = UInt64(max(0, timeoutMs)) * 1_000_000
-
-    var didTimeout = false
-    var status: Int32? = nil
-    var sawEOF = false
-    var output = Data()
-    output.reserveCapacity(min(maxOutputBytes, 32 * 1024))
+}
 
-    func drainOutput() {
-      if sawEOF { return }
-      var buf = [UInt8](repeating: 0, count: 8192)
-      while output.count < maxOutputBytes {
-        let n: Int = buf.withUnsafeMutableBytes { raw in
-          guard let base = raw.baseAddress else { return -1 }
-          return Darwin.read(outFds[0], base, raw.count)
-        }
-        if n > 0 {
-          output.append(contentsOf: buf[0..<n])
-          continue
-        }
-        if n == 0 {
-          sawEOF = true
-          break
-        }
-        if errno == EAGAIN || errno == EWOULDBLOCK {
-          break
-        }
-        sawEOF = true
-        break
+/// Pulls the reply out of `claude -p --output-format stream-json --include-partial-messages`:
+/// text deltas from `stream_event` lines as they arrive, and the final `result` line. Lines
+/// that aren't JSON (stderr shares the pipe) are skipped.
+struct ClaudeStreamParser {
+  /// The partial line after the last newline, always starting at index 0.
+  private var buffer = Data()
+  /// Bytes of `buffer` already searched for a newline, so a long event arriving in many chunks
+  /// is scanned once rather than from its start on every chunk.
+  private var scanned = 0
+  /// Concatenated text deltas so far.
+  private(set) var text = ""
+  /// The `result` line's text, once seen.
+  private(set) var result: String?
+  private(set) var isError = false
+
+  /// Feeds raw output; returns the text deltas completed by it.
+  mutating func append(_ chunk: Data) -> [String] {
+    buffer.append(chunk)
+    var deltas: [String] = []
+    var lineStart = 0
+    var searchFrom = scanned
+    while let newline = buffer[searchFrom...].firstIndex(of: UInt8(ascii: "\n")) {
+      if let delta = consume(buffer[lineStart..<newline]) {
+        deltas.append(delta)
       }
+      lineStart = newline + 1
+      searchFrom = lineStart
     }
-
-    while true {
-      drainOutput()
-
-      if status == nil {
-        var st: Int32 = 0
-        let w = waitpid(pid, &st, WNOHANG)
-        if w == pid {
-          status = st
-        }
-      }
-
-      if status != nil, sawEOF {
-        break
-      }
-
-      let elapsedNs = DispatchTime.now().uptimeNanoseconds - startNs
-      if status == nil, elapsedNs > timeoutNs, !didTimeout {
-        didTimeout = true
-        kill(pid, SIGTERM)
-
-        let graceStart = DispatchTime.now().uptimeNanoseconds
-        while DispatchTime.now().uptimeNanoseconds - graceStart < 1_000_000_000 {
-          drainOutput()
-          var st: Int32 = 0
-          let w = waitpid(pid, &st, WNOHANG)
-          if w == pid {
-            status = st
-            break
-          }
-          var pfd = pollfd(fd: outFds[0], events: Int16(POLLIN | POLLHUP | POLLERR), revents: 0)
-          _ = poll(&pfd, 1, 20)
-        }
-
-        if status == nil {
-          kill(pid, SIGKILL)
-          var st: Int32 = 0
-          _ = waitpid(pid, &st, 0)
-          status = st
-        }
-      }
-
-      var pfd = pollfd(fd: outFds[0], events: Int16(POLLIN | POLLHUP | POLLERR), revents: 0)
-      _ = poll(&pfd, 1, 50)
+    // Drop the complete lines in one move instead of one per line.
+    if lineStart > 0 {
+      buffer = Data(buffer[lineStart...])
     }
+    scanned = buffer.count
+    return deltas
+  }
 
-    close(outFds[0])
-
-    let st = status ?? 0
-    let wstatus = st & 0x7F
-    let exitCode: Int32
-    if wstatus == 0 {
-      exitCode = (st >> 8) & 0xFF
-    } else {
-      exitCode = 128 + wstatus
+  private mutating func consume(_ line: Data) -> String? {
+    guard line.first == UInt8(ascii: "{"),
+          let obj = (try? JSONSerialization.jsonObject(with: line)) as? [String: Any],
+          let type = obj["type"] as? String
+    else { return nil }
+
+    switch type {
+    case "stream_event":
+      guard let event = obj["event"] as? [String: Any],
+            event["type"] as? String == "content_block_delta",
+            let delta = event["delta"] as? [String: Any],
+            delta["type"] as? String == "text_delta",
+            let piece = delta["text"] as? String,
+            !piece.isEmpty
+      else { return nil }
+      text += piece
+      return piece
+    case "result":
+      result = obj["result"] as? String
+      isError = (obj["is_error"] as? Bool) ?? false
+      return nil
+    default:
+      return nil
     }
-
-    return SpawnResult(exitCode: exitCode, output: output, didTimeout: didTimeout)
   }
-
 }
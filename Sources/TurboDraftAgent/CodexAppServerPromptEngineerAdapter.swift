@@ -32,6 +32,7 @@ public enum CodexAppServerPromptEngineerError: Error, CustomStringConvertible {
 ///
 /// This adapter keeps a warm app-server process for low per-turn latency.
 /// Transport is stdio with JSON Lines messages (one JSON object per line).
+/// `item/agentMessage/delta` notifications are forwarded to `draftStream` as they arrive.
 public final class CodexAppServerPromptEngineerAdapter: AgentAdapting, @unchecked Sendable {
   private let command: String
   private let model: String
@@ -76,12 +77,27 @@ public final class CodexAppServerPromptEngineerAdapter: AgentAdapting, @unchecke
   }
 
   public func draft(prompt: String, instruction: String, images: [URL], cwd: String?) async throws -> String {
-    try await withCheckedThrowingContinuation { cont in
+    try await collectDraft(prompt: prompt, instruction: instruction, images: images, cwd: cwd)
+  }
+
+  public func draftStream(prompt: String, instruction: String, images: [URL], cwd: String?) -> AsyncThrowingStream<AgentDraftEvent, Error> {
+    AsyncThrowingStream { continuation in
+      let cancellation = AgentRunCancellation()
+      continuation.onTermination = { _ in cancellation.cancel() }
       queue.async {
         do {
-          cont.resume(returning: try self.draftSync(prompt: prompt, instruction: instruction, images: images, cwd: cwd))
+          let out = try self.draftSync(
+            prompt: prompt,
+            instruction: instruction,
+            images: images,
+            cwd: cwd,
+            cancellation: cancellation,
+            emit: { continuation.yield($0) }
+          )
+          continuation.yield(.completed(out))
+          continuation.finish()
         } catch {
-          cont.resume(throwing: error)
+          continuation.finish(throwing: error)
         }
       }
     }
@@ -93,7 +109,9 @@ public final class CodexAppServerPromptEngineerAdapter: AgentAdapting, @unchecke
     prompt: String,
     instruction: String,
     effortOverride: String?,
-    images: [URL]
+    images: [URL],
+    cancellation: AgentRunCancellation,
+    emit: (AgentDraftEvent) -> Void
   ) throws -> String {
     let userText = PromptEngineerPrompts.userTurnText(prompt: prompt, instruction: instruction)
     var inputItems: [[String: Any]] = [["type": "text", "text": userText]]
@@ -130,6 +148,10 @@ public final class CodexAppServerPromptEngineerAdapter: AgentAdapting, @unchecke
     var sawFinalAgent = false
 
     while DispatchTime.now().uptimeNanoseconds < endByNs {
+      if cancellation.isCancelled {
+        // Later messages for this turn are dropped by the turnId checks of the next one.
+        throw CancellationError()
+      }
       let remainingMs = Int((endByNs - DispatchTime.now().uptimeNanoseconds) / 1_000_000)
       guard let msg = try s.readNextMessage(timeoutMs: max(10, min(500, remainingMs))) else {
         continue
@@ -142,8 +164,9 @@ public final class CodexAppServerPromptEngineerAdapter: AgentAdapting, @unchecke
            !sawFinalAgent,
            let delta = params["delta"] as? String
         {
-          if agentText.count + delta.utf8.count <= maxOutputBytes {
+          if agentText.utf8.count + delta.utf8.count <= maxOutputBytes {
             agentText += delta
+            emit(.delta(delta))
           }
           continue
         }
@@ -200,7 +223,14 @@ public final class CodexAppServerPromptEngineerAdapter: AgentAdapting, @unchecke
     throw CodexAppServerPromptEngineerError.timedOut
   }
 
-  private func draftSync(prompt: String, instruction: String, images: [URL], cwd: String?) throws -> String {
+  private func draftSync(
+    prompt: String,
+    instruction: String,
+    images: [URL],
+    cwd: String?,
+    cancellation: AgentRunCancellation,
+    emit: (AgentDraftEvent) -> Void
+  ) throws -> String {
     let s = try ensureServer()
     try s.ensureInitialized(timeoutMs: 10_000)
     let profile = PromptEngineerPrompts.Profile(rawValue: promptProfile) ?? .largeOpt
@@ -227,12 +257,13 @@ public final class CodexAppServerPromptEngineerAdapter: AgentAdapting, @unchecke
     }
 
     let baseEff = PromptEngineerPrompts.effectiveReasoningEffort(model: model, requested: reasoningEffort)
-    let out1Raw = try runTurn(s: s, threadId: threadId, prompt: prompt, instruction: instruction, effortOverride: baseEff, images: images)
+    let out1Raw = try runTurn(s: s, threadId: threadId, prompt: prompt, instruction: instruction, effortOverride: baseEff, images: images, cancellation: cancellation, emit: emit)
     let out1 = PromptEngineerOutputGuard.normalize(output: out1Raw).trimmingCharacters(in: .whitespacesAndNewlines)
     let check = PromptEngineerOutputGuard.check(draft: prompt, output: out1)
     if !check.needsRepair {
       return out1
     }
+    emit(.restart(reasons: check.reasons))
 
     let repairEff = PromptEngineerOutputGuard.suggestedRepairEffort(baseEff)
     let out2Raw = try runTurn(
@@ -241,7 +272,9 @@ public final class CodexAppServerPromptEngineerAdapter: AgentAdapting, @unchecke
       prompt: prompt,
       instruction: PromptEngineerPrompts.repairInstruction,
       effortOverride: repairEff.isEmpty ? baseEff : repairEff,
-      images: []
+      images: [],
+      cancellation: cancellation,
+      emit: emit
     )
     let out2 = PromptEngineerOutputGuard.normalize(output: out2Raw).trimmingCharacters(in: .whitespacesAndNewlines)
     let check2 = PromptEngineerOutputGuard.check(draft: prompt, output: out2)
@@ -29,6 +29,7 @@ public enum CodexPromptEngineerError: Error, CustomStringConvertible {
 ///
 /// This adapter writes the final assistant message to a temp file via
 /// `--output-last-message` and returns that file content as the “draft”.
+/// Runs go through `AgentProcessPool`, so a pre-spawned `codex exec` is used when one is ready.
 public final class CodexPromptEngineerAdapter: AgentAdapting, @unchecked Sendable {
   private let command: String
   private let model: String
@@ -79,7 +80,7 @@ public final class CodexPromptEngineerAdapter: AgentAdapting, @unchecked Sendabl
     guard let resolved = CommandResolver.resolveInPATH(command) else {
       throw CodexPromptEngineerError.commandNotFound
     }
-    // Run blocking posix_spawn + poll loop off the cooperative thread pool.
+    // Run the blocking pool checkout + poll loop off the cooperative thread pool.
     let adapter = self
     return try await Task.detached {
       try await adapter.draftBlocking(resolved: resolved, prompt: prompt, instruction: instruction, images: images, cwd: cwd)
@@ -141,10 +142,6 @@ public final class CodexPromptEngineerAdapter: AgentAdapting, @unchecked Sendabl
   }
 
   private func runCodex(resolved: String, stdin: Data, modelOverride: String?, reasoningEffortOverride: String?, images: [URL], cwd: String?) throws -> String {
-    let outURL = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
-      .appendingPathComponent("turbodraft-codex-\(UUID().uuidString).txt")
-    defer { try? FileManager.default.removeItem(at: outURL) }
-
     // Use Codex CLI exec mode. `-` reads from stdin.
     var args: [String] = [
       "exec",
@@ -153,7 +150,7 @@ public final class CodexPromptEngineerAdapter: AgentAdapting, @unchecked Sendabl
       "--sandbox",
       "read-only",
       "--output-last-message",
-      outURL.path,
+      AgentProcessPool.scratchPathPlaceholder,
     ]
     let m = modelOverride?.trimmingCharacters(in: .whitespacesAndNewlines) ?? ""
     if !m.isEmpty {
@@ -183,7 +180,21 @@ public final class CodexPromptEngineerAdapter: AgentAdapting, @unchecked Sendabl
     args.append(contentsOf: extraArgs)
     args.append("-")
 
-    let res = try spawnAndCapture(executablePath: resolved, arguments: args, stdin: stdin, timeoutMs: timeoutMs, maxOutputBytes: 256 * 1024, cwd: cwd)
+    // Image runs are one-offs; don't leave a process waiting on the same attachments.
+    let res: AgentProcessResult
+    do {
+      res = try AgentProcessPool.shared.run(
+        AgentProcessSpec(executablePath: resolved, arguments: args, cwd: cwd),
+        stdin: stdin,
+        timeoutMs: timeoutMs,
+        maxOutputBytes: 256 * 1024,
+        keepWarm: images.isEmpty
+      )
+    } catch AgentProcessPoolError.commandNotFound {
+      throw CodexPromptEngineerError.commandNotFound
+    } catch let AgentProcessPoolError.spawnFailed(e) {
+      throw CodexPromptEngineerError.spawnFailed(errno: e)
+    }
     if res.didTimeout {
       throw CodexPromptEngineerError.timedOut
     }
@@ -192,7 +203,7 @@ public final class CodexPromptEngineerAdapter: AgentAdapting, @unchecked Sendabl
       throw CodexPromptEngineerError.nonZeroExit(res.exitCode, msg.isEmpty ? "codex exec failed" : msg)
     }
 
-    guard let data = try? Data(contentsOf: outURL) else {
+    guard let data = res.scratchOutput else {
       throw CodexPromptEngineerError.missingOutputFile
     }
 
@@ -231,165 +242,4 @@ public final class CodexPromptEngineerAdapter: AgentAdapting, @unchecked Sendabl
     return tail
   }
 
-  private struct SpawnResult {
-    var exitCode: Int32
-    var output: Data
-    var didTimeout: Bool
-  }
-
-  private func spawnAndCapture(executablePath: String, arguments: [String], stdin: Data, timeoutMs: Int, maxOutputBytes: Int, cwd: String? = nil) throws -> SpawnResult {
-    var inFds: [Int32] = [0, 0]
-    guard pipe(&inFds) == 0 else { throw CodexPromptEngineerError.spawnFailed(errno: errno) }
-    var outFds: [Int32] = [0, 0]
-    guard pipe(&outFds) == 0 else {
-      close(inFds[0]); close(inFds[1])
-      throw CodexPromptEngineerError.spawnFailed(errno: errno)
-    }
-
-    setCloExec(inFds[0]); setCloExec(inFds[1])
-    setCloExec(outFds[0]); setCloExec(outFds[1])
-
-    var actions: posix_spawn_file_actions_t? = nil
-    posix_spawn_file_actions_init(&actions)
-    defer { posix_spawn_file_actions_destroy(&actions) }
-
-    posix_spawn_file_actions_adddup2(&actions, inFds[0], STDIN_FILENO)
-    posix_spawn_file_actions_adddup2(&actions, outFds[1], STDOUT_FILENO)
-    posix_spawn_file_actions_adddup2(&actions, outFds[1], STDERR_FILENO)
-
-    posix_spawn_file_actions_addclose(&actions, inFds[1])
-    posix_spawn_file_actions_addclose(&actions, outFds[0])
-    posix_spawn_file_actions_addclose(&actions, inFds[0])
-    posix_spawn_file_actions_addclose(&actions, outFds[1])
-
-    if let cwd, !cwd.isEmpty {
-      posix_spawn_file_actions_addchdir_np(&actions, cwd)
-    }
-
-    var pid: pid_t = 0
-    let argv = [executablePath] + arguments
-    var cArgs: [UnsafeMutablePointer<CChar>?] = argv.map { strdup($0) }
-    cArgs.append(nil)
-    defer {
-      for p in cArgs where p != nil { free(p) }
-    }
-
-    // Prepend the executable's own directory to PATH so that shebang interpreters
-    // (e.g. `#!/usr/bin/env node`) resolve when running under a LaunchAgent whose
-    // PATH omits nvm/fnm-managed bin directories.
-    let execDir = URL(fileURLWithPath: executablePath).deletingLastPathComponent().path
-    var cEnv: [UnsafeMutablePointer<CChar>?] = CommandResolver.buildEnv(prependingToPath: execDir).map { strdup($0) }
-    cEnv.append(nil)
-    defer { for p in cEnv where p != nil { free(p) } }
-
-    let rc = posix_spawn(&pid, executablePath, &actions, nil, &cArgs, &cEnv)
-    if rc != 0 {
-      close(inFds[0]); close(inFds[1]); close(outFds[0]); close(outFds[1])
-      if rc == ENOENT {
-        throw CodexPromptEngineerError.commandNotFound
-      }
-      throw CodexPromptEngineerError.spawnFailed(errno: Int32(rc))
-    }
-
-    close(inFds[0])
-    close(outFds[1])
-
-    // Write prompt to child stdin. writeAll handles partial writes on non-blocking FDs.
-    do { try writeAll(fd: inFds[1], data: stdin) } catch { /* ignore */ }
-    close(inFds[1])
-
-    setNonBlocking(outFds[0])
-
-    let startNs = DispatchTime.now().uptimeNanoseconds
-    let timeoutNs = UInt64(max(0, timeoutMs)) * 1_000_000
-
-    var didTimeout = false
-    var status: Int32? = nil
-    var sawEOF = false
-    var output = Data()
-    output.reserveCapacity(min(maxOutputBytes, 32 * 1024))
-
-    func drainOutput() {
-      if sawEOF { return }
-      var buf = [UInt8](repeating: 0, count: 8192)
-      while output.count < maxOutputBytes {
-        let n: Int = buf.withUnsafeMutableBytes { raw in
-          guard let base = raw.baseAddress else { return -1 }
-          return Darwin.read(outFds[0], base, raw.count)
-        }
-        if n > 0 {
-          output.append(contentsOf: buf[0..<n])
-          continue
-        }
-        if n == 0 {
-          sawEOF = true
-          break
-        }
-        if errno == EAGAIN || errno == EWOULDBLOCK {
-          break
-        }
-        sawEOF = true
-        break
-      }
-    }
-
-    while true {
-      drainOutput()
-
-      if status == nil {
-        var st: Int32 = 0
-        let w = waitpid(pid, &st, WNOHANG)
-        if w == pid {
-          status = st
-        }
-      }
-
-      if status != nil, sawEOF {
-        break
-      }
-
-      let elapsedNs = DispatchTime.now().uptimeNanoseconds - startNs
-      if status == nil, elapsedNs > timeoutNs, !didTimeout {
-        didTimeout = true
-        kill(pid, SIGTERM)
-
-        let graceStart = DispatchTime.now().uptimeNanoseconds
-        while DispatchTime.now().uptimeNanoseconds - graceStart < 1_000_000_000 {
-          drainOutput()
-          var st: Int32 = 0
-          let w = waitpid(pid, &st, WNOHANG)
-          if w == pid {
-            status = st
-            break
-          }
-          var pfd = pollfd(fd: outFds[0], events: Int16(POLLIN | POLLHUP | POLLERR), revents: 0)
-          _ = poll(&pfd, 1, 20)
-        }
-
-        if status == nil {
-          kill(pid, SIGKILL)
-          var st: Int32 = 0
-          _ = waitpid(pid, &st, 0)
-          status = st
-        }
-      }
-
-      var pfd = pollfd(fd: outFds[0], events: Int16(POLLIN | POLLHUP | POLLERR), revents: 0)
-      _ = poll(&pfd, 1, 50)
-    }
-
-    close(outFds[0])
-
-    let st = status ?? 0
-    let wstatus = st & 0x7F
-    let exitCode: Int32
-    if wstatus == 0 {
-      exitCode = (st >> 8) & 0xFF
-    } else {
-      exitCode = 128 + wstatus
-    }
-
-    return SpawnResult(exitCode: exitCode, output: output, didTimeout: didTimeout)
-  }
-
 }
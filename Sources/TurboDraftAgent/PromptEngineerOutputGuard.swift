@@ -35,13 +35,7 @@ public enum PromptEngineerOutputGuard {
       reasons.append("leaked_system_preamble")
     }
 
-    if lc.contains("draft prompt to rewrite")
-      || lc.contains("rewriting rules")
-      || lc.contains("output requirements")
-      || lc.contains("draft_prompt:")
-      || lc.contains("draft prompt (markdown):")
-      || lc.contains("draft prompt to improve:")
-    {
+    if containsRewriterPhrase(lc: lc) {
       reasons.append("looks_like_prompt_rewriter")
     }
 
@@ -64,6 +58,88 @@ public enum PromptEngineerOutputGuard {
     return Result(needsRepair: !reasons.isEmpty, reasons: reasons)
   }
 
+  /// `check` fed as the output streams in. Complete lines are checked as they arrive, so a reason
+  /// no later text can clear (leaked markers, a rewriter-style reply, …) shows up in
+  /// `settledReasons` mid-stream and the caller can cut the turn short. `finish` gives the same
+  /// result `check` would for the concatenated chunks.
+  public struct StreamingCheck {
+    private var text = ""
+    /// Text after the last line break, not yet checked.
+    private var pending = ""
+    private var containsMarkers = false
+    private var leakedPreamble = false
+    private var looksLikeRewriter = false
+    private var inputsNeededHeading = false
+    private var todoPlaceholders = false
+    private var inSteps = false
+    private var numberedStepCount = 0
+
+    public init() {}
+
+    /// Reasons already certain to be in the final result, in `check`'s order.
+    public var settledReasons: [String] {
+      var reasons: [String] = []
+      if containsMarkers { reasons.append("contains_prompt_markers") }
+      if leakedPreamble { reasons.append("leaked_system_preamble") }
+      if looksLikeRewriter { reasons.append("looks_like_prompt_rewriter") }
+      if inputsNeededHeading { reasons.append("uses_inputs_needed_heading") }
+      if todoPlaceholders { reasons.append("contains_todo_paste_placeholders") }
+      return reasons
+    }
+
+    public mutating func append(_ chunk: String) {
+      text += chunk
+      pending += chunk
+      // Split where `normalize` would: on "\n" characters of the text so far, so a "\r\n" that
+      // straddles two chunks stays one character.
+      guard let lastBreak = pending.lastIndex(of: "\n") else { return }
+      for segment in pending[..<lastBreak].split(separator: "\n", omittingEmptySubsequences: false) {
+        consume(String(segment))
+      }
+      pending = String(pending[pending.index(after: lastBreak)...])
+    }
+
+    public mutating func finish(draft: String) -> Result {
+      consume(pending)
+      pending = ""
+      var reasons: [String] = []
+      if text.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty {
+        reasons.append("empty_output")
+      }
+      if containsMarkers { reasons.append("contains_prompt_markers") }
+      if leakedPreamble { reasons.append("leaked_system_preamble") }
+      if looksLikeRewriter { reasons.append("looks_like_prompt_rewriter") }
+      if containsDraftPrefix(draft: draft, output: normalize(output: text)) {
+        reasons.append("contains_draft_prefix")
+      }
+      if inputsNeededHeading { reasons.append("uses_inputs_needed_heading") }
+      if todoPlaceholders { reasons.append("contains_todo_paste_placeholders") }
+      if numberedStepCount < 2 { reasons.append("missing_actionable_numbered_step_section") }
+      return Result(needsRepair: !reasons.isEmpty, reasons: reasons)
+    }
+
+    private mutating func consume(_ segment: String) {
+      let line = normalizeHeadingAliases(in: segment)
+      let lc = line.lowercased()
+      containsMarkers = containsMarkers || line.contains("<BEGIN_PROMPT>") || line.contains("<END_PROMPT>")
+      leakedPreamble = leakedPreamble || lc.contains("you are turbodraft, a prompt engineering assistant")
+      looksLikeRewriter = looksLikeRewriter || containsRewriterPhrase(lc: lc)
+      todoPlaceholders = todoPlaceholders || containsTodoPastePlaceholders(lc: lc)
+
+      let lines = line.split(whereSeparator: \.isNewline).map { String($0) }
+      inputsNeededHeading = inputsNeededHeading || usesInputsNeededHeading(lines: lines)
+      for ln in lines where numberedStepCount < 2 {
+        if let (_, title) = parseHeading(ln) {
+          inSteps = (title.lowercased() == "implementation steps")
+          continue
+        }
+        if inSteps, isNumberedListItem(ln) {
+          numberedStepCount += 1
+        }
+      }
+    }
+  }
+
   public static func suggestedRepairEffort(_ effectiveEffort: String) -> String {
     let e = effectiveEffort.trimmingCharacters(in: .whitespacesAndNewlines).lowercased()
     switch e {
@@ -76,6 +152,15 @@ public enum PromptEngineerOutputGuard {
     }
   }
 
+  private static func containsRewriterPhrase(lc: String) -> Bool {
+    lc.contains("draft prompt to rewrite")
+      || lc.contains("rewriting rules")
+      || lc.contains("output requirements")
+      || lc.contains("draft_prompt:")
+      || lc.contains("draft prompt (markdown):")
+      || lc.contains("draft prompt to improve:")
+  }
+
   private static func containsDraftPrefix(draft: String, output: String) -> Bool {
     let d = collapseWhitespace(draft)
     let o = collapseWhitespace(output)
@@ -4,6 +4,7 @@ import os
 import TurboDraftAgent
 import TurboDraftConfig
 import TurboDraftCore
+import TurboDraftMarkdown
 import TurboDraftProtocol
 import TurboDraftTransport
 
@@ -11,22 +12,32 @@ import TurboDraftTransport
 final class AppDelegate: NSObject, NSApplicationDelegate {
   private var allWindowControllers: [EditorWindowController] = []
   private var idleWindowControllers: [EditorWindowController] = []
-  private var sessionsById: [String: EditorSession] = [:]
-  private var windowsById: [String: EditorWindowController] = [:]
-  private var sessionPathById: [String: String] = [:]
-  private var sessionLastTouchedById: [String: Date] = [:]
+  private var idlePoolSizer = IdleWindowPoolSizer()
+  private var idlePoolReplenishTask: Task<Void, Never>?
+  /// When each pooled window entered the pool; dropped once it has been deep-trimmed.
+  private var idlePooledAt: [ObjectIdentifier: Date] = [:]
+  private var memoryPressureSource: DispatchSourceMemoryPressure?
+  /// The pool keeps no spare windows until this passes.
+  private var memoryPressureHoldUntil = Date.distantPast
+  /// Sessions that go 120s untouched after their window is gone are closed.
+  private var sessions = SessionRegistry<EditorSession, EditorWindowController>(orphanMaxAgeNs: 120 * 1_000_000_000)
+  /// Fires at `sessions.nextDeadlineNs`; `sessionExpiryArmedNs` is what it's set for.
+  private var sessionExpiryTimer: DispatchSourceTimer?
+  private var sessionExpiryArmedNs: UInt64?
   private weak var focusedWindowController: EditorWindowController?
+  /// Recent traced opens by trace id, oldest first in `openTraceOrder`.
+  private var openTraces: [String: OpenTrace] = [:]
+  private var openTraceOrder: [String] = []
+  private let openTraceLimit = 32
 
   private var socketServer: UnixDomainSocketServer?
   private var stdioServer: JSONRPCServerConnection?
-  private var sessionSweepTask: Task<Void, Never>?
-  private var lastSessionSweepAt = Date.distantPast
-  private var telemetryHandle: FileHandle?
-  private lazy var telemetryFileURL: URL? = {
+  private var maintenanceTask: Task<Void, Never>?
+  private lazy var telemetry: TelemetryLog? = {
     do {
       let dir = try TurboDraftPaths.applicationSupportDir().appendingPathComponent("telemetry", isDirectory: true)
       try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
-      return dir.appendingPathComponent("editor-open.jsonl")
+      return TelemetryLog(fileURL: dir.appendingPathComponent("app-events.tdlog"))
     } catch {
       Self.appLog.warning("Failed to prepare telemetry path: \(String(describing: error), privacy: .public)")
       return nil
@@ -48,27 +59,32 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
   private let startHidden = CommandLine.arguments.contains("--start-hidden")
   private let terminateOnLastClose = CommandLine.arguments.contains("--terminate-on-last-close")
   private static let appLog = Logger(subsystem: "com.turbodraft", category: "AppDelegate")
-  private static let telemetryDateFormatter = ISO8601DateFormatter()
-  private let sessionSweepInterval: TimeInterval = 60
-  private let orphanSessionMaxAge: TimeInterval = 120
+  private let maintenanceInterval: TimeInterval = 60
+  private let idleWindowDeepTrimAfter: TimeInterval = 5 * 60
+  private let memoryPressureHold: TimeInterval = 10 * 60
 
   func applicationDidFinishLaunching(_ notification: Notification) {
     NSWindow.allowsAutomaticWindowTabbing = false
     // Lower tooltip hover delay for snappier in-editor discoverability.
     UserDefaults.standard.register(defaults: ["NSInitialToolTipDelay": 180])
     cleanUpStaleTempFiles()
+    try? TurboDraftSocketPathCache.publish()
     colorThemes = EditorColorTheme.allThemes()
+    seedIdlePoolSizer()
 
     if !startHidden {
       let wc = makeWindowController(session: EditorSession(), showInDock: true)
       wc.showWindow(nil)
       focusedWindowController = wc
     } else {
-      // Pre-create one idle window so first Ctrl+G is instant.
+      // Pre-create one idle window so first Ctrl+G is instant; the rest of the pool follows.
       let wc = makeWindowController(session: EditorSession(), showInDock: false)
-      idleWindowControllers.append(wc)
+      wc.warmUpForIdlePool()
+      parkIdleWindowController(wc)
     }
     installMenu()
+    startMemoryPressureSource()
+    scheduleIdlePoolReplenish()
 
     NotificationCenter.default.addObserver(
       self,
@@ -87,15 +103,15 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
       do {
         try ensureSocketDirectorySecure(for: cfg.socketPath)
 
-        let server = try UnixDomainSocketServer(socketPath: cfg.socketPath)
+        let server = try UnixDomainSocketServer(socketPath: cfg.socketPath, maxConcurrentConnections: cfg.maxClientConnections)
         socketServer = server
-        server.start { [weak self] clientFD in
+        server.start { [weak self] clientFD, lease in
           guard let self else { return }
-          Task { @MainActor [self, clientFD] in
-            self.handleClient(fd: clientFD)
-          }
+          self.handleClient(fd: clientFD, lease: lease)
         }
+        LaunchReadiness.finish(listening: true)
       } catch {
+        LaunchReadiness.finish(listening: false)
         if case UnixDomainSocketError.alreadyRunning = error {
           NSApplication.shared.terminate(nil)
           return
@@ -104,7 +120,7 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
       }
     }
 
-    startSessionSweepTask()
+    startMaintenanceTask()
 
     if CommandLine.arguments.contains("--stdio") {
       startStdioServer()
@@ -179,9 +195,12 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
   }
 
   private func performGracefulShutdown() async {
-    stopSessionSweepTask()
-    try? telemetryHandle?.close()
-    telemetryHandle = nil
+    stopMaintenanceTask()
+    sessionExpiryTimer?.cancel()
+    sessionExpiryTimer = nil
+    idlePoolReplenishTask?.cancel()
+    memoryPressureSource?.cancel()
+    telemetry?.flush()
 
     // Race all flushes against a 5s overall timeout to prevent quit hang.
     await withTaskGroup(of: Void.self) { group in
@@ -189,7 +208,7 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
         for wc in self.allWindowControllers {
           await wc.flushAutosaveNow(reason: "app_terminate")
         }
-        for session in self.sessionsById.values {
+        for session in self.sessions.sessions {
           await session.markClosed()
         }
       }
@@ -199,6 +218,7 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
       _ = await group.next()
       group.cancelAll()
     }
+    AgentProcessPool.shared.drain()
   }
 
   private func ensureSocketDirectorySecure(for socketPath: String) throws {
@@ -244,53 +264,64 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
     }
   }
 
-  private func startSessionSweepTask() {
-    stopSessionSweepTask()
-    sessionSweepTask = Task { [weak self] in
+  private func startMaintenanceTask() {
+    stopMaintenanceTask()
+    maintenanceTask = Task { [weak self] in
       while !Task.isCancelled {
-        let intervalSeconds = self?.sessionSweepInterval ?? 60
+        let intervalSeconds = self?.maintenanceInterval ?? 60
         let sleepNs = UInt64(max(1.0, intervalSeconds) * 1_000_000_000)
         try? await Task.sleep(nanoseconds: sleepNs)
         guard let self else { return }
-        await self.sweepOrphanSessionsIfNeeded(force: true, reason: "periodic")
+        // The target follows time of day; grow or shrink the pool as the hour turns.
+        self.scheduleIdlePoolReplenish()
+        self.trimLongIdleWindows()
       }
     }
   }
 
-  private func stopSessionSweepTask() {
-    sessionSweepTask?.cancel()
-    sessionSweepTask = nil
+  private func stopMaintenanceTask() {
+    maintenanceTask?.cancel()
+    maintenanceTask = nil
   }
 
-  private func sweepOrphanSessionsIfNeeded(force: Bool = false, reason: String) async {
-    let now = Date()
-    if !force, now.timeIntervalSince(lastSessionSweepAt) < sessionSweepInterval {
+  /// Points the expiry timer at the registry's earliest deadline. Touches only push deadlines
+  /// later, so from the request path this is a comparison; the timer fires at most once per
+  /// deadline that surfaced, early ones included.
+  private func armSessionExpiryTimer() {
+    guard let deadline = sessions.nextDeadlineNs else {
+      sessionExpiryTimer?.cancel()
+      sessionExpiryTimer = nil
+      sessionExpiryArmedNs = nil
       return
     }
-    lastSessionSweepAt = now
-
-    var staleSessionIDs: [String] = []
-    for id in sessionsById.keys {
-      if windowsById[id] != nil {
-        continue
-      }
-      let touchedAt = sessionLastTouchedById[id] ?? .distantPast
-      if now.timeIntervalSince(touchedAt) >= orphanSessionMaxAge {
-        staleSessionIDs.append(id)
+    if let armed = sessionExpiryArmedNs, armed <= deadline { return }
+    let timer: DispatchSourceTimer
+    if let existing = sessionExpiryTimer {
+      timer = existing
+    } else {
+      timer = DispatchSource.makeTimerSource(queue: .main)
+      timer.setEventHandler { [weak self] in
+        Task { @MainActor [weak self] in
+          await self?.expireOrphanSessions()
+        }
       }
+      sessionExpiryTimer = timer
+      timer.resume()
     }
+    sessionExpiryArmedNs = deadline
+    // Sessions live for minutes; a second of leeway lets the system coalesce the wakeup.
+    timer.schedule(deadline: DispatchTime(uptimeNanoseconds: deadline), leeway: .seconds(1))
+  }
 
-    for id in staleSessionIDs {
-      if let session = sessionsById.removeValue(forKey: id) {
-        await session.markClosed()
-      }
-      windowsById.removeValue(forKey: id)
-      sessionPathById.removeValue(forKey: id)
-      sessionLastTouchedById.removeValue(forKey: id)
+  private func expireOrphanSessions() async {
+    sessionExpiryArmedNs = nil
+    let expired = sessions.popExpired(nowNs: DispatchTime.now().uptimeNanoseconds)
+    armSessionExpiryTimer()
+    for entry in expired {
+      await entry.session.markClosed()
     }
-
-    if !staleSessionIDs.isEmpty {
-      Self.appLog.info("Swept \(staleSessionIDs.count) orphaned session(s) (\(reason, privacy: .public))")
+    if !expired.isEmpty {
+      Self.appLog.info("Expired \(expired.count) orphaned session(s)")
     }
   }
 
@@ -337,36 +368,136 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
   }
 
   private func dequeueIdleWindowController() -> EditorWindowController {
+    defer { scheduleIdlePoolReplenish() }
     if let wc = idleWindowControllers.popLast() {
+      idlePooledAt.removeValue(forKey: ObjectIdentifier(wc))
       return wc
     }
     return makeWindowController(session: EditorSession(), showInDock: false)
   }
 
-  private func handleWindowClosed(_ wc: EditorWindowController) {
-    let removedSessionIds = windowsById.compactMap { key, value in
-      value === wc ? key : nil
+  private var visibleWindowCount: Int {
+    allWindowControllers.count - idleWindowControllers.count
+  }
+
+  /// Tops the idle pool up to the sizer's target, one warmed window per main-loop turn so an
+  /// open that just dequeued gets presented first. Excess idle windows are released.
+  private func scheduleIdlePoolReplenish() {
+    guard idlePoolReplenishTask == nil else { return }
+    idlePoolReplenishTask = Task { @MainActor [weak self] in
+      // Let the window that was just dequeued present before building its replacement.
+      try? await Task.sleep(nanoseconds: 150_000_000)
+      while let self, !Task.isCancelled {
+        let target = self.idlePoolTarget()
+        self.releaseIdleWindowControllers(beyond: target)
+        guard self.idleWindowControllers.count < target else { break }
+        let wc = self.makeWindowController(session: EditorSession(), showInDock: false)
+        wc.warmUpForIdlePool()
+        self.parkIdleWindowController(wc)
+        await Task.yield()
+      }
+      // A cancelled run has already been replaced or torn down by whoever cancelled it.
+      if !Task.isCancelled {
+        self?.idlePoolReplenishTask = nil
+      }
+    }
+  }
+
+  private func idlePoolTarget() -> Int {
+    let now = Date()
+    return now < memoryPressureHoldUntil ? 0 : idlePoolSizer.targetIdleCount(at: now)
+  }
+
+  private func parkIdleWindowController(_ wc: EditorWindowController) {
+    idleWindowControllers.append(wc)
+    idlePooledAt[ObjectIdentifier(wc)] = Date()
+  }
+
+  /// Drops the oldest idle windows until at most `count` remain.
+  private func releaseIdleWindowControllers(beyond count: Int) {
+    guard idleWindowControllers.count > count else { return }
+    let excess = idleWindowControllers.prefix(idleWindowControllers.count - count)
+    for wc in excess {
+      idlePooledAt.removeValue(forKey: ObjectIdentifier(wc))
+      allWindowControllers.removeAll { $0 === wc }
+    }
+    idleWindowControllers.removeFirst(excess.count)
+  }
+
+  /// Second idle tier: windows pooled longer than `idleWindowDeepTrimAfter` release their text
+  /// storage, layout and per-session caches, and the freed pages go back to the system.
+  private func trimLongIdleWindows() {
+    let now = Date()
+    var trimmed = 0
+    for wc in idleWindowControllers {
+      let id = ObjectIdentifier(wc)
+      guard let since = idlePooledAt[id], now.timeIntervalSince(since) >= idleWindowDeepTrimAfter else { continue }
+      wc.releaseIdleResources()
+      idlePooledAt.removeValue(forKey: id)
+      trimmed += 1
+    }
+    if trimmed > 0 {
+      _ = malloc_zone_pressure_relief(nil, 0)
     }
-    for sessionId in removedSessionIds {
-      sessionsById.removeValue(forKey: sessionId)
-      windowsById.removeValue(forKey: sessionId)
-      sessionPathById.removeValue(forKey: sessionId)
-      sessionLastTouchedById.removeValue(forKey: sessionId)
+  }
+
+  private func startMemoryPressureSource() {
+    let source = DispatchSource.makeMemoryPressureSource(eventMask: [.warning, .critical], queue: .main)
+    source.setEventHandler { [weak self] in
+      Task { @MainActor [weak self] in
+        self?.handleMemoryPressure()
+      }
     }
+    memoryPressureSource = source
+    source.resume()
+  }
+
+  /// Under memory pressure the pool keeps no spare windows for `memoryPressureHold`, and the
+  /// shared line cache and warm agent processes are dropped. Opens still work; they start cold.
+  private func handleMemoryPressure() {
+    memoryPressureHoldUntil = Date().addingTimeInterval(memoryPressureHold)
+    idlePoolReplenishTask?.cancel()
+    idlePoolReplenishTask = nil
+    releaseIdleWindowControllers(beyond: 0)
+    MarkdownLineHighlightCache.shared.removeAll()
+    AgentProcessPool.shared.evictIdle()
+    _ = malloc_zone_pressure_relief(nil, 0)
+    Self.appLog.info("Memory pressure: released idle windows and caches")
+  }
+
+  private func recordSessionOpen(openMs: Double, reusedSession: Bool) {
+    let concurrent = visibleWindowCount
+    idlePoolSizer.recordOpen(at: Date(), concurrentWindows: concurrent)
+    telemetry?.record(
+      .appSessionOpen,
+      count: concurrent,
+      value: openMs,
+      flags: reusedSession ? TelemetryRecord.reusedSession : 0
+    )
+  }
+
+  /// Loads open history from the telemetry log so the pool is sized right from launch instead
+  /// of relearning every restart.
+  private func seedIdlePoolSizer() {
+    guard let url = telemetry?.fileURL else { return }
+    idlePoolSizer.seed(from: TelemetryLog.readRecords(at: url), now: Date())
+  }
+
+  private func handleWindowClosed(_ wc: EditorWindowController) {
+    sessions.removeAll { _, window in window === wc }
     if focusedWindowController === wc {
       focusedWindowController = nil
     }
 
-    // Recycle to idle pool (keep max 3 idle windows)
-    if idleWindowControllers.count < 3 {
-      idleWindowControllers.append(wc)
+    // Recycle to idle pool, up to the size recent usage calls for.
+    if idleWindowControllers.count < idlePoolTarget() {
+      parkIdleWindowController(wc)
     } else {
       allWindowControllers.removeAll { $0 === wc }
     }
 
     // If no visible windows remain, handle accessory mode and terminate-on-last-close
-    let visibleCount = allWindowControllers.count - idleWindowControllers.count
-    if visibleCount <= 0 {
+    if visibleWindowCount <= 0 {
       if terminateOnLastClose {
         Task { @MainActor in
           await self.performGracefulShutdown()
@@ -379,31 +510,17 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
   }
 
   private func registerSession(id: String, path: String, session: EditorSession, window: EditorWindowController) {
-    sessionsById[id] = session
-    windowsById[id] = window
-    sessionPathById[id] = path
-    sessionLastTouchedById[id] = Date()
+    sessions.register(id: id, path: path, session: session, window: window, nowNs: DispatchTime.now().uptimeNanoseconds)
+    armSessionExpiryTimer()
     focusedWindowController = window
   }
 
   private func retireSessionMappings(for session: EditorSession) {
-    let staleIDs = sessionsById.compactMap { id, value in
-      value === session ? id : nil
-    }
-    for id in staleIDs {
-      sessionsById.removeValue(forKey: id)
-      windowsById.removeValue(forKey: id)
-      sessionPathById.removeValue(forKey: id)
-      sessionLastTouchedById.removeValue(forKey: id)
-    }
+    sessions.removeAll { registered, _ in registered === session }
   }
 
   private func reusableSession(forPath normalizedPath: String) -> (EditorSession, EditorWindowController)? {
-    for (sessionId, path) in sessionPathById where path == normalizedPath {
-      guard let session = sessionsById[sessionId], let window = windowsById[sessionId] else { continue }
-      return (session, window)
-    }
-    return nil
+    sessions.entry(forPath: normalizedPath)
   }
 
   private func activeWindowController() -> EditorWindowController? {
@@ -443,38 +560,175 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
     }
   }
 
+  /// One heap push; the expiry timer is left alone, since the deadline only moved later.
   private func touchSession(_ id: String) {
-    sessionLastTouchedById[id] = Date()
+    sessions.touch(id, nowNs: DispatchTime.now().uptimeNanoseconds)
   }
 
-  private func handleClient(fd: Int32) {
+  /// Called on the socket server's client queue; only `handleRequest` hops to the main actor.
+  private nonisolated func handleClient(fd: Int32, lease: UnixDomainSocketServer.Lease) {
     let handle = FileHandle(fileDescriptor: fd, closeOnDealloc: true)
     let conn = JSONRPCConnection(readHandle: handle, writeHandle: handle)
-    let server = JSONRPCServerConnection(connection: conn) { [weak self] req in
-      await self?.handleRequest(req) ?? nil
-    }
+    let server = JSONRPCServerConnection(
+      connection: conn,
+      streamingHandler: { [weak self] req, notify in
+        await self?.handleRequest(req, notify: notify) ?? nil
+      },
+      onClose: { lease.release() },
+      acceptedNs: lease.acceptedAtNs,
+      firstByteNs: lease.firstByteAtNs
+    )
     server.run()
   }
 
   private func startStdioServer() {
     let conn = JSONRPCConnection(readHandle: FileHandle.standardInput, writeHandle: FileHandle.standardOutput)
-    let server = JSONRPCServerConnection(connection: conn) { [weak self] req in
-      await self?.handleRequest(req) ?? nil
+    let server = JSONRPCServerConnection(connection: conn) { [weak self] req, notify in
+      await self?.handleRequest(req, notify: notify) ?? nil
     }
     stdioServer = server
     server.run()
   }
 
-  private func handleRequest(_ req: JSONRPCRequest) async -> JSONRPCResponse? {
+  /// Protocol-level failure raised by shared request helpers; mapped 1:1 onto a JSON-RPC error.
+  private struct RequestFailure: Error {
+    var code: Int
+    var message: String
+  }
+
+  // Known: encode → serialize → wrap round-trip is ~microsecond overhead per RPC (#46).
+  private static func jsonValue(_ value: Encodable) -> JSONValue {
+    let data = (try? JSONEncoder().encode(AnyEncodable(value))) ?? Data()
+    let json = (try? JSONSerialization.jsonObject(with: data)) ?? NSNull()
+    return JSONValue.fromJSONObject(json)
+  }
+
+  private func openSession(_ params: SessionOpenParams) async throws -> SessionOpenResult {
+    guard let clientProtocolVersion = params.protocolVersion else {
+      throw RequestFailure(code: JSONRPCStandardErrorCode.invalidRequest, message: "protocolVersion is required")
+    }
+    guard clientProtocolVersion == TurboDraftProtocolVersion.current else {
+      throw RequestFailure(
+        code: JSONRPCStandardErrorCode.invalidRequest,
+        message: "protocolVersion mismatch: client=\(clientProtocolVersion) server=\(TurboDraftProtocolVersion.current)"
+      )
+    }
+    let t0 = nowMs()
+    let normalizedPath = URL(fileURLWithPath: params.path).standardizedFileURL.path
+    let editorSession: EditorSession
+    let wc: EditorWindowController
+    if let reuse = reusableSession(forPath: normalizedPath) {
+      editorSession = reuse.0
+      wc = reuse.1
+      if let current = await editorSession.currentInfo(),
+         current.fileURL.standardizedFileURL.path == normalizedPath {
+        touchSession(current.sessionId)
+        let refocusStart = OpenTrace.nowMs()
+        wc.focusExistingSessionWindow()
+        OpenTrace.current?.add("server.refocus", startMs: refocusStart)
+        let openMs = nowMs() - t0
+        recordSessionOpen(openMs: openMs, reusedSession: true)
+        return SessionOpenResult(
+          sessionId: current.sessionId,
+          path: current.fileURL.path,
+          content: current.content,
+          revision: current.diskRevision,
+          isDirty: current.isDirty,
+          serverOpenMs: openMs
+        )
+      }
+    } else {
+      let dequeueStart = OpenTrace.nowMs()
+      wc = dequeueIdleWindowController()
+      OpenTrace.current?.add("server.window_dequeue", startMs: dequeueStart)
+      editorSession = wc.session
+    }
+    if NSApp.activationPolicy() == .accessory {
+      NSApp.setActivationPolicy(.regular)
+    }
+    let url = URL(fileURLWithPath: params.path)
+    let sessionOpenStart = OpenTrace.nowMs()
+    let info = try await editorSession.open(fileURL: url, cwd: params.cwd)
+    OpenTrace.current?.add("server.session_open", startMs: sessionOpenStart)
+    retireSessionMappings(for: editorSession)
+    registerSession(
+      id: info.sessionId,
+      path: info.fileURL.standardizedFileURL.path,
+      session: editorSession,
+      window: wc
+    )
+    touchSession(info.sessionId)
+
+    // Present window asynchronously — doesn't block RPC response
+    let trace = OpenTrace.current
+    Task { @MainActor in
+      await wc.presentSession(info, line: params.line, column: params.column, trace: trace)
+    }
+
+    let openMs = nowMs() - t0
+    recordSessionOpen(openMs: openMs, reusedSession: false)
+
+    return SessionOpenResult(
+      sessionId: info.sessionId,
+      path: info.fileURL.path,
+      content: info.content,
+      revision: info.diskRevision,
+      isDirty: info.isDirty,
+      serverOpenMs: openMs
+    )
+  }
+
+  /// Starts the trace for a traced `session.open`, with the spans the transport timed before
+  /// the handler ran: accept → first request byte, reading and decoding the frame, the hop to
+  /// the main actor, and decoding the params.
+  private func beginOpenTrace(id: String, handlerStartMs: Double) -> OpenTrace {
+    let trace = OpenTrace(id: id)
+    if let timing = JSONRPCRequestTiming.current {
+      let frameReadMs = OpenTrace.ms(fromUptimeNs: timing.frameReadNs)
+      let decodedMs = OpenTrace.ms(fromUptimeNs: timing.decodedNs)
+      if let acceptedNs = timing.acceptedNs, let firstByteNs = timing.firstByteNs {
+        let firstByteMs = OpenTrace.ms(fromUptimeNs: firstByteNs)
+        trace.add("server.accept", startMs: OpenTrace.ms(fromUptimeNs: acceptedNs), endMs: firstByteMs)
+        trace.add("server.read", startMs: firstByteMs, endMs: frameReadMs)
+      }
+      trace.add("server.decode", startMs: frameReadMs, endMs: decodedMs)
+      trace.add("server.dispatch", startMs: decodedMs, endMs: handlerStartMs)
+    }
+    trace.add("server.decode_params", startMs: handlerStartMs)
+
+    if openTraces.updateValue(trace, forKey: id) == nil {
+      openTraceOrder.append(id)
+    }
+    while openTraceOrder.count > openTraceLimit {
+      openTraces.removeValue(forKey: openTraceOrder.removeFirst())
+    }
+    return trace
+  }
+
+  /// A fresh window's trace ends at its first styling pass and first responder; a refocused
+  /// session's at the refocus.
+  private func isOpenTraceComplete(_ trace: OpenTrace) -> Bool {
+    if trace.contains("server.refocus") { return true }
+    return trace.contains("ui.first_styling") && trace.contains("ui.first_responder")
+  }
+
+  private func waitForSessionClose(sessionId: String, timeoutMs: Int?) async throws -> SessionWaitResult {
+    guard let editorSession = sessions.session(sessionId) else {
+      throw RequestFailure(code: JSONRPCStandardErrorCode.invalidRequest, message: "Invalid sessionId")
+    }
+    touchSession(sessionId)
+    let closed = await editorSession.waitUntilClosed(timeoutMs: timeoutMs)
+    if closed {
+      sessions.remove(sessionId)
+    }
+    return SessionWaitResult(reason: closed ? "userClosed" : "timeout")
+  }
+
+  private func handleRequest(_ req: JSONRPCRequest, notify: JSONRPCNotify) async -> JSONRPCResponse? {
     guard let id = req.id else { return nil }
-    await sweepOrphanSessionsIfNeeded(reason: "request")
 
-    // Known: encode → serialize → wrap round-trip is ~microsecond overhead per RPC (#46).
     func ok(_ value: Encodable) -> JSONRPCResponse {
-      let data = (try? JSONEncoder().encode(AnyEncodable(value))) ?? Data()
-      let json = (try? JSONSerialization.jsonObject(with: data)) ?? NSNull()
-      let wrapped = JSONValue.fromJSONObject(json)
-      return JSONRPCResponse(id: id, result: wrapped, error: nil)
+      JSONRPCResponse(id: id, result: Self.jsonValue(value), error: nil)
     }
 
     func err(_ code: Int, _ message: String, _ data: JSONValue? = nil) -> JSONRPCResponse {
@@ -497,88 +751,46 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
 
     case TurboDraftMethod.sessionOpen:
       do {
+        let handlerStart = OpenTrace.nowMs()
         let params = try (req.params ?? .object([:])).decode(SessionOpenParams.self)
-        guard let clientProtocolVersion = params.protocolVersion else {
-          return err(JSONRPCStandardErrorCode.invalidRequest, "protocolVersion is required")
-        }
-        guard clientProtocolVersion == TurboDraftProtocolVersion.current else {
-          return err(
-            JSONRPCStandardErrorCode.invalidRequest,
-            "protocolVersion mismatch: client=\(clientProtocolVersion) server=\(TurboDraftProtocolVersion.current)"
-          )
-        }
-        let t0 = nowMs()
-        let normalizedPath = URL(fileURLWithPath: params.path).standardizedFileURL.path
-        let editorSession: EditorSession
-        let wc: EditorWindowController
-        if let reuse = reusableSession(forPath: normalizedPath) {
-          editorSession = reuse.0
-          wc = reuse.1
-          if let current = await editorSession.currentInfo(),
-             current.fileURL.standardizedFileURL.path == normalizedPath {
-            touchSession(current.sessionId)
-            wc.focusExistingSessionWindow()
-            let openMs = nowMs() - t0
-            appendLatencyRecord([
-              "event": "app_session_open",
-              "openMs": openMs,
-            ])
-            let out = SessionOpenResult(
-              sessionId: current.sessionId,
-              path: current.fileURL.path,
-              content: current.content,
-              revision: current.diskRevision,
-              isDirty: current.isDirty,
-              serverOpenMs: openMs
-            )
-            return ok(out)
-          }
-        } else {
-          wc = dequeueIdleWindowController()
-          editorSession = wc.session
+        guard let traceId = params.traceId else {
+          return ok(try await openSession(params))
         }
-        if NSApp.activationPolicy() == .accessory {
-          NSApp.setActivationPolicy(.regular)
+        let trace = beginOpenTrace(id: traceId, handlerStartMs: handlerStart)
+        let openStart = OpenTrace.nowMs()
+        defer { trace.add("server.open", startMs: openStart) }
+        let result = try await OpenTrace.$current.withValue(trace) {
+          try await openSession(params)
         }
-        let url = URL(fileURLWithPath: params.path)
-        let info = try await editorSession.open(fileURL: url, cwd: params.cwd)
-        retireSessionMappings(for: editorSession)
-        registerSession(
-          id: info.sessionId,
-          path: info.fileURL.standardizedFileURL.path,
-          session: editorSession,
-          window: wc
-        )
-        touchSession(info.sessionId)
-
-        // Present window asynchronously — doesn't block RPC response
-        Task { @MainActor in
-          await wc.presentSession(info, line: params.line, column: params.column)
-        }
-
-        let openMs = nowMs() - t0
-        appendLatencyRecord([
-          "event": "app_session_open",
-          "openMs": openMs,
-        ])
-
-        let out = SessionOpenResult(
-          sessionId: info.sessionId,
-          path: info.fileURL.path,
-          content: info.content,
-          revision: info.diskRevision,
-          isDirty: info.isDirty,
-          serverOpenMs: openMs
-        )
-        return ok(out)
+        trace.sessionId = result.sessionId
+        return ok(result)
+      } catch let failure as RequestFailure {
+        return err(failure.code, failure.message)
       } catch {
         return err(JSONRPCStandardErrorCode.invalidParams, "open failed: \(error)")
       }
 
+    case TurboDraftMethod.sessionOpenAndWait:
+      do {
+        let params = try (req.params ?? .object([:])).decode(SessionOpenAndWaitParams.self)
+        let opened = try await openSession(params.openParams)
+        // Ack the open on the same connection so the launcher never needs a second request.
+        notify(JSONRPCRequest(
+          id: nil,
+          method: TurboDraftMethod.sessionOpened,
+          params: Self.jsonValue(SessionOpenedParams(opened))
+        ))
+        return ok(try await waitForSessionClose(sessionId: opened.sessionId, timeoutMs: params.timeoutMs))
+      } catch let failure as RequestFailure {
+        return err(failure.code, failure.message)
+      } catch {
+        return err(JSONRPCStandardErrorCode.invalidParams, "openAndWait failed: \(error)")
+      }
+
     case TurboDraftMethod.sessionReload:
       do {
         let params = try (req.params ?? .object([:])).decode(SessionReloadParams.self)
-        guard let editorSession = sessionsById[params.sessionId] else {
+        guard let editorSession = sessions.session(params.sessionId) else {
           return err(JSONRPCStandardErrorCode.invalidRequest, "Invalid sessionId")
         }
         touchSession(params.sessionId)
@@ -594,7 +806,7 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
     case TurboDraftMethod.sessionWaitForRevision:
       do {
         let params = try (req.params ?? .object([:])).decode(SessionWaitForRevisionParams.self)
-        guard let editorSession = sessionsById[params.sessionId] else {
+        guard let editorSession = sessions.session(params.sessionId) else {
           return err(JSONRPCStandardErrorCode.invalidRequest, "Invalid sessionId")
         }
         touchSession(params.sessionId)
@@ -630,7 +842,7 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
       do {
         let params = try (req.params ?? .object([:])).decode(SessionSaveParams.self)
         let saveT0 = nowMs()
-        guard let editorSession = sessionsById[params.sessionId] else {
+        guard let editorSession = sessions.session(params.sessionId) else {
           return err(JSONRPCStandardErrorCode.invalidRequest, "Invalid sessionId")
         }
         touchSession(params.sessionId)
@@ -642,10 +854,13 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
         }
         // Session-bound save: ignore params.path and only save current session content.
         await editorSession.updateBufferContent(params.content)
+        let writesBefore = await editorSession.currentSaveStats().writeCount
         let _ = try await editorSession.autosave(reason: "rpc_save")
         let saveMs = nowMs() - saveT0
+        let saveStats = await editorSession.currentSaveStats()
+        let phaseMs = saveStats.writeCount > writesBefore ? saveStats.lastWriteTimings?.phaseMs : nil
         if let info = await editorSession.currentInfo() {
-          return ok(SessionSaveResult(ok: true, revision: info.diskRevision, serverSaveMs: saveMs))
+          return ok(SessionSaveResult(ok: true, revision: info.diskRevision, serverSaveMs: saveMs, serverSavePhaseMs: phaseMs))
         }
         return err(JSONRPCStandardErrorCode.invalidRequest, "No session")
       } catch {
@@ -655,18 +870,15 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
     case TurboDraftMethod.sessionClose:
       do {
         let params = try (req.params ?? .object([:])).decode(SessionCloseParams.self)
-        guard let editorSession = sessionsById[params.sessionId] else {
+        guard let editorSession = sessions.session(params.sessionId) else {
           return ok(SessionCloseResult(ok: false))
         }
         touchSession(params.sessionId)
 
-        if let wc = windowsById[params.sessionId], wc.window != nil {
+        if let wc = sessions.window(params.sessionId), wc.window != nil {
           wc.window?.performClose(nil)
         } else {
-          sessionsById.removeValue(forKey: params.sessionId)
-          windowsById.removeValue(forKey: params.sessionId)
-          sessionPathById.removeValue(forKey: params.sessionId)
-          sessionLastTouchedById.removeValue(forKey: params.sessionId)
+          sessions.remove(params.sessionId)
           await editorSession.markClosed()
         }
         return ok(SessionCloseResult(ok: true))
@@ -677,18 +889,9 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
     case TurboDraftMethod.sessionWait:
       do {
         let params = try (req.params ?? .object([:])).decode(SessionWaitParams.self)
-        guard let editorSession = sessionsById[params.sessionId] else {
-          return err(JSONRPCStandardErrorCode.invalidRequest, "Invalid sessionId")
-        }
-        touchSession(params.sessionId)
-        let closed = await editorSession.waitUntilClosed(timeoutMs: params.timeoutMs)
-        if closed {
-          sessionsById.removeValue(forKey: params.sessionId)
-          windowsById.removeValue(forKey: params.sessionId)
-          sessionPathById.removeValue(forKey: params.sessionId)
-          sessionLastTouchedById.removeValue(forKey: params.sessionId)
-        }
-        return ok(SessionWaitResult(reason: closed ? "userClosed" : "timeout"))
+        return ok(try await waitForSessionClose(sessionId: params.sessionId, timeoutMs: params.timeoutMs))
+      } catch let failure as RequestFailure {
+        return err(failure.code, failure.message)
       } catch {
         return err(JSONRPCStandardErrorCode.invalidParams, "wait failed: \(error)")
       }
@@ -696,17 +899,20 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
     case TurboDraftMethod.benchMetrics:
       do {
         let params = try (req.params ?? .object([:])).decode(BenchMetricsParams.self)
-        guard let editorSession = sessionsById[params.sessionId] else {
+        guard let editorSession = sessions.session(params.sessionId) else {
           return err(JSONRPCStandardErrorCode.invalidRequest, "Invalid sessionId")
         }
         touchSession(params.sessionId)
         // Collect typing latencies from the editor view controller.
-        let wc = windowsById[params.sessionId]
+        let wc = sessions.window(params.sessionId)
         let latencies = wc?.typingLatencySamples ?? []
         let openToReadyMs = wc?.sessionOpenToReadyMs
         let historyStats = await editorSession.historyStats()
+        let saveStats = await editorSession.currentSaveStats()
         // Query process memory via mach_task_info.
         let memBytes = processResidentBytes()
+        let socketStats = socketServer?.stats()
+        let poolStats = AgentProcessPool.shared.stats()
         return ok(BenchMetricsResult(
           typingLatencySamples: latencies,
           memoryResidentBytes: memBytes,
@@ -714,12 +920,39 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
           historySnapshotCount: historyStats.snapshotCount,
           historySnapshotBytes: Int64(historyStats.totalBytes),
           stylerCacheEntryCount: wc?.stylerCacheEntryCount,
-          stylerCacheLimit: wc?.stylerCacheLimit
+          stylerCacheLimit: wc?.stylerCacheLimit,
+          stylerCacheHitRate: wc?.stylerCacheHitRate,
+          socketActiveConnections: socketStats?.activeConnections,
+          socketRejectedConnections: socketStats?.rejectedConnections,
+          socketAcceptToFirstByteMs: socketStats?.acceptToFirstByteMs,
+          suppressedSelfWriteEvents: saveStats.suppressedSelfEventCount,
+          agentPoolHits: poolStats.hits,
+          agentPoolMisses: poolStats.misses
         ))
       } catch {
         return err(JSONRPCStandardErrorCode.invalidParams, "benchMetrics failed: \(error)")
       }
 
+    case TurboDraftMethod.benchTrace:
+      do {
+        let params = try (req.params ?? .object([:])).decode(BenchTraceParams.self)
+        guard let trace = openTraces[params.traceId] else {
+          return err(JSONRPCStandardErrorCode.invalidRequest, "Unknown traceId")
+        }
+        // The launcher resends its spans with every poll; keep the first copy.
+        if let clientSpans = params.clientSpans, let first = clientSpans.first, !trace.contains(first.name) {
+          trace.add(clientSpans)
+        }
+        return ok(BenchTraceResult(
+          traceId: trace.id,
+          sessionId: trace.sessionId,
+          spans: trace.snapshot(),
+          complete: isOpenTraceComplete(trace)
+        ))
+      } catch {
+        return err(JSONRPCStandardErrorCode.invalidParams, "benchTrace failed: \(error)")
+      }
+
     case TurboDraftMethod.appQuit:
       Task { @MainActor in
         // Give the JSON-RPC response a chance to flush before terminating.
@@ -1320,6 +1553,12 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
         }
       }
     }
+
+    // Recovery journals are only compacted when their file is reopened; drop the expired ones
+    // left by sessions that never came back.
+    DispatchQueue.global(qos: .utility).async {
+      RecoveryStore().removeExpiredJournals()
+    }
   }
 
   private func nowMs() -> Double {
@@ -1337,29 +1576,6 @@ final class AppDelegate: NSObject, NSApplicationDelegate {
     guard result == KERN_SUCCESS else { return 0 }
     return Int64(taskInfo.resident_size)
   }
-
-  private func appendLatencyRecord(_ payload: [String: Any]) {
-    guard let file = telemetryFileURL else { return }
-    do {
-      var record = payload
-      record["ts"] = Self.telemetryDateFormatter.string(from: Date())
-      let data = try JSONSerialization.data(withJSONObject: record, options: [])
-      let line = data + Data([0x0A])
-      if telemetryHandle == nil {
-        telemetryHandle = try? FileHandle(forWritingTo: file)
-      }
-      if let fh = telemetryHandle {
-        try fh.seekToEnd()
-        try fh.write(contentsOf: line)
-      } else {
-        // First record fallback if file doesn't exist yet.
-        try line.write(to: file, options: [.atomic])
-        telemetryHandle = try? FileHandle(forWritingTo: file)
-      }
-    } catch {
-      // Best-effort telemetry only.
-    }
-  }
 }
 
 // Helpers to bridge Encodable -> JSONValue without generic envelopes.
@@ -8,18 +8,15 @@ struct Highlight {
 }
 
 final class MarkdownStyler {
-  private struct CacheKey: Hashable {
-    var rangeLocation: Int
-    var rangeLength: Int
-    var textHash: Int
-  }
-
-  private var cache: [CacheKey: [Highlight]] = [:]
-  private var cacheOrder: [CacheKey] = []
-  private let cacheLimit = 512
+  /// Line spans are shared by every window (and the background worker); only the theme
+  /// attributes below are per styler.
+  private let lineCache: MarkdownLineHighlightCache
+  /// Attributes per span kind for the current theme and fonts.
+  private var attributesByKind: [MarkdownHighlightKind: [NSAttributedString.Key: Any]] = [:]
 
-  var cacheEntryCount: Int { cacheOrder.count }
-  var cacheCapacity: Int { cacheLimit }
+  var cacheEntryCount: Int { lineCache.stats().entryCount }
+  var cacheCapacity: Int { lineCache.capacity }
+  var cacheHitRate: Double { lineCache.stats().hitRate }
 
   var theme: EditorColorTheme = .defaultTheme
 
@@ -32,7 +29,8 @@ final class MarkdownStyler {
   private var italicFont: NSFont
   private var strongItalicFont: NSFont
 
-  init() {
+  init(lineCache: MarkdownLineHighlightCache = .shared) {
+    self.lineCache = lineCache
     let italicTraits: NSFontDescriptor.SymbolicTraits = [.italic]
     let baseItalicDesc = baseFont.fontDescriptor.withSymbolicTraits(italicTraits)
     if let f = NSFont(descriptor: baseItalicDesc, size: baseFont.pointSize) {
@@ -75,8 +73,7 @@ final class MarkdownStyler {
     let strongItalicDesc = strongFont.fontDescriptor.withSymbolicTraits(italicTraits)
     strongItalicFont = NSFont(descriptor: strongItalicDesc, size: strongFont.pointSize) ?? strongFont
 
-    cache.removeAll()
-    cacheOrder.removeAll()
+    attributesByKind.removeAll()
   }
 
   private func fontVariant(of base: NSFont, size: CGFloat, weight: NSFont.Weight) -> NSFont {
@@ -87,167 +84,191 @@ final class MarkdownStyler {
 
   func setTheme(_ newTheme: EditorColorTheme) {
     theme = newTheme
-    cache.removeAll()
-    cacheOrder.removeAll()
+    attributesByKind.removeAll()
   }
 
-  func highlights(in text: String, range: NSRange) -> [Highlight] {
-    let key = cacheKey(text: text, range: range)
-    if let cached = cache[key] {
-      return cached
-    }
+  func highlights(in text: String, range: NSRange, fenceIndex: MarkdownFenceIndex? = nil) -> [Highlight] {
+    highlights(for: lineCache.highlights(in: text as NSString, range: range, fenceIndex: fenceIndex))
+  }
 
+  /// Attributes for spans computed elsewhere (e.g. by `MarkdownStylingWorker`), using the
+  /// current theme and fonts.
+  func highlights(for spans: [MarkdownHighlight]) -> [Highlight] {
     var out: [Highlight] = []
-    let spans = MarkdownHighlighter.highlights(in: text, range: range)
-    let t = theme
+    out.reserveCapacity(spans.count)
     for span in spans {
       let attrs: [NSAttributedString.Key: Any]
-      switch span.kind {
-      case .codeFenceDelimiter:
-        attrs = [.foregroundColor: t.marker]
-      case .codeFenceInfo:
-        attrs = [.foregroundColor: t.secondaryText]
-      case .codeBlockLine:
-        attrs = [
-          .foregroundColor: t.code,
-          .backgroundColor: t.codeBackground,
-        ]
-      case let .headerMarker(level):
-        _ = level
-        attrs = [.foregroundColor: t.marker]
-      case let .headerText(level):
-        let font: NSFont
-        switch level {
-        case 1: font = header1Font
-        case 2: font = header2Font
-        case 3: font = header3Font
-        default: font = headerFont
-        }
-        attrs = [
-          .foregroundColor: t.heading,
-          .font: font,
-        ]
-      case .listMarker:
-        attrs = [.foregroundColor: t.marker]
-      case let .taskBox(checked):
-        if checked {
-          attrs = [.foregroundColor: t.link]
-        } else {
-          attrs = [.foregroundColor: t.marker]
-        }
-      case let .quoteMarker(level):
-        _ = level
-        attrs = [.foregroundColor: t.marker]
-      case let .quoteText(level):
-        _ = level
-        attrs = [.foregroundColor: t.quote]
-      case .horizontalRule:
-        attrs = [.foregroundColor: t.marker]
-      case .inlineCodeDelimiter:
-        attrs = [.foregroundColor: t.marker]
-      case .inlineCodeText:
-        attrs = [
-          .foregroundColor: t.code,
-          .backgroundColor: t.inlineCodeBackground,
-          .font: baseFont,
-        ]
-      case .strongMarker:
-        attrs = [.foregroundColor: t.marker]
-      case .strongText:
-        attrs = [.foregroundColor: t.strong, .font: strongFont]
-      case .emphasisMarker:
-        attrs = [.foregroundColor: t.marker]
-      case .emphasisText:
-        attrs = [.foregroundColor: t.emphasis, .font: italicFont]
-      case .strikethroughMarker:
+      if let cached = attributesByKind[span.kind] {
+        attrs = cached
+      } else {
+        attrs = attributes(for: span.kind)
+        attributesByKind[span.kind] = attrs
+      }
+      out.append(Highlight(range: span.range, attributes: attrs))
+    }
+    return out
+  }
+
+  private func attributes(for kind: MarkdownHighlightKind) -> [NSAttributedString.Key: Any] {
+    let t = theme
+    let attrs: [NSAttributedString.Key: Any]
+    switch kind {
+    case .codeFenceDelimiter:
+      attrs = [.foregroundColor: t.marker]
+    case .codeFenceInfo:
+      attrs = [.foregroundColor: t.secondaryText]
+    case .codeBlockLine:
+      attrs = [
+        .foregroundColor: t.code,
+        .backgroundColor: t.codeBackground,
+      ]
+    case let .headerMarker(level):
+      _ = level
+      attrs = [.foregroundColor: t.marker]
+    case let .headerText(level):
+      let font: NSFont
+      switch level {
+      case 1: font = header1Font
+      case 2: font = header2Font
+      case 3: font = header3Font
+      default: font = headerFont
+      }
+      attrs = [
+        .foregroundColor: t.heading,
+        .font: font,
+      ]
+    case .listMarker:
+      attrs = [.foregroundColor: t.marker]
+    case let .taskBox(checked):
+      if checked {
+        attrs = [.foregroundColor: t.link]
+      } else {
         attrs = [.foregroundColor: t.marker]
-      case .strikethroughText:
+      }
+    case let .quoteMarker(level):
+      _ = level
+      attrs = [.foregroundColor: t.marker]
+    case let .quoteText(level):
+      _ = level
+      attrs = [.foregroundColor: t.quote]
+    case .horizontalRule:
+      attrs = [.foregroundColor: t.marker]
+    case .inlineCodeDelimiter:
+      attrs = [.foregroundColor: t.marker]
+    case .inlineCodeText:
+      attrs = [
+        .foregroundColor: t.code,
+        .backgroundColor: t.inlineCodeBackground,
+        .font: baseFont,
+      ]
+    case .strongMarker:
+      attrs = [.foregroundColor: t.marker]
+    case .strongText:
+      attrs = [.foregroundColor: t.strong, .font: strongFont]
+    case .emphasisMarker:
+      attrs = [.foregroundColor: t.marker]
+    case .emphasisText:
+      attrs = [.foregroundColor: t.emphasis, .font: italicFont]
+    case .strikethroughMarker:
+      attrs = [.foregroundColor: t.marker]
+    case .strikethroughText:
+      attrs = [
+        .foregroundColor: t.strikethrough,
+        .strikethroughStyle: NSUnderlineStyle.single.rawValue,
+      ]
+    case .highlightMarker:
+      attrs = [.foregroundColor: t.marker]
+    case .highlightText:
+      attrs = [
+        .foregroundColor: t.foreground,
+        .backgroundColor: t.highlight,
+      ]
+    case .linkText:
+      attrs = [
+        .foregroundColor: t.link,
+        .underlineStyle: NSUnderlineStyle.single.rawValue,
+      ]
+    case .linkURL:
+      attrs = [
+        .foregroundColor: t.link,
+        .underlineStyle: NSUnderlineStyle.single.rawValue,
+      ]
+    case .linkPunctuation:
+      attrs = [.foregroundColor: t.marker]
+    case .tablePipe:
+      attrs = [.foregroundColor: t.marker]
+    case .tableSeparator:
+      attrs = [.foregroundColor: t.marker]
+    case .tableHeaderText:
+      attrs = [.foregroundColor: t.heading, .font: strongFont]
+    case let .taskText(checked):
+      if checked {
         attrs = [
           .foregroundColor: t.strikethrough,
           .strikethroughStyle: NSUnderlineStyle.single.rawValue,
         ]
-      case .highlightMarker:
-        attrs = [.foregroundColor: t.marker]
-      case .highlightText:
-        attrs = [
-          .foregroundColor: t.foreground,
-          .backgroundColor: t.highlight,
-        ]
-      case .linkText:
-        attrs = [
-          .foregroundColor: t.link,
-          .underlineStyle: NSUnderlineStyle.single.rawValue,
-        ]
-      case .linkURL:
-        attrs = [
-          .foregroundColor: t.link,
-          .underlineStyle: NSUnderlineStyle.single.rawValue,
-        ]
-      case .linkPunctuation:
-        attrs = [.foregroundColor: t.marker]
-      case .tablePipe:
-        attrs = [.foregroundColor: t.marker]
-      case .tableSeparator:
-        attrs = [.foregroundColor: t.marker]
-      case .tableHeaderText:
-        attrs = [.foregroundColor: t.heading, .font: strongFont]
-      case let .taskText(checked):
-        if checked {
-          attrs = [
-            .foregroundColor: t.strikethrough,
-            .strikethroughStyle: NSUnderlineStyle.single.rawValue,
-          ]
-        } else {
-          attrs = [:]
-        }
+      } else {
+        attrs = [:]
       }
-      out.append(Highlight(range: span.range, attributes: attrs))
     }
+    return attrs
+  }
+}
 
-    cache[key] = out
-    cacheOrder.append(key)
-    // O(n) FIFO eviction is fine here — cacheLimit is small (512) and this runs
-    // at most once per highlight pass, removing only a handful of entries.
-    if cacheOrder.count > cacheLimit {
-      let removeCount = cacheOrder.count - cacheLimit
-      for _ in 0..<removeCount {
-        let victim = cacheOrder.removeFirst()
-        cache.removeValue(forKey: victim)
-      }
-    }
+/// Computes highlight spans for a text snapshot on a background queue.
+///
+/// The editor tags each batch with the document version it snapshotted; `advanceVersion()` on
+/// every character edit makes queued batches stop early, and the editor drops any result whose
+/// version no longer matches before touching the text storage. Spans are theme-independent, so
+/// attributes are resolved on the main thread when a result is applied.
+final class MarkdownStylingWorker: @unchecked Sendable {
+  struct Job: Sendable {
+    var lines: NSRange
+    /// Fence state at `lines.location`, read from the fence index with the snapshot.
+    var entryState: MarkdownFenceState
+  }
 
-    return out
+  struct Result: Sendable {
+    var lines: NSRange
+    var spans: [MarkdownHighlight]
   }
 
-  private func cacheKey(text: String, range: NSRange) -> CacheKey {
-    let ns = text as NSString
-    let full = NSRange(location: 0, length: ns.length)
-    let safe = NSIntersectionRange(range, full)
-    if safe.length <= 0 {
-      return CacheKey(rangeLocation: 0, rangeLength: 0, textHash: 0)
-    }
+  private let queue = DispatchQueue(label: "turbodraft.styling", qos: .userInitiated)
+  private let lock = NSLock()
+  private var version = 0
+
+  var currentVersion: Int {
+    lock.lock()
+    defer { lock.unlock() }
+    return version
+  }
 
-    return CacheKey(
-      rangeLocation: safe.location,
-      rangeLength: safe.length,
-      textHash: hashUTF16(in: ns, range: safe)
-    )
+  @discardableResult
+  func advanceVersion() -> Int {
+    lock.lock()
+    defer { lock.unlock() }
+    version &+= 1
+    return version
   }
 
-  private func hashUTF16(in ns: NSString, range: NSRange) -> Int {
-    var hasher = Hasher()
-    var cursor = range.location
-    let end = range.location + range.length
-    var buffer = [unichar](repeating: 0, count: 1024)
-    while cursor < end {
-      let chunkLen = min(buffer.count, end - cursor)
-      let chunkRange = NSRange(location: cursor, length: chunkLen)
-      ns.getCharacters(&buffer, range: chunkRange)
-      for i in 0..<chunkLen {
-        hasher.combine(buffer[i])
+  /// Runs `jobs` against `snapshot` in order; `completion` (on the worker queue) is skipped when
+  /// `version` went stale partway through.
+  func compute(
+    _ jobs: [Job],
+    in snapshot: String,
+    version: Int,
+    completion: @escaping @Sendable ([Result]) -> Void
+  ) {
+    queue.async { [self] in
+      var results: [Result] = []
+      results.reserveCapacity(jobs.count)
+      for job in jobs {
+        guard currentVersion == version else { return }
+        let spans = MarkdownLineHighlightCache.shared.highlights(in: snapshot as NSString, range: job.lines, entryState: job.entryState)
+        results.append(Result(lines: job.lines, spans: spans))
       }
-      cursor += chunkLen
+      guard currentVersion == version else { return }
+      completion(results)
     }
-    return hasher.finalize()
   }
 }
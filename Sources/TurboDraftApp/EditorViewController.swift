@@ -25,12 +25,26 @@ final class EditorViewController: NSViewController {
   private let scrollView = NSScrollView()
   private let textView: TurboDraftEditorTextView
   private let styler = MarkdownStyler()
+  private let fenceIndex = MarkdownFenceIndex()
+  /// Lines whose fence context changed since the last restyle was scheduled (from `fenceIndex`).
+  private var pendingFenceDirtyRange: NSRange?
+  /// Text that already carries current highlight attributes; edits punch holes, styling fills them.
+  private var styledRanges = MarkdownStyledRanges()
+  /// Set by `applyTextEdits` for the storage edit it makes: the touched lines, in pre-edit
+  /// coordinates, to invalidate instead of the whole edited span.
+  private var pendingStyledRangeEdits: [(range: NSRange, replacementLength: Int)]?
+  private let stylingWorker = MarkdownStylingWorker()
+  /// Lines queued on `stylingWorker` for the current document version.
+  private var stylingInFlight = MarkdownStyledRanges()
+  /// Restyles up to this many UTF-16 units run inline; bigger ones go to `stylingWorker`.
+  private let inlineStylingLimit = 4_000
   private var colorTheme: EditorColorTheme = .defaultTheme
 
   private let autosaveDebouncer = AsyncDebouncer()
   private let styleDebouncer = AsyncDebouncer()
   private let openStyleDebouncer = AsyncDebouncer()
   private let fullOpenStyleDebouncer = AsyncDebouncer()
+  private let catchUpStyleDebouncer = AsyncDebouncer()
   private let watcherDebouncer = AsyncDebouncer()
   private var autosaveMaxFlushTask: Task<Void, Never>?
   private var autosavePending = false
@@ -64,18 +78,39 @@ final class EditorViewController: NSViewController {
   private var activeFindHighlightRange: NSRange?
   private var findFeedbackTask: Task<Void, Never>?
   private let maxVisibleFindHighlights = 700
+  /// Compiled find query and its matches, kept current by `handleTextStorageDidProcessEditing`.
+  private var searchSession = TextSearchSession()
 
   private let agentRow = NSStackView()
   private let agentButton = NSButton(title: "Improve Prompt", target: nil, action: nil)
   private let saveStatus = NSTextField(labelWithString: "Saved")
   private var agentAdapter: AgentAdapting?
   private var agentRunning = false
+  /// Read-only staging area for streamed agent output. The document is only touched when the run
+  /// completes, in one undoable edit.
+  private let agentPreviewScrollView = NSScrollView()
+  private let agentPreviewTextView = NSTextView(frame: .zero)
   private var sessionCwd: String?
+  /// Placeholder id → ingested file in `imageCache`. The files are shared through the cache,
+  /// so forgetting an image only drops its entry here.
   private var attachedImages: [String: URL] = [:]
+  private static let imageCache = ImageIngestCache()
   private var imageConversionTask: Task<Void, Never>?
   private var _typingLatencies: [Double] = []
   private var sessionOpenStartNs: UInt64?
   private var sessionOpenToReadyMsValue: Double?
+  /// The traced open being presented, until its first styling pass and first responder are in.
+  private var openTrace: OpenTrace?
+  /// A large document whose tail isn't in the text storage yet, and where the tail starts; see
+  /// `chunkedLoadHead(of:)`.
+  private var chunkedLoadSource: NSString?
+  private var chunkedLoadOffset = 0
+  private var chunkedLoadGeneration = 0
+  /// Documents longer than this (UTF-16 units) are put into the text storage in chunks.
+  private static let chunkedLoadThreshold = 1_000_000
+  /// The first chunk, extended to the end of its line: comfortably more than a screenful.
+  private static let chunkedLoadHeadLength = 64_000
+  private static let chunkedLoadChunkLength = 512_000
   private let imagePlaceholderRegex = try! NSRegularExpression(pattern: #"\[image-([a-f0-9]{8})\]"#)
   private let listPrefixRegex = try! NSRegularExpression(
     pattern: #"^([ \t]*(?:>[ \t]*)*)(?:[-+*][ \t]+(?:\[[ xX]\][ \t]+)?|\d{1,9}[.)][ \t]+)"#
@@ -88,6 +123,7 @@ final class EditorViewController: NSViewController {
   var sessionOpenToReadyMs: Double? { sessionOpenToReadyMsValue }
   var stylerCacheEntryCount: Int { styler.cacheEntryCount }
   var stylerCacheLimit: Int { styler.cacheCapacity }
+  var stylerCacheHitRate: Double { styler.cacheHitRate }
 
   private enum SaveState {
     case saved
@@ -128,11 +164,11 @@ final class EditorViewController: NSViewController {
     styleDebouncer.cancel()
     openStyleDebouncer.cancel()
     fullOpenStyleDebouncer.cancel()
+    catchUpStyleDebouncer.cancel()
     watcherDebouncer.cancel()
     autosaveMaxFlushTask?.cancel()
     findFeedbackTask?.cancel()
     watcher?.stop()
-    for url in attachedImages.values { try? FileManager.default.removeItem(at: url) }
     NotificationCenter.default.removeObserver(self)
   }
 
@@ -187,8 +223,8 @@ final class EditorViewController: NSViewController {
     textView.usesFindPanel = true
     textView.isIncrementalSearchingEnabled = true
     textView.delegate = self
-    textView.onImageDrop = { [weak self] images in
-      self?.insertImages(images)
+    textView.onImageDrop = { [weak self] sources in
+      self?.insertImages(sources)
     }
     textView.onCommandEnter = { [weak self] in
       self?.view.window?.performClose(nil)
@@ -230,6 +266,22 @@ final class EditorViewController: NSViewController {
     )
     #endif
 
+    NotificationCenter.default.addObserver(
+      self,
+      selector: #selector(handleTextStorageDidProcessEditing(_:)),
+      name: NSTextStorage.didProcessEditingNotification,
+      object: textView.textStorage
+    )
+    scrollView.contentView.postsBoundsChangedNotifications = true
+    for name in [NSView.boundsDidChangeNotification, NSView.frameDidChangeNotification] {
+      NotificationCenter.default.addObserver(
+        self,
+        selector: #selector(handleViewportDidChange(_:)),
+        name: name,
+        object: scrollView.contentView
+      )
+    }
+
     findContainer.material = .hudWindow
     findContainer.blendingMode = .withinWindow
     findContainer.state = .active
@@ -392,12 +444,27 @@ final class EditorViewController: NSViewController {
     agentRow.addArrangedSubview(agentButton)
     agentButton.setContentHuggingPriority(.required, for: .horizontal)
 
+    agentPreviewTextView.isEditable = false
+    agentPreviewTextView.isSelectable = true
+    agentPreviewTextView.isRichText = false
+    agentPreviewTextView.font = NSFont.monospacedSystemFont(ofSize: 13, weight: .regular)
+    agentPreviewTextView.textContainerInset = NSSize(width: 18, height: 12)
+    agentPreviewTextView.isVerticallyResizable = true
+    agentPreviewTextView.isHorizontallyResizable = false
+    agentPreviewTextView.autoresizingMask = [.width]
+    agentPreviewTextView.textContainer?.widthTracksTextView = true
+    agentPreviewScrollView.hasVerticalScroller = true
+    agentPreviewScrollView.drawsBackground = false
+    agentPreviewScrollView.documentView = agentPreviewTextView
+    agentPreviewScrollView.isHidden = true
+
     let stack = NSStackView()
     stack.orientation = .vertical
     stack.spacing = 10
     stack.translatesAutoresizingMaskIntoConstraints = false
     stack.addArrangedSubview(banner)
     stack.addArrangedSubview(scrollView)
+    stack.addArrangedSubview(agentPreviewScrollView)
     stack.addArrangedSubview(agentRow)
     view.addSubview(stack)
     view.addSubview(saveStatus)
@@ -416,6 +483,7 @@ final class EditorViewController: NSViewController {
       findContainer.leadingAnchor.constraint(greaterThanOrEqualTo: scrollView.leadingAnchor, constant: 12),
       findContainer.widthAnchor.constraint(greaterThanOrEqualToConstant: 420),
       findContainer.widthAnchor.constraint(lessThanOrEqualToConstant: 620),
+      agentPreviewScrollView.heightAnchor.constraint(equalToConstant: 220),
     ])
 
     applyAgentConfig()
@@ -443,6 +511,7 @@ final class EditorViewController: NSViewController {
   }
 
   func showFind(replace: Bool) {
+    completeChunkedLoad()
     findContainer.isHidden = false
     replaceRow.isHidden = !replace
     toggleReplaceButton.title = replace ? "Hide Replace" : "Replace"
@@ -501,6 +570,7 @@ final class EditorViewController: NSViewController {
   }
 
   func replaceNext() {
+    completeChunkedLoad()
     guard !findField.stringValue.trimmingCharacters(in: .whitespacesAndNewlines).isEmpty else {
       useSelectionForFind()
       return
@@ -541,14 +611,14 @@ final class EditorViewController: NSViewController {
   }
 
   func replaceAll() {
+    completeChunkedLoad()
     let query = findField.stringValue.trimmingCharacters(in: .whitespacesAndNewlines)
     guard !query.isEmpty else {
       NSSound.beep()
       return
     }
-    let source = textView.string
-    guard let result = TextSearchEngine.replaceAll(
-      in: source,
+    guard let edits = TextSearchEngine.replacements(
+      in: textView.string as NSString,
       query: query,
       replacementTemplate: replaceField.stringValue,
       options: currentSearchOptions()
@@ -556,22 +626,15 @@ final class EditorViewController: NSViewController {
       NSSound.beep()
       return
     }
-    let count = result.count
-    guard count > 0 else {
+    guard !edits.isEmpty else {
       NSSound.beep()
       return
     }
 
-    let fullRange = NSRange(location: 0, length: (source as NSString).length)
-    _ = applyTextEdit(
-      replacementRange: fullRange,
-      replacement: result.text,
-      selectedLocation: 0,
-      actionName: "Replace All"
-    )
+    _ = applyTextEdits(edits, selectedLocation: 0, actionName: "Replace All")
     updateFindCountLabel()
     updateCurrentFindHighlight()
-    showFindFeedback("\(count) replaced")
+    showFindFeedback("\(edits.count) replaced")
   }
 
   func restorePreviousBuffer() {
@@ -589,16 +652,88 @@ final class EditorViewController: NSViewController {
     // Clear styler LRU cache to release attributed string memory.
     styler.setTheme(colorTheme)
     // Clear text storage so idle windows don't retain large documents.
+    cancelChunkedLoad()
     isApplyingProgrammaticUpdate = true
     textView.string = ""
     isApplyingProgrammaticUpdate = false
     sessionOpenStartNs = nil
     sessionOpenToReadyMsValue = nil
+    openTrace = nil
     // Clear session history snapshots (they're persisted in RecoveryStore).
     Task { await session.resetForRecycle() }
   }
 
+  /// Second tier after `prepareForIdlePool`, for a window that has sat in the pool a while:
+  /// releases what that keeps around for a quick reuse. A fresh text storage drops the grown
+  /// character and attribute buffers and the layout manager's glyph and line caches with them;
+  /// the find state, temp images, agent adapter and streamed preview go too. The next open pays
+  /// for one text storage allocation and a cold layout pass.
+  func releaseIdleResources() {
+    clearAllFindHighlights()
+    clearCurrentFindHighlight()
+    allFindHighlightRanges = []
+    searchSession = TextSearchSession()
+    cleanUpAttachedImages()
+    imageConversionTask = nil
+    agentAdapter = nil
+    hideAgentPreview()
+    _typingLatencies = []
+    #if !TURBODRAFT_USE_CODEEDIT_TEXTVIEW
+    if let layout = textView.layoutManager, let old = textView.textStorage {
+      NotificationCenter.default.removeObserver(self, name: NSTextStorage.didProcessEditingNotification, object: old)
+      let fresh = NSTextStorage()
+      layout.replaceTextStorage(fresh)
+      NotificationCenter.default.addObserver(
+        self,
+        selector: #selector(handleTextStorageDidProcessEditing(_:)),
+        name: NSTextStorage.didProcessEditingNotification,
+        object: fresh
+      )
+    }
+    #endif
+    fenceIndex.rebuild(text: "")
+    pendingFenceDirtyRange = nil
+    styledRanges = MarkdownStyledRanges()
+    stylingInFlight = MarkdownStyledRanges()
+    textView.typingAttributes = baseStylingAttributes()
+  }
+
+  /// Styles and lays out a short sample covering every span kind, then clears it, so the
+  /// styler's fonts and attribute memo, the theme colours and the layout manager's glyph caches
+  /// are built before a pooled window takes its first session.
+  func warmUpForIdlePool() {
+    isApplyingProgrammaticUpdate = true
+    textView.string = Self.warmUpSample
+    isApplyingProgrammaticUpdate = false
+    applyStyling(forChangedRange: NSRange(location: 0, length: (Self.warmUpSample as NSString).length), synchronously: true)
+    #if !TURBODRAFT_USE_CODEEDIT_TEXTVIEW
+    if let lm = textView.layoutManager, let tc = textView.textContainer {
+      lm.ensureLayout(for: tc)
+    }
+    #endif
+    isApplyingProgrammaticUpdate = true
+    textView.string = ""
+    isApplyingProgrammaticUpdate = false
+    pendingFenceDirtyRange = nil
+    styledRanges.removeAll()
+    textView.undoManager?.removeAllActions()
+  }
+
+  private static let warmUpSample = """
+  # Heading
+  > quote with **bold**, _italic_, ~~strike~~, ==mark== and `code`
+  - [x] task with [link](https://example.com)
+  1. item
+
+  | a | b |
+  |---|---|
+  ```
+  fenced
+  ```
+  """
+
   func flushAutosaveNow(reason: String = "forced_flush") async {
+    completeChunkedLoad()
     autosaveDebouncer.cancel()
     autosaveMaxFlushTask?.cancel()
     autosaveMaxFlushTask = nil
@@ -630,6 +765,7 @@ final class EditorViewController: NSViewController {
   /// window/app close so the invoking CLI model reads images first.
   private func appendImageReferencesForClose() async {
     guard !attachedImages.isEmpty else { return }
+    completeChunkedLoad()
 
     var text = textView.string
 
@@ -647,6 +783,7 @@ final class EditorViewController: NSViewController {
 
     // Prepend image references at the top so the model reads them first.
     if !referencedURLs.isEmpty {
+      Self.imageCache.markUsed(referencedURLs)
       let refs = referencedURLs.map { "@\($0.path)" }.joined(separator: "\n")
       text = refs + "\n" + text
     }
@@ -657,11 +794,10 @@ final class EditorViewController: NSViewController {
     await session.updateBufferContent(text)
     autosavePending = true
 
-    // Clear so deinit doesn't delete referenced files — the invoking CLI model
-    // may still need them after editor close. Keep only still-referenced files.
+    // The invoking CLI model reads the referenced files after the editor closes; they stay in
+    // the image cache. Keep only still-referenced entries.
     let referencedSet = Set(referencedURLs)
     for (id, url) in attachedImages where !referencedSet.contains(url) {
-      try? FileManager.default.removeItem(at: url)
       attachedImages.removeValue(forKey: id)
     }
   }
@@ -695,13 +831,13 @@ final class EditorViewController: NSViewController {
     }
 
     images.reverse()
+    Self.imageCache.markUsed(images)
     return (mutable as String, images)
   }
 
   private func pruneUnreferencedAttachedImages(using text: String) {
     let referenced = Set(imagePlaceholderIDs(in: text))
-    for (id, url) in attachedImages where !referenced.contains(id) {
-      try? FileManager.default.removeItem(at: url)
+    for id in attachedImages.keys where !referenced.contains(id) {
       attachedImages.removeValue(forKey: id)
     }
   }
@@ -735,6 +871,8 @@ final class EditorViewController: NSViewController {
       updateCurrentFindHighlight()
     }
     banner.applyTheme(with: t)
+    agentPreviewTextView.backgroundColor = t.banner
+    agentPreviewTextView.textColor = t.secondaryText
     setSaveState(saveState)
   }
 
@@ -742,6 +880,7 @@ final class EditorViewController: NSViewController {
     colorTheme = theme
     styler.setTheme(theme)
     applyTheme()
+    styledRanges.removeAll()
     let fullRange = NSRange(location: 0, length: (textView.string as NSString).length)
     if fullRange.length > 0 {
       applyStyling(forChangedRange: fullRange)
@@ -752,6 +891,7 @@ final class EditorViewController: NSViewController {
     let sz = CGFloat(max(9, min(size, 72)))
     styler.rebuildFonts(family: family, size: sz)
     textView.font = styler.baseFont
+    styledRanges.removeAll()
     let fullRange = NSRange(location: 0, length: (textView.string as NSString).length)
     if fullRange.length > 0 {
       applyStyling(forChangedRange: fullRange)
@@ -828,42 +968,59 @@ final class EditorViewController: NSViewController {
 
   var preferredResponderView: NSView { textView }
 
-  func applySessionInfo(_ info: SessionInfo, moveCursorLine: Int?, column: Int?) {
+  func applySessionInfo(_ info: SessionInfo, moveCursorLine: Int?, column: Int?, trace: OpenTrace? = nil) {
     autosaveDebouncer.cancel()
     autosaveMaxFlushTask?.cancel()
     autosaveMaxFlushTask = nil
     autosavePending = info.isDirty
     sessionCwd = info.cwd
 
-    // Clean up stale image temp files from the previous session.
+    // Forget the previous session's images.
     cleanUpAttachedImages()
 
+    cancelChunkedLoad()
     isApplyingProgrammaticUpdate = true
-    textView.string = info.content
+    textView.string = chunkedLoadHead(of: info.content)
     isApplyingProgrammaticUpdate = false
+    // Nothing is styled yet and the open passes below start from scratch, so nothing from the
+    // index is pending either.
+    pendingFenceDirtyRange = nil
+    styledRanges.removeAll()
     sessionOpenStartNs = DispatchTime.now().uptimeNanoseconds
     sessionOpenToReadyMsValue = nil
+    openTrace = trace
     setSaveState(info.isDirty ? .unsaved : .saved)
     banner.set(message: info.bannerMessage, snapshotId: info.conflictSnapshotId)
     banner.isHidden = (info.bannerMessage == nil)
     // First paint fast path: style only initial visible/nearby content immediately,
-    // then complete full styling shortly after.
+    // then complete full styling shortly after. Large documents skip the full pass and are
+    // styled as they scroll into view.
     let fullRange = NSRange(location: 0, length: (info.content as NSString).length)
     let initialRange = initialOpenStylingRange(fullRange: fullRange)
     openStyleDebouncer.schedule(delayMs: 0) { [weak self] in
       guard let self else { return }
       await MainActor.run {
-        self.applyStyling(forChangedRange: initialRange)
+        let styleStart = OpenTrace.nowMs()
+        self.applyStyling(forChangedRange: initialRange, synchronously: true)
+        if let trace = self.openTrace {
+          trace.add("ui.first_styling", startMs: styleStart)
+          self.finishOpenTraceIfDone()
+        }
       }
     }
-    let deferredStyleDelayMs = (editorMode == .ultraFast) ? 260 : 140
-    fullOpenStyleDebouncer.schedule(delayMs: deferredStyleDelayMs) { [weak self] in
-      guard let self else { return }
-      await MainActor.run {
-        self.applyStyling(forChangedRange: fullRange)
+    if usesViewportStyling(length: fullRange.length) {
+      fullOpenStyleDebouncer.cancel()
+    } else {
+      let deferredStyleDelayMs = (editorMode == .ultraFast) ? 260 : 140
+      fullOpenStyleDebouncer.schedule(delayMs: deferredStyleDelayMs) { [weak self] in
+        guard let self else { return }
+        await MainActor.run {
+          self.applyStyling(forChangedRange: fullRange)
+        }
       }
     }
     if let line = moveCursorLine {
+      completeChunkedLoad()
       moveCursor(toLine: line, column: column ?? 1)
     }
     attachWatcher(for: info.fileURL)
@@ -873,12 +1030,91 @@ final class EditorViewController: NSViewController {
     }
   }
 
+  /// What of `content` goes into the text storage now. A document over `chunkedLoadThreshold`
+  /// starts with its first `chunkedLoadHeadLength` characters (to a line end), so the window is
+  /// drawn and editable right away; the rest is appended a chunk per main-queue turn. Edits to
+  /// the head are fine meanwhile, since the tail only ever goes on the end. Anything that needs
+  /// the whole buffer (the first edit, saving, find, the agent) calls `completeChunkedLoad()`.
+  private func chunkedLoadHead(of content: String) -> String {
+    #if TURBODRAFT_USE_CODEEDIT_TEXTVIEW
+    return content
+    #else
+    let ns = content as NSString
+    guard ns.length > Self.chunkedLoadThreshold else { return content }
+    let headEnd = NSMaxRange(ns.lineRange(for: NSRange(location: Self.chunkedLoadHeadLength, length: 0)))
+    guard headEnd < ns.length else { return content }
+    chunkedLoadSource = ns
+    chunkedLoadOffset = headEnd
+    scheduleChunkedLoad()
+    return ns.substring(to: headEnd)
+    #endif
+  }
+
+  private func scheduleChunkedLoad() {
+    let generation = chunkedLoadGeneration
+    DispatchQueue.main.async { [weak self] in
+      guard let self, self.chunkedLoadGeneration == generation else { return }
+      if self.appendChunkedLoadText(maxLength: Self.chunkedLoadChunkLength) {
+        self.scheduleChunkedLoad()
+      }
+    }
+  }
+
+  /// Appends up to `maxLength` more of the pending tail; true while some is left.
+  private func appendChunkedLoadText(maxLength: Int) -> Bool {
+    #if TURBODRAFT_USE_CODEEDIT_TEXTVIEW
+    return false
+    #else
+    guard let source = chunkedLoadSource, let storage = textView.textStorage else { return false }
+    var end = min(source.length, chunkedLoadOffset + maxLength)
+    if end < source.length {
+      // Don't split a surrogate pair or composed character across chunks.
+      let composed = source.rangeOfComposedCharacterSequence(at: end)
+      end = composed.location > chunkedLoadOffset ? composed.location : NSMaxRange(composed)
+    }
+    let chunk = source.substring(with: NSRange(location: chunkedLoadOffset, length: end - chunkedLoadOffset))
+    isApplyingProgrammaticUpdate = true
+    textView.undoManager?.disableUndoRegistration()
+    storage.append(NSAttributedString(string: chunk, attributes: baseStylingAttributes()))
+    textView.undoManager?.enableUndoRegistration()
+    isApplyingProgrammaticUpdate = false
+    chunkedLoadOffset = end
+    guard end >= source.length else { return true }
+    chunkedLoadSource = nil
+    if !usesViewportStyling(length: storage.length) {
+      // The deferred full pass may have run on the head alone.
+      scheduleCatchUpStyling(delayMs: 0)
+    }
+    return false
+    #endif
+  }
+
+  /// Puts the rest of a chunked load in now.
+  private func completeChunkedLoad() {
+    guard chunkedLoadSource != nil else { return }
+    chunkedLoadGeneration &+= 1
+    _ = appendChunkedLoadText(maxLength: Int.max)
+  }
+
+  /// Drops a chunked load without finishing it, for a buffer that is about to be replaced.
+  private func cancelChunkedLoad() {
+    chunkedLoadGeneration &+= 1
+    chunkedLoadSource = nil
+  }
+
   private func recordSessionReadyIfNeeded() {
     guard sessionOpenToReadyMsValue == nil else { return }
     guard let startNs = sessionOpenStartNs else { return }
     guard isEditorFirstResponder() else { return }
     let nowNs = DispatchTime.now().uptimeNanoseconds
     sessionOpenToReadyMsValue = Double(nowNs - startNs) / 1_000_000.0
+    openTrace?.add("ui.first_responder", startMs: OpenTrace.ms(fromUptimeNs: startNs), endMs: OpenTrace.ms(fromUptimeNs: nowNs))
+    finishOpenTraceIfDone()
+  }
+
+  private func finishOpenTraceIfDone() {
+    guard let trace = openTrace, trace.contains("ui.first_styling"), trace.contains("ui.first_responder") else { return }
+    openTrace = nil
   }
 
   private func initialOpenStylingRange(fullRange: NSRange) -> NSRange {
@@ -888,24 +1124,53 @@ final class EditorViewController: NSViewController {
     }
 
     let fullText = textView.string as NSString
-    #if !TURBODRAFT_USE_CODEEDIT_TEXTVIEW
-    if let lm = textView.layoutManager, let tc = textView.textContainer {
-      let visibleRect = scrollView.contentView.documentVisibleRect
-      let glyph = lm.glyphRange(forBoundingRect: visibleRect, in: tc)
-      let char = lm.characterRange(forGlyphRange: glyph, actualGlyphRange: nil)
-      let pad = (editorMode == .ultraFast) ? 1_200 : 2_000
-      let start = max(0, char.location - pad)
-      let end = min(fullRange.length, NSMaxRange(char) + pad)
-      let padded = NSRange(location: start, length: max(0, end - start))
-      return fullText.lineRange(for: padded)
+    if let viewport = viewportStylingRange(in: fullText) {
+      return viewport
     }
-    #endif
 
     let fallbackLimit = (editorMode == .ultraFast) ? 4_500 : 8_000
     let fallback = NSRange(location: 0, length: min(fullRange.length, fallbackLimit))
     return fullText.lineRange(for: fallback)
   }
 
+  /// Visible characters plus a margin, widened to whole lines; nil when the text view can't say.
+  private func viewportStylingRange(in fullText: NSString) -> NSRange? {
+    #if TURBODRAFT_USE_CODEEDIT_TEXTVIEW
+    return nil
+    #else
+    guard let lm = textView.layoutManager, let tc = textView.textContainer else { return nil }
+    let visibleRect = scrollView.contentView.documentVisibleRect
+    let glyph = lm.glyphRange(forBoundingRect: visibleRect, in: tc)
+    let char = lm.characterRange(forGlyphRange: glyph, actualGlyphRange: nil)
+    let pad = (editorMode == .ultraFast) ? 1_200 : 2_000
+    let start = max(0, char.location - pad)
+    let end = min(fullText.length, NSMaxRange(char) + pad)
+    let padded = NSRange(location: start, length: max(0, end - start))
+    return fullText.lineRange(for: padded)
+    #endif
+  }
+
+  private func usesViewportStyling(length: Int) -> Bool {
+    config.lazyStylingThreshold > 0 && length > config.lazyStylingThreshold
+  }
+
+  /// Styles whatever scrolled (or resized) into view and isn't styled yet.
+  @objc private func handleViewportDidChange(_ note: Notification) {
+    guard usesViewportStyling(length: (textView.string as NSString).length) else { return }
+    scheduleCatchUpStyling(delayMs: 0)
+  }
+
+  /// Styles everything still unstyled (only around the viewport for large documents).
+  private func scheduleCatchUpStyling(delayMs: Int) {
+    catchUpStyleDebouncer.schedule(delayMs: delayMs) { [weak self] in
+      guard let self else { return }
+      await MainActor.run {
+        let fullRange = NSRange(location: 0, length: (self.textView.string as NSString).length)
+        self.applyStyling(forChangedRange: fullRange)
+      }
+    }
+  }
+
   private func attachWatcher(for fileURL: URL) {
     watcher?.stop()
     watcher = nil
@@ -938,8 +1203,59 @@ final class EditorViewController: NSViewController {
     }
   }
 
+  /// Keeps `fenceIndex` in step with every character edit, programmatic ones included.
+  @objc private func handleTextStorageDidProcessEditing(_ note: Notification) {
+    guard let storage = note.object as? NSTextStorage,
+          storage.editedMask.contains(.editedCharacters)
+    else { return }
+    let text = storage.string as NSString
+    let lineEdits = pendingStyledRangeEdits
+    pendingStyledRangeEdits = nil
+    let dirty: [NSRange]
+    if let lineEdits {
+      // A batched replace: past the replaced lines, only those whose fence state flipped.
+      dirty = fenceIndex.applyEdits(
+        in: text,
+        editedRange: storage.editedRange,
+        changeInLength: storage.changeInLength,
+        lineEdits: lineEdits
+      )
+    } else {
+      dirty = [fenceIndex.applyEdit(
+        in: text,
+        editedRange: storage.editedRange,
+        changeInLength: storage.changeInLength
+      )]
+    }
+    if let first = dirty.first, let last = dirty.last {
+      let span = NSUnionRange(first, last)
+      pendingFenceDirtyRange = pendingFenceDirtyRange.map { NSUnionRange($0, span) } ?? span
+    }
+    searchSession.applyEdit(in: text, editedRange: storage.editedRange, changeInLength: storage.changeInLength)
+
+    // The edited lines and every line whose fence context flipped need styling again, and
+    // anything the worker is computing for the old text is now stale: pick it up once typing pauses.
+    stylingWorker.advanceVersion()
+    if !stylingInFlight.ranges.isEmpty {
+      stylingInFlight.removeAll()
+      scheduleCatchUpStyling(delayMs: 50)
+    }
+    if let lineEdits {
+      // A batched replace: drop only the lines that held a replacement, not the whole span.
+      styledRanges.applyEdits(lineEdits)
+    } else {
+      styledRanges.applyEdit(editedRange: storage.editedRange, changeInLength: storage.changeInLength)
+      let edited = NSIntersectionRange(storage.editedRange, NSRange(location: 0, length: text.length))
+      styledRanges.remove(text.lineRange(for: edited))
+    }
+    for range in dirty {
+      styledRanges.remove(range)
+    }
+  }
+
   @objc private func handleTextDidChange(_ note: Notification) {
     if isApplyingProgrammaticUpdate { return }
+    completeChunkedLoad()
     let changeStartNs = DispatchTime.now().uptimeNanoseconds
     let content = textView.string
     if !findContainer.isHidden {
@@ -1037,24 +1353,47 @@ final class EditorViewController: NSViewController {
     let docRange = NSRange(location: 0, length: fullText.length)
     let safeChanged = NSIntersectionRange(changedRange, docRange)
     let lineRange = fullText.lineRange(for: safeChanged)
-    let lineText = fullText.substring(with: lineRange)
 
-    // If a fence delimiter line changes, everything after it may need restyling.
-    let fenceDelimiterPattern = #"^\s*(`{3,}|~{3,})"#
-    if lineText.range(of: fenceDelimiterPattern, options: .regularExpression) != nil {
-      return NSRange(location: lineRange.location, length: docRange.length - lineRange.location)
-    }
-    return lineRange
+    // Lines whose fence open/close state flipped (e.g. everything after a newly typed ```)
+    // come from the fence index, so only they are restyled instead of the rest of the document.
+    guard let fenceDirty = pendingFenceDirtyRange else { return lineRange }
+    pendingFenceDirtyRange = nil
+    let safeFenceDirty = NSIntersectionRange(fenceDirty, docRange)
+    if safeFenceDirty.length == 0 { return lineRange }
+    return NSUnionRange(lineRange, fullText.lineRange(for: safeFenceDirty))
   }
 
-  private func applyStyling(forChangedRange range: NSRange) {
-    isApplyingProgrammaticUpdate = true
-    defer { isApplyingProgrammaticUpdate = false }
-
-    let fullText = textView.string as NSString
+  /// Styles the unstyled lines of `range`. Small batches (a keystroke's line) are styled inline;
+  /// larger ones are computed by `stylingWorker` on a snapshot and applied when they come back,
+  /// unless the text changed meanwhile. `synchronously` forces the inline path (first paint).
+  private func applyStyling(forChangedRange range: NSRange, synchronously: Bool = false) {
+    let text = textView.string
+    let fullText = text as NSString
     // Clamp range to current text length (range may be stale from debounce).
     let safeRange = NSIntersectionRange(range, NSRange(location: 0, length: fullText.length))
-    let lineRange = fullText.lineRange(for: safeRange)
+    var lineRange = fullText.lineRange(for: safeRange)
+    if usesViewportStyling(length: fullText.length), let viewport = viewportStylingRange(in: fullText) {
+      // Off-screen lines stay unstyled (and tracked as such) until they scroll into view.
+      lineRange = NSIntersectionRange(lineRange, viewport)
+    }
+    let dirtyLines = unstyledLineRanges(in: lineRange, of: fullText)
+    let baseAttrs = baseStylingAttributes()
+
+    let dirtyLength = dirtyLines.reduce(0) { $0 + $1.length }
+    if synchronously || dirtyLength <= inlineStylingLimit {
+      let runs = dirtyLines.map { lines in
+        (lines: lines, highlights: styler.highlights(in: text, range: lines, fenceIndex: fenceIndex))
+      }
+      applyHighlightRuns(runs, baseAttrs: baseAttrs)
+    } else {
+      scheduleBackgroundStyling(dirtyLines, snapshot: text)
+    }
+
+    // Reset typingAttributes so stale styles don't bleed into new keystrokes.
+    textView.typingAttributes = baseAttrs
+  }
+
+  private func baseStylingAttributes() -> [NSAttributedString.Key: Any] {
     let editorFont: NSFont
     let editorTextColor: NSColor
     #if TURBODRAFT_USE_CODEEDIT_TEXTVIEW
@@ -1066,26 +1405,71 @@ final class EditorViewController: NSViewController {
     // storage, so our own highlight attributes (marker, heading) corrupt it.
     editorTextColor = colorTheme.foreground
     #endif
-    let baseAttrs: [NSAttributedString.Key: Any] = [
+    return [
       .font: editorFont,
       .foregroundColor: editorTextColor,
     ]
+  }
+
+  private func applyHighlightRuns(_ runs: [(lines: NSRange, highlights: [Highlight])], baseAttrs: [NSAttributedString.Key: Any]) {
+    guard !runs.isEmpty, let storage = textView.textStorage else { return }
+    isApplyingProgrammaticUpdate = true
+    defer { isApplyingProgrammaticUpdate = false }
 
-    guard let storage = textView.textStorage else { return }
     textView.undoManager?.disableUndoRegistration()
     storage.beginEditing()
-    storage.setAttributes(baseAttrs, range: lineRange)
-
-    let highlights = styler.highlights(in: fullText as String, range: lineRange)
-    for h in highlights {
-      storage.addAttributes(h.attributes, range: h.range)
+    for run in runs {
+      storage.setAttributes(baseAttrs, range: run.lines)
+      for h in run.highlights {
+        storage.addAttributes(h.attributes, range: h.range)
+      }
+      styledRanges.insert(run.lines)
     }
-
     storage.endEditing()
     textView.undoManager?.enableUndoRegistration()
+  }
 
-    // Reset typingAttributes so stale styles don't bleed into new keystrokes.
-    textView.typingAttributes = baseAttrs
+  private func scheduleBackgroundStyling(_ dirtyLines: [NSRange], snapshot: String) {
+    if fenceIndex.length != (snapshot as NSString).length {
+      fenceIndex.rebuild(text: snapshot as NSString)
+    }
+    // Skip lines an earlier batch for this same text is already computing.
+    let pending = dirtyLines.flatMap { stylingInFlight.gaps(in: $0) }
+    guard !pending.isEmpty else { return }
+    let jobs = pending.map { MarkdownStylingWorker.Job(lines: $0, entryState: fenceIndex.state(before: $0.location)) }
+    for job in jobs {
+      stylingInFlight.insert(job.lines)
+    }
+    let version = stylingWorker.currentVersion
+    stylingWorker.compute(jobs, in: snapshot, version: version) { [weak self] results in
+      Task { @MainActor in
+        self?.applyBackgroundStyling(results, version: version)
+      }
+    }
+  }
+
+  private func applyBackgroundStyling(_ results: [MarkdownStylingWorker.Result], version: Int) {
+    // An edit since the snapshot shifted or replaced these ranges; the catch-up pass redoes them.
+    guard version == stylingWorker.currentVersion else { return }
+    for result in results {
+      stylingInFlight.remove(result.lines)
+    }
+    let runs = results.map { (lines: $0.lines, highlights: styler.highlights(for: $0.spans)) }
+    applyHighlightRuns(runs, baseAttrs: baseStylingAttributes())
+  }
+
+  /// The unstyled parts of `range`, widened to whole lines and coalesced.
+  private func unstyledLineRanges(in range: NSRange, of fullText: NSString) -> [NSRange] {
+    var out: [NSRange] = []
+    for gap in styledRanges.gaps(in: range) {
+      let lines = fullText.lineRange(for: gap)
+      if let last = out.last, NSMaxRange(last) >= lines.location {
+        out[out.count - 1] = NSUnionRange(last, lines)
+      } else {
+        out.append(lines)
+      }
+    }
+    return out
   }
 
   private func moveCursor(toLine line: Int, column: Int) {
@@ -1133,7 +1517,65 @@ final class EditorViewController: NSViewController {
     return true
   }
 
+  /// Applies `edits` (ascending, non-overlapping) as one storage edit and, given an
+  /// `actionName`, one undo step. The span from the first edit to the last is spliced together
+  /// front to back from the untouched text, attributes included, and the replacements, so only
+  /// the lines holding a replacement lose their styling and the cost stays linear however many
+  /// edits there are.
+  @discardableResult
+  private func applyTextEdits(
+    _ edits: [TextReplacement],
+    selectedLocation: Int? = nil,
+    actionName: String? = nil
+  ) -> Bool {
+    guard let storage = textView.textStorage, let first = edits.first, let last = edits.last else { return false }
+    let text = storage.string as NSString
+    let span = NSUnionRange(first.range, last.range)
+    let baseAttrs = baseStylingAttributes()
+    let spliced = NSMutableAttributedString()
+    var lineEdits: [(range: NSRange, replacementLength: Int)] = []
+    var cursor = span.location
+    for edit in edits {
+      if edit.range.location > cursor {
+        spliced.append(storage.attributedSubstring(from: NSRange(location: cursor, length: edit.range.location - cursor)))
+      }
+      spliced.append(NSAttributedString(string: edit.replacement, attributes: baseAttrs))
+      cursor = NSMaxRange(edit.range)
+
+      // Styling is invalidated per touched line, not across the whole span.
+      let lines = text.lineRange(for: edit.range)
+      let change = (edit.replacement as NSString).length - edit.range.length
+      if let previous = lineEdits.last, NSMaxRange(previous.range) > lines.location {
+        let merged = NSUnionRange(previous.range, lines)
+        lineEdits[lineEdits.count - 1] = (merged, previous.replacementLength + merged.length - previous.range.length + change)
+      } else {
+        lineEdits.append((lines, lines.length + change))
+      }
+    }
+
+    guard textView.shouldChangeText(in: span, replacementString: spliced.string) else { return false }
+    pendingStyledRangeEdits = lineEdits
+    if let actionName, let um = textView.undoManager {
+      um.beginUndoGrouping()
+      um.setActionName(actionName)
+      defer { um.endUndoGrouping() }
+      storage.replaceCharacters(in: span, with: spliced)
+    } else {
+      storage.replaceCharacters(in: span, with: spliced)
+    }
+    pendingStyledRangeEdits = nil
+    textView.didChangeText()
+    if let selectedLocation {
+      let clamped = max(0, min(selectedLocation, (textView.string as NSString).length))
+      textView.setSelectedRange(NSRange(location: clamped, length: 0))
+    }
+    return true
+  }
+
   private func replaceEntireDocumentWithUndo(_ content: String, actionName: String) {
+    // The whole document, tail included, so nothing is appended after `content` and undo
+    // brings all of it back.
+    completeChunkedLoad()
     let current = textView.string as NSString
     _ = applyTextEdit(
       replacementRange: NSRange(location: 0, length: current.length),
@@ -1210,15 +1652,9 @@ final class EditorViewController: NSViewController {
   private func updateAllFindHighlights() {
     clearAllFindHighlights()
     guard !findContainer.isHidden, let layout = textView.layoutManager else { return }
-    guard let summary = TextSearchEngine.summarizeMatches(
-      in: textView.string,
-      query: findField.stringValue,
-      options: currentSearchOptions(),
-      captureLimit: maxVisibleFindHighlights
-    ) else { return }
-    if summary.ranges.isEmpty { return }
+    guard let matches = currentFindMatches(), !matches.isEmpty else { return }
     let bg = colorTheme.highlight.withAlphaComponent(colorTheme.isDark ? 0.22 : 0.15)
-    for range in summary.ranges {
+    for range in matches.prefix(maxVisibleFindHighlights) {
       layout.addTemporaryAttributes([.backgroundColor: bg], forCharacterRange: range)
       allFindHighlightRanges.append(range)
     }
@@ -1309,10 +1745,14 @@ final class EditorViewController: NSViewController {
   }
 
   private func selectedRangeMatchesQuery(_ range: NSRange) -> Bool {
-    guard range.length > 0, let re = findRegularExpression() else { return false }
-    let source = textView.string
-    guard let match = re.firstMatch(in: source, range: range) else { return false }
-    return match.range == range
+    guard range.length > 0, currentFindMatches() != nil else { return false }
+    return searchSession.contains(range)
+  }
+
+  /// Matches of the find field's query, from `searchSession` (which only rescans when the query,
+  /// options or text changed in a way it couldn't track). Nil for an empty query or invalid regex.
+  private func currentFindMatches() -> [NSRange]? {
+    searchSession.update(query: findField.stringValue, options: currentSearchOptions(), in: textView.string as NSString)
   }
 
   private func currentSearchOptions() -> TextSearchOptions {
@@ -1329,41 +1769,22 @@ final class EditorViewController: NSViewController {
       showFind(replace: false)
       return nil
     }
-    guard let re = findRegularExpression() else { return nil }
-    let source = textView.string
-    let matches = re.matches(in: source, range: NSRange(location: 0, length: (source as NSString).length))
-    guard !matches.isEmpty else { return nil }
+    guard let matches = currentFindMatches(), !matches.isEmpty else { return nil }
 
     let selected = textView.selectedRange()
     let active = (activeFindHighlightRange != nil && selectedRangeMatchesQuery(activeFindHighlightRange!)) ? activeFindHighlightRange! : nil
 
     if forward {
       let anchor = (active != nil) ? (active!.location + active!.length) : (selected.location + selected.length)
-      if let next = matches.first(where: { $0.range.location >= anchor }) {
-        return next.range
-      }
-      return matches.first?.range
+      return searchSession.match(startingAtOrAfter: anchor)
     } else {
       let anchor = (active != nil) ? active!.location : selected.location
-      if let prev = matches.last(where: { $0.range.location < anchor }) {
-        return prev.range
-      }
-      return matches.last?.range
+      return searchSession.match(startingBefore: anchor)
     }
   }
 
-  private func findRegularExpression() -> NSRegularExpression? {
-    TextSearchEngine.makeRegex(query: findField.stringValue, options: currentSearchOptions())
-  }
-
   private func replacementString(for range: NSRange, in source: String) -> String {
-    TextSearchEngine.replacementForMatch(
-      in: source,
-      range: range,
-      query: findField.stringValue,
-      replacementTemplate: replaceField.stringValue,
-      options: currentSearchOptions()
-    ) ?? replaceField.stringValue
+    searchSession.replacement(for: range, in: source as NSString, template: replaceField.stringValue)
   }
 
   private func updateFindCountLabel() {
@@ -1372,16 +1793,11 @@ final class EditorViewController: NSViewController {
       findCountLabel.stringValue = ""
       return
     }
-    guard let summary = TextSearchEngine.summarizeMatches(
-      in: textView.string,
-      query: query,
-      options: currentSearchOptions(),
-      captureLimit: 0
-    ) else {
+    guard let matches = currentFindMatches() else {
       findCountLabel.stringValue = findRegexEnabled ? "Invalid regex" : ""
       return
     }
-    let count = summary.totalCount
+    let count = matches.count
     findCountLabel.stringValue = "\(count) match\(count == 1 ? "" : "es")"
   }
 
@@ -1484,6 +1900,7 @@ final class EditorViewController: NSViewController {
     }
 
     let instruction = "" // adapter applies a default instruction when empty
+    completeChunkedLoad()
     let basePrompt = textView.string
 
     let oldTitle = agentButton.title
@@ -1502,7 +1919,22 @@ final class EditorViewController: NSViewController {
       let resolved = await MainActor.run { self.promptAndImagesForAgent(from: basePrompt) }
       do {
         await flushAutosaveNow(reason: "agent_preflight")
-        let draft = try await adapter.draft(prompt: resolved.prompt, instruction: instruction, images: resolved.images, cwd: self.sessionCwd)
+        self.resetAgentPreview()
+        var completed: String?
+        let events = adapter.draftStream(prompt: resolved.prompt, instruction: instruction, images: resolved.images, cwd: self.sessionCwd)
+        for try await event in events {
+          switch event {
+          case let .delta(text):
+            self.appendAgentPreview(text)
+          case .restart:
+            self.resetAgentPreview()
+            self.banner.set(message: "Output needs repair; running prompt engineer again...", snapshotId: nil)
+          case let .completed(text):
+            completed = text
+          }
+        }
+        self.hideAgentPreview()
+        guard let draft = completed else { throw CancellationError() }
 
         let currentText = await MainActor.run { self.textView.string }
         await session.updateBufferContent(currentText)
@@ -1516,6 +1948,7 @@ final class EditorViewController: NSViewController {
         }
       } catch {
         await MainActor.run {
+          self.hideAgentPreview()
           self.banner.set(message: "Agent failed: \(error)", snapshotId: nil)
           self.banner.isHidden = false
         }
@@ -1529,8 +1962,27 @@ final class EditorViewController: NSViewController {
     }
   }
 
+  private func resetAgentPreview() {
+    agentPreviewTextView.string = ""
+    agentPreviewScrollView.isHidden = false
+  }
+
+  private func appendAgentPreview(_ text: String) {
+    guard let storage = agentPreviewTextView.textStorage else { return }
+    let attributes: [NSAttributedString.Key: Any] = [
+      .font: agentPreviewTextView.font ?? NSFont.monospacedSystemFont(ofSize: 13, weight: .regular),
+      .foregroundColor: colorTheme.secondaryText,
+    ]
+    storage.append(NSAttributedString(string: text, attributes: attributes))
+    agentPreviewTextView.scrollToEndOfDocument(nil)
+  }
+
+  private func hideAgentPreview() {
+    agentPreviewScrollView.isHidden = true
+    agentPreviewTextView.string = ""
+  }
+
   private func cleanUpAttachedImages() {
-    for url in attachedImages.values { try? FileManager.default.removeItem(at: url) }
     attachedImages.removeAll()
   }
 
@@ -1617,16 +2069,14 @@ extension EditorViewController: NSTextViewDelegate {
       guard let edit = MarkdownEnterBehavior.editForEnter(in: textView.string, selection: selected) else {
         return false
       }
-      guard applyTextEdit(
-        replacementRange: edit.replaceRange,
-        replacement: edit.replacement,
-        selectedLocation: edit.selectedLocation,
-        actionName: "Insert Newline"
-      ) else {
-        return false
+      return applyRenumberingListEdit {
+        applyTextEdit(
+          replacementRange: edit.replaceRange,
+          replacement: edit.replacement,
+          selectedLocation: edit.selectedLocation,
+          actionName: "Insert Newline"
+        )
       }
-      renumberOrderedListAroundCursor()
-      return true
     }
 
     if commandSelector == #selector(NSResponder.insertLineBreak(_:)) {
@@ -1643,27 +2093,15 @@ extension EditorViewController: NSTextViewDelegate {
     }
 
     if commandSelector == #selector(NSResponder.deleteBackward(_:)) {
-      if handleSmartListBackspace() {
-        renumberOrderedListAroundCursor()
-        return true
-      }
-      return false
+      return applyRenumberingListEdit { handleSmartListBackspace() }
     }
 
     if commandSelector == #selector(NSResponder.insertTab(_:)) {
-      if shiftSelectedListLines(direction: .right) {
-        renumberOrderedListAroundCursor()
-        return true
-      }
-      return false
+      return applyRenumberingListEdit { shiftSelectedListLines(direction: .right) }
     }
 
     if commandSelector == #selector(NSResponder.insertBacktab(_:)) {
-      if shiftSelectedListLines(direction: .left) {
-        renumberOrderedListAroundCursor()
-        return true
-      }
-      return false
+      return applyRenumberingListEdit { shiftSelectedListLines(direction: .left) }
     }
 
     return false
@@ -1809,19 +2247,31 @@ extension EditorViewController: NSTextViewDelegate {
     return trimmed
   }
 
+  /// Runs a structural list edit and, when it applied, the renumbering it calls for, as one
+  /// undo step under the edit's own action name.
+  private func applyRenumberingListEdit(_ edit: () -> Bool) -> Bool {
+    let um = textView.undoManager
+    um?.beginUndoGrouping()
+    defer { um?.endUndoGrouping() }
+    guard edit() else { return false }
+    renumberOrderedListAroundCursor()
+    return true
+  }
+
+  /// Rewrites just the item numbers that are off in the list around the cursor, so only those
+  /// lines are restyled. The cursor keeps its place when a number before it changes width.
   private func renumberOrderedListAroundCursor() {
-    let current = textView.string
     let cursor = textView.selectedRange().location
-    guard let renumbered = MarkdownOrderedListRenumbering.renumber(document: current, around: cursor),
-          renumbered != current
-    else { return }
+    let edits = MarkdownOrderedListRenumbering.edits(in: textView.string, around: cursor)
+    guard !edits.isEmpty else { return }
 
-    let oldSelection = textView.selectedRange()
-    _ = applyTextEdit(
-      replacementRange: NSRange(location: 0, length: (current as NSString).length),
-      replacement: renumbered,
-      selectedLocation: oldSelection.location,
-      actionName: "Renumber List"
+    var shifted = cursor
+    for edit in edits where NSMaxRange(edit.range) <= cursor {
+      shifted += (edit.replacement as NSString).length - edit.range.length
+    }
+    _ = applyTextEdits(
+      edits.map { TextReplacement(range: $0.range, replacement: $0.replacement) },
+      selectedLocation: shifted
     )
   }
 
@@ -1850,49 +2300,47 @@ extension EditorViewController: NSTextViewDelegate {
   }
 
   /// Shared image insertion logic for paste and drag-and-drop.
-  /// Inserts `[image-XXXX]` placeholders immediately, converts TIFF→PNG in background.
-  private func insertImages(_ images: [NSImage]) {
+  /// Inserts `[image-XXXX]` placeholders immediately; decoding, downsampling to
+  /// `imageMaxPixelSize` and writing happen in `imageCache` off the main thread. Each batch
+  /// waits behind the previous one, so `imageConversionTask` covers every pending paste.
+  private func insertImages(_ sources: [ImageIngestCache.Source]) {
     var ids: [String] = []
-    for _ in images {
+    for _ in sources {
       let id = UUID().uuidString.prefix(8).lowercased()
       ids.append(String(id))
       textView.insertText("[image-\(id)]", replacementRange: textView.selectedRange())
     }
-    let imagesToConvert = images
-    let converter = Task.detached(priority: .utility) { [ids, imagesToConvert] in
+    let maxPixelSize = config.imageMaxPixelSize
+    let cache = Self.imageCache
+    let converter = Task.detached(priority: .utility) { [ids, sources] in
       var pairs: [(String, URL)] = []
-      for (i, image) in imagesToConvert.enumerated() {
-        if let url = Self.saveTempImageBackground(image) {
-          pairs.append((ids[i], url))
+      for (i, source) in sources.enumerated() {
+        if let ingested = try? cache.ingest(source, maxPixelSize: maxPixelSize) {
+          pairs.append((ids[i], ingested.url))
         }
       }
       return pairs
     }
+    let previous = imageConversionTask
     imageConversionTask = Task { [weak self] in
+      await previous?.value
       let pairs = await converter.value
       guard let self else { return }
       for (id, url) in pairs {
         self.attachedImages[id] = url
       }
+      let failed = ids.count - pairs.count
+      if failed > 0 {
+        self.banner.set(
+          message: failed == 1
+            ? "Couldn't read the pasted image; its placeholder isn't attached."
+            : "Couldn't read \(failed) pasted images; their placeholders aren't attached.",
+          snapshotId: nil
+        )
+        self.banner.isHidden = false
+      }
     }
   }
-
-  private nonisolated static func saveTempImageBackground(_ image: NSImage) -> URL? {
-    guard let tiff = image.tiffRepresentation,
-          let bitmap = NSBitmapImageRep(data: tiff),
-          let png = bitmap.representation(using: .png, properties: [:])
-    else { return nil }
-    let imagesDir = FileManager.default.homeDirectoryForCurrentUser
-      .appendingPathComponent("Library/Application Support/TurboDraft/images", isDirectory: true)
-    try? FileManager.default.createDirectory(at: imagesDir, withIntermediateDirectories: true)
-    let url = imagesDir.appendingPathComponent("turbodraft-img-\(UUID().uuidString).png")
-    do {
-      try png.write(to: url)
-    } catch {
-      return nil
-    }
-    return url
-  }
 }
 #endif
 
@@ -1900,7 +2348,8 @@ extension EditorViewController: NSTextViewDelegate {
 /// Thin NSTextView subclass that adds drag-and-drop and paste support for images.
 /// Non-image drags/pastes fall through to NSTextView's default behavior.
 final class EditorTextView: NSTextView {
-  var onImageDrop: (([NSImage]) -> Void)?
+  /// Image bytes or files, not yet decoded; the controller ingests them in the background.
+  var onImageDrop: (([ImageIngestCache.Source]) -> Void)?
   var onCommandEnter: (() -> Void)?
   var onShowFind: (() -> Void)?
   var onShowReplace: (() -> Void)?
@@ -1996,10 +2445,11 @@ final class EditorTextView: NSTextView {
   private func handleImagePaste() -> Bool {
     let pb = NSPasteboard.general
 
-    // 1. Try raw TIFF/PNG data from clipboard (screenshots, copied image data).
-    for type in [NSPasteboard.PasteboardType.tiff, .png] {
-      if let data = pb.data(forType: type), let image = NSImage(data: data) {
-        onImageDrop?([image])
+    // 1. Try raw PNG/TIFF data from clipboard (screenshots, copied image data). PNG first:
+    // it's the smaller of the two when both are offered.
+    for type in [NSPasteboard.PasteboardType.png, .tiff] {
+      if let data = pb.data(forType: type), !data.isEmpty {
+        onImageDrop?([.data(data)])
         return true
       }
     }
@@ -2011,11 +2461,8 @@ final class EditorTextView: NSTextView {
        ) as? [URL] {
       let imageURLs = urls.filter { Self.imageExtensions.contains($0.pathExtension.lowercased()) }
       if !imageURLs.isEmpty {
-        let images = imageURLs.compactMap { NSImage(contentsOf: $0) }
-        if !images.isEmpty {
-          onImageDrop?(images)
-          return true
-        }
+        onImageDrop?(imageURLs.map { .file($0) })
+        return true
       }
     }
 
@@ -2082,9 +2529,7 @@ final class EditorTextView: NSTextView {
   override func performDragOperation(_ sender: NSDraggingInfo) -> Bool {
     let urls = imageURLs(from: sender)
     guard !urls.isEmpty else { return super.performDragOperation(sender) }
-    let images = urls.compactMap { NSImage(contentsOf: $0) }
-    guard !images.isEmpty else { return super.performDragOperation(sender) }
-    onImageDrop?(images)
+    onImageDrop?(urls.map { .file($0) })
     return true
   }
 }
@@ -2166,6 +2611,7 @@ extension EditorViewController {
   }
 
   func _testingSetDocumentText(_ text: String, actionName: String? = nil) {
+    completeChunkedLoad()
     if textView.string == text { return }
     if let window = view.window {
       _ = window.makeFirstResponder(textView)
@@ -2184,7 +2630,7 @@ extension EditorViewController {
       textView.setSelectedRange(NSRange(location: (text as NSString).length, length: 0))
     }
     let full = NSRange(location: 0, length: (text as NSString).length)
-    applyStyling(forChangedRange: full)
+    applyStyling(forChangedRange: full, synchronously: true)
     _testingBreakUndoCoalescing()
   }
 
@@ -2201,7 +2647,7 @@ extension EditorViewController {
     textView.insertText(text, replacementRange: textView.selectedRange())
     #endif
     let full = NSRange(location: 0, length: (textView.string as NSString).length)
-    applyStyling(forChangedRange: full)
+    applyStyling(forChangedRange: full, synchronously: true)
     _testingBreakUndoCoalescing()
   }
 
@@ -2241,6 +2687,7 @@ extension EditorViewController {
   }
   func _testingActiveFindRange() -> NSRange? { activeFindHighlightRange }
   func _testingAllFindRangeCount() -> Int { allFindHighlightRanges.count }
+  func _testingIsStyled(_ range: NSRange) -> Bool { styledRanges.contains(range) }
   func _testingActiveHighlightBackgroundColor() -> NSColor? {
     guard let layout = textView.layoutManager, let range = activeFindHighlightRange, range.length > 0 else { return nil }
     return layout.temporaryAttribute(.backgroundColor, atCharacterIndex: range.location, effectiveRange: nil) as? NSColor
@@ -131,6 +131,17 @@ final class EditorWindowController: NSWindowController, NSWindowDelegate {
     editorVC.setFont(family: family, size: size)
   }
 
+  /// Drops the window to its minimal footprint while it waits in the idle pool.
+  func releaseIdleResources() {
+    editorVC.releaseIdleResources()
+  }
+
+  /// Builds everything the first open would otherwise pay for while the window is still hidden.
+  func warmUpForIdlePool() {
+    window?.contentView?.layoutSubtreeIfNeeded()
+    editorVC.warmUpForIdlePool()
+  }
+
   func runPromptEngineer() {
     editorVC.runPromptEngineer()
   }
@@ -187,12 +198,20 @@ final class EditorWindowController: NSWindowController, NSWindowDelegate {
     editorVC.stylerCacheLimit
   }
 
+  var stylerCacheHitRate: Double {
+    editorVC.stylerCacheHitRate
+  }
+
   func flushAutosaveNow(reason: String = "forced_flush") async {
     await editorVC.flushAutosaveNow(reason: reason)
   }
 
-  func presentSession(_ info: SessionInfo, line: Int?, column: Int?) async {
-    editorVC.applySessionInfo(info, moveCursorLine: line, column: column)
+  /// `trace` gets the window's part of a traced open: presenting it here, and its first styling
+  /// pass and first responder from the view controller.
+  func presentSession(_ info: SessionInfo, line: Int?, column: Int?, trace: OpenTrace? = nil) async {
+    let presentStart = OpenTrace.nowMs()
+    defer { trace?.add("ui.present", startMs: presentStart) }
+    editorVC.applySessionInfo(info, moveCursorLine: line, column: column, trace: trace)
     window?.orderFrontRegardless()
     window?.makeKeyAndOrderFront(nil)
     NSApp.activate(ignoringOtherApps: true)
@@ -0,0 +1,65 @@
+import Foundation
+import TurboDraftCore
+
+/// Decides how many idle editor windows to keep warm, from how many windows were open at once
+/// recently and at this hour on previous days.
+///
+/// Each session open records the number of windows visible right after it. The target is the
+/// larger of the peak over the last `recentWindow` and the peak seen in the same hour of day
+/// (or the next one, so a burst at 9:58 still warms for 10:00) within `historyWindow`,
+/// clamped to `minIdle...maxIdle`. With no history it is `minIdle`, the old single pre-created
+/// window.
+struct IdleWindowPoolSizer {
+  struct Open: Equatable {
+    var at: Date
+    var concurrentWindows: Int
+  }
+
+  var minIdle = 1
+  var maxIdle = 4
+  var recentWindow: TimeInterval = 30 * 60
+  var historyWindow: TimeInterval = 14 * 24 * 60 * 60
+  var maxRecords = 2_048
+  var calendar = Calendar.current
+
+  private(set) var opens: [Open] = []
+
+  mutating func recordOpen(at date: Date, concurrentWindows: Int) {
+    opens.append(Open(at: date, concurrentWindows: max(1, concurrentWindows)))
+    if opens.count > maxRecords {
+      opens.removeFirst(opens.count - maxRecords)
+    }
+  }
+
+  /// Seeds history from `appSessionOpen` telemetry records; ones older than `historyWindow` are
+  /// skipped.
+  mutating func seed(from records: [TelemetryRecord], now: Date) {
+    let seeded = records.compactMap { record -> Open? in
+      guard record.event == .appSessionOpen, now.timeIntervalSince(record.date) <= historyWindow else { return nil }
+      return Open(at: record.date, concurrentWindows: max(1, Int(record.count)))
+    }
+    opens = (seeded + opens).sorted { $0.at < $1.at }
+    if opens.count > maxRecords {
+      opens.removeFirst(opens.count - maxRecords)
+    }
+  }
+
+  func targetIdleCount(at now: Date) -> Int {
+    let hour = calendar.component(.hour, from: now)
+    let nextHour = (hour + 1) % 24
+    var recentPeak = 0
+    var hourPeak = 0
+    for open in opens.reversed() {
+      let age = now.timeIntervalSince(open.at)
+      if age > historyWindow { break }
+      if age <= recentWindow {
+        recentPeak = max(recentPeak, open.concurrentWindows)
+      }
+      let openHour = calendar.component(.hour, from: open.at)
+      if openHour == hour || openHour == nextHour {
+        hourPeak = max(hourPeak, open.concurrentWindows)
+      }
+    }
+    return min(maxIdle, max(minIdle, max(recentPeak, hourPeak)))
+  }
+}
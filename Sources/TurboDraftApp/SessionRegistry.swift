@@ -0,0 +1,174 @@
+import Foundation
+
+/// The app's open sessions by id, with the file path and window each one belongs to, and an
+/// expiry index so orphans can be found without walking every session.
+///
+/// Every touch moves a session's deadline to `now + orphanMaxAgeNs` on the uptime clock
+/// (`DispatchTime.uptimeNanoseconds`; it doesn't run while the Mac sleeps, and wall-clock
+/// changes can't expire anything). Deadlines live in a binary min-heap, so a touch is one
+/// O(log n) push and nothing else: the node with the old deadline is left behind and skipped
+/// when it surfaces, recognised by an out-of-date `token`. The heap is rebuilt from the entries
+/// once stale nodes outnumber live ones, so it stays proportional to the session count however
+/// often a client polls.
+///
+/// Windows are held weakly. A session whose window is still around when its deadline passes is
+/// not an orphan; it gets a fresh deadline instead. The owner arms one timer for
+/// `nextDeadlineNs` and calls `popExpired` when it fires.
+struct SessionRegistry<Session: AnyObject, Window: AnyObject> {
+  private struct Entry {
+    var session: Session
+    weak var window: Window?
+    var path: String
+    var deadlineNs: UInt64
+    var token: UInt64
+  }
+
+  private struct Node {
+    var deadlineNs: UInt64
+    var id: String
+    var token: UInt64
+  }
+
+  let orphanMaxAgeNs: UInt64
+  private var entries: [String: Entry] = [:]
+  private var heap: [Node] = []
+  private var nextToken: UInt64 = 0
+
+  init(orphanMaxAgeNs: UInt64) {
+    self.orphanMaxAgeNs = max(1, orphanMaxAgeNs)
+  }
+
+  var count: Int { entries.count }
+  var isEmpty: Bool { entries.isEmpty }
+  var sessions: [Session] { entries.values.map(\.session) }
+  /// Heap nodes, stale ones included; for tests.
+  var indexedDeadlineCount: Int { heap.count }
+
+  func session(_ id: String) -> Session? {
+    entries[id]?.session
+  }
+
+  func window(_ id: String) -> Window? {
+    entries[id]?.window
+  }
+
+  /// A session registered for `path` whose window is still around.
+  func entry(forPath path: String) -> (session: Session, window: Window)? {
+    for entry in entries.values where entry.path == path {
+      guard let window = entry.window else { continue }
+      return (entry.session, window)
+    }
+    return nil
+  }
+
+  /// The earliest deadline in the index. It may belong to a session touched since; the timer
+  /// firing early only costs a `popExpired` that finds nothing.
+  var nextDeadlineNs: UInt64? { heap.first?.deadlineNs }
+
+  mutating func register(id: String, path: String, session: Session, window: Window, nowNs: UInt64) {
+    let token = takeToken()
+    let deadline = nowNs &+ orphanMaxAgeNs
+    entries[id] = Entry(session: session, window: window, path: path, deadlineNs: deadline, token: token)
+    push(Node(deadlineNs: deadline, id: id, token: token))
+  }
+
+  mutating func touch(_ id: String, nowNs: UInt64) {
+    guard entries[id] != nil else { return }
+    let token = takeToken()
+    let deadline = nowNs &+ orphanMaxAgeNs
+    entries[id]?.deadlineNs = deadline
+    entries[id]?.token = token
+    push(Node(deadlineNs: deadline, id: id, token: token))
+  }
+
+  /// Its heap node goes stale and is dropped when it surfaces.
+  @discardableResult
+  mutating func remove(_ id: String) -> Session? {
+    entries.removeValue(forKey: id)?.session
+  }
+
+  /// Removes every session `shouldRemove` matches; returns their ids.
+  @discardableResult
+  mutating func removeAll(where shouldRemove: (_ session: Session, _ window: Window?) -> Bool) -> [String] {
+    let ids = entries.compactMap { id, entry in shouldRemove(entry.session, entry.window) ? id : nil }
+    for id in ids {
+      entries.removeValue(forKey: id)
+    }
+    return ids
+  }
+
+  /// Removes and returns the sessions whose deadline is at or before `nowNs` and whose window
+  /// is gone. Ones that still have a window are re-armed for another `orphanMaxAgeNs`.
+  mutating func popExpired(nowNs: UInt64) -> [(id: String, session: Session)] {
+    var expired: [(id: String, session: Session)] = []
+    while let top = heap.first, top.deadlineNs <= nowNs {
+      popTop()
+      guard let entry = entries[top.id], entry.token == top.token else { continue }
+      if entry.window != nil {
+        touch(top.id, nowNs: nowNs)
+        continue
+      }
+      entries.removeValue(forKey: top.id)
+      expired.append((top.id, entry.session))
+    }
+    return expired
+  }
+
+  // MARK: - Heap
+
+  private mutating func takeToken() -> UInt64 {
+    nextToken &+= 1
+    return nextToken
+  }
+
+  private mutating func push(_ node: Node) {
+    heap.append(node)
+    siftUp(heap.count - 1)
+    if heap.count > 2 * entries.count + 32 {
+      rebuildHeap()
+    }
+  }
+
+  private mutating func popTop() {
+    let last = heap.removeLast()
+    guard !heap.isEmpty else { return }
+    heap[0] = last
+    siftDown(0)
+  }
+
+  /// Drops stale nodes: one node per entry, heapified bottom-up in O(n).
+  private mutating func rebuildHeap() {
+    heap = entries.map { id, entry in Node(deadlineNs: entry.deadlineNs, id: id, token: entry.token) }
+    var i = heap.count / 2
+    while i > 0 {
+      i -= 1
+      siftDown(i)
+    }
+  }
+
+  private mutating func siftUp(_ start: Int) {
+    var child = start
+    while child > 0 {
+      let parent = (child - 1) / 2
+      guard heap[child].deadlineNs < heap[parent].deadlineNs else { return }
+      heap.swapAt(child, parent)
+      child = parent
+    }
+  }
+
+  private mutating func siftDown(_ start: Int) {
+    var parent = start
+    while true {
+      let left = 2 * parent + 1
+      guard left < heap.count else { return }
+      var smallest = left
+      let right = left + 1
+      if right < heap.count, heap[right].deadlineNs < heap[left].deadlineNs {
+        smallest = right
+      }
+      guard heap[smallest].deadlineNs < heap[parent].deadlineNs else { return }
+      heap.swapAt(parent, smallest)
+      parent = smallest
+    }
+  }
+}
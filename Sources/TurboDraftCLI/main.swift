@@ -2,6 +2,7 @@ import AppKit
 import Darwin
 import Foundation
 import TurboDraftConfig
+import TurboDraftCore
 import TurboDraftMarkdown
 import TurboDraftProtocol
 import TurboDraftTransport
@@ -35,6 +36,8 @@ Commands:
   turbodraft open --path <file> [--line N] [--column N] [--wait] [--timeout-ms N] [--stdio]
   turbodraft bench run --path <file> [--fixture-dir <dir>] [--warm N] [--cold N] [--warmup-discard N] [--out <file.json>]
   turbodraft bench check --baseline <file.json> --results <file.json> [--compare <previous.json>]
+  turbodraft bench telemetry [--path <file.tdlog>] [--event <name>] [--since-hours N] [--raw]
+  turbodraft bench trace --path <file> [--runs N] [--warmup-discard N] [--out <file.json>]
 """
 
   func run() throws {
@@ -156,8 +159,12 @@ Commands:
       try runBenchRun()
     case "check":
       try runBenchCheck()
+    case "telemetry":
+      try runBenchTelemetry()
+    case "trace":
+      try runBenchTrace()
     default:
-      throw CLIError.invalidArgs("bench requires run|check")
+      throw CLIError.invalidArgs("bench requires run|check|telemetry|trace")
     }
   }
 
@@ -311,6 +318,7 @@ Commands:
         }
         var saveSamplesMs: [Double] = []
         var serverSaveSamplesMs: [Double] = []
+        var serverSavePhaseSamplesMs: [String: [Double]] = [:]
         for i in 0..<warmN {
           let mutatedContent = originalContent + "\n// bench save \(i)\n"
           let start = DispatchTime.now().uptimeNanoseconds
@@ -320,6 +328,9 @@ Commands:
           if let srvMs = saveRes.serverSaveMs {
             serverSaveSamplesMs.append(srvMs)
           }
+          for (phase, ms) in saveRes.serverSavePhaseMs ?? [:] {
+            serverSavePhaseSamplesMs[phase, default: []].append(ms)
+          }
         }
         emitMetric("warm_rpc_save_roundtrip", saveSamplesMs, suffix: suffix, metrics: &allMetrics, rawSamples: &allRawSamples)
         // Compat alias:
@@ -328,6 +339,9 @@ Commands:
         if !serverSaveSamplesMs.isEmpty {
           emitMetric("warm_server_save", serverSaveSamplesMs, suffix: suffix, metrics: &allMetrics, rawSamples: &allRawSamples)
         }
+        for (phase, samples) in serverSavePhaseSamplesMs.sorted(by: { $0.key < $1.key }) {
+          emitMetric("warm_server_save_\(phase)", samples, suffix: suffix, metrics: &allMetrics, rawSamples: &allRawSamples)
+        }
       }
 
       // --- Warm reflect bench with event-driven vs polling fallback tracking ---
@@ -395,6 +409,9 @@ Commands:
           emitMetric("warm_agent_reflect_event", reflectEventMs, suffix: suffix, metrics: &allMetrics, rawSamples: &allRawSamples)
         }
         allMetrics["warm_agent_reflect_polled_count\(suffix)"] = Double(reflectPolledMs.count)
+        if let suppressed = (try? sendBenchMetrics(conn, sessionId: openRes.sessionId))?.suppressedSelfWriteEvents {
+          allMetrics["warm_agent_reflect_suppressed_self_events\(suffix)"] = Double(suppressed)
+        }
         if Double(reflectPolledMs.count) > Double(warmN) * 0.10 {
           fputs("WARNING: \(reflectPolledMs.count)/\(warmN) reflect iterations used polling fallback\n", stderr)
         }
@@ -415,6 +432,10 @@ Commands:
           if let readyMs = benchResult.sessionOpenToReadyMs {
             allMetrics["warm_session_open_to_ready_ms\(suffix)"] = readyMs
           }
+          if let hits = benchResult.agentPoolHits, let misses = benchResult.agentPoolMisses {
+            allMetrics["agent_pool_hits\(suffix)"] = Double(hits)
+            allMetrics["agent_pool_misses\(suffix)"] = Double(misses)
+          }
         }
       }
 
@@ -586,6 +607,16 @@ Commands:
         }
         print(String(format: "%-40s %10.2f %10.2f %7.1f%% %8.4f %s", key, medA, medB, deltaPct, pValue, verdict))
       }
+      // Allocation counts (turbodraft-microbench) are deterministic per op, so there is no
+      // distribution to test: any growth past the threshold, plus one for rounding, fails.
+      let allocKeys = Set(prev.metrics.keys).intersection(results.metrics.keys).filter { $0.hasSuffix("_allocs_per_op") }
+      for key in allocKeys.sorted() {
+        guard let a = prev.metrics[key], let b = results.metrics[key] else { continue }
+        if b > a * (1 + thresholdPct / 100.0) + 1 {
+          print("\(key): \(String(format: "%.1f", a)) -> \(String(format: "%.1f", b)) REGRESSION")
+          regressions.append("\(key): \(String(format: "%.1f", a)) -> \(String(format: "%.1f", b)) allocations per op")
+        }
+      }
       if !regressions.isEmpty {
         throw CLIError.benchFailed("Regressions detected: " + regressions.joined(separator: "; "))
       }
@@ -614,6 +645,199 @@ Commands:
     }
   }
 
+  /// Reads the app's binary telemetry log (current and rotated file) and summarizes each event's
+  /// `value`, or with `--raw` prints one tab-separated line per record.
+  private func runBenchTelemetry() throws {
+    let url: URL
+    if let path = argValue("--path") {
+      url = URL(fileURLWithPath: path)
+    } else {
+      url = try TurboDraftPaths.applicationSupportDir()
+        .appendingPathComponent("telemetry", isDirectory: true)
+        .appendingPathComponent("app-events.tdlog")
+    }
+    var records = TelemetryLog.readRecords(at: url)
+    if let name = argValue("--event") {
+      guard let event = TelemetryEvent(name: name) else {
+        let known = TelemetryEvent.allCases.map(\.name).joined(separator: ", ")
+        throw CLIError.invalidArgs("unknown telemetry event: \(name) (known: \(known))")
+      }
+      records = records.filter { $0.event == event }
+    }
+    if let hours = argValue("--since-hours").flatMap(Double.init) {
+      let cutoff = Date().addingTimeInterval(-hours * 3600)
+      records = records.filter { $0.date >= cutoff }
+    }
+    guard !records.isEmpty else {
+      print("no telemetry records in \(url.path)")
+      return
+    }
+
+    if args.contains("--raw") {
+      let formatter = ISO8601DateFormatter()
+      formatter.formatOptions.insert(.withFractionalSeconds)
+      for r in records {
+        let name = r.event?.name ?? "event_\(r.eventID)"
+        print("\(formatter.string(from: r.date))\t\(name)\t\(r.count)\t\(String(format: "%.3f", r.value))\t\(r.flags)")
+      }
+      return
+    }
+
+    func pad(_ s: String, _ width: Int) -> String {
+      s.count >= width ? s + " " : s.padding(toLength: width, withPad: " ", startingAt: 0)
+    }
+    func padLeft(_ s: String, _ width: Int) -> String {
+      String(repeating: " ", count: max(0, width - s.count)) + s
+    }
+    print(pad("Event", 24) + [padLeft("n", 8), padLeft("median", 10), padLeft("p95", 10), padLeft("max", 10)].joined(separator: " "))
+    print(String(repeating: "-", count: 66))
+    for (eventID, group) in Dictionary(grouping: records, by: \.eventID).sorted(by: { $0.key < $1.key }) {
+      let name = TelemetryEvent(rawValue: eventID)?.name ?? "event_\(eventID)"
+      let values = group.map(\.value)
+      print(pad(name, 24) + String(
+        format: "%8d %10.2f %10.2f %10.2f",
+        values.count,
+        percentile(values, p: 0.50),
+        percentile(values, p: 0.95),
+        values.max() ?? 0
+      ))
+    }
+  }
+
+  private struct BenchTraceReport: Codable {
+    struct Span: Codable {
+      var depth: Int
+      var n: Int
+      var offsetP50Ms: Double
+      var p50Ms: Double
+      var p95Ms: Double
+    }
+
+    var timestamp: String
+    var path: String
+    var runs: Int
+    var incomplete: Int
+    var spans: [String: Span]
+    var traces: [BenchTraceResult]
+  }
+
+  /// Opens `--path` through `turbodraft --trace` `--runs` times, closing the session after each
+  /// so every run takes a pooled window, and prints each span's place in the open and its
+  /// p50/p95 as an indented timeline.
+  private func runBenchTrace() throws {
+    guard let path = argValue("--path") else { throw CLIError.invalidArgs("bench trace requires --path") }
+    let runs = max(1, argInt("--runs") ?? 20)
+    let warmupDiscard = max(0, argInt("--warmup-discard") ?? 2)
+    let launcher = siblingExecutablePath(named: "turbodraft") ?? "turbodraft"
+    let socketPath = TurboDraftConfig.load().socketPath
+
+    func traceOnce() throws -> BenchTraceResult? {
+      let proc = Process()
+      proc.executableURL = URL(fileURLWithPath: launcher.contains("/") ? launcher : "/usr/bin/env")
+      proc.arguments = (launcher.contains("/") ? [] : [launcher])
+        + ["--path", path, "--line", "1", "--column", "1", "--timeout-ms", "60000", "--trace"]
+      let stderrPipe = Pipe()
+      proc.standardInput = FileHandle.nullDevice
+      proc.standardOutput = FileHandle.nullDevice
+      proc.standardError = stderrPipe
+      try proc.run()
+      let output = stderrPipe.fileHandleForReading.readDataToEndOfFile()
+      proc.waitUntilExit()
+      guard proc.terminationStatus == 0 else {
+        throw CLIError.benchFailed("traced open exited \(proc.terminationStatus)")
+      }
+      let prefix = "trace_result="
+      guard let line = String(decoding: output, as: UTF8.self)
+        .split(separator: "\n")
+        .last(where: { $0.hasPrefix(prefix) }),
+        let resp = try? JSONDecoder().decode(JSONRPCResponse.self, from: Data(line.dropFirst(prefix.count).utf8)),
+        let result = try? resp.result?.decode(BenchTraceResult.self)
+      else { return nil }
+
+      if let sessionId = result.sessionId {
+        let fd = try connectOrLaunch(socketPath: socketPath, timeoutMs: 5_000)
+        let handle = FileHandle(fileDescriptor: fd, closeOnDealloc: true)
+        let conn = JSONRPCConnection(readHandle: handle, writeHandle: handle)
+        _ = try? sendSessionClose(conn, sessionId: sessionId)
+      }
+      // Let the closed window settle back into the pool.
+      Thread.sleep(forTimeInterval: 0.05)
+      return result
+    }
+
+    for _ in 0..<warmupDiscard {
+      _ = try traceOnce()
+    }
+    var traces: [BenchTraceResult] = []
+    var missing = 0
+    for _ in 0..<runs {
+      if let trace = try traceOnce() {
+        traces.append(trace)
+      } else {
+        missing += 1
+      }
+    }
+    guard !traces.isEmpty else {
+      throw CLIError.benchFailed("no traces returned; is the running app older than --trace?")
+    }
+
+    let summary = OpenTraceSummary(traces: traces.map(\.spans))
+    let incomplete = traces.filter { !$0.complete }.count + missing
+    print("\(traces.count) traced opens of \(path)" + (incomplete > 0 ? " (\(incomplete) incomplete)" : ""))
+
+    func pad(_ s: String, _ width: Int) -> String {
+      s.count >= width ? s + " " : s.padding(toLength: width, withPad: " ", startingAt: 0)
+    }
+    func padLeft(_ s: String, _ width: Int) -> String {
+      String(repeating: " ", count: max(0, width - s.count)) + s
+    }
+    let end = summary.rows.map { $0.offsetP50Ms + $0.durationP50Ms }.max() ?? 0
+    let barWidth = 40
+    func bar(_ row: OpenTraceSummary.Row) -> String {
+      guard end > 0 else { return "" }
+      let from = Int((row.offsetP50Ms / end * Double(barWidth)).rounded(.down))
+      let width = max(1, Int((row.durationP50Ms / end * Double(barWidth)).rounded()))
+      let lead = min(from, barWidth - 1)
+      return String(repeating: " ", count: lead) + String(repeating: "#", count: min(width, barWidth - lead))
+    }
+    print(pad("Span", 34) + [padLeft("at", 9), padLeft("p50", 9), padLeft("p95", 9), padLeft("n", 5)].joined(separator: " ") + "  timeline (p50)")
+    print(String(repeating: "-", count: 34 + 36 + 2 + barWidth))
+    for row in summary.rows {
+      let name = String(repeating: "  ", count: row.depth) + row.name
+      print(pad(name, 34) + String(
+        format: "%9.2f %9.2f %9.2f %5d",
+        row.offsetP50Ms,
+        row.durationP50Ms,
+        row.durationP95Ms,
+        row.count
+      ) + "  |" + bar(row).padding(toLength: barWidth, withPad: " ", startingAt: 0) + "|")
+    }
+
+    if let outPath = argValue("--out") {
+      var spans: [String: BenchTraceReport.Span] = [:]
+      for row in summary.rows {
+        spans[row.name] = BenchTraceReport.Span(
+          depth: row.depth,
+          n: row.count,
+          offsetP50Ms: row.offsetP50Ms,
+          p50Ms: row.durationP50Ms,
+          p95Ms: row.durationP95Ms
+        )
+      }
+      let report = BenchTraceReport(
+        timestamp: ISO8601DateFormatter().string(from: Date()),
+        path: path,
+        runs: runs,
+        incomplete: incomplete,
+        spans: spans,
+        traces: traces
+      )
+      let encoder = JSONEncoder()
+      encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+      try encoder.encode(report).write(to: URL(fileURLWithPath: outPath), options: [.atomic])
+    }
+  }
+
   /// Mann-Whitney U test with normal approximation. Returns p-value.
   private func mannWhitneyU(_ a: [Double], _ b: [Double]) -> Double {
     let na = a.count
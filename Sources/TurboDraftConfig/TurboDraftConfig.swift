@@ -134,6 +134,14 @@ public struct TurboDraftConfig: Codable, Sendable, Equatable {
   public var colorTheme: String
   public var fontSize: Int
   public var fontFamily: String
+  /// Concurrent launcher/CLI connections the app serves; extra connects are closed immediately.
+  public var maxClientConnections: Int
+  /// Documents longer than this (UTF-16 units) are styled around the viewport as it scrolls
+  /// instead of in one full pass after open; 0 always styles the whole document.
+  public var lazyStylingThreshold: Int
+  /// Pasted and dropped images are downsampled so their longer side is at most this many pixels
+  /// before they are attached; 0 keeps the original size.
+  public var imageMaxPixelSize: Int
 
   public init(
     socketPath: String = TurboDraftPaths.defaultSocketPath(),
@@ -144,7 +152,10 @@ public struct TurboDraftConfig: Codable, Sendable, Equatable {
     editorMode: EditorMode = .reliable,
     colorTheme: String = "turbodraft-dark",
     fontSize: Int = 13,
-    fontFamily: String = "system"
+    fontFamily: String = "system",
+    maxClientConnections: Int = 32,
+    lazyStylingThreshold: Int = 64_000,
+    imageMaxPixelSize: Int = 2_048
   ) {
     self.socketPath = socketPath
     self.autosaveDebounceMs = autosaveDebounceMs
@@ -155,6 +166,9 @@ public struct TurboDraftConfig: Codable, Sendable, Equatable {
     self.colorTheme = colorTheme
     self.fontSize = fontSize
     self.fontFamily = fontFamily
+    self.maxClientConnections = maxClientConnections
+    self.lazyStylingThreshold = lazyStylingThreshold
+    self.imageMaxPixelSize = imageMaxPixelSize
   }
 
   private enum CodingKeys: String, CodingKey {
@@ -167,6 +181,9 @@ public struct TurboDraftConfig: Codable, Sendable, Equatable {
     case colorTheme
     case fontSize
     case fontFamily
+    case maxClientConnections
+    case lazyStylingThreshold
+    case imageMaxPixelSize
   }
 
   public init(from decoder: Decoder) throws {
@@ -180,6 +197,9 @@ public struct TurboDraftConfig: Codable, Sendable, Equatable {
     self.colorTheme = try c.decodeIfPresent(String.self, forKey: .colorTheme) ?? "turbodraft-dark"
     self.fontSize = try c.decodeIfPresent(Int.self, forKey: .fontSize) ?? 13
     self.fontFamily = try c.decodeIfPresent(String.self, forKey: .fontFamily) ?? "system"
+    self.maxClientConnections = try c.decodeIfPresent(Int.self, forKey: .maxClientConnections) ?? 32
+    self.lazyStylingThreshold = try c.decodeIfPresent(Int.self, forKey: .lazyStylingThreshold) ?? 64_000
+    self.imageMaxPixelSize = try c.decodeIfPresent(Int.self, forKey: .imageMaxPixelSize) ?? 2_048
   }
 
   public func encode(to encoder: Encoder) throws {
@@ -193,10 +213,16 @@ public struct TurboDraftConfig: Codable, Sendable, Equatable {
     try c.encode(colorTheme, forKey: .colorTheme)
     try c.encode(fontSize, forKey: .fontSize)
     try c.encode(fontFamily, forKey: .fontFamily)
+    try c.encode(maxClientConnections, forKey: .maxClientConnections)
+    try c.encode(lazyStylingThreshold, forKey: .lazyStylingThreshold)
+    try c.encode(imageMaxPixelSize, forKey: .imageMaxPixelSize)
   }
 
   public static func load() -> TurboDraftConfig {
-    let path = resolvedConfigPath()
+    load(from: resolvedConfigPath())
+  }
+
+  public static func load(from path: String) -> TurboDraftConfig {
     guard let data = try? Data(contentsOf: URL(fileURLWithPath: path)) else {
       return TurboDraftConfig()
     }
@@ -215,6 +241,9 @@ public struct TurboDraftConfig: Codable, Sendable, Equatable {
     if cfg.autosaveMaxFlushMs > 0 {
       cfg.autosaveMaxFlushMs = max(cfg.autosaveMaxFlushMs, cfg.autosaveDebounceMs)
     }
+    cfg.maxClientConnections = min(max(cfg.maxClientConnections, 1), 256)
+    cfg.lazyStylingThreshold = max(0, cfg.lazyStylingThreshold)
+    cfg.imageMaxPixelSize = min(max(cfg.imageMaxPixelSize, 0), 16_384)
     // Some Codex model variants don't support all reasoning efforts (for example Spark doesn't accept "minimal").
     if cfg.agent.model.contains("spark"), cfg.agent.reasoningEffort == .minimal {
       cfg.agent.reasoningEffort = .low
@@ -244,6 +273,8 @@ public struct TurboDraftConfig: Codable, Sendable, Equatable {
     let data = try JSONEncoder().encode(self.sanitized())
     try FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true)
     try data.write(to: url, options: [.atomic])
+    // Keep the launcher's binary socket-path record in step with the file we just wrote.
+    try? TurboDraftSocketPathCache.publish(configPath: target)
   }
 
   public static func writeDefault(to path: String? = nil) throws {
@@ -0,0 +1,115 @@
+import Foundation
+
+/// Fixed-layout record that lets the C launcher resolve the socket path with one `stat` + `pread`
+/// instead of reading and scanning `config.json` on every invocation.
+///
+/// Layout (little-endian, `recordBytes` long, stored at `<config path>.socket-cache`):
+///
+///     0   u32  magic "TDSC"
+///     4   u32  version
+///     8   i64  config mtime seconds
+///     16  i64  config mtime nanoseconds
+///     24  i64  config size (-1 when the config file does not exist)
+///     32  u64  config inode
+///     40  u32  socket path length in bytes
+///     44  u32  reserved (0)
+///     48  u8[pathBytes]  socket path, NUL-padded
+///
+/// The record is only trusted while the config file's (mtime, size, inode) still match;
+/// otherwise the launcher falls back to parsing `config.json`. Keep in sync with
+/// `read_socket_path_cache()` in `Sources/TurboDraftOpen/main.c`.
+public enum TurboDraftSocketPathCache {
+  static let magic: UInt32 = 0x4353_4454
+  static let version: UInt32 = 1
+  static let headerBytes = 48
+  static let pathBytes = 1024
+  public static let recordBytes = headerBytes + pathBytes
+
+  struct ConfigKey: Equatable {
+    var mtimeSec: Int64
+    var mtimeNsec: Int64
+    var size: Int64
+    var inode: UInt64
+
+    static let missing = ConfigKey(mtimeSec: 0, mtimeNsec: 0, size: -1, inode: 0)
+
+    /// Returns `.missing` when the config file does not exist, nil when it can't be stat'ed.
+    static func current(configPath: String) -> ConfigKey? {
+      var st = stat()
+      if stat(configPath, &st) != 0 {
+        return errno == ENOENT ? .missing : nil
+      }
+      return ConfigKey(
+        mtimeSec: Int64(st.st_mtimespec.tv_sec),
+        mtimeNsec: Int64(st.st_mtimespec.tv_nsec),
+        size: Int64(st.st_size),
+        inode: UInt64(st.st_ino)
+      )
+    }
+  }
+
+  public static func cachePath(forConfigPath configPath: String) -> String {
+    configPath + ".socket-cache"
+  }
+
+  /// Resolves the config at `configPath` and publishes its socket path. Best-effort callers use `try?`.
+  public static func publish(configPath: String = TurboDraftConfig.resolvedConfigPath()) throws {
+    // Stat before reading so a concurrent edit can only make the record stale, never wrong.
+    guard let key = ConfigKey.current(configPath: configPath) else { return }
+    let socketPath = TurboDraftConfig.load(from: configPath).socketPath
+    guard let record = encode(socketPath: socketPath, key: key) else { return }
+    try record.write(to: URL(fileURLWithPath: cachePath(forConfigPath: configPath)), options: [.atomic])
+  }
+
+  /// Swift mirror of the launcher's lookup; nil when the record is missing, malformed or stale.
+  public static func lookup(configPath: String = TurboDraftConfig.resolvedConfigPath()) -> String? {
+    guard let key = ConfigKey.current(configPath: configPath),
+          let data = FileManager.default.contents(atPath: cachePath(forConfigPath: configPath))
+    else { return nil }
+    return decode(data, expecting: key)
+  }
+
+  static func encode(socketPath: String, key: ConfigKey) -> Data? {
+    let pathUTF8 = Array(socketPath.utf8)
+    guard !pathUTF8.isEmpty, pathUTF8.count < pathBytes, !pathUTF8.contains(0) else { return nil }
+
+    var out = Data(capacity: recordBytes)
+    func append<T: FixedWidthInteger>(_ value: T) {
+      withUnsafeBytes(of: value.littleEndian) { out.append(contentsOf: $0) }
+    }
+    append(magic)
+    append(version)
+    append(key.mtimeSec)
+    append(key.mtimeNsec)
+    append(key.size)
+    append(key.inode)
+    append(UInt32(pathUTF8.count))
+    append(UInt32(0))
+    out.append(contentsOf: pathUTF8)
+    out.append(Data(count: recordBytes - out.count))
+    return out
+  }
+
+  static func decode(_ data: Data, expecting key: ConfigKey) -> String? {
+    guard data.count >= headerBytes else { return nil }
+    let bytes = [UInt8](data)
+    func read<T: FixedWidthInteger>(_: T.Type, at offset: Int) -> T {
+      var value: T = 0
+      withUnsafeMutableBytes(of: &value) { dst in
+        dst.copyBytes(from: bytes[offset..<(offset + MemoryLayout<T>.size)])
+      }
+      return T(littleEndian: value)
+    }
+    guard read(UInt32.self, at: 0) == magic, read(UInt32.self, at: 4) == version else { return nil }
+    let stored = ConfigKey(
+      mtimeSec: read(Int64.self, at: 8),
+      mtimeNsec: read(Int64.self, at: 16),
+      size: read(Int64.self, at: 24),
+      inode: read(UInt64.self, at: 32)
+    )
+    guard stored == key else { return nil }
+    let length = Int(read(UInt32.self, at: 40))
+    guard length > 0, length < pathBytes, headerBytes + length <= bytes.count else { return nil }
+    return String(decoding: bytes[headerBytes..<(headerBytes + length)], as: UTF8.self)
+  }
+}
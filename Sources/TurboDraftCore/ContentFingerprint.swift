@@ -0,0 +1,127 @@
+import Foundation
+
+/// Fast 128-bit content hash for equality checks and dedup.
+///
+/// The two halves are XXH64 of the UTF-8 bytes under two seeds, computed in one pass over 32-byte
+/// stripes with eight independent lanes (so the multiply-rotate rounds pipeline and vectorize).
+/// Not cryptographic: anything that leaves the process as a revision stays `Revision.sha256`.
+public struct ContentFingerprint: Hashable, Sendable, CustomStringConvertible {
+  public var high: UInt64
+  public var low: UInt64
+
+  public init(high: UInt64, low: UInt64) {
+    self.high = high
+    self.low = low
+  }
+
+  public init(text: String) {
+    var text = text
+    self = text.withUTF8 { ContentFingerprint(bytes: UnsafeRawBufferPointer($0)) }
+  }
+
+  public init(bytes: UnsafeRawBufferPointer) {
+    (high, low) = Self.hash(bytes)
+  }
+
+  /// `fp128:` followed by 32 hex digits, high half first.
+  public var description: String {
+    "fp128:" + Revision.hex(high) + Revision.hex(low)
+  }
+
+  private static let prime1: UInt64 = 0x9E37_79B1_85EB_CA87
+  private static let prime2: UInt64 = 0xC2B2_AE3D_27D4_EB4F
+  private static let prime3: UInt64 = 0x1656_67B1_9E37_79F9
+  private static let prime4: UInt64 = 0x85EB_CA77_C2B2_AE63
+  private static let prime5: UInt64 = 0x27D4_EB2F_1656_67C5
+  private static let highSeed = prime5
+
+  private static func hash(_ bytes: UnsafeRawBufferPointer) -> (UInt64, UInt64) {
+    let count = bytes.count
+    guard let base = bytes.baseAddress, count > 0 else {
+      return (finish(highSeed &+ prime5, from: bytes, at: 0), finish(prime5, from: bytes, at: 0))
+    }
+
+    var offset = 0
+    var hi: UInt64
+    var lo: UInt64
+    if count >= 32 {
+      var h1 = highSeed &+ prime1 &+ prime2, h2 = highSeed &+ prime2, h3 = highSeed, h4 = highSeed &- prime1
+      var l1 = prime1 &+ prime2, l2 = prime2, l3: UInt64 = 0, l4: UInt64 = 0 &- prime1
+      while offset + 32 <= count {
+        let w1 = UInt64(littleEndian: base.loadUnaligned(fromByteOffset: offset, as: UInt64.self))
+        let w2 = UInt64(littleEndian: base.loadUnaligned(fromByteOffset: offset + 8, as: UInt64.self))
+        let w3 = UInt64(littleEndian: base.loadUnaligned(fromByteOffset: offset + 16, as: UInt64.self))
+        let w4 = UInt64(littleEndian: base.loadUnaligned(fromByteOffset: offset + 24, as: UInt64.self))
+        h1 = accumulate(h1, w1)
+        h2 = accumulate(h2, w2)
+        h3 = accumulate(h3, w3)
+        h4 = accumulate(h4, w4)
+        l1 = accumulate(l1, w1)
+        l2 = accumulate(l2, w2)
+        l3 = accumulate(l3, w3)
+        l4 = accumulate(l4, w4)
+        offset += 32
+      }
+      hi = converge(h1, h2, h3, h4)
+      lo = converge(l1, l2, l3, l4)
+    } else {
+      hi = highSeed &+ prime5
+      lo = prime5
+    }
+    return (finish(hi, from: bytes, at: offset), finish(lo, from: bytes, at: offset))
+  }
+
+  @inline(__always)
+  private static func accumulate(_ acc: UInt64, _ input: UInt64) -> UInt64 {
+    rotl(acc &+ input &* prime2, 31) &* prime1
+  }
+
+  @inline(__always)
+  private static func rotl(_ x: UInt64, _ r: UInt64) -> UInt64 {
+    (x << r) | (x >> (64 - r))
+  }
+
+  /// Unrolled: a `[v1, v2, v3, v4]` loop would put an array on the heap on every hash.
+  @inline(__always)
+  private static func converge(_ v1: UInt64, _ v2: UInt64, _ v3: UInt64, _ v4: UInt64) -> UInt64 {
+    var h = rotl(v1, 1) &+ rotl(v2, 7) &+ rotl(v3, 12) &+ rotl(v4, 18)
+    h = merge(h, v1)
+    h = merge(h, v2)
+    h = merge(h, v3)
+    h = merge(h, v4)
+    return h
+  }
+
+  @inline(__always)
+  private static func merge(_ h: UInt64, _ v: UInt64) -> UInt64 {
+    (h ^ accumulate(0, v)) &* prime1 &+ prime4
+  }
+
+  /// Folds in the length and the bytes after the last full stripe, then avalanches.
+  private static func finish(_ acc: UInt64, from bytes: UnsafeRawBufferPointer, at start: Int) -> UInt64 {
+    let count = bytes.count
+    var h = acc &+ UInt64(count)
+    var offset = start
+    while offset + 8 <= count {
+      h ^= accumulate(0, UInt64(littleEndian: bytes.loadUnaligned(fromByteOffset: offset, as: UInt64.self)))
+      h = rotl(h, 27) &* prime1 &+ prime4
+      offset += 8
+    }
+    if offset + 4 <= count {
+      h ^= UInt64(UInt32(littleEndian: bytes.loadUnaligned(fromByteOffset: offset, as: UInt32.self))) &* prime1
+      h = rotl(h, 23) &* prime2 &+ prime3
+      offset += 4
+    }
+    while offset < count {
+      h ^= UInt64(bytes[offset]) &* prime5
+      h = rotl(h, 11) &* prime1
+      offset += 1
+    }
+    h ^= h >> 33
+    h = h &* prime2
+    h ^= h >> 29
+    h = h &* prime3
+    h ^= h >> 32
+    return h
+  }
+}
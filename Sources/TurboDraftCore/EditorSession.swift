@@ -31,6 +31,19 @@ public struct SessionInfo: Sendable, Equatable {
   }
 }
 
+/// Disk-write counters for one session, for bench metrics.
+public struct SessionSaveStats: Sendable, Equatable {
+  public var writeCount: Int = 0
+  /// Saves settled without writing because the buffer already matched what is on disk.
+  public var skippedWriteCount: Int = 0
+  public var lastWriteTimings: AtomicWriteTimings?
+  /// Disk-change checks (watcher events, revision-wait polls) answered by the file's stamp still
+  /// being the one our last write left, without reading the file.
+  public var suppressedSelfEventCount: Int = 0
+
+  public init() {}
+}
+
 public actor EditorSession {
   private static let historyMaxCount = 32
   private static let historyMaxBytes = 4_000_000
@@ -44,14 +57,40 @@ public actor EditorSession {
 
   private var sessionId: String = UUID().uuidString
   private var fileURL: URL?
-  private var content: String = ""
+  private var content: String = "" {
+    didSet { cachedContentFingerprint = nil }
+  }
+  /// Fingerprint of `content`, computed at most once per buffer version.
+  private var cachedContentFingerprint: ContentFingerprint?
   private var diskRevision: String = Revision.sha256(text: "")
+  /// Fingerprint of the text `diskRevision` names; disk-change checks compare this instead of
+  /// rehashing with SHA-256.
+  private var diskFingerprint = ContentFingerprint(text: "")
+  /// `stat` stamp of the file whose content is `diskFingerprint`; while the file still has this
+  /// stamp, a disk-change check needs no read.
+  private var diskStamp: FileStamp?
+  /// Whether `diskStamp` came from our own write (for `suppressedSelfEventCount`).
+  private var diskStampIsOwnWrite = false
   private var isDirty: Bool = false
   private var history = HistoryStore(
     maxCount: EditorSession.historyMaxCount,
     maxBytes: EditorSession.historyMaxBytes
   )
   private let recoveryStore = RecoveryStore()
+  private let io = SessionIOQueue()
+  /// The latest disk write not yet started; autosaves that arrive meanwhile join it, and it
+  /// writes whatever the buffer holds when it starts.
+  private var pendingWrite: Task<Void, Error>?
+  /// The most recently queued disk write, which the next one waits behind.
+  private var lastWrite: Task<Void, Error>?
+  /// Fingerprint of the content a write in progress is putting on disk, so the watcher event
+  /// for our own save isn't mistaken for an external change.
+  private var writingFingerprint: ContentFingerprint?
+  /// Disk-change checks, coalesced like writes: callers during a burst join the one not yet
+  /// started rather than each re-reading the file.
+  private var pendingDiskCheck: Task<SessionInfo?, Error>?
+  private var lastDiskCheck: Task<SessionInfo?, Error>?
+  private var saveStats = SessionSaveStats()
   private var conflictSnapshotId: String?
   private var bannerMessage: String?
 
@@ -63,24 +102,32 @@ public actor EditorSession {
 
   public init() {}
 
-  public func open(fileURL: URL, cwd: String? = nil) throws -> SessionInfo {
-    // Perform failable I/O before mutating instance state (#13).
-    if !FileManager.default.fileExists(atPath: fileURL.path) {
-      try FileManager.default.createDirectory(at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true)
-      FileManager.default.createFile(atPath: fileURL.path, contents: Data())
+  public func open(fileURL: URL, cwd: String? = nil) async throws -> SessionInfo {
+    // Perform failable I/O before mutating instance state (#13), on the I/O queue so the actor
+    // stays free. The recovery load+append is a single read-write cycle with its write queued.
+    let recoveryStore = recoveryStore
+    let trace = OpenTrace.current
+    let (text, stamp, openSnap, fingerprint, recovered) = try await io.perform {
+      if !FileManager.default.fileExists(atPath: fileURL.path) {
+        try FileManager.default.createDirectory(at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true)
+        FileManager.default.createFile(atPath: fileURL.path, contents: Data())
+      }
+      // Stamp before reading: if the file changes in between, the next check sees a new stamp.
+      let stamp = FileIO.stamp(at: fileURL)
+      let text = try FileIO.readText(at: fileURL)
+      let openSnap = HistorySnapshot(reason: "open_buffer", content: text)
+      let fingerprint = ContentFingerprint(text: text)
+      let recoveryStart = OpenTrace.nowMs()
+      let recovered = recoveryStore.loadAndAppend(
+        for: fileURL,
+        snapshot: openSnap,
+        fingerprint: fingerprint,
+        loadMaxCount: EditorSession.recoveryLoadCount
+      )
+      trace?.add("server.recovery_load", startMs: recoveryStart)
+      return (text, stamp, openSnap, fingerprint, recovered)
     }
 
-    // PERF: sync file I/O on actor — acceptable for single-file editor
-    let text = try FileIO.readText(at: fileURL)
-    // PERF: combined load+append in single read-write cycle (Tier 2),
-    // write dispatched to background queue (Tier 3).
-    let openSnap = HistorySnapshot(reason: "open_buffer", content: text)
-    let recovered = recoveryStore.loadAndAppend(
-      for: fileURL,
-      snapshot: openSnap,
-      loadMaxCount: EditorSession.recoveryLoadCount
-    )
-
     // All failable operations succeeded — now mutate instance state.
 
     // Opening a new file/session supersedes any existing waiters from
@@ -106,7 +153,11 @@ public actor EditorSession {
     }
 
     self.content = text
+    self.cachedContentFingerprint = fingerprint
     self.diskRevision = Revision.sha256(text: text)
+    self.diskFingerprint = fingerprint
+    self.diskStamp = stamp
+    self.diskStampIsOwnWrite = false
     self.isDirty = false
     if let recoverable = recovered.last(where: { $0.content != text }) {
       self.conflictSnapshotId = recoverable.id
@@ -139,8 +190,7 @@ public actor EditorSession {
     guard let url = fileURL else { return nil }
     let snap = HistorySnapshot(reason: reason, content: content)
     history.append(snap)
-    // PERF: sync disk I/O for recovery store
-    _ = recoveryStore.appendSnapshot(snap, for: url)
+    appendRecoverySnapshot(snap, for: url)
     return snap.id
   }
 
@@ -158,38 +208,131 @@ public actor EditorSession {
     )
   }
 
-  public func autosave(reason: String = "autosave") throws -> SessionInfo? {
+  /// Snapshots the buffer and writes it to disk, returning once bytes at least as new as this
+  /// call's content are on disk (revision waiters are released at the same point). Autosaves
+  /// that arrive while a write is in progress coalesce into one follow-up write of the latest
+  /// content.
+  public func autosave(reason: String = "autosave") async throws -> SessionInfo? {
     guard let url = fileURL else { return nil }
     guard isDirty else { return currentInfo() }
 
     let snap = HistorySnapshot(reason: reason, content: content)
     history.append(snap)
-    // PERF: sync disk I/O for recovery store
-    _ = recoveryStore.appendSnapshot(snap, for: url)
-    // PERF: sync file write on actor
-    let newRev = try FileIO.writeTextAtomically(content, to: url)
-    diskRevision = newRev
-    isDirty = false
+    appendRecoverySnapshot(snap, for: url)
+    try await writeLatestContent()
+    return currentInfo()
+  }
+
+  private func writeLatestContent() async throws {
+    if let pendingWrite {
+      return try await pendingWrite.value
+    }
+    let previous = lastWrite
+    let write = Task {
+      _ = try? await previous?.value
+      try await self.performPendingWrite()
+    }
+    pendingWrite = write
+    lastWrite = write
+    try await write.value
+  }
+
+  private func performPendingWrite() async throws {
+    pendingWrite = nil
+    guard let url = fileURL, isDirty else { return }
+    let text = content
+    let fingerprint = contentFingerprint()
+    let session = sessionId
+    if fingerprint == diskFingerprint {
+      // Edited back to what we last read or wrote. The file may have changed since without a
+      // disk-change check noticing yet, so one `stat` confirms it is still that file before
+      // the write is skipped.
+      let knownStamp = diskStamp
+      let stamp = try await io.perform { FileIO.stamp(at: url) }
+      guard sessionId == session else { return }
+      if let stamp, stamp == knownStamp {
+        saveStats.skippedWriteCount += 1
+        if contentFingerprint() == fingerprint {
+          isDirty = false
+        }
+        bannerMessage = nil
+        conflictSnapshotId = nil
+        return
+      }
+    }
+    writingFingerprint = fingerprint
+    defer { writingFingerprint = nil }
+
+    let written = try await io.perform { try FileIO.replaceContents(of: url, with: text) }
+    saveStats.writeCount += 1
+    saveStats.lastWriteTimings = written.timings
+    // Reopened onto another file while the write ran: that session has its own disk state.
+    guard sessionId == session else { return }
+    diskRevision = written.revision
+    diskFingerprint = fingerprint
+    diskStamp = written.stamp
+    diskStampIsOwnWrite = true
+    if contentFingerprint() == fingerprint {
+      isDirty = false
+    }
     bannerMessage = nil
     conflictSnapshotId = nil
     notifyRevisionWaitersForCurrentRevision()
-    return currentInfo()
   }
 
-  public func applyExternalDiskChange() throws -> SessionInfo? {
+  /// Re-reads the file if it may have changed and adopts its content when it differs from what we
+  /// last read or wrote; nil when nothing changed. Concurrent calls share one check.
+  public func applyExternalDiskChange() async throws -> SessionInfo? {
+    if let pendingDiskCheck {
+      return try await pendingDiskCheck.value
+    }
+    let previous = lastDiskCheck
+    let check = Task {
+      _ = try? await previous?.value
+      return try await self.performPendingDiskCheck()
+    }
+    pendingDiskCheck = check
+    lastDiskCheck = check
+    return try await check.value
+  }
+
+  private func performPendingDiskCheck() async throws -> SessionInfo? {
+    pendingDiskCheck = nil
     guard let url = fileURL else { return nil }
-    // PERF: sync file read on actor
-    let diskText = try FileIO.readText(at: url)
-    let diskRev = Revision.sha256(text: diskText)
-    if diskRev == diskRevision {
+    let session = sessionId
+    let knownStamp = diskStamp
+    // Our own saves land here too (via the watcher): an unchanged stamp settles those with one
+    // `stat`, and the fingerprint settles the rest without SHA-256, including a write whose
+    // result hasn't been recorded yet.
+    let read = try await io.perform { () -> (stamp: FileStamp?, text: String)? in
+      let stamp = FileIO.stamp(at: url)
+      if let stamp, stamp == knownStamp {
+        return nil
+      }
+      return (stamp, try FileIO.readText(at: url))
+    }
+    guard sessionId == session else { return nil }
+    guard let read else {
+      if diskStampIsOwnWrite {
+        saveStats.suppressedSelfEventCount += 1
+      }
+      return nil
+    }
+    let diskText = read.text
+    let diskFP = ContentFingerprint(text: diskText)
+    if diskFP == diskFingerprint || diskFP == writingFingerprint {
+      if diskFP == diskFingerprint {
+        // Same bytes under a new stamp (touched, or rewritten identically): remember it.
+        diskStamp = read.stamp
+        diskStampIsOwnWrite = false
+      }
       return nil
     }
 
     if isDirty {
       let snap = HistorySnapshot(reason: "before_external_apply", content: content)
       history.append(snap)
-      // PERF: sync disk I/O for recovery store
-      _ = recoveryStore.appendSnapshot(snap, for: url)
+      appendRecoverySnapshot(snap, for: url)
       conflictSnapshotId = snap.id
       bannerMessage = "File changed externally. Newest version applied. You can restore your previous buffer."
     } else {
@@ -198,12 +341,41 @@ public actor EditorSession {
     }
 
     content = diskText
-    diskRevision = diskRev
+    cachedContentFingerprint = diskFP
+    diskRevision = Revision.sha256(text: diskText)
+    diskFingerprint = diskFP
+    diskStamp = read.stamp
+    diskStampIsOwnWrite = false
     isDirty = false
     notifyRevisionWaitersForCurrentRevision()
     return currentInfo()
   }
 
+  /// Queues the recovery append on `io`. It is usually one indexed journal write, but the first
+  /// append for a journal, or one whose file changed behind the store's back, reads the journal
+  /// first, and that read must not run on the actor. `snapshot` must hold the current `content`.
+  private func appendRecoverySnapshot(_ snapshot: HistorySnapshot, for url: URL) {
+    let store = recoveryStore
+    let fingerprint = contentFingerprint()
+    io.enqueue {
+      _ = store.appendSnapshot(snapshot, for: url, fingerprint: fingerprint)
+    }
+  }
+
+  private func contentFingerprint() -> ContentFingerprint {
+    if let cachedContentFingerprint {
+      return cachedContentFingerprint
+    }
+    // A bridged buffer (NSTextView hands over an NSString) would be transcoded into a fresh
+    // UTF-8 copy on every hash and save; convert it in place once.
+    if !content.isContiguousUTF8 {
+      content.makeContiguousUTF8()
+    }
+    let fingerprint = ContentFingerprint(text: content)
+    cachedContentFingerprint = fingerprint
+    return fingerprint
+  }
+
   public func restoreSnapshot(id: String) -> SessionInfo? {
     guard let url = fileURL else { return nil }
     guard let snap = history.find(id: id) else { return currentInfo() }
@@ -247,6 +419,10 @@ public actor EditorSession {
     history.stats()
   }
 
+  public func currentSaveStats() -> SessionSaveStats {
+    saveStats
+  }
+
   public func waitUntilRevisionChange(baseRevision: String, timeoutMs: Int?) async -> SessionInfo? {
     guard fileURL != nil else { return nil }
     if diskRevision != baseRevision {
@@ -1,13 +1,87 @@
 import Foundation
+import Darwin
 
 public enum FileIOError: Error {
   case notAFile
   case fileTooLarge(Int)
+  case readFailed(Int32)
   case createFailed
+  case writeFailed(Int32)
+  case renameFailed(Int32)
+}
+
+/// Time spent in each step of one `FileIO.replaceContents(of:with:)`, in nanoseconds.
+public struct AtomicWriteTimings: Sendable, Equatable {
+  /// `lstat` of the target plus `open(O_CREAT|O_EXCL)` of the temp file.
+  public var createNs: UInt64 = 0
+  public var writeNs: UInt64 = 0
+  /// `fchmod` to the target's mode, `fstat` for the stamp, and `close`.
+  public var chmodNs: UInt64 = 0
+  public var renameNs: UInt64 = 0
+  /// SHA-256 of the written text, for the returned revision.
+  public var hashNs: UInt64 = 0
+
+  public init() {}
+
+  public var totalNs: UInt64 { createNs + writeNs + chmodNs + renameNs + hashNs }
+
+  /// Per-phase milliseconds, keyed by phase name, for bench reporting.
+  public var phaseMs: [String: Double] {
+    [
+      "create": Double(createNs) / 1_000_000.0,
+      "write": Double(writeNs) / 1_000_000.0,
+      "chmod": Double(chmodNs) / 1_000_000.0,
+      "rename": Double(renameNs) / 1_000_000.0,
+      "hash": Double(hashNs) / 1_000_000.0,
+    ]
+  }
+}
+
+/// A file's identity and version as `stat` reports it. Two equal stamps mean the same inode with
+/// the same size and modification time, so its content can be assumed unchanged without reading
+/// it. `rename` leaves these alone, so a stamp taken on the temp file holds after the swap.
+public struct FileStamp: Sendable, Equatable {
+  public var device: UInt64
+  public var inode: UInt64
+  public var size: Int64
+  public var modifiedNs: Int64
+
+  init(_ st: stat) {
+    device = UInt64(bitPattern: Int64(st.st_dev))
+    inode = UInt64(st.st_ino)
+    size = Int64(st.st_size)
+    modifiedNs = Int64(st.st_mtimespec.tv_sec) * 1_000_000_000 + Int64(st.st_mtimespec.tv_nsec)
+  }
+}
+
+/// What `FileIO.replaceContents(of:with:)` wrote.
+public struct AtomicWriteResult: Sendable, Equatable {
+  public var revision: String
+  /// Stamp of the new file, taken from the open descriptor before the rename.
+  public var stamp: FileStamp?
+  public var timings: AtomicWriteTimings
 }
 
 public enum FileIO {
-  public static func readText(at url: URL, maxBytes: Int = 2 * 1024 * 1024) throws -> String {
+  /// Stamp of the file at `url` (following symlinks), or nil when it can't be `stat`ed.
+  public static func stamp(at url: URL) -> FileStamp? {
+    var st = stat()
+    guard stat(url.path, &st) == 0 else { return nil }
+    return FileStamp(st)
+  }
+
+  /// Largest file `readText` opens by default. The editor takes documents this big, but
+  /// JSON-RPC frames are capped at 5 MiB (`ContentLengthFramer`), so a response or request that
+  /// carries the content of a draft near that size (`session.open`, `getContent`, `save`) is
+  /// rejected by the peer; clients of such drafts should let the app read the file itself.
+  public static let defaultMaxReadBytes = 64 * 1024 * 1024
+  /// Files at least this big are `read` straight into the string's storage.
+  public static let directReadThreshold = 1024 * 1024
+
+  /// The file's text, decoded as UTF-8 with invalid bytes replaced by U+FFFD. Large files
+  /// (`directReadThreshold` and up) are read with `read(2)` into the new string's buffer, so the
+  /// only copy is the string itself; smaller ones, or an open that fails, go through `Data`.
+  public static func readText(at url: URL, maxBytes: Int = defaultMaxReadBytes) throws -> String {
     let values = try url.resourceValues(forKeys: [.isRegularFileKey, .fileSizeKey])
     if values.isRegularFile != true {
       throw FileIOError.notAFile
@@ -15,27 +89,140 @@ public enum FileIO {
     if let size = values.fileSize, size > maxBytes {
       throw FileIOError.fileTooLarge(size)
     }
+    if let size = values.fileSize, size >= directReadThreshold,
+       let text = try readTextDirectly(at: url, maxBytes: maxBytes) {
+      return text
+    }
     let data = try Data(contentsOf: url)
     return String(decoding: data, as: UTF8.self)
   }
 
+  /// nil when the file can't be opened; the caller's `Data` read reports why. Not a mapping:
+  /// agents and other editors rewrite these files in place, and a mapped page that a truncate
+  /// takes away is a SIGBUS. A file that shrinks mid-read yields what was read; one that grows
+  /// is read up to its size at `fstat`, and the next disk-change check sees the new stamp.
+  /// The string initializer validates and, only where needed, repairs the UTF-8.
+  private static func readTextDirectly(at url: URL, maxBytes: Int) throws -> String? {
+    let fd = open(url.path, O_RDONLY | O_CLOEXEC)
+    guard fd >= 0 else { return nil }
+    defer { close(fd) }
+    var st = stat()
+    guard fstat(fd, &st) == 0, st.st_mode & S_IFMT == S_IFREG else { return nil }
+    // Sized again from the descriptor: the file may have grown since the caller's check.
+    let size = Int(st.st_size)
+    if size > maxBytes {
+      throw FileIOError.fileTooLarge(size)
+    }
+    guard size > 0 else { return "" }
+    _ = fcntl(fd, F_RDAHEAD, 1)
+    return try String(unsafeUninitializedCapacity: size) { buffer in
+      var offset = 0
+      while offset < size {
+        let n = read(fd, buffer.baseAddress! + offset, size - offset)
+        if n < 0 {
+          if errno == EINTR { continue }
+          throw FileIOError.readFailed(errno)
+        }
+        if n == 0 { break }
+        offset += n
+      }
+      return offset
+    }
+  }
+
   @discardableResult
   public static func writeTextAtomically(_ text: String, to url: URL) throws -> String {
-    let fm = FileManager.default
-    try fm.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true)
+    try replaceContents(of: url, with: text).revision
+  }
 
-    let existingPerms: NSNumber? = (try? fm.attributesOfItem(atPath: url.path)[.posixPermissions]) as? NSNumber
-    let tmpName = ".\(url.lastPathComponent).turbodraft.tmp.\(UUID().uuidString)"
-    let tmpURL = url.deletingLastPathComponent().appendingPathComponent(tmpName)
-    let data = Data(text.utf8)
-    guard fm.createFile(atPath: tmpURL.path, contents: data) else {
-      throw FileIOError.createFailed
+  /// Replaces the file at `url` with `text`, reporting its revision, stamp and per-phase timings.
+  /// The bytes go into a fresh temp file beside the target (`open(O_CREAT|O_EXCL)`, one `write`
+  /// loop straight from the string's UTF-8 storage, `fchmod` to the target's mode), which is then
+  /// `rename`d over it, so readers see the old file or the new one, never a mix. A symlinked
+  /// target is replaced at the path it points to, leaving the link in place.
+  @discardableResult
+  public static func replaceContents(of url: URL, with text: String) throws -> AtomicWriteResult {
+    var timings = AtomicWriteTimings()
+    var t0 = DispatchTime.now().uptimeNanoseconds
+    func lap() -> UInt64 {
+      let now = DispatchTime.now().uptimeNanoseconds
+      defer { t0 = now }
+      return now - t0
+    }
+
+    var targetPath = url.path
+    var st = stat()
+    var existingMode: mode_t?
+    if lstat(targetPath, &st) == 0 {
+      if st.st_mode & S_IFMT == S_IFLNK {
+        targetPath = url.resolvingSymlinksInPath().path
+        if stat(targetPath, &st) == 0 {
+          existingMode = st.st_mode & 0o7777
+        }
+      } else {
+        existingMode = st.st_mode & 0o7777
+      }
     }
-    if let perms = existingPerms {
-      try? fm.setAttributes([.posixPermissions: perms], ofItemAtPath: tmpURL.path)
+    let dirPath = (targetPath as NSString).deletingLastPathComponent
+    let name = (targetPath as NSString).lastPathComponent
+
+    var fd: Int32 = -1
+    var tmpPath = ""
+    var createdDirectory = false
+    for _ in 0..<8 {
+      tmpPath = "\(dirPath)/.\(name).turbodraft.tmp.\(getpid()).\(arc4random())"
+      fd = open(tmpPath, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0o666)
+      if fd >= 0 { break }
+      if errno == ENOENT, !createdDirectory {
+        try FileManager.default.createDirectory(atPath: dirPath, withIntermediateDirectories: true)
+        createdDirectory = true
+      } else if errno != EEXIST {
+        break
+      }
     }
-    _ = try fm.replaceItemAt(url, withItemAt: tmpURL)
-    return Revision.sha256(text: text)
+    guard fd >= 0 else { throw FileIOError.createFailed }
+    timings.createNs = lap()
+
+    var text = text
+    let writeErrno = text.withUTF8 { bytes -> Int32 in
+      var offset = 0
+      while offset < bytes.count {
+        let n = write(fd, bytes.baseAddress! + offset, bytes.count - offset)
+        if n < 0 {
+          if errno == EINTR { continue }
+          return errno
+        }
+        offset += n
+      }
+      return 0
+    }
+    timings.writeNs = lap()
+    var stamp: FileStamp?
+    if writeErrno == 0 {
+      if let existingMode {
+        _ = fchmod(fd, existingMode)
+      }
+      var written = stat()
+      if fstat(fd, &written) == 0 {
+        stamp = FileStamp(written)
+      }
+    }
+    close(fd)
+    timings.chmodNs = lap()
+    guard writeErrno == 0 else {
+      unlink(tmpPath)
+      throw FileIOError.writeFailed(writeErrno)
+    }
+
+    guard rename(tmpPath, targetPath) == 0 else {
+      let renameErrno = errno
+      unlink(tmpPath)
+      throw FileIOError.renameFailed(renameErrno)
+    }
+    timings.renameNs = lap()
+
+    let revision = Revision.sha256(text: text)
+    timings.hashNs = lap()
+    return AtomicWriteResult(revision: revision, stamp: stamp, timings: timings)
   }
 }
-
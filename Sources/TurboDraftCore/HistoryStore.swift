@@ -24,12 +24,39 @@ public struct HistoryStoreStats: Sendable, Equatable {
   }
 }
 
+/// In-memory snapshot history, stored as periodic keyframes plus deltas from the previous
+/// snapshot (`SnapshotDelta`). `find(id:)` and `all()` rebuild content on demand.
 public struct HistoryStore: Sendable {
+  private enum Body: Sendable {
+    case keyframe(String)
+    case delta(SnapshotDelta)
+
+    var footprint: Int {
+      switch self {
+      case let .keyframe(content): return content.utf8.count
+      case let .delta(delta): return delta.footprint
+      }
+    }
+  }
+
+  private struct StoredSnapshot: Sendable {
+    var id: String
+    var createdAt: Date
+    var reason: String
+    var body: Body
+  }
+
+  /// Upper bound on deltas applied to rebuild one snapshot.
+  private static let keyframeInterval = 16
+
   private var maxCount: Int
   private var maxBytes: Int
-  private var items: [HistorySnapshot] = []
+  private var items: [StoredSnapshot] = []
   private var itemSizes: [Int] = []
   private var totalBytes: Int = 0
+  /// Content of the newest item, to dedupe against and diff the next append from.
+  private var lastContent: String?
+  private var deltasSinceKeyframe = 0
 
   public init(maxCount: Int = 32, maxBytes: Int = 2_000_000) {
     self.maxCount = maxCount
@@ -39,38 +66,90 @@ public struct HistoryStore: Sendable {
   public mutating func append(_ snapshot: HistorySnapshot) {
     // Consecutive duplicate content snapshots are memory churn and don't add
     // useful restore states.
-    if let last = items.last, last.content == snapshot.content {
+    if let lastContent, lastContent == snapshot.content {
       return
     }
 
-    let size = snapshot.content.utf8.count
-    items.append(snapshot)
+    var body = Body.keyframe(snapshot.content)
+    if let lastContent, !items.isEmpty, deltasSinceKeyframe + 1 < Self.keyframeInterval {
+      let delta = SnapshotDelta(from: lastContent, to: snapshot.content)
+      if delta.footprint < snapshot.content.utf8.count {
+        body = .delta(delta)
+      }
+    }
+    if case .delta = body {
+      deltasSinceKeyframe += 1
+    } else {
+      deltasSinceKeyframe = 0
+    }
+
+    let size = body.footprint
+    items.append(StoredSnapshot(id: snapshot.id, createdAt: snapshot.createdAt, reason: snapshot.reason, body: body))
     itemSizes.append(size)
     totalBytes += size
+    lastContent = snapshot.content
     trimToBudget()
   }
 
-  public func all() -> [HistorySnapshot] { items }
+  public func all() -> [HistorySnapshot] {
+    var content = ""
+    return items.map { item in
+      content = Self.content(of: item.body, after: content)
+      return HistorySnapshot(id: item.id, createdAt: item.createdAt, reason: item.reason, content: content)
+    }
+  }
 
   public func find(id: String) -> HistorySnapshot? {
-    items.last { $0.id == id }
+    guard let index = items.lastIndex(where: { $0.id == id }) else { return nil }
+    let item = items[index]
+    return HistorySnapshot(id: item.id, createdAt: item.createdAt, reason: item.reason, content: content(at: index))
   }
 
+  /// `totalBytes` is the stored footprint: full content for keyframes, changed bytes for deltas.
   public func stats() -> HistoryStoreStats {
     HistoryStoreStats(snapshotCount: items.count, totalBytes: totalBytes)
   }
 
+  private func content(at index: Int) -> String {
+    var start = index
+    while start > 0, case .delta = items[start].body {
+      start -= 1
+    }
+    var content = ""
+    for i in start...index {
+      content = Self.content(of: items[i].body, after: content)
+    }
+    return content
+  }
+
+  private static func content(of body: Body, after previous: String) -> String {
+    switch body {
+    case let .keyframe(content): return content
+    case let .delta(delta): return delta.apply(to: previous) ?? previous
+    }
+  }
+
+  private mutating func removeOldest() {
+    totalBytes -= itemSizes.removeFirst()
+    let removed = items.removeFirst()
+    // The new oldest item can't lean on a snapshot that's gone.
+    guard let first = items.first, case let .delta(delta) = first.body else { return }
+    let content = delta.apply(to: Self.content(of: removed.body, after: "")) ?? ""
+    items[0].body = .keyframe(content)
+    totalBytes += content.utf8.count - itemSizes[0]
+    itemSizes[0] = content.utf8.count
+    deltasSinceKeyframe = min(deltasSinceKeyframe, items.count - 1)
+  }
+
   private mutating func trimToBudget() {
     while items.count > maxCount, !items.isEmpty {
-      totalBytes -= itemSizes.removeFirst()
-      items.removeFirst()
+      removeOldest()
     }
 
     // Keep at least one snapshot even when single-entry content exceeds
     // the byte budget.
     while totalBytes > maxBytes, items.count > 1 {
-      totalBytes -= itemSizes.removeFirst()
-      items.removeFirst()
+      removeOldest()
     }
   }
 }
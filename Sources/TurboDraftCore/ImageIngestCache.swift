@@ -0,0 +1,183 @@
+import Foundation
+import ImageIO
+import UniformTypeIdentifiers
+
+/// Pasted and dropped images, turned into files sized for the agents: decoded with ImageIO,
+/// downsampled to a maximum pixel size through its thumbnail path (which decodes straight to
+/// the smaller size instead of inflating a full retina bitmap first) and re-encoded, once.
+///
+/// Files are content-addressed: named by the `ContentFingerprint` of the source bytes and the
+/// pixel size they were made for, so pasting the same screenshot again costs one hash and a
+/// `stat`. Sessions only ever reference these files, never delete them; the directory is kept
+/// under `maxCacheBytes` by dropping the least recently used. A file's modification date is its
+/// last use: ingesting it again or `markUsed` (when a session hands it to an agent or the
+/// invoking CLI) moves it forward, and nothing used within `minRetention` is deleted, even
+/// over budget, since a live session or a CLI that hasn't read its `@` references yet may
+/// still need it.
+///
+/// `ingest` blocks on decoding and I/O, so it belongs on a background queue. Safe to call from
+/// several at once.
+public final class ImageIngestCache: @unchecked Sendable {
+  public enum Source: Sendable, Equatable {
+    /// Encoded image bytes, as the pasteboard holds them (PNG, TIFF).
+    case data(Data)
+    case file(URL)
+  }
+
+  public enum IngestError: Error, Equatable {
+    case unreadable
+    case encodeFailed
+    case writeFailed
+  }
+
+  public struct Ingested: Sendable, Equatable {
+    public var url: URL
+    /// Already in the cache: nothing was decoded or written.
+    public var cacheHit: Bool
+  }
+
+  public let directory: URL
+  public let maxCacheBytes: Int
+  public let minRetention: TimeInterval
+  private let lock = NSLock()
+  /// Bytes written since the directory was last trimmed; the first write trims too.
+  private var bytesSinceTrim: Int?
+
+  public static func defaultDirectory() -> URL {
+    FileManager.default.homeDirectoryForCurrentUser
+      .appendingPathComponent("Library/Application Support/TurboDraft/images", isDirectory: true)
+  }
+
+  public init(
+    directory: URL = ImageIngestCache.defaultDirectory(),
+    maxCacheBytes: Int = 256 * 1024 * 1024,
+    minRetention: TimeInterval = 24 * 60 * 60
+  ) {
+    self.directory = directory
+    self.maxCacheBytes = max(1, maxCacheBytes)
+    self.minRetention = max(0, minRetention)
+  }
+
+  /// Records that `urls` were just handed out, so trimming keeps them for another
+  /// `minRetention`. URLs outside `directory` are ignored.
+  public func markUsed(_ urls: [URL]) {
+    let prefix = directory.standardizedFileURL.path + "/"
+    let now = Date()
+    for url in urls where url.standardizedFileURL.path.hasPrefix(prefix) {
+      try? FileManager.default.setAttributes([.modificationDate: now], ofItemAtPath: url.path)
+    }
+  }
+
+  /// A file for `source` whose longer side is at most `maxPixelSize` pixels (0: original size).
+  /// PNG and JPEG sources that are already small enough are stored byte for byte; anything else
+  /// is re-encoded, as JPEG when the source was JPEG and PNG otherwise.
+  public func ingest(_ source: Source, maxPixelSize: Int) throws -> Ingested {
+    let data: Data
+    switch source {
+    case let .data(bytes):
+      data = bytes
+    case let .file(url):
+      guard let bytes = try? Data(contentsOf: url, options: .mappedIfSafe) else { throw IngestError.unreadable }
+      data = bytes
+    }
+    let maxPixelSize = max(0, maxPixelSize)
+    let fingerprint = data.withUnsafeBytes { ContentFingerprint(bytes: $0) }
+    let key = Revision.hex(fingerprint.high) + Revision.hex(fingerprint.low) + "-\(maxPixelSize)"
+
+    for ext in ["png", "jpg"] {
+      let url = directory.appendingPathComponent("\(key).\(ext)")
+      if FileManager.default.fileExists(atPath: url.path) {
+        markUsed([url])
+        return Ingested(url: url, cacheHit: true)
+      }
+    }
+
+    let (encoded, ext) = try Self.encode(data, maxPixelSize: maxPixelSize)
+    try? FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    let url = directory.appendingPathComponent("\(key).\(ext)")
+    do {
+      try encoded.write(to: url, options: [.atomic])
+    } catch {
+      throw IngestError.writeFailed
+    }
+    noteWritten(encoded.count)
+    return Ingested(url: url, cacheHit: false)
+  }
+
+  private static func encode(_ data: Data, maxPixelSize: Int) throws -> (Data, String) {
+    guard let source = CGImageSourceCreateWithData(data as CFData, nil), CGImageSourceGetCount(source) > 0 else {
+      throw IngestError.unreadable
+    }
+    let properties = CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [CFString: Any] ?? [:]
+    let width = properties[kCGImagePropertyPixelWidth] as? Int ?? 0
+    let height = properties[kCGImagePropertyPixelHeight] as? Int ?? 0
+    let orientation = properties[kCGImagePropertyOrientation] as? Int ?? 1
+    let sourceType = CGImageSourceGetType(source) as String?
+    let isJPEG = sourceType == UTType.jpeg.identifier
+    let needsResize = maxPixelSize > 0 && max(width, height) > maxPixelSize
+
+    if !needsResize, orientation == 1, width > 0, height > 0, isJPEG || sourceType == UTType.png.identifier {
+      return (data, isJPEG ? "jpg" : "png")
+    }
+
+    var options: [CFString: Any] = [
+      kCGImageSourceCreateThumbnailFromImageAlways: true,
+      // Applies EXIF orientation, so the pixels come out upright and the tag can be dropped.
+      kCGImageSourceCreateThumbnailWithTransform: true,
+      kCGImageSourceShouldCacheImmediately: true,
+    ]
+    let targetSize = needsResize ? maxPixelSize : max(width, height)
+    if targetSize > 0 {
+      options[kCGImageSourceThumbnailMaxPixelSize] = targetSize
+    }
+    guard let image = CGImageSourceCreateThumbnailAtIndex(source, 0, options as CFDictionary) else {
+      throw IngestError.unreadable
+    }
+
+    let out = NSMutableData()
+    let type = isJPEG ? UTType.jpeg : UTType.png
+    guard let destination = CGImageDestinationCreateWithData(out as CFMutableData, type.identifier as CFString, 1, nil) else {
+      throw IngestError.encodeFailed
+    }
+    let destinationProperties: [CFString: Any] = isJPEG ? [kCGImageDestinationLossyCompressionQuality: 0.9] : [:]
+    CGImageDestinationAddImage(destination, image, destinationProperties as CFDictionary)
+    guard CGImageDestinationFinalize(destination) else { throw IngestError.encodeFailed }
+    return (out as Data, isJPEG ? "jpg" : "png")
+  }
+
+  private func noteWritten(_ bytes: Int) {
+    lock.lock()
+    defer { lock.unlock() }
+    let pending = (bytesSinceTrim ?? maxCacheBytes) + bytes
+    // Trimming lists the directory; once per eighth of the budget is plenty.
+    guard pending >= maxCacheBytes / 8 else {
+      bytesSinceTrim = pending
+      return
+    }
+    bytesSinceTrim = 0
+    trim()
+  }
+
+  /// Deletes the least recently used files until the directory fits `maxCacheBytes`, sparing
+  /// any used within `minRetention`. Caller holds `lock`.
+  private func trim() {
+    let keys: [URLResourceKey] = [.isRegularFileKey, .fileSizeKey, .contentModificationDateKey]
+    guard let urls = try? FileManager.default.contentsOfDirectory(
+      at: directory,
+      includingPropertiesForKeys: keys,
+      options: [.skipsHiddenFiles]
+    ) else { return }
+    let files = urls.compactMap { url -> (url: URL, bytes: Int, used: Date)? in
+      guard let values = try? url.resourceValues(forKeys: Set(keys)), values.isRegularFile == true else { return nil }
+      return (url, values.fileSize ?? 0, values.contentModificationDate ?? .distantPast)
+    }
+    let retainedSince = Date(timeIntervalSinceNow: -minRetention)
+    var total = 0
+    for file in files.sorted(by: { $0.used > $1.used }) {
+      total += file.bytes
+      if total > maxCacheBytes, file.used < retainedSince {
+        try? FileManager.default.removeItem(at: file.url)
+      }
+    }
+  }
+}
@@ -0,0 +1,130 @@
+import Foundation
+import TurboDraftProtocol
+
+/// Spans of one traced `session.open` (see `SessionOpenParams.traceId`). Times are on the
+/// `DispatchTime` uptime clock, the one `turbodraft --trace` stamps its own spans with, so the
+/// launcher's and the app's spans share a timeline.
+///
+/// The open path binds the trace to `current` so code below it can add spans without an extra
+/// parameter; work hopped onto a dispatch queue has to capture `current` first. With nothing
+/// bound, `OpenTrace.current?.add` costs one task-local lookup.
+public final class OpenTrace: @unchecked Sendable {
+  @TaskLocal public static var current: OpenTrace?
+
+  public let id: String
+  private let lock = NSLock()
+  private var spans: [TraceSpan] = []
+  private var _sessionId: String?
+
+  /// The session the traced open ended up on, once it is known.
+  public var sessionId: String? {
+    get {
+      lock.lock()
+      defer { lock.unlock() }
+      return _sessionId
+    }
+    set {
+      lock.lock()
+      _sessionId = newValue
+      lock.unlock()
+    }
+  }
+
+  public init(id: String) {
+    self.id = id
+  }
+
+  public static func nowMs() -> Double {
+    Double(DispatchTime.now().uptimeNanoseconds) / 1_000_000
+  }
+
+  public static func ms(fromUptimeNs ns: UInt64) -> Double {
+    Double(ns) / 1_000_000
+  }
+
+  public func add(_ name: String, startMs: Double, endMs: Double = OpenTrace.nowMs()) {
+    lock.lock()
+    spans.append(TraceSpan(name: name, startMs: startMs, endMs: endMs))
+    lock.unlock()
+  }
+
+  public func add(_ more: [TraceSpan]) {
+    lock.lock()
+    spans.append(contentsOf: more)
+    lock.unlock()
+  }
+
+  public func contains(_ name: String) -> Bool {
+    lock.lock()
+    defer { lock.unlock() }
+    return spans.contains { $0.name == name }
+  }
+
+  /// Spans ordered by start, outer spans before the ones they contain.
+  public func snapshot() -> [TraceSpan] {
+    lock.lock()
+    defer { lock.unlock() }
+    return spans.sorted { ($0.startMs, -$0.endMs) < ($1.startMs, -$1.endMs) }
+  }
+}
+
+/// Per-span statistics over many traced opens, for `bench trace`: how long each span took
+/// (p50/p95) and where it sits in the open (median start from the trace's first span, and how
+/// deeply it nests in the spans around it).
+public struct OpenTraceSummary: Sendable, Equatable {
+  public struct Row: Sendable, Equatable {
+    public var name: String
+    /// Spans enclosing this one, in most traces.
+    public var depth: Int
+    public var count: Int
+    public var offsetP50Ms: Double
+    public var durationP50Ms: Double
+    public var durationP95Ms: Double
+  }
+
+  public var traceCount: Int
+  /// Timeline order; at equal offsets an enclosing span comes first.
+  public var rows: [Row]
+
+  public init(traces: [[TraceSpan]]) {
+    var offsets: [String: [Double]] = [:]
+    var durations: [String: [Double]] = [:]
+    var depthVotes: [String: [Int: Int]] = [:]
+    for spans in traces {
+      guard let origin = spans.map(\.startMs).min() else { continue }
+      var enclosing: [TraceSpan] = []
+      for span in spans.sorted(by: { ($0.startMs, -$0.endMs) < ($1.startMs, -$1.endMs) }) {
+        while let last = enclosing.last, !(last.startMs <= span.startMs && span.endMs <= last.endMs) {
+          enclosing.removeLast()
+        }
+        depthVotes[span.name, default: [:]][enclosing.count, default: 0] += 1
+        enclosing.append(span)
+        offsets[span.name, default: []].append(span.startMs - origin)
+        durations[span.name, default: []].append(span.durationMs)
+      }
+    }
+    traceCount = traces.count
+    rows = offsets.keys.map { name in
+      let votes = depthVotes[name] ?? [:]
+      let depth = votes.max { ($0.value, -$0.key) < ($1.value, -$1.key) }?.key ?? 0
+      let spanDurations = durations[name] ?? []
+      return Row(
+        name: name,
+        depth: depth,
+        count: spanDurations.count,
+        offsetP50Ms: Self.percentile(offsets[name] ?? [], 0.50),
+        durationP50Ms: Self.percentile(spanDurations, 0.50),
+        durationP95Ms: Self.percentile(spanDurations, 0.95)
+      )
+    }
+    .sorted { ($0.offsetP50Ms, $0.depth, $0.name) < ($1.offsetP50Ms, $1.depth, $1.name) }
+  }
+
+  /// Nearest-rank, as `bench run` reports.
+  static func percentile(_ samples: [Double], _ p: Double) -> Double {
+    guard !samples.isEmpty else { return 0 }
+    let sorted = samples.sorted()
+    let idx = Int((Double(sorted.count) * p).rounded(.up)) - 1
+    return sorted[max(0, min(idx, sorted.count - 1))]
+  }
+}
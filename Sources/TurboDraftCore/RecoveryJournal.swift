@@ -0,0 +1,186 @@
+import Foundation
+
+/// On-disk layout of a per-file recovery journal: a 4-byte magic followed by length-prefixed
+/// records, appended oldest first.
+///
+///     record  := u32 payloadLength, payload
+///     payload := f64 createdAt, u16 idLength, id, u16 reasonLength, reason,
+///                u8 hashLength, contentHash, body
+///     body    := 0x00, content                                   (keyframe)
+///              | 0x01, u32 prefixLength, u32 suffixLength, inserted   (delta)
+///
+/// Integers are little-endian and text is UTF-8; `content`/`inserted` run to the end of the
+/// payload. A delta applies to the content of the record before it (`SnapshotDelta`). A crash
+/// mid-append leaves a short final record, which `scan` stops in front of.
+enum RecoveryJournal {
+  static let magic: [UInt8] = Array("TDJ2".utf8)
+
+  /// A record's position and metadata, read without decoding its content.
+  struct Entry: Sendable {
+    /// Offset of the record's length prefix.
+    var offset: Int
+    /// Length prefix + payload.
+    var length: Int
+    var id: String
+    var createdAt: Date
+    var contentHash: String
+    var isKeyframe: Bool
+    /// Body bytes: the full content for a keyframe, the delta for a delta.
+    var storedBytes: Int
+  }
+
+  struct Scan {
+    var entries: [Entry]
+    /// End of the last complete record; shorter than the data when the tail is torn.
+    var validLength: Int
+  }
+
+  /// Encodes `snapshot` as a keyframe, or as `delta` from the previous record when given.
+  static func encode(_ snapshot: HistorySnapshot, contentHash: String, delta: SnapshotDelta? = nil) -> Data {
+    let id = Array(snapshot.id.utf8.prefix(Int(UInt16.max)))
+    let reason = Array(snapshot.reason.utf8.prefix(Int(UInt16.max)))
+    let hash = Array(contentHash.utf8.prefix(Int(UInt8.max)))
+    let body = delta?.inserted ?? Array(snapshot.content.utf8)
+    let bodyHeader = delta == nil ? 1 : 1 + 8
+    let payloadLength = 8 + 2 + id.count + 2 + reason.count + 1 + hash.count + bodyHeader + body.count
+
+    var out = [UInt8]()
+    out.reserveCapacity(4 + payloadLength)
+    appendLittleEndian(UInt32(truncatingIfNeeded: payloadLength), to: &out)
+    appendLittleEndian(snapshot.createdAt.timeIntervalSince1970.bitPattern, to: &out)
+    appendLittleEndian(UInt16(id.count), to: &out)
+    out.append(contentsOf: id)
+    appendLittleEndian(UInt16(reason.count), to: &out)
+    out.append(contentsOf: reason)
+    out.append(UInt8(hash.count))
+    out.append(contentsOf: hash)
+    if let delta {
+      out.append(1)
+      appendLittleEndian(UInt32(truncatingIfNeeded: delta.prefixLength), to: &out)
+      appendLittleEndian(UInt32(truncatingIfNeeded: delta.suffixLength), to: &out)
+    } else {
+      out.append(0)
+    }
+    out.append(contentsOf: body)
+    return Data(out)
+  }
+
+  /// Indexes the complete records in `data`. Returns nil when `data` is not a journal.
+  static func scan(_ data: Data) -> Scan? {
+    data.withUnsafeBytes { (raw: UnsafeRawBufferPointer) -> Scan? in
+      guard raw.count >= magic.count, raw.prefix(magic.count).elementsEqual(magic) else {
+        return nil
+      }
+      var entries: [Entry] = []
+      var offset = magic.count
+      while let entry = readEntry(raw, at: offset) {
+        entries.append(entry)
+        offset += entry.length
+      }
+      return Scan(entries: entries, validLength: offset)
+    }
+  }
+
+  /// Decodes the records at `wanted` (ascending indices into `entries`, scanned from `data`),
+  /// replaying deltas from the nearest keyframe before the first one. Undecodable records are nil.
+  static func snapshots(_ wanted: [Int], of entries: [Entry], in data: Data) -> [HistorySnapshot?] {
+    guard let first = wanted.first, let last = wanted.last else { return [] }
+    return data.withUnsafeBytes { (raw: UnsafeRawBufferPointer) -> [HistorySnapshot?] in
+      var start = first
+      while start > 0, !entries[start].isKeyframe {
+        start -= 1
+      }
+      var out: [HistorySnapshot?] = []
+      out.reserveCapacity(wanted.count)
+      var next = wanted.startIndex
+      var content: String?
+      for index in start...last {
+        content = self.content(of: entries[index], in: raw, after: content)
+        guard index == wanted[next] else { continue }
+        let entry = entries[index]
+        out.append(content.map {
+          HistorySnapshot(id: entry.id, createdAt: entry.createdAt, reason: reason(of: entry, in: raw), content: $0)
+        })
+        next += 1
+      }
+      return out
+    }
+  }
+
+  private static func content(of entry: Entry, in raw: UnsafeRawBufferPointer, after previous: String?) -> String? {
+    let end = entry.offset + entry.length
+    guard end <= raw.count else { return nil }
+    let body = UnsafeRawBufferPointer(rebasing: raw[(end - entry.storedBytes)..<end])
+    if entry.isKeyframe {
+      return String(decoding: body.dropFirst(), as: UTF8.self)
+    }
+    guard let previous, body.count >= 9 else { return nil }
+    let delta = SnapshotDelta(
+      prefixLength: Int(readUInt32(body, at: 1)),
+      suffixLength: Int(readUInt32(body, at: 5)),
+      inserted: Array(body.dropFirst(9))
+    )
+    return delta.apply(to: previous)
+  }
+
+  private static func reason(of entry: Entry, in raw: UnsafeRawBufferPointer) -> String {
+    var cursor = entry.offset + 4 + 8
+    cursor += 2 + Int(readUInt16(raw, at: cursor))
+    let reasonLength = Int(readUInt16(raw, at: cursor))
+    return String(decoding: UnsafeRawBufferPointer(rebasing: raw[(cursor + 2)..<(cursor + 2 + reasonLength)]), as: UTF8.self)
+  }
+
+  private static func readEntry(_ raw: UnsafeRawBufferPointer, at offset: Int) -> Entry? {
+    guard offset + 4 <= raw.count else { return nil }
+    let payloadLength = Int(readUInt32(raw, at: offset))
+    let end = offset + 4 + payloadLength
+    guard end <= raw.count else { return nil }
+
+    var cursor = offset + 4
+    guard cursor + 8 + 2 <= end else { return nil }
+    let createdAt = Date(timeIntervalSince1970: Double(bitPattern: readUInt64(raw, at: cursor)))
+    cursor += 8
+    let idLength = Int(readUInt16(raw, at: cursor))
+    cursor += 2
+    guard cursor + idLength + 2 <= end else { return nil }
+    let id = String(decoding: UnsafeRawBufferPointer(rebasing: raw[cursor..<(cursor + idLength)]), as: UTF8.self)
+    cursor += idLength
+    let reasonLength = Int(readUInt16(raw, at: cursor))
+    cursor += 2 + reasonLength
+    guard cursor + 1 <= end else { return nil }
+    let hashLength = Int(raw[cursor])
+    cursor += 1
+    guard cursor + hashLength <= end else { return nil }
+    let hash = String(decoding: UnsafeRawBufferPointer(rebasing: raw[cursor..<(cursor + hashLength)]), as: UTF8.self)
+    cursor += hashLength
+    guard cursor + 1 <= end else { return nil }
+    let isKeyframe = raw[cursor] == 0
+    guard isKeyframe || cursor + 9 <= end else { return nil }
+
+    return Entry(
+      offset: offset,
+      length: end - offset,
+      id: id,
+      createdAt: createdAt,
+      contentHash: hash,
+      isKeyframe: isKeyframe,
+      storedBytes: end - cursor
+    )
+  }
+
+  private static func appendLittleEndian<T: FixedWidthInteger>(_ value: T, to out: inout [UInt8]) {
+    withUnsafeBytes(of: value.littleEndian) { out.append(contentsOf: $0) }
+  }
+
+  private static func readUInt16(_ raw: UnsafeRawBufferPointer, at offset: Int) -> UInt16 {
+    UInt16(raw[offset]) | UInt16(raw[offset + 1]) << 8
+  }
+
+  private static func readUInt32(_ raw: UnsafeRawBufferPointer, at offset: Int) -> UInt32 {
+    (0..<4).reduce(UInt32(0)) { $0 | UInt32(raw[offset + $1]) << (8 * UInt32($1)) }
+  }
+
+  private static func readUInt64(_ raw: UnsafeRawBufferPointer, at offset: Int) -> UInt64 {
+    (0..<8).reduce(UInt64(0)) { $0 | UInt64(raw[offset + $1]) << (8 * UInt64($1)) }
+  }
+}
@@ -1,7 +1,17 @@
 import Foundation
+import Darwin
 
+/// Per-file recovery snapshots, persisted as append-only journals (`RecoveryJournal`).
+///
+/// An append costs one `write` of the new record, queued on a background queue; consecutive
+/// duplicates are skipped by content hash, and a record is a delta from the previous one
+/// (`SnapshotDelta`) with a full keyframe at least every `keyframeInterval` records. The
+/// TTL/count/byte budgets (bytes as stored) are applied to what loads return straight away, while
+/// the records they drop are reclaimed by a background compaction once enough of them accumulate
+/// (or on the next load).
 public final class RecoveryStore: @unchecked Sendable {
-  private struct StoredSnapshot: Codable, Sendable {
+  /// Pre-journal on-disk format (`<key>.json`), migrated on first use.
+  private struct LegacySnapshot: Codable, Sendable {
     var id: String
     var createdAt: Date
     var reason: String
@@ -9,141 +19,400 @@ public final class RecoveryStore: @unchecked Sendable {
     var contentHash: String
   }
 
+  /// Index of one journal as it will be on disk once `writeQueue` drains.
+  private struct Journal {
+    var entries: [RecoveryJournal.Entry] = []
+    var length = 0
+    /// Content of the last record when known, so the next append can be a delta.
+    var lastContent: String?
+  }
+
+  /// Upper bound on deltas replayed to rebuild one snapshot.
+  private static let keyframeInterval = 16
+
   private let ioLock = NSLock()
   private let writeQueue = DispatchQueue(label: "com.turbodraft.recovery.write")
   private let maxSnapshotsPerFile: Int
   private let maxBytesPerFile: Int
   private let ttlDays: Int
   private let maxSnapshotBytes: Int
+  private let directory: URL?
+
+  /// Guarded by `ioLock`, keyed by journal path.
+  private var journals: [String: Journal] = [:]
+  /// Journals whose on-disk bytes stopped matching their index (changed behind our back); set by
+  /// `writeQueue`, so guarded by its own lock.
+  private let staleLock = NSLock()
+  private var stalePaths: Set<String> = []
 
   public init(
     maxSnapshotsPerFile: Int = 256,
     maxBytesPerFile: Int = 1_500_000,
     ttlDays: Int = 14,
-    maxSnapshotBytes: Int = 512_000
+    maxSnapshotBytes: Int = 512_000,
+    directory: URL? = nil
   ) {
     self.maxSnapshotsPerFile = max(16, maxSnapshotsPerFile)
     self.maxBytesPerFile = max(256_000, maxBytesPerFile)
     self.ttlDays = max(1, ttlDays)
     self.maxSnapshotBytes = max(8_192, maxSnapshotBytes)
+    self.directory = directory
   }
 
   public func loadSnapshots(for fileURL: URL, maxCount: Int = 64) -> [HistorySnapshot] {
     ioLock.lock()
     defer { ioLock.unlock() }
 
-    let path = normalizedPath(for: fileURL)
-    let file = snapshotsFileURL(forPath: path)
-    var items = readStoredSnapshots(from: file)
-    prune(&items)
-    writeStoredSnapshots(items, to: file)
-
-    return items.suffix(max(1, maxCount)).map {
-      HistorySnapshot(id: $0.id, createdAt: $0.createdAt, reason: $0.reason, content: $0.content)
+    let file = journalFileURL(for: fileURL)
+    let (journal, loaded) = load(file, for: fileURL, maxCount: maxCount)
+    journals[file.path] = journal
+    if reclaimableCount(of: journal.entries) > 0 {
+      compact(file)
     }
+    return loaded
   }
 
+  /// `fingerprint` is the content's `ContentFingerprint` when the caller already has it.
   @discardableResult
-  public func appendSnapshot(_ snapshot: HistorySnapshot, for fileURL: URL) -> String {
-    let bytes = snapshot.content.utf8.count
-    guard bytes <= maxSnapshotBytes else {
+  public func appendSnapshot(_ snapshot: HistorySnapshot, for fileURL: URL, fingerprint: ContentFingerprint? = nil) -> String {
+    guard !exceedsSnapshotLimit(snapshot.content) else {
       return snapshot.id
     }
 
     ioLock.lock()
     defer { ioLock.unlock() }
 
-    let path = normalizedPath(for: fileURL)
-    let file = snapshotsFileURL(forPath: path)
-    var items = readStoredSnapshots(from: file)
-    prune(&items)
+    let file = journalFileURL(for: fileURL)
+    let journal = cachedJournal(at: file, for: fileURL)
+    return append(snapshot, to: file, journal: journal, fingerprint: fingerprint)
+  }
 
-    let contentHash = Revision.sha256(text: snapshot.content)
-    if let last = items.last, last.contentHash == contentHash {
-      return last.id
-    }
+  /// Combined load + append in a single pass over the journal.
+  /// Eliminates the double read that `loadSnapshots` + `appendSnapshot` would perform.
+  /// The append is written on a background queue, like every journal write.
+  public func loadAndAppend(
+    for fileURL: URL,
+    snapshot: HistorySnapshot,
+    fingerprint: ContentFingerprint? = nil,
+    loadMaxCount: Int = 64
+  ) -> [HistorySnapshot] {
+    ioLock.lock()
+    defer { ioLock.unlock() }
 
-    items.append(
-      StoredSnapshot(
-        id: snapshot.id,
-        createdAt: snapshot.createdAt,
-        reason: snapshot.reason,
-        content: snapshot.content,
-        contentHash: contentHash
-      )
-    )
+    let file = journalFileURL(for: fileURL)
+    // Capture load result before appending
+    let (journal, loaded) = load(file, for: fileURL, maxCount: loadMaxCount)
+    journals[file.path] = journal
 
-    prune(&items)
-    writeStoredSnapshots(items, to: file)
-    return snapshot.id
+    if !exceedsSnapshotLimit(snapshot.content) {
+      append(snapshot, to: file, journal: journal, fingerprint: fingerprint)
+    } else if reclaimableCount(of: journal.entries) > 0 {
+      compact(file)
+    }
+    return loaded
   }
 
-  /// Combined load + append in a single read-compute-write cycle.
-  /// Eliminates the double read/write that `loadSnapshots` + `appendSnapshot` would perform.
-  /// The write is dispatched to a background queue (Tier 3).
-  public func loadAndAppend(for fileURL: URL, snapshot: HistorySnapshot, loadMaxCount: Int = 64) -> [HistorySnapshot] {
+  /// Deletes journals (and legacy JSON files) not written for `ttlDays`: every record in them
+  /// has expired, and nothing else would reclaim them, since a journal is only loaded and
+  /// compacted when its file is opened again. For sessions that never closed cleanly, or files
+  /// that were moved or deleted. Blocks on directory I/O; the app runs it once at launch, off
+  /// the main thread. Returns how many files were removed.
+  @discardableResult
+  public func removeExpiredJournals() -> Int {
+    let dir = recoveryDirURL()
+    let keys: [URLResourceKey] = [.isRegularFileKey, .contentModificationDateKey]
+    guard let urls = try? FileManager.default.contentsOfDirectory(
+      at: dir,
+      includingPropertiesForKeys: keys,
+      options: [.skipsHiddenFiles]
+    ) else { return 0 }
+    let cutoff = Date().addingTimeInterval(TimeInterval(-ttlDays * 24 * 60 * 60))
+
     ioLock.lock()
     defer { ioLock.unlock() }
-
-    let path = normalizedPath(for: fileURL)
-    let file = snapshotsFileURL(forPath: path)
-    var items = readStoredSnapshots(from: file)
-    prune(&items)
-
-    // Capture load result before appending
-    let loaded = items.suffix(max(1, loadMaxCount)).map {
-      HistorySnapshot(id: $0.id, createdAt: $0.createdAt, reason: $0.reason, content: $0.content)
-    }
-
-    // Append (with dedup + size guard)
-    let bytes = snapshot.content.utf8.count
-    if bytes <= maxSnapshotBytes {
-      let contentHash = Revision.sha256(text: snapshot.content)
-      if items.last?.contentHash != contentHash {
-        items.append(StoredSnapshot(
-          id: snapshot.id,
-          createdAt: snapshot.createdAt,
-          reason: snapshot.reason,
-          content: snapshot.content,
-          contentHash: contentHash
-        ))
-        prune(&items)
+    writeQueue.sync {}
+    var removed = 0
+    for url in urls where url.pathExtension == "journal" || url.pathExtension == "json" {
+      guard let values = try? url.resourceValues(forKeys: Set(keys)), values.isRegularFile == true,
+            let modified = values.contentModificationDate, modified < cutoff
+      else { continue }
+      if (try? FileManager.default.removeItem(at: url)) != nil {
+        journals.removeValue(forKey: url.path)
+        removed += 1
       }
     }
+    return removed
+  }
 
-    writeStoredSnapshotsAsync(items, to: file)
-    return loaded
+  /// Whether `text` is over `maxSnapshotBytes`, transcoding it only when nothing cheaper can
+  /// tell: a native string knows its UTF-8 length, and the editor's buffers (bridged from the
+  /// text storage) know their UTF-16 length, which bounds it at one to three bytes per unit.
+  private func exceedsSnapshotLimit(_ text: String) -> Bool {
+    if let bytes = text.utf8.withContiguousStorageIfAvailable({ $0.count }) {
+      return bytes > maxSnapshotBytes
+    }
+    let units = (text as NSString).length
+    if units > maxSnapshotBytes { return true }
+    if units * 3 <= maxSnapshotBytes { return false }
+    return text.utf8.count > maxSnapshotBytes
   }
 
   private func normalizedPath(for fileURL: URL) -> String {
     fileURL.standardizedFileURL.path
   }
 
-  private func prune(_ items: inout [StoredSnapshot]) {
-    guard !items.isEmpty else { return }
+  /// Reads `file` and decodes its newest `maxCount` live snapshots, plus the last record's content
+  /// for the next delta. Caller holds `ioLock`.
+  private func load(_ file: URL, for fileURL: URL, maxCount: Int) -> (Journal, [HistorySnapshot]) {
+    let (read, data) = readJournal(at: file, for: fileURL)
+    var journal = read
+    guard let data, !journal.entries.isEmpty else { return (journal, []) }
+
+    var wanted = Array(survivingIndices(of: journal.entries).suffix(max(1, maxCount)))
+    let lastIndex = journal.entries.count - 1
+    let wantsTail = wanted.last != lastIndex
+    if wantsTail {
+      wanted.append(lastIndex)
+    }
+    var decoded = RecoveryJournal.snapshots(wanted, of: journal.entries, in: data)
+    journal.lastContent = wantsTail ? decoded.removeLast()?.content : decoded.last??.content
+    return (journal, decoded.compactMap { $0 })
+  }
+
+  /// Appends `snapshot` unless it repeats the newest live record. Caller holds `ioLock` and has
+  /// cached `journal` for `file`.
+  @discardableResult
+  private func append(_ snapshot: HistorySnapshot, to file: URL, journal: Journal, fingerprint: ContentFingerprint?) -> String {
+    var journal = journal
+    let kept = survivingIndices(of: journal.entries)
+    let contentHash = (fingerprint ?? ContentFingerprint(text: snapshot.content)).description
+    if let last = kept.last, journal.entries[last].contentHash == contentHash {
+      return journal.entries[last].id
+    }
+
+    var delta: SnapshotDelta?
+    if let lastContent = journal.lastContent, !journal.entries.isEmpty,
+       deltasSinceKeyframe(in: journal.entries) + 1 < Self.keyframeInterval {
+      let candidate = SnapshotDelta(from: lastContent, to: snapshot.content)
+      if candidate.footprint < snapshot.content.utf8.count {
+        delta = candidate
+      }
+    }
+    let record = RecoveryJournal.encode(snapshot, contentHash: contentHash, delta: delta)
+    let isNewJournal = journal.length == 0
+    if isNewJournal {
+      journal.length = RecoveryJournal.magic.count
+    }
+    journal.entries.append(RecoveryJournal.Entry(
+      offset: journal.length,
+      length: record.count,
+      id: snapshot.id,
+      createdAt: snapshot.createdAt,
+      contentHash: contentHash,
+      isKeyframe: delta == nil,
+      storedBytes: 1 + (delta.map { $0.footprint } ?? snapshot.content.utf8.count)
+    ))
+    journal.length += record.count
+    journal.lastContent = snapshot.content
+    journals[file.path] = journal
+
+    let path = file.path
+    let bytes = isNewJournal ? Data(RecoveryJournal.magic) + record : record
+    let expectedEnd = journal.length
+    writeQueue.async { [weak self] in
+      if !Self.appendBytes(bytes, toPath: path, expectedEnd: expectedEnd) {
+        self?.markStale(path)
+      }
+    }
+
+    let reclaimable = reclaimableCount(of: journal.entries)
+    let reclaimableBytes = journal.entries.prefix(reclaimable).reduce(0) { $0 + $1.storedBytes }
+    if reclaimable >= maxSnapshotsPerFile / 4 || reclaimableBytes >= maxBytesPerFile / 4 {
+      compact(file)
+    }
+    return snapshot.id
+  }
+
+  private func deltasSinceKeyframe(in entries: [RecoveryJournal.Entry]) -> Int {
+    entries.count - 1 - (entries.lastIndex { $0.isKeyframe } ?? -1)
+  }
+
+  /// How many leading records compaction can drop: everything before the keyframe that the oldest
+  /// live record's delta chain starts from (all of them when nothing is live).
+  private func reclaimableCount(of entries: [RecoveryJournal.Entry]) -> Int {
+    guard var cut = survivingIndices(of: entries).first else { return entries.count }
+    while cut > 0, !entries[cut].isKeyframe {
+      cut -= 1
+    }
+    return cut
+  }
+
+  /// Indices of the entries that survive the TTL, count and byte budgets, oldest first.
+  private func survivingIndices(of entries: [RecoveryJournal.Entry]) -> [Int] {
+    guard !entries.isEmpty else { return [] }
 
     let cutoff = Date().addingTimeInterval(TimeInterval(-ttlDays * 24 * 60 * 60))
-    items.removeAll { $0.createdAt < cutoff }
+    var kept = entries.indices.filter { entries[$0].createdAt >= cutoff }
 
-    if items.count > maxSnapshotsPerFile {
-      items.removeFirst(items.count - maxSnapshotsPerFile)
+    if kept.count > maxSnapshotsPerFile {
+      kept.removeFirst(kept.count - maxSnapshotsPerFile)
     }
 
-    var bytes = items.reduce(0) { $0 + $1.content.utf8.count }
-    while bytes > maxBytesPerFile, !items.isEmpty {
-      bytes -= items[0].content.utf8.count
-      items.removeFirst()
+    var bytes = kept.reduce(0) { $0 + entries[$1].storedBytes }
+    var drop = 0
+    while bytes > maxBytesPerFile, drop < kept.count {
+      bytes -= entries[kept[drop]].storedBytes
+      drop += 1
     }
+    kept.removeFirst(drop)
+    return kept
   }
 
-  private func snapshotsFileURL(forPath path: String) -> URL {
-    let key = Revision.sha256(text: path).replacingOccurrences(of: "sha256:", with: "")
-    let dir = recoveryDirURL()
-    return dir.appendingPathComponent("\(key).json", isDirectory: false)
+  /// Rewrites `file` without its reclaimable leading records, on `writeQueue`. The index is updated
+  /// now so appends queued behind the compaction land at the right offsets. Records between the
+  /// cut and the oldest live one stay on disk as its delta base; budgets keep them out of loads.
+  /// Caller holds `ioLock`.
+  private func compact(_ file: URL) {
+    guard var journal = journals[file.path] else { return }
+    let cut = reclaimableCount(of: journal.entries)
+    guard cut > 0 else { return }
+
+    let expectedLength = journal.length
+    let tailStart = cut < journal.entries.count ? journal.entries[cut].offset : expectedLength
+    let shift = tailStart - RecoveryJournal.magic.count
+    journal.entries.removeFirst(cut)
+    for i in journal.entries.indices {
+      journal.entries[i].offset -= shift
+    }
+    if journal.entries.isEmpty {
+      journal = Journal()
+    } else {
+      journal.length -= shift
+    }
+    journals[file.path] = journal
+
+    writeQueue.async { [weak self] in
+      guard let data = try? Data(contentsOf: file, options: .alwaysMapped),
+            data.count == expectedLength
+      else {
+        self?.markStale(file.path)
+        return
+      }
+      guard tailStart < expectedLength else {
+        try? FileManager.default.removeItem(at: file)
+        return
+      }
+      var out = Data(RecoveryJournal.magic)
+      out.reserveCapacity(expectedLength - shift)
+      out.append(data.subdata(in: tailStart..<expectedLength))
+      do {
+        try out.write(to: file, options: [.atomic])
+      } catch {
+        self?.markStale(file.path)
+      }
+    }
+  }
+
+  /// The cached index for `file`, reading the journal if there is none (or it went stale).
+  /// Caller holds `ioLock`.
+  private func cachedJournal(at file: URL, for fileURL: URL) -> Journal {
+    if !takeStale(file.path), let journal = journals[file.path] {
+      return journal
+    }
+    let (journal, _) = readJournal(at: file, for: fileURL)
+    journals[file.path] = journal
+    return journal
+  }
+
+  /// Reads and indexes `file` after pending writes land, migrating a legacy JSON file and
+  /// queueing removal of a torn tail. Caller holds `ioLock`.
+  private func readJournal(at file: URL, for fileURL: URL) -> (Journal, Data?) {
+    writeQueue.sync {}  // Drain pending background writes before reading
+    _ = takeStale(file.path)
+
+    guard let data = (try? Data(contentsOf: file, options: .alwaysMapped)) ?? migrateLegacySnapshots(for: fileURL, to: file) else {
+      return (Journal(), nil)
+    }
+    guard let scan = RecoveryJournal.scan(data) else {
+      // Not a journal (or truncated before the magic): start over.
+      try? FileManager.default.removeItem(at: file)
+      return (Journal(), nil)
+    }
+    if scan.validLength < data.count {
+      let path = file.path
+      let validLength = scan.validLength
+      writeQueue.async { _ = truncate(path, off_t(validLength)) }
+    }
+    return (Journal(entries: scan.entries, length: scan.validLength), data)
+  }
+
+  /// Converts the pre-journal `<sha256 of path>.json` for `fileURL` into `file`, returning the
+  /// journal bytes.
+  private func migrateLegacySnapshots(for fileURL: URL, to file: URL) -> Data? {
+    let legacyKey = Revision.sha256(text: normalizedPath(for: fileURL)).replacingOccurrences(of: "sha256:", with: "")
+    let legacy = file.deletingLastPathComponent().appendingPathComponent("\(legacyKey).json", isDirectory: false)
+    guard FileManager.default.fileExists(atPath: legacy.path), let json = try? Data(contentsOf: legacy) else { return nil }
+    defer { try? FileManager.default.removeItem(at: legacy) }
+    guard let items = try? JSONDecoder().decode([LegacySnapshot].self, from: json), !items.isEmpty else {
+      return nil
+    }
+
+    var data = Data(RecoveryJournal.magic)
+    for item in items {
+      let snapshot = HistorySnapshot(id: item.id, createdAt: item.createdAt, reason: item.reason, content: item.content)
+      data.append(RecoveryJournal.encode(snapshot, contentHash: item.contentHash))
+    }
+    guard (try? data.write(to: file, options: [.atomic])) != nil else { return nil }
+    return data
+  }
+
+  private func markStale(_ path: String) {
+    staleLock.lock()
+    defer { staleLock.unlock() }
+    stalePaths.insert(path)
+  }
+
+  private func takeStale(_ path: String) -> Bool {
+    staleLock.lock()
+    defer { staleLock.unlock() }
+    return stalePaths.remove(path) != nil
+  }
+
+  /// Appends `bytes` with a single `write`, reporting whether the file then ends at
+  /// `expectedEnd` (i.e. still matches the index).
+  private static func appendBytes(_ bytes: Data, toPath path: String, expectedEnd: Int) -> Bool {
+    let fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0o600)
+    guard fd >= 0 else { return false }
+    defer { close(fd) }
+
+    let ok = bytes.withUnsafeBytes { (raw: UnsafeRawBufferPointer) -> Bool in
+      guard var p = raw.baseAddress else { return true }
+      var remaining = raw.count
+      while remaining > 0 {
+        let n = write(fd, p, remaining)
+        if n < 0 {
+          if errno == EINTR { continue }
+          return false
+        }
+        p += n
+        remaining -= n
+      }
+      return true
+    }
+    return ok && lseek(fd, 0, SEEK_END) == off_t(expectedEnd)
+  }
+
+  private func journalFileURL(for fileURL: URL) -> URL {
+    let key = ContentFingerprint(text: normalizedPath(for: fileURL)).description.replacingOccurrences(of: "fp128:", with: "")
+    return recoveryDirURL().appendingPathComponent("\(key).journal", isDirectory: false)
   }
 
   private func recoveryDirURL() -> URL {
     let fm = FileManager.default
+    if let directory {
+      try? fm.createDirectory(at: directory, withIntermediateDirectories: true)
+      return directory
+    }
     let base = (try? fm.url(for: .applicationSupportDirectory, in: .userDomainMask, appropriateFor: nil, create: true))
       ?? URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
     let dir = base
@@ -152,22 +421,4 @@ public final class RecoveryStore: @unchecked Sendable {
     try? fm.createDirectory(at: dir, withIntermediateDirectories: true)
     return dir
   }
-
-  private func readStoredSnapshots(from file: URL) -> [StoredSnapshot] {
-    writeQueue.sync {}  // Drain pending background writes before reading
-    guard let data = try? Data(contentsOf: file) else { return [] }
-    return (try? JSONDecoder().decode([StoredSnapshot].self, from: data)) ?? []
-  }
-
-  private func writeStoredSnapshots(_ items: [StoredSnapshot], to file: URL) {
-    guard let data = try? JSONEncoder().encode(items) else { return }
-    try? data.write(to: file, options: [.atomic])
-  }
-
-  private func writeStoredSnapshotsAsync(_ items: [StoredSnapshot], to file: URL) {
-    writeQueue.async {
-      guard let data = try? JSONEncoder().encode(items) else { return }
-      try? data.write(to: file, options: [.atomic])
-    }
-  }
 }
@@ -2,10 +2,29 @@ import CryptoKit
 import Foundation
 
 public enum Revision {
+  /// The revision clients see (`revision` fields in the protocol): stable across processes and
+  /// versions. Costs a full SHA-256 pass, so in-process equality checks use `ContentFingerprint`.
   public static func sha256(text: String) -> String {
-    let digest = SHA256.hash(data: Data(text.utf8))
-    let hex = digest.map { String(format: "%02x", $0) }.joined()
-    return "sha256:\(hex)"
+    var text = text
+    let digest = text.withUTF8 { SHA256.hash(data: UnsafeRawBufferPointer($0)) }
+    var out = "sha256:"
+    out.reserveCapacity(7 + 2 * SHA256.byteCount)
+    for byte in digest {
+      out.unicodeScalars.append(hexDigits[Int(byte >> 4)])
+      out.unicodeScalars.append(hexDigits[Int(byte & 0x0F)])
+    }
+    return out
   }
-}
 
+  private static let hexDigits = Array("0123456789abcdef".unicodeScalars)
+
+  /// `value` as 16 lowercase hex digits.
+  static func hex(_ value: UInt64) -> String {
+    var out = ""
+    out.reserveCapacity(16)
+    for shift in stride(from: 60, through: 0, by: -4) {
+      out.unicodeScalars.append(hexDigits[Int((value >> UInt64(shift)) & 0x0F)])
+    }
+    return out
+  }
+}
@@ -0,0 +1,23 @@
+import Foundation
+
+/// Runs an `EditorSession`'s file reads and writes on one serial queue, off the actor.
+///
+/// The session awaits the result instead of blocking, so `currentInfo`, `waitUntilRevisionChange`
+/// and the rest keep answering while a slow disk write is in progress. Being serial, a read issued
+/// after a write sees that write's bytes.
+final class SessionIOQueue: @unchecked Sendable {
+  private let queue = DispatchQueue(label: "turbodraft.session.io", qos: .userInitiated)
+
+  func perform<T: Sendable>(_ work: @escaping @Sendable () throws -> T) async throws -> T {
+    try await withCheckedThrowingContinuation { (cont: CheckedContinuation<T, Error>) in
+      queue.async {
+        cont.resume(with: Result { try work() })
+      }
+    }
+  }
+
+  /// Queues `work` without waiting for it, still in order with everything else on the queue.
+  func enqueue(_ work: @escaping @Sendable () -> Void) {
+    queue.async(execute: work)
+  }
+}
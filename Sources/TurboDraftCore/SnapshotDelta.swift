@@ -0,0 +1,56 @@
+import Foundation
+
+/// A snapshot's content stored relative to the snapshot before it: the UTF-8 bytes between a
+/// shared prefix and a shared suffix are replaced by `inserted`.
+///
+/// Consecutive autosaves of a draft usually differ in one place, so this is a few bytes where a
+/// full copy would be the whole document. Used by `HistoryStore` and the recovery journal.
+struct SnapshotDelta: Sendable, Equatable {
+  var prefixLength: Int
+  var suffixLength: Int
+  var inserted: [UInt8]
+
+  /// Bytes this delta occupies when stored: `inserted` plus the two lengths.
+  var footprint: Int { inserted.count + 2 * MemoryLayout<UInt32>.size }
+
+  init(prefixLength: Int, suffixLength: Int, inserted: [UInt8]) {
+    self.prefixLength = prefixLength
+    self.suffixLength = suffixLength
+    self.inserted = inserted
+  }
+
+  init(from base: String, to target: String) {
+    var base = base
+    var target = target
+    (prefixLength, suffixLength, inserted) = base.withUTF8 { b in
+      target.withUTF8 { t in
+        let limit = min(b.count, t.count)
+        var prefix = 0
+        while prefix < limit, b[prefix] == t[prefix] {
+          prefix += 1
+        }
+        var suffix = 0
+        while suffix < limit - prefix, b[b.count - 1 - suffix] == t[t.count - 1 - suffix] {
+          suffix += 1
+        }
+        return (prefix, suffix, Array(t[prefix..<(t.count - suffix)]))
+      }
+    }
+  }
+
+  /// The target content, or nil when `base` is too short to be what this delta was made from.
+  func apply(to base: String) -> String? {
+    var base = base
+    return base.withUTF8 { b -> String? in
+      guard prefixLength >= 0, suffixLength >= 0, prefixLength + suffixLength <= b.count else {
+        return nil
+      }
+      var bytes: [UInt8] = []
+      bytes.reserveCapacity(prefixLength + inserted.count + suffixLength)
+      bytes.append(contentsOf: b[..<prefixLength])
+      bytes.append(contentsOf: inserted)
+      bytes.append(contentsOf: b[(b.count - suffixLength)...])
+      return String(decoding: bytes, as: UTF8.self)
+    }
+  }
+}
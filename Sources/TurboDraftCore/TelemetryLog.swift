@@ -0,0 +1,331 @@
+import Foundation
+
+/// Events in the binary telemetry log. The raw value is what's stored; never reuse one.
+public enum TelemetryEvent: UInt16, CaseIterable, Sendable {
+  /// `session.open` served. `count`: windows visible after it. `value`: server open ms.
+  /// Flag `reusedSession`: an already-open session was refocused.
+  case appSessionOpen = 1
+
+  public var name: String {
+    switch self {
+    case .appSessionOpen: return "app_session_open"
+    }
+  }
+
+  public init?(name: String) {
+    guard let event = Self.allCases.first(where: { $0.name == name }) else { return nil }
+    self = event
+  }
+}
+
+public struct TelemetryRecord: Sendable, Equatable {
+  public static let reusedSession: UInt16 = 1 << 0
+
+  public var eventID: UInt16
+  public var flags: UInt16
+  public var count: Int32
+  public var value: Double
+  /// `DispatchTime` uptime when the record was taken.
+  public var monotonicNs: UInt64
+  /// Wall clock, from the anchor of the batch the record was flushed in.
+  public var date: Date
+
+  public init(eventID: UInt16, flags: UInt16, count: Int32, value: Double, monotonicNs: UInt64, date: Date) {
+    self.eventID = eventID
+    self.flags = flags
+    self.count = count
+    self.value = value
+    self.monotonicNs = monotonicNs
+    self.date = date
+  }
+
+  public var event: TelemetryEvent? { TelemetryEvent(rawValue: eventID) }
+}
+
+/// Append-only binary telemetry. `record` stores a fixed-size entry into a preallocated ring;
+/// a background queue flushes the ring in batches, one `write(2)` each.
+///
+///     file   := "TDTL", u32 version, batch*
+///     batch  := u32 recordCount, u64 anchorWallNs, u64 anchorMonotonicNs, record*
+///     record := u64 monotonicNs, u16 event, u16 flags, i32 count, f64 value    (24 bytes)
+///
+/// Little-endian. Records carry only the monotonic clock; the batch anchor, taken at flush,
+/// maps them to wall time. Once the file passes `maxFileBytes` it is renamed to
+/// `rotatedURL(for:)` (replacing the previous one) and a new file is started. A crash mid-write
+/// leaves a short final batch, which `readRecords` stops in front of; the next open truncates
+/// it away before appending, as a failed `write` does straight away, so later batches never
+/// land behind torn bytes.
+///
+/// `record` takes an uncontended lock for a 24-byte store: no allocation, formatting or
+/// syscall. The first record after a flush schedules the next one; when the ring is full,
+/// new records are dropped and counted until the flush catches up.
+public final class TelemetryLog: @unchecked Sendable {
+  public struct Stats: Sendable, Equatable {
+    public var recorded: Int
+    public var dropped: Int
+    public var flushedBatches: Int
+  }
+
+  static let magic: [UInt8] = Array("TDTL".utf8)
+  static let version: UInt32 = 1
+  static let fileHeaderBytes = 8
+  static let batchHeaderBytes = 20
+  static let recordBytes = 24
+
+  private struct Slot {
+    var monotonicNs: UInt64
+    var eventID: UInt16
+    var flags: UInt16
+    var count: Int32
+    var value: Double
+  }
+
+  public let fileURL: URL
+  public let capacity: Int
+  private let flushIntervalMs: Int
+  private let maxFileBytes: Int
+  private let queue = DispatchQueue(label: "turbodraft.telemetry", qos: .utility)
+  private let lock = NSLock()
+  private let ring: UnsafeMutablePointer<Slot>
+  /// Records ever stored; `head - tail` are pending.
+  private var head = 0
+  private var tail = 0
+  private var flushScheduled = false
+  private var dropped = 0
+  private var flushedBatches = 0
+  // Owned by `queue`.
+  private var fd: Int32 = -1
+  private var fileBytes = 0
+
+  public init(fileURL: URL, capacity: Int = 1024, flushIntervalMs: Int = 2_000, maxFileBytes: Int = 4 * 1024 * 1024) {
+    self.fileURL = fileURL
+    self.capacity = max(1, capacity)
+    self.flushIntervalMs = max(0, flushIntervalMs)
+    self.maxFileBytes = max(Self.fileHeaderBytes + Self.batchHeaderBytes + Self.recordBytes, maxFileBytes)
+    ring = .allocate(capacity: self.capacity)
+  }
+
+  deinit {
+    // Nothing else can reach `self` now, and this may be running on `queue`: no `sync`.
+    flushPending()
+    if fd >= 0 { close(fd) }
+    ring.deallocate()
+  }
+
+  public static func rotatedURL(for url: URL) -> URL {
+    url.deletingPathExtension().appendingPathExtension("1").appendingPathExtension(url.pathExtension)
+  }
+
+  public func stats() -> Stats {
+    lock.lock()
+    defer { lock.unlock() }
+    return Stats(recorded: head, dropped: dropped, flushedBatches: flushedBatches)
+  }
+
+  public func record(_ event: TelemetryEvent, count: Int = 0, value: Double = 0, flags: UInt16 = 0) {
+    let now = DispatchTime.now().uptimeNanoseconds
+    lock.lock()
+    guard head - tail < capacity else {
+      dropped += 1
+      lock.unlock()
+      return
+    }
+    ring[head % capacity] = Slot(
+      monotonicNs: now,
+      eventID: event.rawValue,
+      flags: flags,
+      count: Int32(clamping: count),
+      value: value
+    )
+    head += 1
+    let schedule = !flushScheduled
+    flushScheduled = true
+    lock.unlock()
+    if schedule {
+      queue.asyncAfter(deadline: .now() + .milliseconds(flushIntervalMs)) { [weak self] in
+        self?.flushPending()
+      }
+    }
+  }
+
+  /// Writes everything recorded so far and returns once it is on disk.
+  public func flush() {
+    queue.sync { flushPending() }
+  }
+
+  // MARK: - Writing (on `queue`)
+
+  private func flushPending() {
+    lock.lock()
+    flushScheduled = false
+    let pending = (tail..<head).map { ring[$0 % capacity] }
+    tail = head
+    lock.unlock()
+    guard !pending.isEmpty else { return }
+
+    let anchorMonotonicNs = DispatchTime.now().uptimeNanoseconds
+    let anchorWallNs = UInt64(max(0, Date().timeIntervalSince1970 * 1_000_000_000))
+    var out = [UInt8]()
+    out.reserveCapacity(Self.batchHeaderBytes + pending.count * Self.recordBytes)
+    Self.appendLittleEndian(UInt32(pending.count), to: &out)
+    Self.appendLittleEndian(anchorWallNs, to: &out)
+    Self.appendLittleEndian(anchorMonotonicNs, to: &out)
+    for slot in pending {
+      Self.appendLittleEndian(slot.monotonicNs, to: &out)
+      Self.appendLittleEndian(slot.eventID, to: &out)
+      Self.appendLittleEndian(slot.flags, to: &out)
+      Self.appendLittleEndian(slot.count, to: &out)
+      Self.appendLittleEndian(slot.value.bitPattern, to: &out)
+    }
+    guard prepareFile(forAppending: out.count) else { return }
+    if writeAll(out) {
+      fileBytes += out.count
+      lock.lock()
+      flushedBatches += 1
+      lock.unlock()
+    } else if ftruncate(fd, off_t(fileBytes)) != 0 {
+      // Best-effort; reopen (and cut the torn batch off) next time.
+      close(fd)
+      fd = -1
+    }
+  }
+
+  /// Opens the log, rotating first when `bytes` more would pass `maxFileBytes`.
+  private func prepareFile(forAppending bytes: Int) -> Bool {
+    if fd < 0, !openFile() { return false }
+    if fileBytes > Self.fileHeaderBytes, fileBytes + bytes > maxFileBytes {
+      close(fd)
+      fd = -1
+      _ = rename(fileURL.path, Self.rotatedURL(for: fileURL).path)
+      guard openFile() else { return false }
+    }
+    if fileBytes == 0 {
+      var header = Self.magic
+      Self.appendLittleEndian(Self.version, to: &header)
+      guard writeAll(header) else {
+        _ = ftruncate(fd, 0)
+        close(fd)
+        fd = -1
+        return false
+      }
+      fileBytes = header.count
+    }
+    return true
+  }
+
+  /// Opens for appending, first cutting the file back to its last complete batch (to nothing
+  /// when it isn't a telemetry log).
+  private func openFile() -> Bool {
+    fd = open(fileURL.path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0o600)
+    guard fd >= 0 else { return false }
+    var st = stat()
+    fileBytes = fstat(fd, &st) == 0 ? Int(st.st_size) : 0
+    if fileBytes > 0 {
+      let complete = (try? Data(contentsOf: fileURL, options: .mappedIfSafe)).map(Self.completeLength) ?? 0
+      if complete != fileBytes {
+        guard ftruncate(fd, off_t(complete)) == 0 else {
+          close(fd)
+          fd = -1
+          return false
+        }
+        fileBytes = complete
+      }
+    }
+    return true
+  }
+
+  private func writeAll(_ bytes: [UInt8]) -> Bool {
+    bytes.withUnsafeBytes { raw in
+      var offset = 0
+      while offset < raw.count {
+        let n = write(fd, raw.baseAddress! + offset, raw.count - offset)
+        if n < 0 {
+          if errno == EINTR { continue }
+          return false
+        }
+        offset += n
+      }
+      return true
+    }
+  }
+
+  // MARK: - Reading
+
+  /// Records in `url`'s rotated file, then `url`, oldest first. Missing files read as empty.
+  public static func readRecords(at url: URL) -> [TelemetryRecord] {
+    var out: [TelemetryRecord] = []
+    for file in [rotatedURL(for: url), url] {
+      guard let data = try? Data(contentsOf: file) else { continue }
+      out.append(contentsOf: decode(data))
+    }
+    return out
+  }
+
+  /// Bytes of `data` up to the end of its last complete batch; 0 when it is not a telemetry log.
+  static func completeLength(_ data: Data) -> Int {
+    data.withUnsafeBytes { (raw: UnsafeRawBufferPointer) -> Int in
+      guard raw.count >= fileHeaderBytes,
+            raw.prefix(magic.count).elementsEqual(magic),
+            readUInt32(raw, at: magic.count) == version
+      else { return 0 }
+      var offset = fileHeaderBytes
+      while offset + batchHeaderBytes <= raw.count {
+        let end = offset + batchHeaderBytes + Int(readUInt32(raw, at: offset)) * recordBytes
+        guard end <= raw.count else { break }
+        offset = end
+      }
+      return offset
+    }
+  }
+
+  /// Complete records in `data`; empty when it is not a telemetry log.
+  static func decode(_ data: Data) -> [TelemetryRecord] {
+    data.withUnsafeBytes { (raw: UnsafeRawBufferPointer) -> [TelemetryRecord] in
+      guard raw.count >= fileHeaderBytes,
+            raw.prefix(magic.count).elementsEqual(magic),
+            readUInt32(raw, at: magic.count) == version
+      else { return [] }
+      var out: [TelemetryRecord] = []
+      var offset = fileHeaderBytes
+      while offset + batchHeaderBytes <= raw.count {
+        let count = Int(readUInt32(raw, at: offset))
+        let end = offset + batchHeaderBytes + count * recordBytes
+        guard end <= raw.count else { break }
+        let anchorWallNs = Int64(bitPattern: readUInt64(raw, at: offset + 4))
+        let anchorMonotonicNs = Int64(bitPattern: readUInt64(raw, at: offset + 12))
+        var at = offset + batchHeaderBytes
+        for _ in 0..<count {
+          let monotonicNs = readUInt64(raw, at: at)
+          let wallNs = anchorWallNs - (anchorMonotonicNs - Int64(bitPattern: monotonicNs))
+          out.append(TelemetryRecord(
+            eventID: readUInt16(raw, at: at + 8),
+            flags: readUInt16(raw, at: at + 10),
+            count: Int32(bitPattern: readUInt32(raw, at: at + 12)),
+            value: Double(bitPattern: readUInt64(raw, at: at + 16)),
+            monotonicNs: monotonicNs,
+            date: Date(timeIntervalSince1970: Double(wallNs) / 1_000_000_000)
+          ))
+          at += recordBytes
+        }
+        offset = end
+      }
+      return out
+    }
+  }
+
+  private static func appendLittleEndian<T: FixedWidthInteger>(_ value: T, to out: inout [UInt8]) {
+    withUnsafeBytes(of: value.littleEndian) { out.append(contentsOf: $0) }
+  }
+
+  private static func readUInt16(_ raw: UnsafeRawBufferPointer, at offset: Int) -> UInt16 {
+    UInt16(raw[offset]) | UInt16(raw[offset + 1]) << 8
+  }
+
+  private static func readUInt32(_ raw: UnsafeRawBufferPointer, at offset: Int) -> UInt32 {
+    (0..<4).reduce(UInt32(0)) { $0 | UInt32(raw[offset + $1]) << (8 * UInt32($1)) }
+  }
+
+  private static func readUInt64(_ raw: UnsafeRawBufferPointer, at offset: Int) -> UInt64 {
+    (0..<8).reduce(UInt64(0)) { $0 | UInt64(raw[offset + $1]) << (8 * UInt64($1)) }
+  }
+}
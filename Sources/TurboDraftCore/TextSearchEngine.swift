@@ -36,16 +36,15 @@ public enum TextSearchEngine {
     options: TextSearchOptions,
     captureLimit: Int = Int.max
   ) -> TextSearchSummary? {
-    guard let re = makeRegex(query: query, options: options) else { return nil }
-    let fullRange = NSRange(location: 0, length: (text as NSString).length)
+    guard let pattern = TextSearchPattern(query: query, options: options) else { return nil }
+    let ns = text as NSString
     var total = 0
     var ranges: [NSRange] = []
     ranges.reserveCapacity(min(captureLimit, 64))
-    re.enumerateMatches(in: text, range: fullRange) { match, _, _ in
-      guard let match else { return }
+    pattern.enumerateMatches(in: ns, range: NSRange(location: 0, length: ns.length)) { range in
       total += 1
       if ranges.count < captureLimit {
-        ranges.append(match.range)
+        ranges.append(range)
       }
     }
     return TextSearchSummary(totalCount: total, ranges: ranges)
@@ -66,16 +65,291 @@ public enum TextSearchEngine {
     return re.replacementString(for: match, in: text, offset: 0, template: replacementTemplate)
   }
 
+  /// Every match paired with its expanded replacement, in document order — the edit set
+  /// `replaceAll` applies, for callers that apply it as ranged edits instead of rebuilding the
+  /// text. The template is expanded as `NSRegularExpression` templates are (`$1`, `\\`), for
+  /// literal queries too.
+  public static func replacements(
+    in text: NSString,
+    query: String,
+    replacementTemplate: String,
+    options: TextSearchOptions
+  ) -> [TextReplacement]? {
+    guard let pattern = TextSearchPattern(query: query, options: options) else { return nil }
+    // A template with no `$` or `\` expands to itself, whatever it matched.
+    let expands = replacementTemplate.contains(where: { $0 == "$" || $0 == "\\" })
+    var out: [TextReplacement] = []
+    pattern.enumerateMatches(in: text, range: NSRange(location: 0, length: text.length)) { range in
+      var replacement = replacementTemplate
+      if expands, let match = pattern.regexMatch(at: range.location, in: text), match.range == range {
+        replacement = pattern.regex.replacementString(for: match, in: text as String, offset: 0, template: replacementTemplate)
+      }
+      out.append(TextReplacement(range: range, replacement: replacement))
+    }
+    return out
+  }
+
   public static func replaceAll(
     in text: String,
     query: String,
     replacementTemplate: String,
     options: TextSearchOptions
   ) -> (text: String, count: Int)? {
-    guard let re = makeRegex(query: query, options: options) else { return nil }
-    let fullRange = NSRange(location: 0, length: (text as NSString).length)
-    let mutable = NSMutableString(string: text)
-    let count = re.replaceMatches(in: mutable, range: fullRange, withTemplate: replacementTemplate)
-    return (mutable as String, count)
+    let ns = text as NSString
+    guard let edits = replacements(in: ns, query: query, replacementTemplate: replacementTemplate, options: options) else {
+      return nil
+    }
+    return (TextReplacement.apply(edits, to: ns), edits.count)
+  }
+}
+
+/// One replace-all edit: `range` of the original text becomes `replacement`.
+public struct TextReplacement: Equatable, Sendable {
+  public var range: NSRange
+  public var replacement: String
+
+  public init(range: NSRange, replacement: String) {
+    self.range = range
+    self.replacement = replacement
+  }
+
+  /// `text` with `edits` (ascending, non-overlapping, in its coordinates) applied, built front to
+  /// back in one pass.
+  public static func apply(_ edits: [TextReplacement], to text: NSString) -> String {
+    let out = NSMutableString(capacity: text.length)
+    var cursor = 0
+    for edit in edits {
+      out.append(text.substring(with: NSRange(location: cursor, length: edit.range.location - cursor)))
+      out.append(edit.replacement)
+      cursor = NSMaxRange(edit.range)
+    }
+    out.append(text.substring(from: cursor))
+    return out as String
+  }
+}
+
+/// A compiled find query. Literal queries are matched with Boyer–Moore–Horspool over the UTF-16
+/// code units; the regex (which every query also compiles to) is the reference, used for regex
+/// queries, whole-word boundary checks, and case-insensitive literals over non-ASCII text.
+struct TextSearchPattern {
+  let regex: NSRegularExpression
+  /// Query code units for literal queries (ASCII-lowercased when case-insensitive).
+  private let literal: [unichar]?
+  private let caseSensitive: Bool
+  private let wholeWord: Bool
+  private let literalIsASCII: Bool
+  /// No match can contain a line terminator, so an edit only changes matches on the lines it
+  /// touched. Conservative for regexes: anything that might match a newline counts as unbounded.
+  let isLineBounded: Bool
+
+  init?(query: String, options: TextSearchOptions) {
+    guard let regex = TextSearchEngine.makeRegex(query: query, options: options) else { return nil }
+    let trimmed = query.trimmingCharacters(in: .whitespacesAndNewlines)
+    self.regex = regex
+    caseSensitive = options.caseSensitive
+    wholeWord = options.wholeWord
+
+    let units = Array(trimmed.utf16)
+    let hasTerminator = units.contains { $0 == 0x0A || $0 == 0x0D || $0 == 0x85 || $0 == 0x2028 || $0 == 0x2029 }
+    if options.regexEnabled {
+      literal = nil
+      literalIsASCII = false
+      let unbounded = ["[", "(?", "\\n", "\\r", "\\s", "\\S", "\\W", "\\D", "\\H", "\\V", "\\v", "\\R", "\\X", "\\p", "\\P", "\\x", "\\u", "\\U", "\\N", "\\0", "\\c", "\\Q"]
+      isLineBounded = !hasTerminator && !unbounded.contains { trimmed.contains($0) }
+    } else {
+      literalIsASCII = units.allSatisfy { $0 < 0x80 }
+      literal = options.caseSensitive ? units : units.map(Self.foldASCII)
+      isLineBounded = !hasTerminator
+    }
+  }
+
+  /// Calls `body` with each match inside `range`, in order. Lookarounds and `\b` see the text
+  /// outside `range`.
+  func enumerateMatches(in text: NSString, range: NSRange, _ body: (NSRange) -> Void) {
+    guard range.length > 0 else { return }
+    if let literal, literal.count <= range.length {
+      var buffer = [unichar](repeating: 0, count: range.length)
+      text.getCharacters(&buffer, range: range)
+      if caseSensitive || (literalIsASCII && buffer.allSatisfy { $0 < 0x80 }) {
+        horspool(literal, in: buffer) { offset in
+          let candidate = NSRange(location: range.location + offset, length: literal.count)
+          guard !wholeWord || isRegexMatch(candidate, in: text) else { return false }
+          body(candidate)
+          return true
+        }
+        return
+      }
+    } else if literal != nil {
+      return
+    }
+    regex.enumerateMatches(in: text as String, options: [.withTransparentBounds, .withoutAnchoringBounds], range: range) { match, _, _ in
+      if let match { body(match.range) }
+    }
+  }
+
+  /// Whether the regex matches exactly `range` (starting there, with the rest of the text visible).
+  func isRegexMatch(_ range: NSRange, in text: NSString) -> Bool {
+    regexMatch(at: range.location, in: text)?.range == range
+  }
+
+  func regexMatch(at location: Int, in text: NSString) -> NSTextCheckingResult? {
+    guard location >= 0, location <= text.length else { return nil }
+    return regex.firstMatch(
+      in: text as String,
+      options: [.anchored, .withTransparentBounds],
+      range: NSRange(location: location, length: text.length - location)
+    )
+  }
+
+  /// Horspool search with a skip table on the low byte of each code unit. `accept` returns
+  /// whether a candidate was taken; taken matches don't overlap, like the regex's.
+  private func horspool(_ pattern: [unichar], in text: [unichar], accept: (Int) -> Bool) {
+    let m = pattern.count
+    let n = text.count
+    guard m > 0, m <= n else { return }
+    let fold = !caseSensitive
+    var skip = [Int](repeating: m, count: 256)
+    for i in 0..<(m - 1) {
+      skip[Int(pattern[i] & 0xFF)] = m - 1 - i
+    }
+    let last = pattern[m - 1]
+    var i = 0
+    while i <= n - m {
+      var c = text[i + m - 1]
+      if fold { c = Self.foldASCII(c) }
+      if c == last {
+        var j = m - 2
+        while j >= 0 {
+          var t = text[i + j]
+          if fold { t = Self.foldASCII(t) }
+          if t != pattern[j] { break }
+          j -= 1
+        }
+        if j < 0, accept(i) {
+          i += m
+          continue
+        }
+      }
+      i += skip[Int(c & 0xFF)]
+    }
+  }
+
+  private static func foldASCII(_ c: unichar) -> unichar {
+    (c >= 0x41 && c <= 0x5A) ? c + 0x20 : c
+  }
+}
+
+/// Find state for one document: the compiled query and every match, kept current across edits.
+///
+/// The editor reports each character edit; for line-bounded queries only the touched lines are
+/// re-matched, otherwise the next `update` rescans. Asking again for the same query and options
+/// reuses the compiled pattern and the match list, so typing in the find field or redrawing
+/// highlights doesn't rescan the document. Not thread-safe; owned by the editor.
+public final class TextSearchSession {
+  public private(set) var query = ""
+  public private(set) var options = TextSearchOptions()
+  private var pattern: TextSearchPattern?
+  private var matchList: [NSRange] = []
+  private var scannedLength: Int?
+  private var needsRescan = true
+
+  public init() {}
+
+  /// Matches of `query` in `text`, sorted; nil when the query is empty or the regex is invalid.
+  @discardableResult
+  public func update(query: String, options: TextSearchOptions, in text: NSString) -> [NSRange]? {
+    if query != self.query || options != self.options {
+      self.query = query
+      self.options = options
+      pattern = TextSearchPattern(query: query, options: options)
+      needsRescan = true
+    }
+    guard let pattern else { return nil }
+    if needsRescan || scannedLength != text.length {
+      matchList.removeAll(keepingCapacity: true)
+      pattern.enumerateMatches(in: text, range: NSRange(location: 0, length: text.length)) { matchList.append($0) }
+      scannedLength = text.length
+      needsRescan = false
+    }
+    return matchList
+  }
+
+  /// Folds a character edit into the match list. `editedRange` is in post-edit coordinates, as
+  /// `NSTextStorage` reports it.
+  public func applyEdit(in text: NSString, editedRange: NSRange, changeInLength delta: Int) {
+    guard let pattern, !needsRescan, let scannedLength, scannedLength + delta == text.length else {
+      needsRescan = true
+      return
+    }
+    guard pattern.isLineBounded else {
+      needsRescan = true
+      return
+    }
+    // The line after the edit is re-matched too when the edit ends at its start: its leading
+    // context (for `\b`) may have changed.
+    var edited = NSIntersectionRange(editedRange, NSRange(location: 0, length: text.length))
+    if NSMaxRange(edited) < text.length {
+      edited.length += 1
+    }
+    let window = text.lineRange(for: edited)
+    let oldWindowEnd = NSMaxRange(window) - delta
+
+    let lo = firstIndex { $0.location >= window.location }
+    let hi = firstIndex { $0.location >= oldWindowEnd }
+    var rematched: [NSRange] = []
+    pattern.enumerateMatches(in: text, range: window) { rematched.append($0) }
+    for i in hi..<matchList.count {
+      matchList[i].location += delta
+    }
+    matchList.replaceSubrange(lo..<hi, with: rematched)
+    self.scannedLength = text.length
+  }
+
+  /// Forget the match list; the next `update` rescans.
+  public func invalidate() {
+    needsRescan = true
+  }
+
+  public func contains(_ range: NSRange) -> Bool {
+    guard pattern != nil, !needsRescan else { return false }
+    let i = firstIndex { $0.location >= range.location }
+    return i < matchList.count && matchList[i] == range
+  }
+
+  /// First match starting at or after `location`, wrapping to the first match.
+  public func match(startingAtOrAfter location: Int) -> NSRange? {
+    guard !matchList.isEmpty else { return nil }
+    let i = firstIndex { $0.location >= location }
+    return i < matchList.count ? matchList[i] : matchList.first
+  }
+
+  /// Last match starting before `location`, wrapping to the last match.
+  public func match(startingBefore location: Int) -> NSRange? {
+    guard !matchList.isEmpty else { return nil }
+    let i = firstIndex { $0.location >= location }
+    return i > 0 ? matchList[i - 1] : matchList.last
+  }
+
+  /// The text replacing the match at `range`: `template` with `$n` expanded in regex mode, or as is.
+  public func replacement(for range: NSRange, in text: NSString, template: String) -> String {
+    guard options.regexEnabled, let pattern, let match = pattern.regexMatch(at: range.location, in: text),
+          match.range == range
+    else { return template }
+    return pattern.regex.replacementString(for: match, in: text as String, offset: 0, template: template)
+  }
+
+  /// Index of the first match satisfying `predicate`, which must be monotonic over the list.
+  private func firstIndex(where predicate: (NSRange) -> Bool) -> Int {
+    var lo = 0
+    var hi = matchList.count
+    while lo < hi {
+      let mid = (lo + hi) / 2
+      if predicate(matchList[mid]) {
+        hi = mid
+      } else {
+        lo = mid + 1
+      }
+    }
+    return lo
   }
 }
@@ -0,0 +1,282 @@
+import Foundation
+
+/// Whether a position sits inside a fenced code block, and which delimiter opened it.
+public struct MarkdownFenceState: Sendable, Hashable {
+  /// UTF-16 code unit of the opening delimiter (`` ` `` or `~`); 0 when outside a fence.
+  public var fenceChar: unichar
+  public var fenceLen: Int
+
+  public var inFence: Bool { fenceChar != 0 }
+
+  public static let outside = MarkdownFenceState(fenceChar: 0, fenceLen: 0)
+
+  public init(fenceChar: unichar, fenceLen: Int) {
+    self.fenceChar = fenceChar
+    self.fenceLen = fenceLen
+  }
+
+  /// State after a line whose fence delimiter is `delim` (`fenceChar == 0` for "no delimiter").
+  func advanced(by delim: MarkdownFenceState) -> MarkdownFenceState {
+    guard delim.inFence else { return self }
+    if !inFence { return delim }
+    if delim.fenceChar == fenceChar, delim.fenceLen >= fenceLen { return .outside }
+    return self
+  }
+}
+
+/// Per-line fence bookkeeping for one document, updated from text-storage edits.
+///
+/// Each `\n`-separated line records its start offset, its fence delimiter (if any) and the fence
+/// state on entry. An edit rescans only the lines it touched and then propagates entry states
+/// forward until they agree with what was stored, so both "is this line inside a fence?" and
+/// "which lines changed fence state?" cost O(changed lines) instead of a prefix or suffix scan.
+/// Not thread-safe; owned by the editor on the main thread.
+public final class MarkdownFenceIndex {
+  private static let backtick: unichar = 0x60
+  private static let tilde: unichar = 0x7E
+  private static let newline: unichar = 0x0A
+
+  private var lineStarts: [Int] = [0]
+  private var delims: [MarkdownFenceState] = [.outside]
+  private var entryStates: [MarkdownFenceState] = [.outside]
+  public private(set) var length = 0
+
+  public init() {}
+
+  public convenience init(text: NSString) {
+    self.init()
+    rebuild(text: text)
+  }
+
+  public var lineCount: Int { lineStarts.count }
+
+  public func rebuild(text: NSString) {
+    length = text.length
+    let scanned = Self.scanLines(in: text, from: 0, to: length)
+    lineStarts = scanned.starts
+    delims = scanned.delims
+    entryStates = []
+    entryStates.reserveCapacity(lineStarts.count)
+    var state = MarkdownFenceState.outside
+    for delim in delims {
+      entryStates.append(state)
+      state = state.advanced(by: delim)
+    }
+  }
+
+  /// Fence state in effect for text starting at `location`: the entry state of its line, or the
+  /// state after that line's delimiter when `location` falls mid-line.
+  public func state(before location: Int) -> MarkdownFenceState {
+    if location <= 0 { return .outside }
+    let line = lineIndex(containing: min(location, length))
+    if lineStarts[line] == location { return entryStates[line] }
+    return entryStates[line].advanced(by: delims[line])
+  }
+
+  /// Fence state after scanning `text[0..<location]` line by line, for callers without an index.
+  /// A line straddling `location` is judged on its prefix only.
+  static func prefixState(in text: NSString, before location: Int) -> MarkdownFenceState {
+    let end = min(location, text.length)
+    if end <= 0 { return .outside }
+    var state = MarkdownFenceState.outside
+    for delim in scanLines(in: text, from: 0, to: end).delims {
+      state = state.advanced(by: delim)
+    }
+    return state
+  }
+
+  /// Index of the line containing UTF-16 offset `location` (clamped to the document).
+  public func lineIndex(containing location: Int) -> Int {
+    var lo = 0
+    var hi = lineStarts.count - 1
+    while lo < hi {
+      let mid = (lo + hi + 1) / 2
+      if lineStarts[mid] <= location {
+        lo = mid
+      } else {
+        hi = mid - 1
+      }
+    }
+    return lo
+  }
+
+  /// Folds a character edit into the index. `editedRange` is in post-edit coordinates and
+  /// `changeInLength` is the edit's length delta (both as reported by `NSTextStorage`).
+  /// Returns the range whose fence context may have changed: the edited lines plus any
+  /// following lines whose entry state flipped.
+  @discardableResult
+  public func applyEdit(in text: NSString, editedRange: NSRange, changeInLength delta: Int) -> NSRange {
+    guard let fold = fold(in: text, editedRange: editedRange, changeInLength: delta) else {
+      return NSRange(location: 0, length: text.length)
+    }
+    let segmentStart = lineStarts[fold.firstLine]
+    let dirtyEnd = fold.endLine < lineStarts.count ? lineStarts[fold.endLine] : length
+    return NSRange(location: segmentStart, length: max(0, dirtyEnd - segmentStart))
+  }
+
+  /// `applyEdit` for a batched replace spliced into one storage edit. `lineEdits` are the whole
+  /// lines each replacement touched, in pre-edit coordinates (as for
+  /// `MarkdownStyledRanges.applyEdits`). Returns only the other lines whose entry state flipped,
+  /// in post-edit coordinates: untouched text between two replacements keeps its fence context
+  /// unless a delimiter was added or removed ahead of it.
+  public func applyEdits(
+    in text: NSString,
+    editedRange: NSRange,
+    changeInLength delta: Int,
+    lineEdits: [(range: NSRange, replacementLength: Int)]
+  ) -> [NSRange] {
+    guard let fold = fold(in: text, editedRange: editedRange, changeInLength: delta) else {
+      return [NSRange(location: 0, length: text.length)]
+    }
+    var flipped: [NSRange] = []
+    func mark(_ line: Int) {
+      let start = lineStarts[line]
+      let end = line + 1 < lineStarts.count ? lineStarts[line + 1] : length
+      if let last = flipped.last, NSMaxRange(last) == start {
+        flipped[flipped.count - 1].length += end - start
+      } else {
+        flipped.append(NSRange(location: start, length: end - start))
+      }
+    }
+
+    // Walk the rescanned lines alongside the replacements, mapping each untouched line back to
+    // its pre-edit start to compare entry states.
+    var e = 0
+    var shift = 0
+    var old = 0
+    for line in fold.firstLine...fold.segmentLastLine {
+      let start = lineStarts[line]
+      while e < lineEdits.count, lineEdits[e].range.location + shift + lineEdits[e].replacementLength <= start {
+        shift += lineEdits[e].replacementLength - lineEdits[e].range.length
+        e += 1
+      }
+      if e < lineEdits.count, lineEdits[e].range.location + shift <= start { continue }
+      let oldStart = start - shift
+      while old < fold.oldStarts.count, fold.oldStarts[old] < oldStart {
+        old += 1
+      }
+      if old == fold.oldStarts.count || fold.oldStarts[old] != oldStart || fold.oldEntryStates[old] != entryStates[line] {
+        mark(line)
+      }
+    }
+    for line in (fold.segmentLastLine + 1)..<fold.endLine {
+      mark(line)
+    }
+    return flipped
+  }
+
+  /// What `fold` rescanned: the post-edit lines `firstLine...segmentLastLine` replaced the old
+  /// lines starting at `oldStarts`, and entry states were propagated up to (not including) `endLine`.
+  private struct Fold {
+    var firstLine: Int
+    var segmentLastLine: Int
+    var endLine: Int
+    var oldStarts: [Int]
+    var oldEntryStates: [MarkdownFenceState]
+  }
+
+  /// Shared body of `applyEdit` and `applyEdits`; nil when the edit didn't fit the index and it
+  /// was rebuilt from scratch.
+  private func fold(in text: NSString, editedRange: NSRange, changeInLength delta: Int) -> Fold? {
+    let newEnd = NSMaxRange(editedRange)
+    let oldEnd = newEnd - delta
+    guard editedRange.location >= 0,
+          text.length == length + delta,
+          oldEnd >= editedRange.location,
+          oldEnd <= length,
+          newEnd <= text.length
+    else {
+      rebuild(text: text)
+      return nil
+    }
+
+    let firstLine = lineIndex(containing: editedRange.location)
+    let lastOldLine = lineIndex(containing: oldEnd)
+    let segmentStart = lineStarts[firstLine]
+    var segmentEnd = newEnd
+    while segmentEnd < text.length, text.character(at: segmentEnd) != Self.newline {
+      segmentEnd += 1
+    }
+
+    let scanned = Self.scanLines(in: text, from: segmentStart, to: segmentEnd)
+    let replaced = firstLine...lastOldLine
+    let oldStarts = Array(lineStarts[replaced])
+    let oldEntryStates = Array(entryStates[replaced])
+    let tail = lastOldLine + 1
+    // Shifting the tail is a flat Int loop; only the scan and the state walk are per-character work.
+    if delta != 0 {
+      for i in tail..<lineStarts.count {
+        lineStarts[i] += delta
+      }
+    }
+    lineStarts.replaceSubrange(replaced, with: scanned.starts)
+    delims.replaceSubrange(replaced, with: scanned.delims)
+    entryStates.replaceSubrange(replaced, with: repeatElement(MarkdownFenceState.outside, count: scanned.starts.count))
+    length = text.length
+
+    var state = firstLine == 0 ? .outside : entryStates[firstLine - 1].advanced(by: delims[firstLine - 1])
+    var line = firstLine
+    let segmentLastLine = firstLine + scanned.starts.count - 1
+    while line < lineStarts.count {
+      if line > segmentLastLine, entryStates[line] == state { break }
+      entryStates[line] = state
+      state = state.advanced(by: delims[line])
+      line += 1
+    }
+    return Fold(
+      firstLine: firstLine,
+      segmentLastLine: segmentLastLine,
+      endLine: line,
+      oldStarts: oldStarts,
+      oldEntryStates: oldEntryStates
+    )
+  }
+
+  /// Line starts and fence delimiters for `[from, to)`, where `from` is a line start and `to` is
+  /// a line end (a `\n` or the end of the text).
+  private static func scanLines(in text: NSString, from: Int, to: Int) -> (starts: [Int], delims: [MarkdownFenceState]) {
+    var starts: [Int] = []
+    var delims: [MarkdownFenceState] = []
+    var lineStart = from
+    var cursor = from
+    var buffer = [unichar](repeating: 0, count: 4096)
+    var bufferStart = from
+    var bufferCount = 0
+
+    @inline(__always) func char(at i: Int) -> unichar {
+      if i >= bufferStart + bufferCount || i < bufferStart {
+        bufferStart = i
+        bufferCount = min(buffer.count, to - i)
+        text.getCharacters(&buffer, range: NSRange(location: i, length: bufferCount))
+      }
+      return buffer[i - bufferStart]
+    }
+
+    while true {
+      while cursor < to, char(at: cursor) != newline {
+        cursor += 1
+      }
+      starts.append(lineStart)
+      delims.append(fenceDelimiter(lineStart, cursor, char))
+      if cursor >= to { break }
+      cursor += 1
+      lineStart = cursor
+    }
+    return (starts, delims)
+  }
+
+  /// Mirrors `^\s*(`{3,}|~{3,})` on one line.
+  private static func fenceDelimiter(_ lo: Int, _ hi: Int, _ char: (Int) -> unichar) -> MarkdownFenceState {
+    var i = lo
+    while i < hi, MarkdownCodeUnit.isSpace(char(i)) { i += 1 }
+    guard i < hi else { return .outside }
+    let c = char(i)
+    guard c == backtick || c == tilde else { return .outside }
+    var run = 0
+    while i < hi, char(i) == c {
+      run += 1
+      i += 1
+    }
+    return run >= 3 ? MarkdownFenceState(fenceChar: c, fenceLen: run) : .outside
+  }
+}
@@ -0,0 +1,216 @@
+import Foundation
+
+/// Highlight spans per line, keyed on the line's text and the fence state it starts in.
+///
+/// `MarkdownTokenizer` output for a line depends on nothing else (the exception, a table
+/// separator row tagging the header cells of the line above, is redone on every lookup), so an
+/// entry stays valid wherever the line moves: typing on line 3 leaves every other line's entry
+/// warm. Spans are stored relative to the line start, rebased on the way out, and carry no theme
+/// attributes, so one cache serves every window. The least recently used entry is evicted in
+/// O(1). Thread-safe; the lock is held per line, never across tokenizing.
+public final class MarkdownLineHighlightCache: @unchecked Sendable {
+  public static let shared = MarkdownLineHighlightCache()
+
+  public struct Stats: Sendable, Equatable {
+    public var hits: Int
+    public var misses: Int
+    public var entryCount: Int
+    public var capacity: Int
+
+    /// Fraction of non-empty line lookups served from the cache; 0 before any lookup.
+    public var hitRate: Double {
+      hits + misses == 0 ? 0 : Double(hits) / Double(hits + misses)
+    }
+  }
+
+  private struct Key: Hashable {
+    var hash: Int
+    var length: Int
+    var entryState: MarkdownFenceState
+  }
+
+  private struct Entry {
+    var key: Key
+    /// The line text, compared on lookup so a hash collision is a miss rather than wrong colours.
+    var units: [unichar]
+    var spans: [MarkdownHighlight]
+    var exitState: MarkdownFenceState
+    var newer = -1
+    var older = -1
+  }
+
+  public let capacity: Int
+  private let lock = NSLock()
+  private var slots: [Entry] = []
+  private var slotByKey: [Key: Int] = [:]
+  private var newest = -1
+  private var oldest = -1
+  private var hits = 0
+  private var misses = 0
+
+  public init(capacity: Int = 8192) {
+    self.capacity = max(1, capacity)
+  }
+
+  public func stats() -> Stats {
+    lock.lock()
+    defer { lock.unlock() }
+    return Stats(hits: hits, misses: misses, entryCount: slots.count, capacity: capacity)
+  }
+
+  public func removeAll() {
+    lock.lock()
+    defer { lock.unlock() }
+    slots.removeAll()
+    slotByKey.removeAll()
+    newest = -1
+    oldest = -1
+    hits = 0
+    misses = 0
+  }
+
+  /// Same result as `MarkdownHighlighter.highlights(in:range:fenceIndex:)`.
+  public func highlights(in text: NSString, range: NSRange, fenceIndex: MarkdownFenceIndex? = nil) -> [MarkdownHighlight] {
+    let safe = NSIntersectionRange(range, NSRange(location: 0, length: text.length))
+    if safe.length <= 0 { return [] }
+    let state: MarkdownFenceState
+    if let fenceIndex, fenceIndex.length == text.length {
+      state = fenceIndex.state(before: safe.location)
+    } else {
+      state = MarkdownFenceIndex.prefixState(in: text, before: safe.location)
+    }
+    return highlights(in: text, range: safe, entryState: state)
+  }
+
+  /// Same result as `MarkdownHighlighter.highlights(in:range:entryState:)`.
+  public func highlights(in text: NSString, range: NSRange, entryState: MarkdownFenceState) -> [MarkdownHighlight] {
+    let safe = NSIntersectionRange(range, NSRange(location: 0, length: text.length))
+    if safe.length <= 0 { return [] }
+    let chars = [unichar](unsafeUninitializedCapacity: safe.length) { buffer, initialized in
+      text.getCharacters(buffer.baseAddress!, range: safe)
+      initialized = safe.length
+    }
+    return chars.withUnsafeBufferPointer { buffer in
+      let base = buffer.baseAddress!
+      let count = buffer.count
+      var out: [MarkdownHighlight] = []
+      var state = entryState
+      var idx = 0
+      var previousStart = 0
+      while true {
+        var lineEnd = idx
+        while lineEnd < count, base[lineEnd] != MarkdownCodeUnit.newline { lineEnd += 1 }
+        let lineLocation = safe.location + idx
+        let line = lineHighlights(in: text, chars: base + idx, count: lineEnd - idx, entryState: state)
+
+        let segmentStart = out.count
+        for span in line.spans {
+          out.append(MarkdownHighlight(
+            range: NSRange(location: span.range.location + lineLocation, length: span.range.length),
+            kind: span.kind
+          ))
+        }
+        // As in `MarkdownTokenizer`: a separator row makes the previous line a table header.
+        var nextPrevious = segmentStart
+        if idx > 1, line.spans.count == 1, line.spans[0].kind == .tableSeparator {
+          let cells = MarkdownTokenizer.tableHeaderCells(in: text, newlineAt: lineLocation - 1)
+          if !cells.isEmpty {
+            out.insert(contentsOf: cells, at: segmentStart)
+            nextPrevious += cells.count
+            out[previousStart..<nextPrevious].sort(by: MarkdownTokenizer.precedes)
+          }
+        }
+        previousStart = nextPrevious
+        state = line.exitState
+
+        if lineEnd >= count { break }
+        idx = lineEnd + 1
+      }
+      return out
+    }
+  }
+
+  private func lineHighlights(
+    in text: NSString,
+    chars: UnsafePointer<unichar>,
+    count: Int,
+    entryState: MarkdownFenceState
+  ) -> (spans: [MarkdownHighlight], exitState: MarkdownFenceState) {
+    // Empty lines carry no spans and don't move the fence state; not worth an entry.
+    if count == 0 { return ([], entryState) }
+
+    var hasher = Hasher()
+    hasher.combine(bytes: UnsafeRawBufferPointer(start: chars, count: count * MemoryLayout<unichar>.stride))
+    let key = Key(hash: hasher.finalize(), length: count, entryState: entryState)
+
+    lock.lock()
+    if let slot = slotByKey[key], slots[slot].units.withUnsafeBufferPointer({ memcmp($0.baseAddress!, chars, count * MemoryLayout<unichar>.stride) == 0 }) {
+      hits += 1
+      moveToNewest(slot)
+      let entry = slots[slot]
+      lock.unlock()
+      return (entry.spans, entry.exitState)
+    }
+    misses += 1
+    lock.unlock()
+
+    let scanned = MarkdownTokenizer.lineHighlights(in: text, chars: chars, count: count, entryState: entryState)
+    let entry = Entry(
+      key: key,
+      units: Array(UnsafeBufferPointer(start: chars, count: count)),
+      spans: scanned.highlights,
+      exitState: scanned.exitState
+    )
+    lock.lock()
+    store(entry)
+    lock.unlock()
+    return (scanned.highlights, scanned.exitState)
+  }
+
+  // MARK: - Recency list (caller holds `lock`)
+
+  private func store(_ entry: Entry) {
+    if let slot = slotByKey[entry.key] {
+      slots[slot].units = entry.units
+      slots[slot].spans = entry.spans
+      slots[slot].exitState = entry.exitState
+      moveToNewest(slot)
+      return
+    }
+    let slot: Int
+    if slots.count < capacity {
+      slots.append(entry)
+      slot = slots.count - 1
+    } else {
+      slot = oldest
+      unlink(slot)
+      slotByKey.removeValue(forKey: slots[slot].key)
+      slots[slot] = entry
+    }
+    slotByKey[entry.key] = slot
+    pushNewest(slot)
+  }
+
+  private func moveToNewest(_ slot: Int) {
+    guard slot != newest else { return }
+    unlink(slot)
+    pushNewest(slot)
+  }
+
+  private func unlink(_ slot: Int) {
+    let newer = slots[slot].newer
+    let older = slots[slot].older
+    if newer >= 0 { slots[newer].older = older } else { newest = older }
+    if older >= 0 { slots[older].newer = newer } else { oldest = newer }
+    slots[slot].newer = -1
+    slots[slot].older = -1
+  }
+
+  private func pushNewest(_ slot: Int) {
+    slots[slot].newer = -1
+    slots[slot].older = newest
+    if newest >= 0 { slots[newest].newer = slot }
+    newest = slot
+    if oldest < 0 { oldest = slot }
+  }
+}
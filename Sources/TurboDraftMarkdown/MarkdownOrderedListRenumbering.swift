@@ -1,5 +1,17 @@
 import Foundation
 
+/// A replacement of `range` with `replacement`, in the coordinates of the document it was
+/// computed against.
+public struct MarkdownTextEdit: Sendable, Equatable {
+  public let range: NSRange
+  public let replacement: String
+
+  public init(range: NSRange, replacement: String) {
+    self.range = range
+    self.replacement = replacement
+  }
+}
+
 public enum MarkdownOrderedListRenumbering {
   private struct OrderedLine {
     let lead: String
@@ -12,100 +24,91 @@ public enum MarkdownOrderedListRenumbering {
     pattern: #"^([ \t]*(?:>[ \t]*)*)(\d{1,9})([.)])([ \t]+)(.*)$"#
   )
 
-  /// Renumbers a contiguous ordered-list block around `cursor`.
+  /// The number rewrites that renumber the contiguous ordered-list block around `cursor`,
+  /// ascending and in `document`'s coordinates: one edit per item whose number is off, covering
+  /// just its digits. Only the block is read, line by line outward from the cursor's line; the
+  /// rest of the document isn't scanned or copied.
   ///
-  /// Returns `nil` when no renumbering is needed.
-  public static func renumber(document: String, around cursor: Int) -> String? {
+  /// Empty when no renumbering is needed.
+  public static func edits(in document: String, around cursor: Int) -> [MarkdownTextEdit] {
     let ns = document as NSString
-    guard ns.length > 0 else { return nil }
+    guard ns.length > 0 else { return [] }
 
-    let lines = allLineRanges(in: ns)
-    guard !lines.isEmpty else { return nil }
+    guard let anchorRange = nearestOrderedLineRange(in: ns, around: cursor),
+          let anchor = parseOrderedLine(in: ns, lineRange: anchorRange)
+    else { return [] }
 
-    let anchorIndex = nearestOrderedLineIndex(in: ns, lines: lines, around: cursor)
-    guard let anchorIndex else { return nil }
-
-    guard let anchor = parseOrderedLine(in: ns, lineRange: lines[anchorIndex]) else {
-      return nil
+    func sameBlock(_ line: OrderedLine) -> Bool {
+      line.lead == anchor.lead && line.delimiter == anchor.delimiter
     }
 
-    var start = anchorIndex
-    while start > 0,
-          let prev = parseOrderedLine(in: ns, lineRange: lines[start - 1]),
-          prev.lead == anchor.lead,
-          prev.delimiter == anchor.delimiter
+    var before: [OrderedLine] = []
+    var lineRange = anchorRange
+    while let prevRange = previousLineRange(in: ns, before: lineRange),
+          let prev = parseOrderedLine(in: ns, lineRange: prevRange), sameBlock(prev)
     {
-      start -= 1
+      before.append(prev)
+      lineRange = prevRange
     }
 
-    var end = anchorIndex
-    while end + 1 < lines.count,
-          let next = parseOrderedLine(in: ns, lineRange: lines[end + 1]),
-          next.lead == anchor.lead,
-          next.delimiter == anchor.delimiter
+    var block = Array(before.reversed())
+    block.append(anchor)
+    lineRange = anchorRange
+    while let nextRange = nextLineRange(in: ns, after: lineRange),
+          let next = parseOrderedLine(in: ns, lineRange: nextRange), sameBlock(next)
     {
-      end += 1
+      block.append(next)
+      lineRange = nextRange
     }
 
-    guard start <= end else { return nil }
-
-    var orderedLines: [OrderedLine] = []
-    orderedLines.reserveCapacity(end - start + 1)
-    for i in start...end {
-      guard let parsed = parseOrderedLine(in: ns, lineRange: lines[i]) else {
-        return nil
-      }
-      orderedLines.append(parsed)
+    let startNumber = max(1, block[0].number)
+    var out: [MarkdownTextEdit] = []
+    for (offset, line) in block.enumerated() where line.number != startNumber + offset {
+      out.append(MarkdownTextEdit(range: line.numberRange, replacement: "\(startNumber + offset)"))
     }
+    return out
+  }
 
-    guard let first = orderedLines.first else { return nil }
-    let startNumber = max(1, first.number)
-
+  /// Renumbers a contiguous ordered-list block around `cursor`: `document` with
+  /// `edits(in:around:)` applied.
+  ///
+  /// Returns `nil` when no renumbering is needed.
+  public static func renumber(document: String, around cursor: Int) -> String? {
+    let edits = edits(in: document, around: cursor)
+    guard !edits.isEmpty else { return nil }
     let mutable = NSMutableString(string: document)
-    var changed = false
-    for (offset, line) in orderedLines.enumerated().reversed() {
-      let expected = startNumber + offset
-      if line.number == expected { continue }
-      mutable.replaceCharacters(in: line.numberRange, with: "\(expected)")
-      changed = true
+    for edit in edits.reversed() {
+      mutable.replaceCharacters(in: edit.range, with: edit.replacement)
     }
-
-    guard changed else { return nil }
     return mutable as String
   }
 
-  private static func allLineRanges(in ns: NSString) -> [NSRange] {
-    var ranges: [NSRange] = []
-    var idx = 0
-    while idx <= ns.length {
-      let range = ns.lineRange(for: NSRange(location: idx, length: 0))
-      ranges.append(range)
-      let next = NSMaxRange(range)
-      if next >= ns.length { break }
-      idx = next
-    }
-    return ranges
+  private static func previousLineRange(in ns: NSString, before lineRange: NSRange) -> NSRange? {
+    guard lineRange.location > 0 else { return nil }
+    return ns.lineRange(for: NSRange(location: lineRange.location - 1, length: 0))
+  }
+
+  /// Nil past the last line; a trailing newline doesn't start an empty one.
+  private static func nextLineRange(in ns: NSString, after lineRange: NSRange) -> NSRange? {
+    let next = NSMaxRange(lineRange)
+    guard next < ns.length else { return nil }
+    return ns.lineRange(for: NSRange(location: next, length: 0))
   }
 
-  private static func nearestOrderedLineIndex(in ns: NSString, lines: [NSRange], around cursor: Int) -> Int? {
+  /// The cursor's line if it's an ordered item, else the line above, else the one below.
+  private static func nearestOrderedLineRange(in ns: NSString, around cursor: Int) -> NSRange? {
     let clamped = max(0, min(cursor, ns.length))
-    var containing: Int?
-    for (i, lineRange) in lines.enumerated() {
-      if NSLocationInRange(clamped, lineRange) || (clamped == NSMaxRange(lineRange) && clamped == ns.length) {
-        containing = i
-        break
-      }
-    }
-    guard let idx = containing else { return nil }
+    // At the very end, after a trailing newline, the cursor belongs to the last line.
+    let containing = ns.lineRange(for: NSRange(location: clamped == ns.length ? clamped - 1 : clamped, length: 0))
 
-    if parseOrderedLine(in: ns, lineRange: lines[idx]) != nil {
-      return idx
+    if parseOrderedLine(in: ns, lineRange: containing) != nil {
+      return containing
     }
-    if idx > 0, parseOrderedLine(in: ns, lineRange: lines[idx - 1]) != nil {
-      return idx - 1
+    if let prev = previousLineRange(in: ns, before: containing), parseOrderedLine(in: ns, lineRange: prev) != nil {
+      return prev
     }
-    if idx + 1 < lines.count, parseOrderedLine(in: ns, lineRange: lines[idx + 1]) != nil {
-      return idx + 1
+    if let next = nextLineRange(in: ns, after: containing), parseOrderedLine(in: ns, lineRange: next) != nil {
+      return next
     }
     return nil
   }
@@ -0,0 +1,160 @@
+import Foundation
+
+/// The parts of a document whose highlight attributes are current, as sorted, disjoint UTF-16
+/// ranges.
+///
+/// The editor inserts what it styles and removes what edits invalidate; `gaps(in:)` then tells
+/// it which parts of a requested range still need work, so scrolling back over styled text or
+/// restyling an edited line never touches clean regions. Not thread-safe; owned by the editor.
+public struct MarkdownStyledRanges: Sendable, Equatable {
+  public private(set) var ranges: [NSRange] = []
+
+  public init() {}
+
+  /// Total UTF-16 length covered.
+  public var styledLength: Int {
+    ranges.reduce(0) { $0 + $1.length }
+  }
+
+  public mutating func removeAll() {
+    ranges.removeAll(keepingCapacity: true)
+  }
+
+  /// Marks `range` as styled, merging with any range it overlaps or touches.
+  public mutating func insert(_ range: NSRange) {
+    guard range.length > 0 else { return }
+    let lo = firstIndex { NSMaxRange($0) >= range.location }
+    let hi = firstIndex { $0.location > NSMaxRange(range) }
+    var merged = range
+    if lo < hi {
+      merged = NSUnionRange(NSUnionRange(ranges[lo], ranges[hi - 1]), range)
+    }
+    ranges.replaceSubrange(lo..<hi, with: CollectionOfOne(merged))
+  }
+
+  /// Marks `range` as needing styling again.
+  public mutating func remove(_ range: NSRange) {
+    guard range.length > 0 else { return }
+    let end = NSMaxRange(range)
+    let lo = firstIndex { NSMaxRange($0) > range.location }
+    let hi = firstIndex { $0.location >= end }
+    guard lo < hi else { return }
+    var kept: [NSRange] = []
+    if ranges[lo].location < range.location {
+      kept.append(NSRange(location: ranges[lo].location, length: range.location - ranges[lo].location))
+    }
+    let lastEnd = NSMaxRange(ranges[hi - 1])
+    if lastEnd > end {
+      kept.append(NSRange(location: end, length: lastEnd - end))
+    }
+    ranges.replaceSubrange(lo..<hi, with: kept)
+  }
+
+  /// The unstyled subranges of `range`, in order.
+  public func gaps(in range: NSRange) -> [NSRange] {
+    guard range.length > 0 else { return [] }
+    let end = NSMaxRange(range)
+    var out: [NSRange] = []
+    var cursor = range.location
+    var i = firstIndex { NSMaxRange($0) > range.location }
+    while cursor < end {
+      guard i < ranges.count, ranges[i].location < end else {
+        out.append(NSRange(location: cursor, length: end - cursor))
+        break
+      }
+      if ranges[i].location > cursor {
+        out.append(NSRange(location: cursor, length: ranges[i].location - cursor))
+      }
+      cursor = NSMaxRange(ranges[i])
+      i += 1
+    }
+    return out
+  }
+
+  public func contains(_ range: NSRange) -> Bool {
+    gaps(in: range).isEmpty
+  }
+
+  /// Folds a character edit in: the replaced text is dropped and everything after it shifts by
+  /// `changeInLength`. `editedRange` is in post-edit coordinates, as `NSTextStorage` reports it.
+  /// The inserted text starts out unstyled.
+  public mutating func applyEdit(editedRange: NSRange, changeInLength delta: Int) {
+    let location = editedRange.location
+    let oldEnd = NSMaxRange(editedRange) - delta
+    guard location >= 0, oldEnd >= location else {
+      removeAll()
+      return
+    }
+    remove(NSRange(location: location, length: oldEnd - location))
+    guard delta != 0 else { return }
+
+    var i = firstIndex { NSMaxRange($0) > location }
+    if i < ranges.count, ranges[i].location < location {
+      // A pure insertion inside a styled range splits it around the new text.
+      let head = NSRange(location: ranges[i].location, length: location - ranges[i].location)
+      let tail = NSRange(location: location, length: NSMaxRange(ranges[i]) - location)
+      ranges.replaceSubrange(i...i, with: [head, tail])
+      i += 1
+    }
+    while i < ranges.count {
+      ranges[i].location += delta
+      i += 1
+    }
+  }
+
+  /// Folds in several edits made in one pass, as if each were applied with `applyEdit` in turn.
+  /// `edits` are the replaced ranges in pre-edit coordinates, ascending and non-overlapping,
+  /// with the length of the text that replaced each. One walk over `ranges`, so a replace-all
+  /// with thousands of matches costs the same as a single edit.
+  public mutating func applyEdits(_ edits: [(range: NSRange, replacementLength: Int)]) {
+    guard !edits.isEmpty else { return }
+    var out: [NSRange] = []
+    out.reserveCapacity(ranges.count + edits.count)
+    func keep(_ location: Int, _ length: Int) {
+      if let last = out.last, NSMaxRange(last) == location {
+        out[out.count - 1].length += length
+      } else {
+        out.append(NSRange(location: location, length: length))
+      }
+    }
+
+    var e = 0
+    var delta = 0
+    for range in ranges {
+      var start = range.location
+      let end = NSMaxRange(range)
+      while start < end {
+        while e < edits.count, NSMaxRange(edits[e].range) <= start {
+          delta += edits[e].replacementLength - edits[e].range.length
+          e += 1
+        }
+        guard e < edits.count, edits[e].range.location < end else {
+          keep(start + delta, end - start)
+          break
+        }
+        // The next edit ends after `start` and begins before `end`: keep what precedes it.
+        let editStart = edits[e].range.location
+        if editStart > start {
+          keep(start + delta, editStart - start)
+        }
+        start = max(start, NSMaxRange(edits[e].range))
+      }
+    }
+    ranges = out
+  }
+
+  /// Index of the first range satisfying `predicate`, which must be monotonic over `ranges`.
+  private func firstIndex(where predicate: (NSRange) -> Bool) -> Int {
+    var lo = 0
+    var hi = ranges.count
+    while lo < hi {
+      let mid = (lo + hi) / 2
+      if predicate(ranges[mid]) {
+        hi = mid
+      } else {
+        lo = mid + 1
+      }
+    }
+    return lo
+  }
+}
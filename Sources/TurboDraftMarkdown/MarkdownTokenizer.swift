@@ -0,0 +1,677 @@
+import Foundation
+
+/// UTF-16 code unit classes, matching the ICU regex semantics `MarkdownRegexHighlighter` was
+/// written against.
+enum MarkdownCodeUnit {
+  static let tab: unichar = 0x09
+  static let newline: unichar = 0x0A
+  static let space: unichar = 0x20
+  static let bang: unichar = 0x21
+  static let hash: unichar = 0x23
+  static let leftParen: unichar = 0x28
+  static let rightParen: unichar = 0x29
+  static let asterisk: unichar = 0x2A
+  static let plus: unichar = 0x2B
+  static let comma: unichar = 0x2C
+  static let dash: unichar = 0x2D
+  static let dot: unichar = 0x2E
+  static let slash: unichar = 0x2F
+  static let colon: unichar = 0x3A
+  static let semicolon: unichar = 0x3B
+  static let lessThan: unichar = 0x3C
+  static let equals: unichar = 0x3D
+  static let greaterThan: unichar = 0x3E
+  static let question: unichar = 0x3F
+  static let leftBracket: unichar = 0x5B
+  static let rightBracket: unichar = 0x5D
+  static let underscore: unichar = 0x5F
+  static let backtick: unichar = 0x60
+  static let pipe: unichar = 0x7C
+  static let tilde: unichar = 0x7E
+
+  /// ICU `\s`: `[\t\n\f\r\p{Z}]`. Vertical tab and U+0085 are not included.
+  @inline(__always)
+  static func isSpace(_ c: unichar) -> Bool {
+    if c < 0x80 {
+      return c == space || c == tab || c == newline || c == 0x0C || c == 0x0D
+    }
+    return c == 0x2028 || c == 0x2029 || isSpaceSeparator(c)
+  }
+
+  /// Code units `.` does not match and `$` stops in front of.
+  @inline(__always)
+  static func isLineTerminator(_ c: unichar) -> Bool {
+    (c >= 0x0A && c <= 0x0D) || c == 0x85 || c == 0x2028 || c == 0x2029
+  }
+
+  /// `CharacterSet.whitespaces`: tab plus general category Zs.
+  @inline(__always)
+  static func isHorizontalSpace(_ c: unichar) -> Bool {
+    c == space || c == tab || (c >= 0x80 && isSpaceSeparator(c))
+  }
+
+  /// `[A-Za-z0-9_]`, or `CharacterSet.alphanumerics` outside ASCII.
+  static func isWordish(_ c: unichar) -> Bool {
+    if c < 0x80 {
+      return (c >= 0x30 && c <= 0x39) || (c >= 0x41 && c <= 0x5A) || (c >= 0x61 && c <= 0x7A) || c == underscore
+    }
+    guard let scalar = UnicodeScalar(c) else { return false }
+    return CharacterSet.alphanumerics.contains(scalar)
+  }
+
+  @inline(__always)
+  static func isDigit(_ c: unichar) -> Bool {
+    c >= 0x30 && c <= 0x39
+  }
+
+  private static func isSpaceSeparator(_ c: unichar) -> Bool {
+    switch c {
+    case 0xA0, 0x1680, 0x2000...0x200A, 0x202F, 0x205F, 0x3000: return true
+    default: return false
+    }
+  }
+}
+
+extension MarkdownHighlightKind {
+  /// Tie-break for highlights with the same range: the alphabetical order of the case names,
+  /// which is what sorting by `String(describing:)` produced.
+  var tieBreakRank: Int {
+    switch self {
+    case .codeBlockLine: return 0
+    case .codeFenceDelimiter: return 1
+    case .codeFenceInfo: return 2
+    case .emphasisMarker: return 3
+    case .emphasisText: return 4
+    case .headerMarker: return 5
+    case .headerText: return 6
+    case .highlightMarker: return 7
+    case .highlightText: return 8
+    case .horizontalRule: return 9
+    case .inlineCodeDelimiter: return 10
+    case .inlineCodeText: return 11
+    case .linkPunctuation: return 12
+    case .linkText: return 13
+    case .linkURL: return 14
+    case .listMarker: return 15
+    case .quoteMarker: return 16
+    case .quoteText: return 17
+    case .strikethroughMarker: return 18
+    case .strikethroughText: return 19
+    case .strongMarker: return 20
+    case .strongText: return 21
+    case .tableHeaderText: return 22
+    case .tablePipe: return 23
+    case .tableSeparator: return 24
+    case let .taskBox(checked): return checked ? 26 : 25
+    case let .taskText(checked): return checked ? 28 : 27
+    }
+  }
+}
+
+/// Single-pass Markdown highlighter over UTF-16 code units.
+///
+/// Copies the requested range out of the string once, then walks it line by line, recognising
+/// the same block and inline constructs as `MarkdownRegexHighlighter` with hand-written
+/// matchers. Highlights are emitted per line and sorted within the line, so the result comes
+/// out in document order without a global sort or any per-line `String` bridging.
+///
+/// Where the regex engine relied on ICU classes the matchers use `MarkdownCodeUnit`; ordered
+/// list numbers accept ASCII digits only.
+enum MarkdownTokenizer {
+  static func highlights(in text: NSString, range: NSRange, entryState: MarkdownFenceState) -> [MarkdownHighlight] {
+    let chars = [unichar](unsafeUninitializedCapacity: range.length) { buffer, initialized in
+      text.getCharacters(buffer.baseAddress!, range: range)
+      initialized = range.length
+    }
+    return chars.withUnsafeBufferPointer { buffer in
+      var scanner = LineScanner(text: text, chars: buffer.baseAddress!, count: range.length, base: range.location, fence: entryState)
+      scanner.run()
+      return scanner.out
+    }
+  }
+
+  /// Highlights for the single line `chars[0..<count]` (no `\n`), with ranges relative to the
+  /// line start, and the fence state after it. `text` is the document the line came from.
+  static func lineHighlights(
+    in text: NSString,
+    chars: UnsafePointer<unichar>,
+    count: Int,
+    entryState: MarkdownFenceState
+  ) -> (highlights: [MarkdownHighlight], exitState: MarkdownFenceState) {
+    var scanner = LineScanner(text: text, chars: chars, count: count, base: 0, fence: entryState)
+    scanner.run()
+    return (scanner.out, scanner.fence)
+  }
+
+  static func precedes(_ a: MarkdownHighlight, _ b: MarkdownHighlight) -> Bool {
+    if a.range.location != b.range.location { return a.range.location < b.range.location }
+    if a.range.length != b.range.length { return a.range.length > b.range.length }
+    return a.kind.tieBreakRank < b.kind.tieBreakRank
+  }
+
+  /// Whether the line, trimmed of `CharacterSet.whitespaces`, starts or ends with `|`.
+  static func hasPipeEdge(_ u: UnsafePointer<unichar>, _ count: Int) -> Bool {
+    var lo = 0
+    var hi = count
+    while lo < hi, MarkdownCodeUnit.isHorizontalSpace(u[lo]) { lo += 1 }
+    while hi > lo, MarkdownCodeUnit.isHorizontalSpace(u[hi - 1]) { hi -= 1 }
+    return lo < hi && (u[lo] == MarkdownCodeUnit.pipe || u[hi - 1] == MarkdownCodeUnit.pipe)
+  }
+
+  private struct LineScanner {
+    private typealias C = MarkdownCodeUnit
+
+    let text: NSString
+    let chars: UnsafePointer<unichar>
+    let count: Int
+    let base: Int
+    var fence: MarkdownFenceState
+    var out: [MarkdownHighlight] = []
+
+    // Current line: `u[0..<len]` starting at document offset `lineBase`.
+    private var u: UnsafePointer<unichar>
+    private var len = 0
+    private var lineBase = 0
+    /// Line-local ranges already claimed by inline code, links and emphasis.
+    private var excluded: [NSRange] = []
+    private var tickRuns: [NSRange] = []
+
+    init(text: NSString, chars: UnsafePointer<unichar>, count: Int, base: Int, fence: MarkdownFenceState) {
+      self.text = text
+      self.chars = chars
+      self.count = count
+      self.base = base
+      self.fence = fence
+      self.u = chars
+    }
+
+    mutating func run() {
+      var idx = 0
+      var previousStart = 0
+      while true {
+        var lineEnd = idx
+        while lineEnd < count, chars[lineEnd] != C.newline { lineEnd += 1 }
+        u = chars + idx
+        len = lineEnd - idx
+        lineBase = base + idx
+
+        let segmentStart = out.count
+        processLine()
+        out[segmentStart...].sort(by: MarkdownTokenizer.precedes)
+
+        // A separator row makes the previous line a table header; its cells join that line's run.
+        var nextPrevious = segmentStart
+        if idx > 1, out.count - segmentStart == 1, out[segmentStart].kind == .tableSeparator {
+          let cells = MarkdownTokenizer.tableHeaderCells(in: text, newlineAt: lineBase - 1)
+          if !cells.isEmpty {
+            out.insert(contentsOf: cells, at: segmentStart)
+            nextPrevious += cells.count
+            out[previousStart..<nextPrevious].sort(by: MarkdownTokenizer.precedes)
+          }
+        }
+        previousStart = nextPrevious
+
+        if lineEnd >= count { break }
+        idx = lineEnd + 1
+      }
+    }
+
+    // MARK: - Line helpers
+
+    private mutating func add(_ location: Int, _ length: Int, _ kind: MarkdownHighlightKind) {
+      if length <= 0 { return }
+      out.append(MarkdownHighlight(range: NSRange(location: lineBase + location, length: length), kind: kind))
+    }
+
+    private func skipSpace(from i: Int, to end: Int? = nil) -> Int {
+      let end = end ?? len
+      var i = i
+      while i < end, C.isSpace(u[i]) { i += 1 }
+      return i
+    }
+
+    /// End of `(.*)$` starting at `i`, or nil when a line terminator sits before the last unit.
+    private func restEnd(from i: Int) -> Int? {
+      var j = i
+      while j < len, !C.isLineTerminator(u[j]) { j += 1 }
+      if j == len { return len }
+      return j == len - 1 ? j : nil
+    }
+
+    /// Where `\s*$` may stop: the line end, or just before one trailing terminator.
+    private var effectiveEnd: Int {
+      len > 0 && C.isLineTerminator(u[len - 1]) ? len - 1 : len
+    }
+
+    private func find(_ c: unichar, from i: Int) -> Int? {
+      var i = i
+      while i < len {
+        if u[i] == c { return i }
+        i += 1
+      }
+      return nil
+    }
+
+    private func isExcluded(_ location: Int, _ length: Int) -> Bool {
+      let r = NSRange(location: location, length: length)
+      for ex in excluded where NSIntersectionRange(ex, r).length > 0 {
+        return true
+      }
+      return false
+    }
+
+    // MARK: - Block structure
+
+    private mutating func processLine() {
+      if fenceLine() { return }
+
+      if fence.inFence {
+        add(0, len, .codeBlockLine)
+        return
+      }
+      if isHorizontalRule() {
+        add(0, len, .horizontalRule)
+        return
+      }
+      if isTableSeparator() {
+        add(0, len, .tableSeparator)
+        return
+      }
+
+      if let firstPipe = find(C.pipe, from: 0), MarkdownTokenizer.hasPipeEdge(u, len) {
+        for k in firstPipe..<len where u[k] == C.pipe {
+          add(k, 1, .tablePipe)
+        }
+      }
+
+      let lead = skipSpace(from: 0)
+      var isBlockquote = false
+      if lead < len, u[lead] == C.greaterThan {
+        var j = lead
+        while j < len, u[j] == C.greaterThan { j += 1 }
+        let textStart = skipSpace(from: j)
+        if let end = restEnd(from: textStart) {
+          isBlockquote = true
+          let level = j - lead
+          add(lead, level, .quoteMarker(level: level))
+          add(textStart, end - textStart, .quoteText(level: level))
+        }
+      }
+
+      if !isBlockquote, lead < len, u[lead] == C.hash {
+        var j = lead
+        while j < len, u[j] == C.hash { j += 1 }
+        let level = j - lead
+        if level <= 6, j < len, C.isSpace(u[j]) {
+          let textStart = skipSpace(from: j)
+          if let end = restEnd(from: textStart) {
+            add(lead, level, .headerMarker(level: level))
+            add(textStart, end - textStart, .headerText(level: level))
+          }
+        }
+      }
+
+      listMarker(lead)
+      inlineSpans()
+    }
+
+    /// `^\s*(`{3,}|~{3,})(.*)$`: emits the delimiter and info string and updates the fence state.
+    private mutating func fenceLine() -> Bool {
+      let i = skipSpace(from: 0)
+      guard i < len else { return false }
+      let c = u[i]
+      guard c == C.backtick || c == C.tilde else { return false }
+      var j = i
+      while j < len, u[j] == c { j += 1 }
+      guard j - i >= 3 else { return false }
+
+      add(i, j - i, .codeFenceDelimiter)
+      var infoEnd = j
+      while infoEnd < len, !C.isLineTerminator(u[infoEnd]) { infoEnd += 1 }
+      let infoStart = skipSpace(from: j, to: infoEnd)
+      add(infoStart, infoEnd - infoStart, .codeFenceInfo)
+
+      fence = fence.advanced(by: MarkdownFenceState(fenceChar: c, fenceLen: j - i))
+      return true
+    }
+
+    /// Three or more of one of `*`, `-`, `_`, optionally separated by whitespace.
+    private func isHorizontalRule() -> Bool {
+      let end = effectiveEnd
+      var i = skipSpace(from: 0, to: end)
+      guard i < end else { return false }
+      let c = u[i]
+      guard c == C.asterisk || c == C.dash || c == C.underscore else { return false }
+      var marks = 0
+      while i < end {
+        if u[i] == c {
+          marks += 1
+        } else if !C.isSpace(u[i]) {
+          return false
+        }
+        i += 1
+      }
+      return marks >= 3
+    }
+
+    /// `^\|?(\s*:?-+:?\s*\|)+\s*:?-+:?\s*\|?\s*$`: at least two dash cells.
+    private func isTableSeparator() -> Bool {
+      let end = effectiveEnd
+      var i = 0
+      if i < end, u[i] == C.pipe { i += 1 }
+      var cells = 0
+      while true {
+        i = skipSpace(from: i, to: end)
+        if i < end, u[i] == C.colon { i += 1 }
+        let dashes = i
+        while i < end, u[i] == C.dash { i += 1 }
+        if i == dashes { return false }
+        if i < end, u[i] == C.colon { i += 1 }
+        i = skipSpace(from: i, to: end)
+        cells += 1
+        if i >= end { break }
+        if u[i] != C.pipe { return false }
+        i += 1
+        if skipSpace(from: i, to: end) >= end { break }
+      }
+      return cells >= 2
+    }
+
+    /// `-`, `*`, `+` or `1.` / `1)` followed by whitespace, then an optional task box.
+    private mutating func listMarker(_ lead: Int) {
+      guard lead < len else { return }
+      let c = u[lead]
+      if c == C.dash || c == C.asterisk || c == C.plus, lead + 1 < len, C.isSpace(u[lead + 1]) {
+        let textStart = skipSpace(from: lead + 1)
+        if restEnd(from: textStart) != nil {
+          add(lead, textStart - lead, .listMarker)
+          taskBox(at: textStart)
+          return
+        }
+      }
+      guard C.isDigit(c) else { return }
+      var j = lead
+      while j < len, C.isDigit(u[j]) { j += 1 }
+      guard j - lead <= 9, j + 1 < len, u[j] == C.dot || u[j] == C.rightParen, C.isSpace(u[j + 1]) else { return }
+      let textStart = skipSpace(from: j + 1)
+      guard restEnd(from: textStart) != nil else { return }
+      add(lead, textStart - lead, .listMarker)
+      taskBox(at: textStart)
+    }
+
+    private mutating func taskBox(at start: Int) {
+      guard start + 2 < len, u[start] == C.leftBracket, u[start + 2] == C.rightBracket else { return }
+      let mid = u[start + 1]
+      let checked = mid == 0x78 /* x */ || mid == 0x58 /* X */
+      add(start, 3, .taskBox(checked: checked))
+      var textStart = start + 3
+      if textStart < len, u[textStart] == C.space { textStart += 1 }
+      add(textStart, len - textStart, .taskText(checked: checked))
+    }
+
+    // MARK: - Inline markup
+
+    private mutating func inlineSpans() {
+      excluded.removeAll(keepingCapacity: true)
+      inlineCode()
+      images()
+      bracketLinks(closer: C.rightParen)
+      autoLinks()
+      bracketLinks(closer: C.rightBracket)
+      linkDefinition()
+      bareURLs()
+      delimited(C.asterisk, C.underscore, 2, marker: .strongMarker, body: .strongText)
+      delimited(C.asterisk, C.underscore, 1, marker: .emphasisMarker, body: .emphasisText)
+      delimited(C.tilde, nil, 2, marker: .strikethroughMarker, body: .strikethroughText)
+      delimited(C.equals, nil, 2, marker: .highlightMarker, body: .highlightText)
+    }
+
+    /// Pairs consecutive backtick runs of equal length; unmatched runs are skipped one at a time.
+    private mutating func inlineCode() {
+      tickRuns.removeAll(keepingCapacity: true)
+      var k = 0
+      while k < len {
+        guard u[k] == C.backtick else {
+          k += 1
+          continue
+        }
+        let start = k
+        while k < len, u[k] == C.backtick { k += 1 }
+        tickRuns.append(NSRange(location: start, length: k - start))
+      }
+      var i = 0
+      while i + 1 < tickRuns.count {
+        let open = tickRuns[i]
+        let close = tickRuns[i + 1]
+        if open.length != close.length {
+          i += 1
+          continue
+        }
+        let contentStart = NSMaxRange(open)
+        let contentLen = close.location - contentStart
+        if contentLen > 0 {
+          add(open.location, open.length, .inlineCodeDelimiter)
+          add(close.location, close.length, .inlineCodeDelimiter)
+          add(contentStart, contentLen, .inlineCodeText)
+          excluded.append(NSRange(location: open.location, length: NSMaxRange(close) - open.location))
+        }
+        i += 2
+      }
+    }
+
+    /// `![alt](url)`; the alt text may be empty.
+    private mutating func images() {
+      var p = 0
+      while p + 1 < len {
+        if u[p] == C.bang, u[p + 1] == C.leftBracket,
+           let q = find(C.rightBracket, from: p + 2), q + 1 < len, u[q + 1] == C.leftParen,
+           let r = find(C.rightParen, from: q + 2), r > q + 2
+        {
+          if !isExcluded(p, r + 1 - p) {
+            add(p + 2, q - p - 2, .linkText)
+            add(q + 2, r - q - 2, .linkURL)
+            for at in [p, p + 1, q, q + 1, r] {
+              add(at, 1, .linkPunctuation)
+            }
+            excluded.append(NSRange(location: p, length: r + 1 - p))
+          }
+          p = r + 1
+          continue
+        }
+        p += 1
+      }
+    }
+
+    /// `[text](url)` when `closer` is `)`, `[text][id]` when it is `]`.
+    private mutating func bracketLinks(closer: unichar) {
+      let opener = closer == C.rightParen ? C.leftParen : C.leftBracket
+      var p = 0
+      while p < len {
+        if u[p] == C.leftBracket,
+           let q = find(C.rightBracket, from: p + 1), q > p + 1, q + 1 < len, u[q + 1] == opener,
+           let r = find(closer, from: q + 2), r > q + 2
+        {
+          if !isExcluded(p, r + 1 - p) {
+            add(p + 1, q - p - 1, .linkText)
+            add(q + 2, r - q - 2, .linkURL)
+            for at in [p, q, q + 1, r] {
+              add(at, 1, .linkPunctuation)
+            }
+            excluded.append(NSRange(location: p, length: r + 1 - p))
+          }
+          p = r + 1
+          continue
+        }
+        p += 1
+      }
+    }
+
+    /// `<http://...>` / `<https://...>`.
+    private mutating func autoLinks() {
+      var p = 0
+      while p < len {
+        if u[p] == C.lessThan, let s = schemeEnd(at: p + 1), let r = find(C.greaterThan, from: s), r > s {
+          if !isExcluded(p, r + 1 - p) {
+            add(p + 1, r - p - 1, .linkURL)
+            add(p, 1, .linkPunctuation)
+            add(r, 1, .linkPunctuation)
+            excluded.append(NSRange(location: p, length: r + 1 - p))
+          }
+          p = r + 1
+          continue
+        }
+        p += 1
+      }
+    }
+
+    /// `[label]: url` at the start of the line. Like the regex rule, it claims the whole line
+    /// without checking earlier spans.
+    private mutating func linkDefinition() {
+      let lead = skipSpace(from: 0)
+      guard lead < len, u[lead] == C.leftBracket,
+            let q = find(C.rightBracket, from: lead + 1), q > lead + 1
+      else { return }
+      let colon = skipSpace(from: q + 1)
+      guard colon < len, u[colon] == C.colon else { return }
+      let urlStart = skipSpace(from: colon + 1)
+      var urlEnd = urlStart
+      while urlEnd < len, !C.isSpace(u[urlEnd]) { urlEnd += 1 }
+      guard urlEnd > urlStart, let end = restEnd(from: urlEnd) else { return }
+      add(lead + 1, q - lead - 1, .linkText)
+      add(urlStart, urlEnd - urlStart, .linkURL)
+      add(lead, 1, .linkPunctuation)
+      add(q, 1, .linkPunctuation)
+      add(q + 1, urlStart - q - 1, .linkPunctuation)
+      excluded.append(NSRange(location: 0, length: end))
+    }
+
+    /// `https?://` runs up to whitespace or `<>()[]`, minus trailing sentence punctuation.
+    private mutating func bareURLs() {
+      var p = 0
+      while p < len {
+        guard let s = schemeEnd(at: p) else {
+          p += 1
+          continue
+        }
+        var e = s
+        while e < len, !C.isSpace(u[e]), !isURLStop(u[e]) { e += 1 }
+        guard e > s else {
+          p += 1
+          continue
+        }
+        if !isExcluded(p, e - p) {
+          var t = e
+          while t > p, isTrailingURLPunctuation(u[t - 1]) { t -= 1 }
+          if t > p {
+            add(p, t - p, .linkURL)
+            excluded.append(NSRange(location: p, length: t - p))
+          }
+        }
+        p = e
+      }
+    }
+
+    /// Offset just past `http://` or `https://` starting at `p`.
+    private func schemeEnd(at p: Int) -> Int? {
+      guard p + 4 <= len, u[p] == 0x68, u[p + 1] == 0x74, u[p + 2] == 0x74, u[p + 3] == 0x70 else { return nil }
+      var k = p + 4
+      if k < len, u[k] == 0x73 { k += 1 }
+      guard k + 3 <= len, u[k] == C.colon, u[k + 1] == C.slash, u[k + 2] == C.slash else { return nil }
+      return k + 3
+    }
+
+    private func isURLStop(_ c: unichar) -> Bool {
+      c == C.lessThan || c == C.greaterThan || c == C.leftParen || c == C.rightParen
+        || c == C.leftBracket || c == C.rightBracket
+    }
+
+    private func isTrailingURLPunctuation(_ c: unichar) -> Bool {
+      c == C.dot || c == C.comma || c == C.semicolon || c == C.colon || c == C.bang || c == C.question
+    }
+
+    /// `M(?=\S)(.+?)(?<=\S)M` for a marker of `n` repeats of `c1` (or `c2`). Underscore markers
+    /// must not touch word characters on either side, so `a_b_c` stays plain.
+    private mutating func delimited(
+      _ c1: unichar,
+      _ c2: unichar?,
+      _ n: Int,
+      marker: MarkdownHighlightKind,
+      body: MarkdownHighlightKind
+    ) {
+      var p = 0
+      while p + n < len {
+        let c = u[p]
+        guard c == c1 || c == c2, repeats(c, at: p, n), !C.isSpace(u[p + n]), !C.isLineTerminator(u[p + n]) else {
+          p += 1
+          continue
+        }
+        // Lazy body: the first closing marker preceded by a non-space, without crossing a terminator.
+        var close: Int?
+        var e = p + n + 1
+        while e + n <= len {
+          if C.isLineTerminator(u[e - 1]) { break }
+          if !C.isSpace(u[e - 1]), repeats(c, at: e, n) {
+            close = e
+            break
+          }
+          e += 1
+        }
+        guard let close else {
+          p += 1
+          continue
+        }
+        let end = close + n
+        if !isExcluded(p, end - p), c != C.underscore || isWordBoundary(p, end) {
+          add(p, n, marker)
+          add(close, n, marker)
+          add(p + n, close - p - n, body)
+          excluded.append(NSRange(location: p, length: end - p))
+        }
+        p = end
+      }
+    }
+
+    private func repeats(_ c: unichar, at p: Int, _ n: Int) -> Bool {
+      for k in 0..<n where u[p + k] != c {
+        return false
+      }
+      return true
+    }
+
+    private func isWordBoundary(_ start: Int, _ end: Int) -> Bool {
+      if start > 0, C.isWordish(u[start - 1]) { return false }
+      if end < len, C.isWordish(u[end]) { return false }
+      return true
+    }
+  }
+
+  /// `tableHeaderText` for the cells of the line ending at the newline `newlineAt`, which may
+  /// start before the scanned range.
+  static func tableHeaderCells(in text: NSString, newlineAt: Int) -> [MarkdownHighlight] {
+    let lineRange = text.lineRange(for: NSRange(location: newlineAt, length: 0))
+    let line = [unichar](unsafeUninitializedCapacity: lineRange.length) { buffer, initialized in
+      text.getCharacters(buffer.baseAddress!, range: lineRange)
+      initialized = lineRange.length
+    }
+    return line.withUnsafeBufferPointer { buffer -> [MarkdownHighlight] in
+      let h = buffer.baseAddress!
+      guard MarkdownTokenizer.hasPipeEdge(h, buffer.count) else { return [] }
+      var cells: [MarkdownHighlight] = []
+      var previousPipe: Int?
+      for k in 0..<buffer.count where h[k] == MarkdownCodeUnit.pipe {
+        defer { previousPipe = k }
+        guard let open = previousPipe, k > open + 1 else { continue }
+        var cellStart = open + 1
+        var cellEnd = k
+        while cellStart < cellEnd, h[cellStart] == MarkdownCodeUnit.space { cellStart += 1 }
+        while cellEnd > cellStart, h[cellEnd - 1] == MarkdownCodeUnit.space { cellEnd -= 1 }
+        guard cellEnd > cellStart else { continue }
+        cells.append(MarkdownHighlight(
+          range: NSRange(location: lineRange.location + cellStart, length: cellEnd - cellStart),
+          kind: .tableHeaderText
+        ))
+      }
+      return cells
+    }
+  }
+}
@@ -0,0 +1,50 @@
+import Darwin
+
+/// Counts heap allocations made on one thread through libmalloc's `malloc_logger` hook: the
+/// same hook malloc stack logging uses, called for every `malloc`/`calloc`/`realloc` in every
+/// zone, typed or not. Setting the hook moves malloc off its fastest path, so the bench never
+/// times a batch while counting.
+///
+/// Unavailable (`isAvailable == false`) when the symbol can't be found; allocations are then
+/// reported as unknown rather than zero.
+enum AllocationCounter {
+  private typealias Logger = @convention(c) (UInt32, UInt, UInt, UInt, UInt, UInt32) -> Void
+
+  private static let hook: UnsafeMutablePointer<Logger?>? = {
+    // RTLD_DEFAULT
+    guard let sym = dlsym(UnsafeMutableRawPointer(bitPattern: -2), "malloc_logger") else { return nil }
+    return sym.assumingMemoryBound(to: Logger?.self)
+  }()
+
+  static var isAvailable: Bool { hook != nil }
+
+  /// Allocations `body` made on the calling thread, or nil when counting is unavailable or the
+  /// process already has a logger installed (malloc stack logging is on).
+  static func count(_ body: () -> Void) -> Int? {
+    guard let hook, hook.pointee == nil else {
+      body()
+      return nil
+    }
+    countedThread = pthread_self()
+    allocations = 0
+    hook.pointee = logger
+    body()
+    hook.pointee = nil
+    countedThread = nil
+    return allocations
+  }
+
+  // Written only by the counted thread while the hook is installed; other threads just compare.
+  private static var countedThread: pthread_t?
+  private static var allocations = 0
+
+  // Runs inside malloc: no allocation, and only statics that `count` has already touched.
+  private static let logger: Logger = { type, _, _, _, _, _ in
+    // MALLOC_LOG_TYPE_ALLOCATE (libmalloc stack_logging.h); reallocs set it too.
+    guard type & 2 != 0,
+          let thread = AllocationCounter.countedThread,
+          pthread_equal(pthread_self(), thread) != 0
+    else { return }
+    AllocationCounter.allocations += 1
+  }
+}
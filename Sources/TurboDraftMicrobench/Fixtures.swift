@@ -0,0 +1,88 @@
+import Foundation
+
+/// Documents the microbench sweeps, each grown to an exact size by repeating a seed text.
+enum MicrobenchFixture {
+  enum Kind: String, CaseIterable {
+    /// `bench/preambles/*.md`: headings, lists, emphasis, inline code; what drafts look like.
+    case prose
+    /// Mostly fenced code blocks, alternating backtick and tilde fences, with prose between.
+    case fences
+    /// Pipe tables with inline markup in the cells.
+    case tables
+  }
+
+  static let sizes: [(label: String, bytes: Int)] = [
+    ("1k", 1_000),
+    ("16k", 16_000),
+    ("256k", 256_000),
+    ("1m", 1_000_000),
+    ("5m", 5_000_000),
+  ]
+
+  static func seed(_ kind: Kind, preambleDir: URL?) -> String {
+    switch kind {
+    case .prose:
+      if let dir = preambleDir,
+         let names = try? FileManager.default.contentsOfDirectory(atPath: dir.path) {
+        let texts = names.filter { $0.hasSuffix(".md") }.sorted().compactMap {
+          try? String(contentsOf: dir.appendingPathComponent($0), encoding: .utf8)
+        }
+        if !texts.isEmpty { return texts.joined(separator: "\n\n") }
+      }
+      return syntheticProse
+    case .fences:
+      return (0..<8).map { i in
+        let fence = i.isMultiple(of: 2) ? "```" : "~~~~"
+        return """
+        Step \(i): run the **migration** and check `status_\(i)`.
+
+        \(fence)swift
+        let value\(i) = try store.load(id: "\(i)") // # not a heading
+        for item in value\(i).items where item.isDirty {
+          print("- [ ] \\(item.name) **\\(item.count)**")
+        }
+        \(fence)
+
+        """
+      }.joined()
+    case .tables:
+      var rows = ["| Key | Value | Notes |", "|:----|------:|-------|"]
+      for i in 0..<24 {
+        rows.append("| `key_\(i)` | \(i * 37) | **bold** _em_ ~~old~~ [link](https://example.com/\(i)) |")
+      }
+      return "## Table\n\n" + rows.joined(separator: "\n") + "\n\n"
+    }
+  }
+
+  /// `seed` repeated to exactly `bytes` UTF-8 bytes, cut at a character boundary.
+  static func text(_ kind: Kind, bytes: Int, preambleDir: URL?) -> String {
+    let unit = Array(Self.seed(kind, preambleDir: preambleDir).utf8)
+    var out = [UInt8]()
+    out.reserveCapacity(bytes)
+    while !unit.isEmpty, out.count < bytes {
+      out.append(contentsOf: unit.prefix(bytes - out.count))
+    }
+    // Drop a trailing partial UTF-8 sequence.
+    if var lead = out.indices.last {
+      while lead > 0, out[lead] & 0xC0 == 0x80 { lead -= 1 }
+      let b = out[lead]
+      let length = b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : b >= 0xC0 ? 2 : 1
+      if out.count - lead < length { out.removeSubrange(lead...) }
+    }
+    return String(decoding: out, as: UTF8.self)
+  }
+
+  private static let syntheticProse = """
+  # Draft
+
+  Rewrite the **onboarding** flow so new users can _skip_ the tour.
+
+  - Keep the `--dry-run` flag
+  - [ ] Add tests for the *empty* state
+  1. Measure first paint
+  2. Compare against [the baseline](https://example.com/baseline)
+
+  > Note: the old flow stays behind a flag.
+
+  """
+}
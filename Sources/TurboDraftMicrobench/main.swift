@@ -0,0 +1,293 @@
+import AppKit
+import Darwin
+import Foundation
+import TurboDraftCore
+import TurboDraftMarkdown
+import TurboDraftTransport
+
+enum MicrobenchError: Error {
+  case invalidArgs(String)
+}
+
+/// Same shape as `turbodraft-bench bench run --out`, so `bench check --compare` runs its
+/// Mann-Whitney comparison on microbench results key by key.
+struct BenchRunResult: Codable {
+  var timestamp: String
+  var osVersion: String
+  var warmN: Int
+  var coldN: Int
+  var warmupDiscard: Int
+  var metrics: [String: Double]
+  var rawSamples: [String: [Double]]
+}
+
+@inline(never)
+func blackHole<T>(_ value: T) {
+  withExtendedLifetime(value) {}
+}
+
+struct Microbench {
+  typealias Kind = MicrobenchFixture.Kind
+
+  /// One engine entry point. `prepare` builds whatever the op needs for a fixture (outside the
+  /// timing) and returns the op. Files it needs go under `scratchDirectory`, which is removed
+  /// after each case.
+  struct Case {
+    var name: String
+    var kinds: [Kind]
+    var prepare: (String) throws -> () -> Void
+  }
+
+  let args: [String]
+
+  static let scratchDirectory = FileManager.default.temporaryDirectory
+    .appendingPathComponent("turbodraft-microbench-\(getpid())", isDirectory: true)
+
+  static let helpText = """
+turbodraft-microbench
+
+Per-op cost of the core engines across document sizes (1 KB to 5 MB) and shapes:
+  turbodraft-microbench [--cases a,b] [--kinds prose,fences,tables] [--sizes 1k,16k,256k,1m,5m]
+                        [--samples N] [--max-seconds-per-case N] [--preamble-dir <dir>] [--out <file.json>]
+
+Cases: \(cases.map(\.name).joined(separator: ", "))
+Compare two runs: turbodraft-bench bench check --compare <before.json> --results <after.json>
+"""
+
+  func run() throws {
+    if args.contains("--help") {
+      print(Self.helpText)
+      return
+    }
+    let samples = max(3, argInt("--samples") ?? 15)
+    let maxSecondsPerCase = Double(argValue("--max-seconds-per-case") ?? "5") ?? 5
+    let selectedCases = try select(argValue("--cases"), from: Self.cases.map(\.name), what: "case")
+    let selectedKinds = try select(argValue("--kinds"), from: Kind.allCases.map(\.rawValue), what: "kind")
+    let selectedSizes = try select(argValue("--sizes"), from: MicrobenchFixture.sizes.map(\.label), what: "size")
+    let preambleDir = argValue("--preamble-dir").map { URL(fileURLWithPath: $0, isDirectory: true) }
+      ?? URL(fileURLWithPath: "bench/preambles", isDirectory: true)
+
+    if !AllocationCounter.isAvailable {
+      fputs("WARNING: malloc_logger not found; allocations per op are not reported\n", stderr)
+    }
+
+    var metrics: [String: Double] = [:]
+    var rawSamples: [String: [Double]] = [:]
+    func pad(_ s: String, _ width: Int) -> String {
+      s.count >= width ? s + " " : s.padding(toLength: width, withPad: " ", startingAt: 0)
+    }
+    func padLeft(_ s: String, _ width: Int) -> String {
+      String(repeating: " ", count: max(0, width - s.count)) + s
+    }
+    print(pad("Case", 16) + pad("Fixture", 8) + [padLeft("Size", 5), padLeft("ns/op p50", 14), padLeft("ns/op p95", 14), padLeft("MB/s", 10), padLeft("allocs/op", 10)].joined(separator: " "))
+    print(String(repeating: "-", count: 81))
+    for size in MicrobenchFixture.sizes where selectedSizes.contains(size.label) {
+      for kind in Kind.allCases where selectedKinds.contains(kind.rawValue) {
+        let text = MicrobenchFixture.text(kind, bytes: size.bytes, preambleDir: preambleDir)
+        let bytes = Double(text.utf8.count)
+        for benchCase in Self.cases where selectedCases.contains(benchCase.name) && benchCase.kinds.contains(kind) {
+          let op = try benchCase.prepare(text)
+          let result = measure(op, samples: samples, maxSeconds: maxSecondsPerCase)
+          try? FileManager.default.removeItem(at: Self.scratchDirectory)
+          let median = percentile(result.nsPerOp, p: 0.50)
+          let p95 = percentile(result.nsPerOp, p: 0.95)
+          // Bytes per nanosecond is GB/s; ×1000 for MB/s.
+          let mbPerSecond = median > 0 ? bytes / median * 1_000 : 0
+
+          let key = "micro_\(benchCase.name)_\(kind.rawValue)_\(size.label)"
+          rawSamples["\(key)_ns_per_op"] = result.nsPerOp
+          metrics["\(key)_ns_per_op_median"] = median
+          metrics["\(key)_ns_per_op_p95"] = p95
+          metrics["\(key)_mb_per_s_median"] = mbPerSecond
+          if let allocs = result.allocationsPerOp {
+            metrics["\(key)_allocs_per_op"] = allocs
+          }
+          print(pad(benchCase.name, 16) + pad(kind.rawValue, 8) + [
+            padLeft(size.label, 5),
+            padLeft(String(format: "%.0f", median), 14),
+            padLeft(String(format: "%.0f", p95), 14),
+            padLeft(String(format: "%.1f", mbPerSecond), 10),
+            padLeft(result.allocationsPerOp.map { String(format: "%.1f", $0) } ?? "n/a", 10),
+          ].joined(separator: " "))
+        }
+      }
+    }
+
+    if let outPath = argValue("--out") {
+      let result = BenchRunResult(
+        timestamp: ISO8601DateFormatter().string(from: Date()),
+        osVersion: ProcessInfo.processInfo.operatingSystemVersionString,
+        warmN: samples,
+        coldN: 0,
+        warmupDiscard: 1,
+        metrics: metrics,
+        rawSamples: rawSamples
+      )
+      let encoder = JSONEncoder()
+      encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+      try encoder.encode(result).write(to: URL(fileURLWithPath: outPath), options: [.atomic])
+    }
+  }
+
+  // MARK: - Measurement
+
+  /// One warmup op, then `samples` timed batches; a batch repeats the op until it takes about
+  /// `targetBatchNs`, so fast ops aren't lost in clock overhead. Slow ops get fewer samples
+  /// (never under 3) to stay within `maxSeconds`. Allocations come from one separate, untimed op.
+  private func measure(_ op: () -> Void, samples: Int, maxSeconds: Double) -> (nsPerOp: [Double], allocationsPerOp: Double?) {
+    let targetBatchNs = 2_000_000.0
+    op()
+    let first = timeNs(op)
+    let batch = max(1, Int(targetBatchNs / max(first, 1)))
+    let budgetSamples = Int(maxSeconds * 1_000_000_000 / max(first * Double(batch), 1))
+    let sampleCount = max(3, min(samples, budgetSamples))
+
+    var nsPerOp: [Double] = []
+    nsPerOp.reserveCapacity(sampleCount)
+    for _ in 0..<sampleCount {
+      let ns = timeNs {
+        for _ in 0..<batch { op() }
+      }
+      nsPerOp.append(ns / Double(batch))
+    }
+    let allocations = AllocationCounter.count(op)
+    return (nsPerOp, allocations.map(Double.init))
+  }
+
+  private func timeNs(_ body: () -> Void) -> Double {
+    let start = DispatchTime.now().uptimeNanoseconds
+    body()
+    return Double(DispatchTime.now().uptimeNanoseconds - start)
+  }
+
+  private func percentile(_ samples: [Double], p: Double) -> Double {
+    if samples.isEmpty { return 0 }
+    let sorted = samples.sorted()
+    if p == 0.0 { return sorted[0] }
+    let idx = Int(ceil(Double(sorted.count) * p)) - 1
+    return sorted[max(0, min(idx, sorted.count - 1))]
+  }
+
+  // MARK: - Cases
+
+  static let cases: [Case] = [
+    Case(name: "highlight", kinds: Kind.allCases) { text in
+      let full = NSRange(location: 0, length: (text as NSString).length)
+      return { blackHole(MarkdownHighlighter.highlights(in: text, range: full)) }
+    },
+    // The app's `MarkdownStyler` lives in the app target; this is its work with a stand-in
+    // theme: line-cached spans (warm after the first op, as in the editor) applied as
+    // attribute runs to a text storage.
+    Case(name: "styler", kinds: Kind.allCases) { text in
+      let storage = NSTextStorage(string: text)
+      let ns = storage.string as NSString
+      let full = NSRange(location: 0, length: ns.length)
+      let cache = MarkdownLineHighlightCache()
+      let fenceIndex = MarkdownFenceIndex(text: ns)
+      let base: [NSAttributedString.Key: Any] = [
+        .font: NSFont.monospacedSystemFont(ofSize: 13, weight: .regular),
+        .foregroundColor: NSColor.textColor,
+      ]
+      let palette: [[NSAttributedString.Key: Any]] = [
+        [.foregroundColor: NSColor.systemBlue],
+        [.foregroundColor: NSColor.systemPurple, .font: NSFont.monospacedSystemFont(ofSize: 13, weight: .semibold)],
+        [.foregroundColor: NSColor.secondaryLabelColor],
+        [.backgroundColor: NSColor.quaternaryLabelColor],
+      ]
+      var attributesByKind: [MarkdownHighlightKind: [NSAttributedString.Key: Any]] = [:]
+      return {
+        let spans = cache.highlights(in: ns, range: full, fenceIndex: fenceIndex)
+        storage.beginEditing()
+        storage.setAttributes(base, range: full)
+        for span in spans {
+          let attributes = attributesByKind[span.kind] ?? {
+            let attributes = palette[attributesByKind.count % palette.count]
+            attributesByKind[span.kind] = attributes
+            return attributes
+          }()
+          storage.addAttributes(attributes, range: span.range)
+        }
+        storage.endEditing()
+      }
+    },
+    // A request whose body is the document, arriving in 64 KB reads on a reused framer.
+    Case(name: "framer", kinds: [.prose]) { text in
+      let body = Data(text.utf8)
+      var stream = Data("Content-Length: \(body.count)\r\n\r\n".utf8)
+      stream.append(body)
+      let chunkBytes = 64 * 1024
+      let chunks = stride(from: 0, to: stream.count, by: chunkBytes).map {
+        stream.subdata(in: $0..<min($0 + chunkBytes, stream.count))
+      }
+      let framer = ContentLengthFramer(maxFrameBytes: max(5 * 1024 * 1024, body.count))
+      return {
+        for chunk in chunks {
+          blackHole(try? framer.append(chunk))
+        }
+      }
+    },
+    Case(name: "search", kinds: [.prose]) { text in
+      { blackHole(TextSearchEngine.summarizeMatches(in: text, query: "the", options: TextSearchOptions(), captureLimit: 1_000)) }
+    },
+    Case(name: "replace_all", kinds: [.prose]) { text in
+      { blackHole(TextSearchEngine.replaceAll(in: text, query: "the", replacementTemplate: "THE", options: TextSearchOptions())) }
+    },
+    // Alternating between two versions so the duplicate check never short-circuits.
+    Case(name: "history_append", kinds: [.prose]) { text in
+      let versions = [text, text + "\n"]
+      var store = HistoryStore()
+      var i = 0
+      return {
+        store.append(HistorySnapshot(reason: "bench", content: versions[i & 1]))
+        i += 1
+      }
+    },
+    // Caller-side cost with the editor's limits: documents over `maxSnapshotBytes` are skipped,
+    // and the journal write itself is queued.
+    Case(name: "recovery_append", kinds: [.prose]) { text in
+      let dir = Microbench.scratchDirectory.appendingPathComponent("recovery", isDirectory: true)
+      try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+      let store = RecoveryStore(directory: dir)
+      let fileURL = dir.appendingPathComponent("doc.md")
+      let versions = [text, text + "\n"]
+      var i = 0
+      return {
+        blackHole(store.appendSnapshot(HistorySnapshot(reason: "bench", content: versions[i & 1]), for: fileURL))
+        i += 1
+      }
+    },
+    Case(name: "sha256", kinds: [.prose]) { text in
+      { blackHole(Revision.sha256(text: text)) }
+    },
+  ]
+
+  // MARK: - Args
+
+  private func select(_ list: String?, from known: [String], what: String) throws -> Set<String> {
+    guard let list else { return Set(known) }
+    let picked = list.split(separator: ",").map { $0.trimmingCharacters(in: .whitespaces) }
+    for name in picked where !known.contains(name) {
+      throw MicrobenchError.invalidArgs("unknown \(what): \(name) (known: \(known.joined(separator: ", ")))")
+    }
+    return Set(picked)
+  }
+
+  private func argValue(_ key: String) -> String? {
+    guard let idx = args.firstIndex(of: key), idx + 1 < args.count else { return nil }
+    return args[idx + 1]
+  }
+
+  private func argInt(_ key: String) -> Int? {
+    argValue(key).flatMap(Int.init)
+  }
+}
+
+do {
+  try Microbench(args: CommandLine.arguments).run()
+} catch MicrobenchError.invalidArgs(let message) {
+  fputs("error: \(message)\n\n\(Microbench.helpText)\n", stderr)
+  exit(2)
+} catch {
+  fputs("error: \(error)\n", stderr)
+  exit(1)
+}
@@ -1,5 +1,6 @@
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <limits.h>
 #include <poll.h>
 #include <spawn.h>
@@ -10,6 +11,7 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <sys/wait.h>
 #include <time.h>
@@ -18,6 +20,8 @@
 
 extern char **environ;
 static const int kProtocolVersion = 1;
+// Keep in sync with LaunchReadiness.environmentKey (TurboDraftTransport).
+static const char *kReadyFdEnvKey = "TURBODRAFT_READY_FD";
 
 static bool env_key_equals(const char *entry, const char *key) {
   if (!entry || !key) return false;
@@ -60,6 +64,8 @@ static bool should_forward_env_entry(const char *entry) {
     if (env_key_equals(entry, explicitKeys[i])) return true;
   }
   if (env_key_has_prefix(entry, "LC_")) return true;
+  // Our readiness fd is per-spawn; never pass along one we inherited.
+  if (env_key_equals(entry, kReadyFdEnvKey)) return false;
   if (env_key_has_prefix(entry, "TURBODRAFT_")) return true;
   return false;
 }
@@ -72,7 +78,8 @@ static void free_env_list(char **envp) {
   free(envp);
 }
 
-static char **build_filtered_spawn_env(void) {
+// extra_entry (optional, "KEY=value") is appended after the filtered environment.
+static char **build_filtered_spawn_env(const char *extra_entry) {
   size_t keep = 0;
   bool has_path = false;
   for (size_t i = 0; environ && environ[i] != NULL; i++) {
@@ -81,7 +88,7 @@ static char **build_filtered_spawn_env(void) {
     keep++;
     if (env_key_equals(entry, "PATH")) has_path = true;
   }
-  size_t extra = has_path ? 0 : 1;
+  size_t extra = (has_path ? 0 : 1) + (extra_entry ? 1 : 0);
   char **envp = (char **)calloc(keep + extra + 1, sizeof(char *));
   if (!envp) return NULL;
   size_t out = 0;
@@ -103,6 +110,14 @@ static char **build_filtered_spawn_env(void) {
     }
     out++;
   }
+  if (extra_entry) {
+    envp[out] = strdup(extra_entry);
+    if (!envp[out]) {
+      free_env_list(envp);
+      return NULL;
+    }
+    out++;
+  }
   envp[out] = NULL;
   return envp;
 }
@@ -111,7 +126,7 @@ static void die_usage(const char *msg) {
   if (msg && msg[0] != '\0') {
     fprintf(stderr, "error: %s\n", msg);
   }
-  fprintf(stderr, "usage: turbodraft [--path] <file> [+line] [--line N] [--column N] [--wait] [--timeout-ms N] [--socket-path <path>] [--debug-ready-latency] [--debug-ready-timeout-ms N]\n");
+  fprintf(stderr, "usage: turbodraft [--path] <file> [+line] [--line N] [--column N] [--wait] [--timeout-ms N] [--socket-path <path>] [--debug-ready-latency] [--debug-ready-timeout-ms N] [--trace]\n");
   exit(2);
 }
 
@@ -121,6 +136,12 @@ static int64_t now_mono_ms(void) {
   return (int64_t)ts.tv_sec * 1000 + (int64_t)(ts.tv_nsec / 1000000);
 }
 
+// Trace timestamps: the clock behind the app's DispatchTime.uptimeNanoseconds, so --trace
+// spans from both processes land on one timeline.
+static double now_uptime_ms(void) {
+  return (double)clock_gettime_nsec_np(CLOCK_UPTIME_RAW) / 1000000.0;
+}
+
 static char *dup_str(const char *s) {
   if (!s) return NULL;
   size_t n = strlen(s);
@@ -317,6 +338,66 @@ static bool json_extract_string_value(const char *json, const char *key, char **
   return false;
 }
 
+// Binary socket-path record published by the app next to the config
+// (see TurboDraftSocketPathCache.swift for the layout). Little-endian, fixed size.
+#define SOCKET_CACHE_MAGIC 0x43534454u /* "TDSC" */
+#define SOCKET_CACHE_VERSION 1u
+#define SOCKET_CACHE_HEADER_BYTES 48
+#define SOCKET_CACHE_PATH_BYTES 1024
+
+static uint32_t load_u32_le(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t load_u64_le(const uint8_t *p) {
+  return (uint64_t)load_u32_le(p) | ((uint64_t)load_u32_le(p + 4) << 32);
+}
+
+// Returns the cached socket path when the record still matches the config's
+// (mtime, size, inode); NULL means "missing or stale, parse config.json".
+static char *read_socket_path_cache(const char *cfg_path) {
+  char cache_path[PATH_MAX];
+  int cn = snprintf(cache_path, sizeof(cache_path), "%s.socket-cache", cfg_path);
+  if (cn <= 0 || cn >= (int)sizeof(cache_path)) return NULL;
+
+  int64_t want_sec = 0;
+  int64_t want_nsec = 0;
+  int64_t want_size = -1;
+  uint64_t want_ino = 0;
+  struct stat st;
+  if (stat(cfg_path, &st) == 0) {
+    want_sec = (int64_t)st.st_mtimespec.tv_sec;
+    want_nsec = (int64_t)st.st_mtimespec.tv_nsec;
+    want_size = (int64_t)st.st_size;
+    want_ino = (uint64_t)st.st_ino;
+  } else if (errno != ENOENT) {
+    return NULL;
+  }
+
+  int fd = open(cache_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return NULL;
+  uint8_t rec[SOCKET_CACHE_HEADER_BYTES + SOCKET_CACHE_PATH_BYTES];
+  ssize_t n = pread(fd, rec, sizeof(rec), 0);
+  close(fd);
+  if (n < SOCKET_CACHE_HEADER_BYTES) return NULL;
+
+  if (load_u32_le(rec) != SOCKET_CACHE_MAGIC || load_u32_le(rec + 4) != SOCKET_CACHE_VERSION) return NULL;
+  if ((int64_t)load_u64_le(rec + 8) != want_sec ||
+      (int64_t)load_u64_le(rec + 16) != want_nsec ||
+      (int64_t)load_u64_le(rec + 24) != want_size ||
+      load_u64_le(rec + 32) != want_ino) {
+    return NULL;
+  }
+  uint32_t path_len = load_u32_le(rec + 40);
+  if (path_len == 0 || path_len >= SOCKET_CACHE_PATH_BYTES || (ssize_t)(SOCKET_CACHE_HEADER_BYTES + path_len) > n) return NULL;
+
+  char *out = (char *)malloc((size_t)path_len + 1);
+  if (!out) return NULL;
+  memcpy(out, rec + SOCKET_CACHE_HEADER_BYTES, path_len);
+  out[path_len] = '\0';
+  return out;
+}
+
 static char *resolve_socket_path(void) {
   const char *explicitSock = getenv("TURBODRAFT_SOCKET");
   if (explicitSock && explicitSock[0] != '\0') {
@@ -326,6 +407,12 @@ static char *resolve_socket_path(void) {
   const char *cfgPathEnv = getenv("TURBODRAFT_CONFIG");
   char *cfgPath = cfgPathEnv && cfgPathEnv[0] != '\0' ? dup_str(cfgPathEnv) : default_config_path();
   if (cfgPath) {
+    char *cached = read_socket_path_cache(cfgPath);
+    if (cached) {
+      free(cfgPath);
+      return cached;
+    }
+
     char *buf = NULL;
     size_t len = 0;
     if (read_file(cfgPath, &buf, &len)) {
@@ -374,30 +461,37 @@ static char *current_executable_realpath(void) {
   return NULL;
 }
 
-static bool try_spawn_path(const char *exe_path) {
+static bool try_spawn_path(const char *exe_path, const char *ready_env) {
   if (!exe_path || exe_path[0] == '\0') return false;
   if (access(exe_path, X_OK) != 0) return false;
   pid_t pid = 0;
   char *argv[] = { (char *)exe_path, "--start-hidden", NULL };
-  char **envp = build_filtered_spawn_env();
+  char **envp = build_filtered_spawn_env(ready_env);
   if (!envp) return false;
   int rc = posix_spawn(&pid, exe_path, NULL, NULL, argv, envp);
   free_env_list(envp);
   return rc == 0;
 }
 
-static void launch_app_best_effort(void) {
+static bool spawn_app(int ready_write_fd) {
+  char ready_env[64];
+  const char *ready_entry = NULL;
+  if (ready_write_fd >= 0) {
+    snprintf(ready_env, sizeof(ready_env), "%s=%d", kReadyFdEnvKey, ready_write_fd);
+    ready_entry = ready_env;
+  }
+
   char *self_path = current_executable_realpath();
   if (self_path) {
     char *dir = dirname_dup(self_path);
     if (dir) {
       char *candidate = join2(dir, "/turbodraft-app");
       if (candidate) {
-        if (try_spawn_path(candidate)) {
+        if (try_spawn_path(candidate, ready_entry)) {
           free(candidate);
           free(dir);
           free(self_path);
-          return;
+          return true;
         }
         free(candidate);
       }
@@ -409,46 +503,99 @@ static void launch_app_best_effort(void) {
   // Fallback to PATH.
   pid_t pid = 0;
   char *argv[] = { "turbodraft-app", "--start-hidden", NULL };
-  char **envp = build_filtered_spawn_env();
-  if (!envp) return;
-  (void)posix_spawnp(&pid, "turbodraft-app", NULL, NULL, argv, envp);
+  char **envp = build_filtered_spawn_env(ready_entry);
+  if (!envp) return false;
+  int rc = posix_spawnp(&pid, "turbodraft-app", NULL, NULL, argv, envp);
   free_env_list(envp);
+  return rc == 0;
+}
+
+// Spawns the app and returns the read end of its readiness pipe, or -1 when the
+// handshake isn't available (connect polling then covers the launch).
+static int launch_app_best_effort(void) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    (void)spawn_app(-1);
+    return -1;
+  }
+  // Only the write end may cross exec; the launcher keeps the read end to itself.
+  (void)fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  bool spawned = spawn_app(fds[1]);
+  // Drop our copy so the pipe reports EOF if the app exits before listening.
+  close(fds[1]);
+  if (!spawned) {
+    close(fds[0]);
+    return -1;
+  }
+  return fds[0];
 }
 
-static int connect_or_launch(const char *sock_path, int timeout_ms) {
+static int try_connect_socket(const char *sock_path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  size_t maxLen = sizeof(addr.sun_path);
+  if (strlen(sock_path) >= maxLen) {
+    close(fd);
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  strncpy(addr.sun_path, sock_path, maxLen - 1);
+
+  if (connect(fd, (struct sockaddr *)&addr, (socklen_t)sizeof(addr)) == 0) {
+    return fd;
+  }
+  int e = errno;
+  close(fd);
+  errno = e;
+  return -1;
+}
+
+static int connect_or_launch(const char *sock_path, int timeout_ms, bool *out_launched) {
   int64_t deadline = now_mono_ms() + (timeout_ms < 0 ? 0 : timeout_ms);
   bool did_launch = false;
+  *out_launched = false;
+  int ready_fd = -1;
   int sleep_us = 5 * 1000;
 
   while (now_mono_ms() < deadline) {
-    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (fd < 0) return -1;
-
-    struct sockaddr_un addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sun_family = AF_UNIX;
-    size_t maxLen = sizeof(addr.sun_path);
-    if (strlen(sock_path) >= maxLen) {
-      close(fd);
-      errno = ENAMETOOLONG;
-      return -1;
-    }
-    strncpy(addr.sun_path, sock_path, maxLen - 1);
-
-    if (connect(fd, (struct sockaddr *)&addr, (socklen_t)sizeof(addr)) == 0) {
+    int fd = try_connect_socket(sock_path);
+    if (fd >= 0) {
+      if (ready_fd >= 0) close(ready_fd);
       return fd;
     }
-    close(fd);
+    if (errno == ENAMETOOLONG) return -1;
 
     if (!did_launch) {
       did_launch = true;
-      launch_app_best_effort();
+      *out_launched = true;
+      ready_fd = launch_app_best_effort();
+    }
+
+    if (ready_fd >= 0) {
+      // Sleep until the app reports it is listening (one byte) or gives up (EOF).
+      // Either way it is a one-shot wake: retry connect, then fall back to polling.
+      struct pollfd pfd;
+      pfd.fd = ready_fd;
+      pfd.events = POLLIN;
+      int remain = (int)(deadline - now_mono_ms());
+      if (remain <= 0) break;
+      int pr = poll(&pfd, 1, remain);
+      if (pr < 0 && errno == EINTR) continue;
+      close(ready_fd);
+      ready_fd = -1;
+      continue;
     }
+
     usleep((useconds_t)sleep_us);
     if (sleep_us < 25 * 1000) {
       sleep_us += 3 * 1000;
     }
   }
+  if (ready_fd >= 0) close(ready_fd);
   errno = ETIMEDOUT;
   return -1;
 }
@@ -470,37 +617,62 @@ static int write_all(int fd, const uint8_t *buf, size_t len) {
   return 0;
 }
 
+// Cursor-based Content-Length reader over one growable arena reused for every
+// response on the connection. framer_read_frame hands out a NUL-terminated view
+// into the arena; the view stays valid until the next framer_read_frame call.
 struct framer {
   uint8_t *buf;
-  size_t len;
   size_t cap;
+  size_t start;       // first unconsumed byte
+  size_t len;         // end of buffered data
+  size_t scan;        // header terminator search resumes here
+  bool have_header;   // current frame's headers parsed
+  size_t body_start;
+  size_t body_len;
+  size_t view_end;    // end of the frame handed out last call (0 = none)
+  uint8_t view_saved; // byte displaced by that view's NUL terminator
+  double first_read_ms; // uptime of the last call's first read() with data (0 = none needed)
 };
 
 static void framer_init(struct framer *f) {
-  f->buf = NULL;
-  f->len = 0;
-  f->cap = 0;
+  memset(f, 0, sizeof(*f));
 }
 
 static void framer_free(struct framer *f) {
   free(f->buf);
-  f->buf = NULL;
-  f->len = 0;
-  f->cap = 0;
+  framer_init(f);
+}
+
+// Consumes the frame handed out by the previous read.
+static void framer_release_view(struct framer *f) {
+  if (f->view_end == 0) return;
+  f->buf[f->view_end] = f->view_saved;
+  f->start = f->view_end;
+  f->view_end = 0;
+  if (f->start == f->len) {
+    f->start = f->len = f->scan = 0;
+  }
 }
 
-static int framer_append(struct framer *f, const uint8_t *data, size_t n) {
-  if (n == 0) return 0;
-  if (f->len + n > f->cap) {
-    size_t newCap = f->cap == 0 ? 8192 : f->cap;
-    while (newCap < f->len + n) newCap *= 2;
-    uint8_t *nb = (uint8_t *)realloc(f->buf, newCap);
-    if (!nb) return -1;
-    f->buf = nb;
-    f->cap = newCap;
+// Ensures `need` bytes fit from f->start, plus one spare byte for the view terminator.
+// Compacts the (partial-frame) remainder to the front only when the tail is short.
+static int framer_reserve(struct framer *f, size_t need) {
+  if (f->start + need + 1 <= f->cap) return 0;
+  if (f->start > 0) {
+    size_t shift = f->start;
+    memmove(f->buf, f->buf + shift, f->len - shift);
+    f->len -= shift;
+    f->scan -= shift;
+    if (f->have_header) f->body_start -= shift;
+    f->start = 0;
+    if (need + 1 <= f->cap) return 0;
   }
-  memcpy(f->buf + f->len, data, n);
-  f->len += n;
+  size_t newCap = f->cap == 0 ? 16 * 1024 : f->cap;
+  while (newCap < need + 1) newCap *= 2;
+  uint8_t *nb = (uint8_t *)realloc(f->buf, newCap);
+  if (!nb) return -1;
+  f->buf = nb;
+  f->cap = newCap;
   return 0;
 }
 
@@ -508,68 +680,87 @@ static int parse_content_length(const char *headers, size_t headers_len, int *ou
   *out_len = -1;
   const char *p = headers;
   const char *end = headers + headers_len;
+  static const char kKey[] = "Content-Length";
+  const size_t keyLen = sizeof(kKey) - 1;
   while (p < end) {
-    const char *line_end = strstr(p, "\r\n");
-    if (!line_end || line_end > end) break;
+    const char *cr = memchr(p, '\r', (size_t)(end - p));
+    const char *line_end = cr ? cr : end;
     const char *colon = memchr(p, ':', (size_t)(line_end - p));
-    if (colon) {
-      size_t key_len = (size_t)(colon - p);
-      if (key_len == strlen("Content-Length") && strncasecmp(p, "Content-Length", key_len) == 0) {
-        const char *v = colon + 1;
-        while (v < line_end && isspace((unsigned char)*v)) v++;
-        char tmp[64];
-        size_t vn = (size_t)(line_end - v);
-        if (vn >= sizeof(tmp)) return -1;
-        memcpy(tmp, v, vn);
-        tmp[vn] = '\0';
-        int n = atoi(tmp);
-        if (n < 0) return -1;
-        *out_len = n;
-        return 0;
+    if (colon && (size_t)(colon - p) == keyLen && strncasecmp(p, kKey, keyLen) == 0) {
+      const char *v = colon + 1;
+      while (v < line_end && isspace((unsigned char)*v)) v++;
+      if (v == line_end) return -1;
+      long n = 0;
+      for (; v < line_end && *v >= '0' && *v <= '9'; v++) {
+        n = n * 10 + (*v - '0');
+        if (n > INT_MAX) return -1;
       }
+      while (v < line_end && isspace((unsigned char)*v)) v++;
+      if (v != line_end) return -1;
+      *out_len = (int)n;
+      return 0;
     }
     p = line_end + 2;
   }
   return -1;
 }
 
-static int framer_read_frame(int fd, struct framer *f, int timeout_ms, uint8_t **out_body, size_t *out_body_len) {
+// Scans only bytes not yet examined for the header terminator.
+static int framer_try_parse_header(struct framer *f) {
+  size_t i = f->scan > f->start ? f->scan : f->start;
+  while (f->len - i >= 4) {
+    const uint8_t *cr = memchr(f->buf + i, '\r', f->len - i - 3);
+    if (!cr) {
+      i = f->len - 3;
+      break;
+    }
+    i = (size_t)(cr - f->buf);
+    if (cr[1] == '\n' && cr[2] == '\r' && cr[3] == '\n') {
+      int body_len = -1;
+      // Include the first CRLF of the terminator so every header line ends in CRLF.
+      if (parse_content_length((const char *)f->buf + f->start, i + 2 - f->start, &body_len) != 0 || body_len < 0) {
+        errno = EPROTO;
+        return -1;
+      }
+      f->have_header = true;
+      f->body_start = i + 4;
+      f->body_len = (size_t)body_len;
+      f->scan = f->body_start;
+      return 0;
+    }
+    i++;
+  }
+  f->scan = i;
+  return 0;
+}
+
+static int framer_read_frame(int fd, struct framer *f, int timeout_ms, const char **out_body, size_t *out_body_len) {
   *out_body = NULL;
   *out_body_len = 0;
+  framer_release_view(f);
+  f->first_read_ms = 0;
   int64_t deadline = now_mono_ms() + (timeout_ms < 0 ? 0 : timeout_ms);
 
   while (true) {
-    // Try to parse a frame from current buffer.
-    for (size_t i = 3; i < f->len; i++) {
-      if (f->buf[i - 3] == '\r' && f->buf[i - 2] == '\n' && f->buf[i - 1] == '\r' && f->buf[i] == '\n') {
-        size_t headers_len = i - 3;
-        const char *headers = (const char *)f->buf;
-        int body_len = -1;
-        if (parse_content_length(headers, headers_len, &body_len) != 0 || body_len < 0) {
-          errno = EPROTO;
-          return -1;
-        }
-        size_t body_start = i + 1;
-        size_t body_end = body_start + (size_t)body_len;
-        if (f->len < body_end) {
-          break; // need more data
-        }
-        uint8_t *body = (uint8_t *)malloc((size_t)body_len + 1);
-        if (!body) return -1;
-        memcpy(body, f->buf + body_start, (size_t)body_len);
-        body[body_len] = 0;
-
-        // Remove this frame from buffer.
-        size_t remaining = f->len - body_end;
-        if (remaining > 0) {
-          memmove(f->buf, f->buf + body_end, remaining);
-        }
-        f->len = remaining;
+    if (!f->have_header && framer_try_parse_header(f) != 0) return -1;
+    if (f->have_header && f->len - f->body_start >= f->body_len) {
+      size_t body_end = f->body_start + f->body_len;
+      // Terminate in place for the strstr-based field scanners; restored on release.
+      f->view_saved = f->buf[body_end];
+      f->buf[body_end] = 0;
+      f->view_end = body_end;
+      f->have_header = false;
+      *out_body = (const char *)f->buf + f->body_start;
+      *out_body_len = f->body_len;
+      return 0;
+    }
 
-        *out_body = body;
-        *out_body_len = (size_t)body_len;
-        return 0;
-      }
+    size_t need = f->have_header
+      ? (f->body_start - f->start) + f->body_len
+      : (f->len - f->start) + 4096;
+    if (framer_reserve(f, need) != 0) {
+      errno = ENOMEM;
+      return -1;
     }
 
     int64_t now = now_mono_ms();
@@ -591,9 +782,9 @@ static int framer_read_frame(int fd, struct framer *f, int timeout_ms, uint8_t *
       errno = ETIMEDOUT;
       return -1;
     }
-    if (pfd.revents & POLLIN) {
-      uint8_t tmp[8192];
-      ssize_t n = read(fd, tmp, sizeof(tmp));
+    if (pfd.revents & (POLLIN | POLLHUP)) {
+      // Read straight into the arena; keep one byte spare for the view terminator.
+      ssize_t n = read(fd, f->buf + f->len, f->cap - 1 - f->len);
       if (n < 0) {
         if (errno == EINTR) continue;
         return -1;
@@ -602,12 +793,12 @@ static int framer_read_frame(int fd, struct framer *f, int timeout_ms, uint8_t *
         errno = EPIPE;
         return -1;
       }
-      if (framer_append(f, tmp, (size_t)n) != 0) {
-        errno = ENOMEM;
-        return -1;
-      }
+      if (f->first_read_ms == 0) f->first_read_ms = now_uptime_ms();
+      f->len += (size_t)n;
       continue;
     }
+    errno = EPIPE;
+    return -1;
   }
 }
 
@@ -665,8 +856,26 @@ static int send_jsonrpc(int fd, const char *json) {
     errno = EOVERFLOW;
     return -1;
   }
-  if (write_all(fd, (const uint8_t *)header, (size_t)hn) != 0) return -1;
-  if (write_all(fd, (const uint8_t *)json, (size_t)json_len) != 0) return -1;
+  // Header and body leave in one writev so each request is a single syscall.
+  struct iovec iov[2];
+  iov[0].iov_base = header;
+  iov[0].iov_len = (size_t)hn;
+  iov[1].iov_base = (void *)json;
+  iov[1].iov_len = (size_t)json_len;
+  ssize_t n;
+  do {
+    n = writev(fd, iov, 2);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) return -1;
+  size_t sent = (size_t)n;
+  if (sent < (size_t)hn) {
+    if (write_all(fd, (const uint8_t *)header + sent, (size_t)hn - sent) != 0) return -1;
+    sent = (size_t)hn;
+  }
+  size_t body_sent = sent - (size_t)hn;
+  if (body_sent < (size_t)json_len) {
+    if (write_all(fd, (const uint8_t *)json + body_sent, (size_t)json_len - body_sent) != 0) return -1;
+  }
   return 0;
 }
 
@@ -674,6 +883,65 @@ static bool response_has_error(const char *body) {
   return body && strstr(body, "\"error\"") != NULL && strstr(body, "\"error\":null") == NULL;
 }
 
+// The `code` member of the response's `error` object. Walks that object's top-level members,
+// skipping string contents and nested values, so whitespace around the colon, a `code` inside
+// `data`, or the same text inside `message` don't confuse it.
+static bool response_error_code(const char *body, long *out_code) {
+  if (!body || !out_code) return false;
+  const char *p = body;
+  while ((p = strstr(p, "\"error\"")) != NULL) {
+    p += strlen("\"error\"");
+    const char *q = p;
+    while (*q && isspace((unsigned char)*q)) q++;
+    if (*q != ':') continue;
+    q++;
+    while (*q && isspace((unsigned char)*q)) q++;
+    if (*q != '{') return false;
+    q++;
+    int depth = 1;
+    bool expect_key = true;
+    while (*q && depth > 0) {
+      char c = *q;
+      if (c == '"') {
+        const char *start = ++q;
+        while (*q && *q != '"') {
+          if (*q == '\\' && q[1]) q++;
+          q++;
+        }
+        if (!*q) return false;
+        size_t len = (size_t)(q - start);
+        q++;
+        if (depth == 1 && expect_key) {
+          const char *after = q;
+          while (*after && isspace((unsigned char)*after)) after++;
+          if (*after == ':' && len == 4 && strncmp(start, "code", 4) == 0) {
+            after++;
+            errno = 0;
+            char *end = NULL;
+            long v = strtol(after, &end, 10);
+            if (end == after || errno != 0) return false;
+            *out_code = v;
+            return true;
+          }
+          expect_key = false;
+        }
+        continue;
+      }
+      if (c == '{' || c == '[') depth++;
+      else if (c == '}' || c == ']') depth--;
+      else if (c == ',' && depth == 1) expect_key = true;
+      q++;
+    }
+    return false;
+  }
+  return false;
+}
+
+static bool response_is_method_not_found(const char *body) {
+  long code = 0;
+  return response_error_code(body, &code) && code == -32601;
+}
+
 static bool extract_session_id(const char *body, char **out_session_id) {
   *out_session_id = NULL;
   if (!body) return false;
@@ -703,30 +971,52 @@ static bool json_extract_number_value(const char *json, const char *key, double
   return true;
 }
 
-static char *format_open_request_json(const char *path_escaped, int line, int column, const char *cwd_escaped) {
-  const char *fmt = NULL;
+// Request ids (1-31) whose read timed out: their responses may still arrive and must not be
+// taken for the answer to a later request.
+static bool response_id_is_stale(const char *body, unsigned stale_ids) {
+  double id = 0;
+  if (stale_ids == 0 || !json_extract_number_value(body, "\"id\"", &id)) return false;
+  if (id < 1 || id > 31) return false;
+  return (stale_ids & (1u << (unsigned)id)) != 0;
+}
+
+// framer_read_frame, dropping late responses to requests in `stale_ids`.
+static int read_frame_skipping_stale(int fd, struct framer *f, int timeout_ms, unsigned stale_ids, const char **out_body, size_t *out_body_len) {
+  int64_t deadline = now_mono_ms() + (timeout_ms < 0 ? 0 : timeout_ms);
+  while (true) {
+    int remain = (int)(deadline - now_mono_ms());
+    if (framer_read_frame(fd, f, remain < 0 ? 0 : remain, out_body, out_body_len) != 0) return -1;
+    if (!response_id_is_stale(*out_body, stale_ids)) return 0;
+  }
+}
+
+// With wait_timeout_ms >= 0 this formats `turbodraft.session.openAndWait`: the server acks the
+// open with a `turbodraft.session.opened` notification and answers the request on close/timeout.
+// A non-NULL trace_id asks the app to record the open's spans under it.
+static char *format_open_request_json(const char *path_escaped, int line, int column, const char *cwd_escaped, int wait_timeout_ms, const char *trace_id) {
+  const char *method = wait_timeout_ms >= 0 ? "turbodraft.session.openAndWait" : "turbodraft.session.open";
+  char position[64] = "";
   if (line > 0 && column > 0) {
-    fmt = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"turbodraft.session.open\",\"params\":{\"path\":\"%s\",\"line\":%d,\"column\":%d,\"cwd\":\"%s\",\"protocolVersion\":%d}}";
+    snprintf(position, sizeof(position), "\"line\":%d,\"column\":%d,", line, column);
   } else if (line > 0) {
-    fmt = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"turbodraft.session.open\",\"params\":{\"path\":\"%s\",\"line\":%d,\"cwd\":\"%s\",\"protocolVersion\":%d}}";
-  } else {
-    fmt = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"turbodraft.session.open\",\"params\":{\"path\":\"%s\",\"cwd\":\"%s\",\"protocolVersion\":%d}}";
+    snprintf(position, sizeof(position), "\"line\":%d,", line);
+  }
+  char wait_param[48] = "";
+  if (wait_timeout_ms >= 0) {
+    snprintf(wait_param, sizeof(wait_param), ",\"timeoutMs\":%d", wait_timeout_ms);
+  }
+  char trace_param[96] = "";
+  if (trace_id) {
+    snprintf(trace_param, sizeof(trace_param), ",\"traceId\":\"%s\"", trace_id);
   }
 
-  int n = (line > 0 && column > 0)
-    ? snprintf(NULL, 0, fmt, path_escaped, line, column, cwd_escaped, kProtocolVersion)
-    : (line > 0 ? snprintf(NULL, 0, fmt, path_escaped, line, cwd_escaped, kProtocolVersion) : snprintf(NULL, 0, fmt, path_escaped, cwd_escaped, kProtocolVersion));
+  const char *fmt = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"%s\",\"params\":{\"path\":\"%s\",%s\"cwd\":\"%s\",\"protocolVersion\":%d%s%s}}";
+  int n = snprintf(NULL, 0, fmt, method, path_escaped, position, cwd_escaped, kProtocolVersion, wait_param, trace_param);
   if (n < 0) return NULL;
 
   char *out = (char *)malloc((size_t)n + 1);
   if (!out) return NULL;
-  if (line > 0 && column > 0) {
-    snprintf(out, (size_t)n + 1, fmt, path_escaped, line, column, cwd_escaped, kProtocolVersion);
-  } else if (line > 0) {
-    snprintf(out, (size_t)n + 1, fmt, path_escaped, line, cwd_escaped, kProtocolVersion);
-  } else {
-    snprintf(out, (size_t)n + 1, fmt, path_escaped, cwd_escaped, kProtocolVersion);
-  }
+  snprintf(out, (size_t)n + 1, fmt, method, path_escaped, position, cwd_escaped, kProtocolVersion, wait_param, trace_param);
   return out;
 }
 
@@ -760,6 +1050,60 @@ static char *format_bench_metrics_request_json(const char *session_id) {
   return out;
 }
 
+// Launcher-side phases of a traced open, as uptime ms (see now_uptime_ms).
+struct open_trace {
+  char id[64];
+  double start_ms;
+  double connect_start_ms;
+  double connected_ms;
+  bool launched;
+  double write_start_ms;
+  double written_ms;
+  double first_byte_ms;
+  double response_ms;
+  double parsed_ms;
+};
+
+static void open_trace_init(struct open_trace *t) {
+  memset(t, 0, sizeof(*t));
+  t->start_ms = now_uptime_ms();
+  snprintf(t->id, sizeof(t->id), "%d-%llx", (int)getpid(), (unsigned long long)clock_gettime_nsec_np(CLOCK_UPTIME_RAW));
+}
+
+// `turbodraft.bench.trace` with the launcher's spans; the app adds them to the trace once.
+static char *format_bench_trace_request_json(const struct open_trace *t) {
+  // A frame already buffered when the response was awaited has no read of its own.
+  double first_byte_ms = t->first_byte_ms > 0 ? t->first_byte_ms : t->response_ms;
+  const char *span = "%s{\"name\":\"%s\",\"startMs\":%.4f,\"endMs\":%.4f}";
+  char spans[1024] = "[";
+  int len = 1;
+  const struct { const char *name; double start; double end; } parts[] = {
+    { "client.total", t->start_ms, t->parsed_ms },
+    { "client.resolve_socket", t->start_ms, t->connect_start_ms },
+    { t->launched ? "client.launch_and_connect" : "client.connect", t->connect_start_ms, t->connected_ms },
+    { "client.write", t->write_start_ms, t->written_ms },
+    { "client.first_byte", t->written_ms, first_byte_ms },
+    { "client.read", first_byte_ms, t->response_ms },
+    { "client.parse", t->response_ms, t->parsed_ms },
+  };
+  for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+    int n = snprintf(spans + len, sizeof(spans) - (size_t)len, span, i == 0 ? "" : ",", parts[i].name, parts[i].start, parts[i].end);
+    if (n < 0 || (size_t)(len + n) >= sizeof(spans)) return NULL;
+    len += n;
+  }
+  if ((size_t)len + 2 > sizeof(spans)) return NULL;
+  spans[len++] = ']';
+  spans[len] = 0;
+
+  const char *fmt = "{\"jsonrpc\":\"2.0\",\"id\":5,\"method\":\"turbodraft.bench.trace\",\"params\":{\"traceId\":\"%s\",\"clientSpans\":%s}}";
+  int n = snprintf(NULL, 0, fmt, t->id, spans);
+  if (n < 0) return NULL;
+  char *out = (char *)malloc((size_t)n + 1);
+  if (!out) return NULL;
+  snprintf(out, (size_t)n + 1, fmt, t->id, spans);
+  return out;
+}
+
 static bool is_valid_bundle_id(const char *bundle_id) {
   if (!bundle_id || bundle_id[0] == '\0') return false;
   for (const char *p = bundle_id; *p; p++) {
@@ -792,7 +1136,7 @@ static void restore_terminal_focus(void) {
   int sn = snprintf(script, sizeof(script), "tell application id \"%s\" to activate", bundle_id);
   if (sn <= 0 || sn >= (int)sizeof(script)) return;
 
-  char **envp = build_filtered_spawn_env();
+  char **envp = build_filtered_spawn_env(NULL);
   if (!envp) return;
 
   pid_t pid = 0;
@@ -816,6 +1160,9 @@ int main(int argc, char **argv) {
   bool timeout_explicit = false;
   bool debug_ready_latency = false;
   int debug_ready_timeout_ms = 2500;
+  bool trace = false;
+  struct open_trace tr;
+  open_trace_init(&tr);
   char *socket_path_override = NULL;
 
   for (int i = 1; i < argc; i++) {
@@ -843,6 +1190,8 @@ int main(int argc, char **argv) {
       if (i + 1 >= argc) die_usage("missing value for --debug-ready-timeout-ms");
       debug_ready_timeout_ms = atoi(argv[++i]);
       if (debug_ready_timeout_ms < 50) debug_ready_timeout_ms = 50;
+    } else if (strcmp(a, "--trace") == 0) {
+      trace = true;
     } else if (strcmp(a, "--socket-path") == 0) {
       if (i + 1 >= argc) die_usage("missing value for --socket-path");
       socket_path_override = dup_str(argv[++i]);
@@ -872,7 +1221,9 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  int fd = connect_or_launch(socket_path, timeout_ms);
+  tr.connect_start_ms = now_uptime_ms();
+  int fd = connect_or_launch(socket_path, timeout_ms, &tr.launched);
+  tr.connected_ms = now_uptime_ms();
   if (fd < 0) {
     fprintf(stderr, "error: connect failed: %s\n", strerror(errno));
     free(socket_path);
@@ -893,40 +1244,64 @@ int main(int argc, char **argv) {
   char *cwd_escaped = json_escape(cwd_raw);
   if (!cwd_escaped) cwd_escaped = json_escape("/");
 
-  char *open_json = format_open_request_json(path_escaped, line, column, cwd_escaped);
-  free(path_escaped);
-  free(cwd_escaped);
-  if (!open_json) {
-    fprintf(stderr, "error: failed to format open request\n");
-    close(fd);
-    free(socket_path);
-    return 1;
-  }
+  // Pipelined fast path: one openAndWait request instead of open → parse → wait.
+  // The debug probe and trace loops need the connection between open and wait, so they keep
+  // the two-step path.
+  bool pipelined = wait && !debug_ready_latency && !trace;
+  struct framer fr;
+  framer_init(&fr);
+  const char *resp = NULL;
+  size_t resp_len = 0;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    char *open_json = format_open_request_json(path_escaped, line, column, cwd_escaped, pipelined ? timeout_ms : -1, trace ? tr.id : NULL);
+    if (!open_json) {
+      fprintf(stderr, "error: failed to format open request\n");
+      free(path_escaped);
+      free(cwd_escaped);
+      framer_free(&fr);
+      close(fd);
+      free(socket_path);
+      return 1;
+    }
 
-  if (send_jsonrpc(fd, open_json) != 0) {
-    fprintf(stderr, "error: write failed: %s\n", strerror(errno));
+    tr.write_start_ms = now_uptime_ms();
+    if (send_jsonrpc(fd, open_json) != 0) {
+      fprintf(stderr, "error: write failed: %s\n", strerror(errno));
+      free(open_json);
+      free(path_escaped);
+      free(cwd_escaped);
+      framer_free(&fr);
+      close(fd);
+      free(socket_path);
+      return 1;
+    }
     free(open_json);
-    close(fd);
-    free(socket_path);
-    return 1;
-  }
-  free(open_json);
+    tr.written_ms = now_uptime_ms();
 
-  struct framer fr;
-  framer_init(&fr);
-  uint8_t *body = NULL;
-  size_t body_len = 0;
-  if (framer_read_frame(fd, &fr, timeout_ms, &body, &body_len) != 0) {
-    fprintf(stderr, "error: read response failed: %s\n", strerror(errno));
-    framer_free(&fr);
-    close(fd);
-    free(socket_path);
-    return 1;
+    if (framer_read_frame(fd, &fr, timeout_ms, &resp, &resp_len) != 0) {
+      fprintf(stderr, "error: read response failed: %s\n", strerror(errno));
+      free(path_escaped);
+      free(cwd_escaped);
+      framer_free(&fr);
+      close(fd);
+      free(socket_path);
+      return 1;
+    }
+    tr.first_byte_ms = fr.first_read_ms;
+    tr.response_ms = now_uptime_ms();
+    if (pipelined && response_is_method_not_found(resp)) {
+      // Resident app predates openAndWait; retry with the two-step protocol.
+      pipelined = false;
+      continue;
+    }
+    break;
   }
-  const char *resp = (const char *)body;
+  free(path_escaped);
+  free(cwd_escaped);
+
   if (response_has_error(resp)) {
     fprintf(stderr, "error: server returned error: %s\n", resp);
-    free(body);
     framer_free(&fr);
     close(fd);
     free(socket_path);
@@ -938,46 +1313,74 @@ int main(int argc, char **argv) {
   (void)json_extract_number_value(resp, "\"serverOpenMs\"", &server_open_ms);
   if (!extract_session_id(resp, &session_id) || !session_id) {
     fprintf(stderr, "error: failed to parse sessionId\n");
-    free(body);
     framer_free(&fr);
     close(fd);
     free(socket_path);
     return 1;
   }
-  free(body);
+  tr.parsed_ms = now_uptime_ms();
+  // Bit n: the response to request id n timed out and may still arrive.
+  unsigned stale_ids = 0;
+
+  if (trace) {
+    // Poll until the app has the editor styled and focused, the last spans of the open, then
+    // print the whole trace (the bench.trace response) for `turbodraft-bench bench trace`.
+    int64_t trace_deadline = now_mono_ms() + 2500;
+    char *trace_json = format_bench_trace_request_json(&tr);
+    // The frame view is only valid until the next read; keep a copy of the last good response.
+    char *trace_result = NULL;
+    while (trace_json && now_mono_ms() < trace_deadline) {
+      if (send_jsonrpc(fd, trace_json) != 0) break;
+      const char *trace_resp = NULL;
+      size_t trace_len = 0;
+      if (read_frame_skipping_stale(fd, &fr, 800, stale_ids, &trace_resp, &trace_len) != 0) {
+        if (errno == ETIMEDOUT) stale_ids |= 1u << 5;
+        break;
+      }
+      if (response_has_error(trace_resp)) break;
+      char *copy = strdup(trace_resp);
+      if (!copy) break;
+      free(trace_result);
+      trace_result = copy;
+      if (strstr(trace_result, "\"complete\":true")) break;
+      usleep(8 * 1000);
+    }
+    free(trace_json);
+    if (trace_result) {
+      fprintf(stderr, "trace_result=%s\n", trace_result);
+      free(trace_result);
+    } else {
+      fprintf(stderr, "trace_result=NA trace_id=%s\n", tr.id);
+    }
+  }
 
   if (debug_ready_latency) {
     int64_t probe_deadline = now_mono_ms() + debug_ready_timeout_ms;
     bool got_ready = false;
     double ready_ms = -1.0;
     int probe_attempts = 0;
+    // Same request every attempt; format it once.
+    char *bench_json = format_bench_metrics_request_json(session_id);
 
-    while (now_mono_ms() < probe_deadline) {
+    while (bench_json && now_mono_ms() < probe_deadline) {
       probe_attempts++;
-      char *bench_json = format_bench_metrics_request_json(session_id);
-      if (!bench_json) break;
-      if (send_jsonrpc(fd, bench_json) != 0) {
-        free(bench_json);
-        break;
-      }
-      free(bench_json);
+      if (send_jsonrpc(fd, bench_json) != 0) break;
 
-      uint8_t *bench_body = NULL;
+      const char *bench_resp = NULL;
       size_t bench_len = 0;
-      if (framer_read_frame(fd, &fr, 800, &bench_body, &bench_len) != 0) {
+      if (read_frame_skipping_stale(fd, &fr, 800, stale_ids, &bench_resp, &bench_len) != 0) {
+        if (errno == ETIMEDOUT) stale_ids |= 1u << 4;
         break;
       }
 
-      const char *bench_resp = (const char *)bench_body;
       if (!response_has_error(bench_resp) &&
           json_extract_number_value(bench_resp, "\"sessionOpenToReadyMs\"", &ready_ms)) {
         got_ready = true;
-        free(bench_body);
         break;
       }
-      free(bench_body);
       usleep(8 * 1000);
     }
+    free(bench_json);
 
     if (got_ready) {
       if (server_open_ms >= 0.0) {
@@ -995,30 +1398,32 @@ int main(int argc, char **argv) {
   }
 
   if (wait) {
-    char *wait_json = format_wait_request_json(session_id, timeout_ms);
-    if (!wait_json) {
-      fprintf(stderr, "error: failed to format wait request\n");
-      free(session_id);
-      framer_free(&fr);
-      close(fd);
-      free(socket_path);
-      return 1;
-    }
+    if (!pipelined) {
+      char *wait_json = format_wait_request_json(session_id, timeout_ms);
+      if (!wait_json) {
+        fprintf(stderr, "error: failed to format wait request\n");
+        free(session_id);
+        framer_free(&fr);
+        close(fd);
+        free(socket_path);
+        return 1;
+      }
 
-    if (send_jsonrpc(fd, wait_json) != 0) {
-      fprintf(stderr, "error: wait write failed: %s\n", strerror(errno));
+      if (send_jsonrpc(fd, wait_json) != 0) {
+        fprintf(stderr, "error: wait write failed: %s\n", strerror(errno));
+        free(wait_json);
+        free(session_id);
+        framer_free(&fr);
+        close(fd);
+        free(socket_path);
+        return 1;
+      }
       free(wait_json);
-      free(session_id);
-      framer_free(&fr);
-      close(fd);
-      free(socket_path);
-      return 1;
     }
-    free(wait_json);
 
-    uint8_t *wait_body = NULL;
+    const char *wait_resp = NULL;
     size_t wait_len = 0;
-    if (framer_read_frame(fd, &fr, timeout_ms, &wait_body, &wait_len) != 0) {
+    if (read_frame_skipping_stale(fd, &fr, timeout_ms, stale_ids, &wait_resp, &wait_len) != 0) {
       fprintf(stderr, "error: wait read failed: %s\n", strerror(errno));
       free(session_id);
       framer_free(&fr);
@@ -1026,10 +1431,8 @@ int main(int argc, char **argv) {
       free(socket_path);
       return 1;
     }
-    const char *wait_resp = (const char *)wait_body;
     if (response_has_error(wait_resp)) {
       fprintf(stderr, "error: wait returned error: %s\n", wait_resp);
-      free(wait_body);
       free(session_id);
       framer_free(&fr);
       close(fd);
@@ -1037,18 +1440,15 @@ int main(int argc, char **argv) {
       return 1;
     }
     bool user_closed = wait_reason_user_closed(wait_resp);
-    free(wait_body);
 
     if (user_closed) {
       // Best-effort close hint for server-side session bookkeeping.
       char *close_json = format_close_request_json(session_id);
       if (close_json) {
         if (send_jsonrpc(fd, close_json) == 0) {
-          uint8_t *close_body = NULL;
+          const char *close_resp = NULL;
           size_t close_len = 0;
-          if (framer_read_frame(fd, &fr, 500, &close_body, &close_len) == 0) {
-            free(close_body);
-          }
+          (void)read_frame_skipping_stale(fd, &fr, 500, stale_ids, &close_resp, &close_len);
         }
         free(close_json);
       }
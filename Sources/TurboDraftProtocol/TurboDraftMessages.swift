@@ -47,6 +47,9 @@ public struct SessionOpenParams: Codable, Sendable, Equatable {
   public var requestId: String?
   public var cwd: String?
   public var protocolVersion: Int?
+  /// Set by `turbodraft --trace`: the app records this open's spans under the id, for
+  /// `turbodraft.bench.trace`.
+  public var traceId: String?
 
   public init(
     path: String,
@@ -54,7 +57,8 @@ public struct SessionOpenParams: Codable, Sendable, Equatable {
     column: Int? = nil,
     requestId: String? = nil,
     cwd: String? = nil,
-    protocolVersion: Int? = TurboDraftProtocolVersion.current
+    protocolVersion: Int? = TurboDraftProtocolVersion.current,
+    traceId: String? = nil
   ) {
     self.path = path
     self.line = line
@@ -62,6 +66,7 @@ public struct SessionOpenParams: Codable, Sendable, Equatable {
     self.requestId = requestId
     self.cwd = cwd
     self.protocolVersion = protocolVersion
+    self.traceId = traceId
   }
 }
 
@@ -149,10 +154,14 @@ public struct SessionSaveResult: Codable, Sendable, Equatable {
   public var ok: Bool
   public var revision: String
   public var serverSaveMs: Double?
-  public init(ok: Bool, revision: String, serverSaveMs: Double? = nil) {
+  /// Time per step of the disk write behind this save (`create`, `write`, `chmod`, `rename`,
+  /// `hash`), when the save wrote.
+  public var serverSavePhaseMs: [String: Double]?
+  public init(ok: Bool, revision: String, serverSaveMs: Double? = nil, serverSavePhaseMs: [String: Double]? = nil) {
     self.ok = ok
     self.revision = revision
     self.serverSaveMs = serverSaveMs
+    self.serverSavePhaseMs = serverSavePhaseMs
   }
 }
 
@@ -169,6 +178,16 @@ public struct BenchMetricsResult: Codable, Sendable {
   public var historySnapshotBytes: Int64?
   public var stylerCacheEntryCount: Int?
   public var stylerCacheLimit: Int?
+  /// Share of line highlight lookups served from the (process-wide) line cache.
+  public var stylerCacheHitRate: Double?
+  public var socketActiveConnections: Int?
+  public var socketRejectedConnections: Int?
+  public var socketAcceptToFirstByteMs: [Double]?
+  /// Disk-change checks that found the file still as our last save left it and skipped the read.
+  public var suppressedSelfWriteEvents: Int?
+  /// Prompt-engineer runs that took a pre-spawned agent process, and runs that had to spawn one.
+  public var agentPoolHits: Int?
+  public var agentPoolMisses: Int?
 
   public init(
     typingLatencySamples: [Double],
@@ -177,7 +196,14 @@ public struct BenchMetricsResult: Codable, Sendable {
     historySnapshotCount: Int? = nil,
     historySnapshotBytes: Int64? = nil,
     stylerCacheEntryCount: Int? = nil,
-    stylerCacheLimit: Int? = nil
+    stylerCacheLimit: Int? = nil,
+    stylerCacheHitRate: Double? = nil,
+    socketActiveConnections: Int? = nil,
+    socketRejectedConnections: Int? = nil,
+    socketAcceptToFirstByteMs: [Double]? = nil,
+    suppressedSelfWriteEvents: Int? = nil,
+    agentPoolHits: Int? = nil,
+    agentPoolMisses: Int? = nil
   ) {
     self.typingLatencySamples = typingLatencySamples
     self.memoryResidentBytes = memoryResidentBytes
@@ -186,6 +212,56 @@ public struct BenchMetricsResult: Codable, Sendable {
     self.historySnapshotBytes = historySnapshotBytes
     self.stylerCacheEntryCount = stylerCacheEntryCount
     self.stylerCacheLimit = stylerCacheLimit
+    self.stylerCacheHitRate = stylerCacheHitRate
+    self.socketActiveConnections = socketActiveConnections
+    self.socketRejectedConnections = socketRejectedConnections
+    self.socketAcceptToFirstByteMs = socketAcceptToFirstByteMs
+    self.suppressedSelfWriteEvents = suppressedSelfWriteEvents
+    self.agentPoolHits = agentPoolHits
+    self.agentPoolMisses = agentPoolMisses
+  }
+}
+
+/// One timed phase of a traced open. Times are milliseconds on the host's uptime clock
+/// (`DispatchTime.uptimeNanoseconds`, `CLOCK_UPTIME_RAW`), which the launcher and the app share,
+/// so their spans line up on one timeline.
+public struct TraceSpan: Codable, Sendable, Equatable {
+  public var name: String
+  public var startMs: Double
+  public var endMs: Double
+
+  public init(name: String, startMs: Double, endMs: Double) {
+    self.name = name
+    self.startMs = startMs
+    self.endMs = endMs
+  }
+
+  public var durationMs: Double { max(0, endMs - startMs) }
+}
+
+public struct BenchTraceParams: Codable, Sendable, Equatable {
+  public var traceId: String
+  /// The launcher's own spans (connect, write, first response byte); added to the trace.
+  public var clientSpans: [TraceSpan]?
+
+  public init(traceId: String, clientSpans: [TraceSpan]? = nil) {
+    self.traceId = traceId
+    self.clientSpans = clientSpans
+  }
+}
+
+public struct BenchTraceResult: Codable, Sendable, Equatable {
+  public var traceId: String
+  public var sessionId: String?
+  public var spans: [TraceSpan]
+  /// False until the editor has been styled and focused, the last spans of an open.
+  public var complete: Bool
+
+  public init(traceId: String, sessionId: String? = nil, spans: [TraceSpan], complete: Bool) {
+    self.traceId = traceId
+    self.sessionId = sessionId
+    self.spans = spans
+    self.complete = complete
   }
 }
 
@@ -203,3 +279,72 @@ public struct SessionWaitResult: Codable, Sendable, Equatable {
   public var reason: String
   public init(reason: String) { self.reason = reason }
 }
+
+/// Combined open + wait in a single request. The server emits a `sessionOpened`
+/// notification as soon as the session is open, then answers the request itself
+/// with a `SessionWaitResult` when the session closes or times out.
+public struct SessionOpenAndWaitParams: Codable, Sendable, Equatable {
+  public var path: String
+  public var line: Int?
+  public var column: Int?
+  public var requestId: String?
+  public var cwd: String?
+  public var protocolVersion: Int?
+  public var timeoutMs: Int?
+
+  public init(
+    path: String,
+    line: Int? = nil,
+    column: Int? = nil,
+    requestId: String? = nil,
+    cwd: String? = nil,
+    protocolVersion: Int? = TurboDraftProtocolVersion.current,
+    timeoutMs: Int? = nil
+  ) {
+    self.path = path
+    self.line = line
+    self.column = column
+    self.requestId = requestId
+    self.cwd = cwd
+    self.protocolVersion = protocolVersion
+    self.timeoutMs = timeoutMs
+  }
+
+  public var openParams: SessionOpenParams {
+    SessionOpenParams(
+      path: path,
+      line: line,
+      column: column,
+      requestId: requestId,
+      cwd: cwd,
+      protocolVersion: protocolVersion
+    )
+  }
+}
+
+/// Open ack for `openAndWait`. Omits `content` so the launcher never pays to decode the buffer.
+public struct SessionOpenedParams: Codable, Sendable, Equatable {
+  public var sessionId: String
+  public var path: String
+  public var revision: String
+  public var isDirty: Bool
+  public var serverOpenMs: Double?
+
+  public init(sessionId: String, path: String, revision: String, isDirty: Bool, serverOpenMs: Double? = nil) {
+    self.sessionId = sessionId
+    self.path = path
+    self.revision = revision
+    self.isDirty = isDirty
+    self.serverOpenMs = serverOpenMs
+  }
+
+  public init(_ result: SessionOpenResult) {
+    self.init(
+      sessionId: result.sessionId,
+      path: result.path,
+      revision: result.revision,
+      isDirty: result.isDirty,
+      serverOpenMs: result.serverOpenMs
+    )
+  }
+}
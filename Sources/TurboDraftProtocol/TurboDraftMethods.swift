@@ -6,6 +6,11 @@ public enum TurboDraftMethod {
   public static let sessionWaitForRevision = "turbodraft.session.waitForRevision"
   public static let sessionSave = "turbodraft.session.save"
   public static let sessionWait = "turbodraft.session.wait"
+  public static let sessionOpenAndWait = "turbodraft.session.openAndWait"
+  /// Server → client notification sent on an `openAndWait` connection once the session is open.
+  public static let sessionOpened = "turbodraft.session.opened"
   public static let appQuit = "turbodraft.app.quit"
   public static let benchMetrics = "turbodraft.bench.metrics"
+  /// Adds the launcher's spans to a traced open and returns the whole trace.
+  public static let benchTrace = "turbodraft.bench.trace"
 }
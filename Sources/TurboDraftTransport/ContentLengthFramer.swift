@@ -17,60 +17,206 @@ public enum ContentLengthFramerError: Error, CustomStringConvertible {
 }
 
 /// Not thread-safe; expected to be used by a single owner (one framer per connection reader).
+///
+/// Bytes live in one growable arena: `start..<end` is unconsumed input, the header terminator
+/// search resumes at `scan`, and a parsed header is remembered until its body is complete, so
+/// a multi-MiB body arriving in 16 KiB reads is scanned once and copied once (into the frame).
 public final class ContentLengthFramer {
-  private var buffer = Data()
+  static let initialCapacity = 16 * 1024
+  /// Headers are a single `Content-Length` line in practice; anything longer is garbage.
+  static let maxHeaderBytes = 8 * 1024
+  /// Capacity above which an empty arena is released back to `initialCapacity`.
+  static let retainedCapacity = 256 * 1024
+  private static let contentLengthName = Array("content-length".utf8)
+
+  private var storage: UnsafeMutablePointer<UInt8>
+  private var capacity: Int
+  private var start = 0
+  private var end = 0
+  private var scan = 0
+  private var bodyStart = -1
+  private var bodyLength = 0
   private let maxFrameBytes: Int
 
   public init(maxFrameBytes: Int = 5 * 1024 * 1024) {
     self.maxFrameBytes = maxFrameBytes
+    self.capacity = Self.initialCapacity
+    self.storage = .allocate(capacity: Self.initialCapacity)
+  }
+
+  deinit {
+    storage.deallocate()
   }
 
+  /// Bytes buffered but not yet returned as frames.
+  public var bufferedByteCount: Int { end - start }
+
   public func append(_ data: Data) throws -> [Data] {
-    buffer.append(data)
-    var frames: [Data] = []
+    data.withUnsafeBytes { raw in
+      guard let base = raw.baseAddress, raw.count > 0 else { return }
+      reserve(raw.count)
+      (storage + end).update(from: base.assumingMemoryBound(to: UInt8.self), count: raw.count)
+      end += raw.count
+    }
+    return try takeFrames()
+  }
+
+  /// Lets the owner `read()` straight into the arena's free tail. `body` receives at least
+  /// `minimumCapacity` writable bytes (more while a large body is pending) and returns how many
+  /// it wrote; call `takeFrames()` afterwards.
+  @discardableResult
+  public func fill(minimumCapacity: Int, _ body: (UnsafeMutableRawBufferPointer) throws -> Int) rethrows -> Int {
+    var want = minimumCapacity
+    if bodyStart >= 0 {
+      want = max(want, bodyStart + bodyLength - end)
+    }
+    reserve(want)
+    let n = try body(UnsafeMutableRawBufferPointer(start: storage + end, count: capacity - end))
+    precondition(n >= 0 && n <= capacity - end)
+    end += n
+    return n
+  }
 
+  /// Returns every complete frame buffered so far, in order.
+  public func takeFrames() throws -> [Data] {
+    var frames: [Data] = []
     while true {
-      guard let headerEndRange = buffer.range(of: Data([13, 10, 13, 10])) else {
-        break
+      if bodyStart < 0 {
+        guard let headerEnd = findHeaderTerminator() else {
+          if end - start > Self.maxHeaderBytes + 3 {
+            throw ContentLengthFramerError.invalidHeaders
+          }
+          break
+        }
+        let length = try parseContentLength(headerEnd: headerEnd)
+        if length > maxFrameBytes {
+          throw ContentLengthFramerError.frameTooLarge(length)
+        }
+        bodyStart = headerEnd + 4
+        bodyLength = length
       }
 
-      let headerData = buffer.subdata(in: 0..<headerEndRange.lowerBound)
-      guard let headerText = String(data: headerData, encoding: .utf8) else {
-        throw ContentLengthFramerError.invalidHeaders
+      let bodyEnd = bodyStart + bodyLength
+      if end < bodyEnd { break }
+
+      frames.append(Data(bytes: storage + bodyStart, count: bodyLength))
+      start = bodyEnd
+      scan = bodyEnd
+      bodyStart = -1
+      bodyLength = 0
+    }
+
+    if start == end {
+      start = 0
+      end = 0
+      scan = 0
+      if capacity > Self.retainedCapacity {
+        storage.deallocate()
+        storage = .allocate(capacity: Self.initialCapacity)
+        capacity = Self.initialCapacity
       }
+    }
+    return frames
+  }
 
-      let length = try parseContentLength(headerText)
-      if length > maxFrameBytes {
-        throw ContentLengthFramerError.frameTooLarge(length)
+  /// Makes room for `count` more bytes after `end`, compacting only when the tail runs short.
+  private func reserve(_ count: Int) {
+    if capacity - end >= count { return }
+    if start > 0 {
+      let live = end - start
+      if live > 0 {
+        memmove(storage, storage + start, live)
       }
+      scan -= start
+      if bodyStart >= 0 { bodyStart -= start }
+      start = 0
+      end = live
+      if capacity - end >= count { return }
+    }
+    var newCapacity = capacity
+    while newCapacity - end < count {
+      newCapacity *= 2
+    }
+    let grown = UnsafeMutablePointer<UInt8>.allocate(capacity: newCapacity)
+    if end > 0 {
+      grown.update(from: storage, count: end)
+    }
+    storage.deallocate()
+    storage = grown
+    capacity = newCapacity
+  }
 
-      let bodyStart = headerEndRange.upperBound
-      let bodyEnd = bodyStart + length
-      if buffer.count < bodyEnd {
+  /// Offset of the `\r\n\r\n` that ends the current header block, or nil (remembering where to resume).
+  private func findHeaderTerminator() -> Int? {
+    var i = max(scan, start)
+    while end - i >= 4 {
+      guard let cr = memchr(storage + i, 13, end - i - 3) else {
+        i = end - 3
         break
       }
-
-      let body = buffer.subdata(in: bodyStart..<bodyEnd)
-      frames.append(body)
-      buffer.removeSubrange(0..<bodyEnd)
+      let at = storage.distance(to: cr.assumingMemoryBound(to: UInt8.self))
+      if storage[at + 1] == 10, storage[at + 2] == 13, storage[at + 3] == 10 {
+        return at
+      }
+      i = at + 1
     }
-
-    return frames
+    scan = max(start, i)
+    return nil
   }
 
-  private func parseContentLength(_ headers: String) throws -> Int {
-    let lines = headers.components(separatedBy: "\r\n")
-    for line in lines {
-      let parts = line.split(separator: ":", maxSplits: 1, omittingEmptySubsequences: true)
-      guard parts.count == 2 else { continue }
-      if String(parts[0]).trimmingCharacters(in: .whitespaces).lowercased() == "content-length" {
-        let value = parts[1].trimmingCharacters(in: .whitespaces)
-        guard let n = Int(value), n >= 0 else {
-          throw ContentLengthFramerError.invalidContentLength
-        }
-        return n
+  private func parseContentLength(headerEnd: Int) throws -> Int {
+    if headerEnd - start > Self.maxHeaderBytes {
+      throw ContentLengthFramerError.invalidHeaders
+    }
+    var lineStart = start
+    while lineStart <= headerEnd {
+      var lineEnd = lineStart
+      while lineEnd < headerEnd, !(storage[lineEnd] == 13 && storage[lineEnd + 1] == 10) {
+        // Headers are ASCII; the previous String-based parser rejected anything that wasn't UTF-8.
+        if storage[lineEnd] >= 0x80 { throw ContentLengthFramerError.invalidHeaders }
+        lineEnd += 1
       }
+      if let value = try contentLengthValue(lineStart, lineEnd) {
+        return value
+      }
+      lineStart = lineEnd + 2
     }
     throw ContentLengthFramerError.missingContentLength
   }
+
+  /// Parses `name: value` in `[lo, hi)`; nil when the line is not a Content-Length header.
+  private func contentLengthValue(_ lo: Int, _ hi: Int) throws -> Int? {
+    guard let colonPtr = memchr(storage + lo, 58, hi - lo) else { return nil }
+    let colon = storage.distance(to: colonPtr.assumingMemoryBound(to: UInt8.self))
+    if colon == lo { return nil }
+
+    let (nameLo, nameHi) = trimmed(lo, colon)
+    guard nameHi - nameLo == Self.contentLengthName.count else { return nil }
+    for (i, c) in Self.contentLengthName.enumerated() {
+      var b = storage[nameLo + i]
+      if b >= 65, b <= 90 { b |= 0x20 }
+      if b != c { return nil }
+    }
+
+    let (valueLo, valueHi) = trimmed(colon + 1, hi)
+    guard valueLo < valueHi else { throw ContentLengthFramerError.invalidContentLength }
+    var n = 0
+    for i in valueLo..<valueHi {
+      let b = storage[i]
+      guard b >= 48, b <= 57 else { throw ContentLengthFramerError.invalidContentLength }
+      let (mul, o1) = n.multipliedReportingOverflow(by: 10)
+      let (sum, o2) = mul.addingReportingOverflow(Int(b - 48))
+      if o1 || o2 { throw ContentLengthFramerError.invalidContentLength }
+      n = sum
+    }
+    return n
+  }
+
+  private func trimmed(_ lo: Int, _ hi: Int) -> (Int, Int) {
+    var lo = lo
+    var hi = hi
+    while lo < hi, storage[lo] == 32 || storage[lo] == 9 { lo += 1 }
+    while hi > lo, storage[hi - 1] == 32 || storage[hi - 1] == 9 { hi -= 1 }
+    return (lo, hi)
+  }
 }
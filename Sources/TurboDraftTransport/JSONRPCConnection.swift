@@ -28,6 +28,7 @@ public final class JSONRPCConnection: @unchecked Sendable {
   private let encoder: JSONEncoder
   private let writeLock = NSLock()
   private var pendingFrames: [Data] = []
+  private static let readChunkBytes = 16 * 1024
 
   public init(readHandle: FileHandle, writeHandle: FileHandle, maxFrameBytes: Int = 5 * 1024 * 1024) {
     self.readHandle = readHandle
@@ -47,29 +48,55 @@ public final class JSONRPCConnection: @unchecked Sendable {
   public func sendFrame(_ body: Data) throws {
     writeLock.lock()
     defer { writeLock.unlock() }
-    let header = "Content-Length: \(body.count)\r\n\r\n"
-    var data = Data(header.utf8)
-    data.append(body)
-    try data.withUnsafeBytes { rawBuf in
-      guard let base = rawBuf.baseAddress else { return }
-      var sent = 0
-      while sent < rawBuf.count {
-        let n = Darwin.write(writeFD, base.advanced(by: sent), rawBuf.count - sent)
-        if n < 0 {
-          if errno == EINTR { continue }
-          throw JSONRPCConnectionError.writeFailed(errno: errno)
-        }
-        if n == 0 {
-          throw JSONRPCConnectionError.writeFailed(errno: 0)
-        }
-        sent += n
+    var header = Array("Content-Length: \(body.count)\r\n\r\n".utf8)
+    // Header and body go out in one writev(); the body is never copied into a combined buffer.
+    try header.withUnsafeMutableBytes { headerBuf in
+      try body.withUnsafeBytes { bodyBuf in
+        var iov = [
+          iovec(iov_base: headerBuf.baseAddress, iov_len: headerBuf.count),
+          iovec(iov_base: UnsafeMutableRawPointer(mutating: bodyBuf.baseAddress), iov_len: bodyBuf.count),
+        ]
+        if bodyBuf.count == 0 { iov.removeLast() }
+        try writeFully(&iov)
+      }
+    }
+  }
+
+  private func writeFully(_ iov: inout [iovec]) throws {
+    var first = 0
+    while first < iov.count {
+      let n = iov[first...].withUnsafeBufferPointer { vecs in
+        Darwin.writev(writeFD, vecs.baseAddress, Int32(vecs.count))
+      }
+      if n < 0 {
+        if errno == EINTR { continue }
+        throw JSONRPCConnectionError.writeFailed(errno: errno)
+      }
+      if n == 0 {
+        throw JSONRPCConnectionError.writeFailed(errno: 0)
+      }
+      var remaining = n
+      while first < iov.count, remaining >= iov[first].iov_len {
+        remaining -= iov[first].iov_len
+        first += 1
+      }
+      if remaining > 0 {
+        iov[first].iov_base = iov[first].iov_base.map { $0 + remaining }
+        iov[first].iov_len -= remaining
       }
     }
   }
 
   public func readRequest() throws -> JSONRPCRequest {
+    try readTimedRequest().request
+  }
+
+  /// `readRequest`, plus when the frame was complete and when it was decoded.
+  func readTimedRequest() throws -> (request: JSONRPCRequest, frameReadNs: UInt64, decodedNs: UInt64) {
     let frame = try nextFrame()
-    return try decoder.decode(JSONRPCRequest.self, from: frame)
+    let frameReadNs = DispatchTime.now().uptimeNanoseconds
+    let request = try decoder.decode(JSONRPCRequest.self, from: frame)
+    return (request, frameReadNs, DispatchTime.now().uptimeNanoseconds)
   }
 
   public func readResponse() throws -> JSONRPCResponse {
@@ -83,7 +110,8 @@ public final class JSONRPCConnection: @unchecked Sendable {
     }
 
     while pendingFrames.isEmpty {
-      let frames = try framer.append(try readChunk())
+      try readChunk()
+      let frames = try framer.takeFrames()
       if !frames.isEmpty {
         pendingFrames.append(contentsOf: frames)
       }
@@ -91,18 +119,21 @@ public final class JSONRPCConnection: @unchecked Sendable {
     return pendingFrames.removeFirst()
   }
 
-  private func readChunk() throws -> Data {
-    var buf = [UInt8](repeating: 0, count: 16 * 1024)
-    while true {
-      let n = Darwin.read(readFD, &buf, buf.count)
-      if n < 0 {
-        if errno == EINTR { continue }
-        throw JSONRPCConnectionError.readFailed(errno: errno)
-      }
-      if n == 0 {
-        throw JSONRPCConnectionError.eof
+  /// Reads straight into the framer's arena; no per-read buffer or `Data` allocation.
+  private func readChunk() throws {
+    let fd = readFD
+    try framer.fill(minimumCapacity: Self.readChunkBytes) { tail in
+      while true {
+        let n = Darwin.read(fd, tail.baseAddress, tail.count)
+        if n < 0 {
+          if errno == EINTR { continue }
+          throw JSONRPCConnectionError.readFailed(errno: errno)
+        }
+        if n == 0 {
+          throw JSONRPCConnectionError.eof
+        }
+        return n
       }
-      return Data(buf[0..<n])
     }
   }
 }
@@ -3,27 +3,102 @@ import TurboDraftProtocol
 
 public typealias JSONRPCHandler = @Sendable (JSONRPCRequest) async -> JSONRPCResponse?
 
+/// Sends a server → client notification (a request with no id) on the handling connection.
+public typealias JSONRPCNotify = @Sendable (JSONRPCRequest) -> Void
+
+/// Handler variant for methods that emit notifications before their final response
+/// (for example `turbodraft.session.openAndWait`).
+public typealias JSONRPCStreamingHandler = @Sendable (JSONRPCRequest, JSONRPCNotify) async -> JSONRPCResponse?
+
+/// When the request being handled arrived, on the `DispatchTime` uptime clock. Bound for the
+/// duration of each handler call, for handlers that trace where a request's time went.
+public struct JSONRPCRequestTiming: Sendable, Equatable {
+  @TaskLocal public static var current: JSONRPCRequestTiming?
+
+  /// Accept and first readable byte of the connection; set for its first request only.
+  public var acceptedNs: UInt64?
+  public var firstByteNs: UInt64?
+  public var frameReadNs: UInt64
+  public var decodedNs: UInt64
+
+  public init(acceptedNs: UInt64? = nil, firstByteNs: UInt64? = nil, frameReadNs: UInt64, decodedNs: UInt64) {
+    self.acceptedNs = acceptedNs
+    self.firstByteNs = firstByteNs
+    self.frameReadNs = frameReadNs
+    self.decodedNs = decodedNs
+  }
+}
+
 public final class JSONRPCServerConnection: @unchecked Sendable {
+  private struct Received: Sendable {
+    var request: JSONRPCRequest
+    var timing: JSONRPCRequestTiming
+  }
+
   private let connection: JSONRPCConnection
-  private let handler: JSONRPCHandler
+  private let handler: JSONRPCStreamingHandler
+  private let onClose: (@Sendable () -> Void)?
+  private let acceptedNs: UInt64?
+  private let firstByteNs: UInt64?
 
-  public init(connection: JSONRPCConnection, handler: @escaping JSONRPCHandler) {
+  public convenience init(connection: JSONRPCConnection, handler: @escaping JSONRPCHandler) {
+    self.init(connection: connection, streamingHandler: { req, _ in await handler(req) })
+  }
+
+  /// `onClose` runs once after the peer disconnects (or sends something unparseable) and the
+  /// last in-flight request has been answered. `acceptedNs`/`firstByteNs` (from the socket
+  /// server's lease) go into the first request's `JSONRPCRequestTiming`.
+  public init(
+    connection: JSONRPCConnection,
+    streamingHandler: @escaping JSONRPCStreamingHandler,
+    onClose: (@Sendable () -> Void)? = nil,
+    acceptedNs: UInt64? = nil,
+    firstByteNs: UInt64? = nil
+  ) {
     self.connection = connection
-    self.handler = handler
+    self.handler = streamingHandler
+    self.onClose = onClose
+    self.acceptedNs = acceptedNs
+    self.firstByteNs = firstByteNs
   }
 
   public func run() {
-    Task.detached(priority: .utility) { [connection, handler] in
+    // Blocking read() lives on its own queue rather than a cooperative-pool thread: several
+    // clients parked in session.wait would otherwise pin the pool and stall every async handler.
+    let (requests, continuation) = AsyncStream.makeStream(of: Received.self)
+    let reader = DispatchQueue(label: "turbodraft.jsonrpc.reader", qos: .userInitiated)
+    reader.async { [connection, acceptedNs, firstByteNs] in
+      var first = true
       while true {
         do {
-          let req = try connection.readRequest()
-          if let resp = await handler(req) {
-            try? connection.sendJSON(resp)
-          }
+          let read = try connection.readTimedRequest()
+          continuation.yield(Received(request: read.request, timing: JSONRPCRequestTiming(
+            acceptedNs: first ? acceptedNs : nil,
+            firstByteNs: first ? firstByteNs : nil,
+            frameReadNs: read.frameReadNs,
+            decodedNs: read.decodedNs
+          )))
+          first = false
         } catch {
+          continuation.finish()
           return
         }
       }
     }
+
+    Task.detached(priority: .userInitiated) { [connection, handler, onClose] in
+      let notify: JSONRPCNotify = { note in
+        try? connection.sendJSON(note)
+      }
+      for await received in requests {
+        let resp = await JSONRPCRequestTiming.$current.withValue(received.timing) {
+          await handler(received.request, notify)
+        }
+        if let resp {
+          try? connection.sendJSON(resp)
+        }
+      }
+      onClose?()
+    }
   }
 }
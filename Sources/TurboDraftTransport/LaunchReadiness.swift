@@ -0,0 +1,30 @@
+import Foundation
+import Darwin
+
+/// Readiness handshake between `turbodraft` and the `turbodraft-app` it spawns.
+///
+/// The launcher passes the write end of a pipe via `TURBODRAFT_READY_FD`; the app writes one
+/// byte once the socket is accepting connections (or just closes it on failure), so the
+/// launcher wakes immediately instead of polling `connect()` on a backoff schedule.
+public enum LaunchReadiness {
+  public static let environmentKey = "TURBODRAFT_READY_FD"
+
+  /// Signals (when `listening`) and releases the inherited readiness fd. Safe to call more than once.
+  public static func finish(listening: Bool) {
+    guard let raw = getenv(environmentKey) else { return }
+    let value = String(cString: raw)
+    // Don't leak the fd number to agent processes spawned later.
+    unsetenv(environmentKey)
+    guard let fd = Int32(value), fd > STDERR_FILENO else { return }
+
+    var st = stat()
+    guard fstat(fd, &st) == 0, (st.st_mode & S_IFMT) == S_IFIFO else { return }
+    if listening {
+      // The launcher may already have timed out and exited; never die of SIGPIPE for it.
+      _ = fcntl(fd, F_SETNOSIGPIPE, 1)
+      var byte: UInt8 = 1
+      while Darwin.write(fd, &byte, 1) < 0, errno == EINTR {}
+    }
+    close(fd)
+  }
+}
@@ -181,12 +181,63 @@ public enum UnixDomainSocket {
   }
 }
 
+/// Point-in-time counters for `UnixDomainSocketServer` (surfaced through `bench.metrics`).
+public struct UnixDomainSocketServerStats: Sendable, Equatable {
+  public var activeConnections: Int
+  public var peakActiveConnections: Int
+  public var acceptedConnections: Int
+  public var rejectedConnections: Int
+  /// Most recent accept → first readable byte latencies, oldest first.
+  public var acceptToFirstByteMs: [Double]
+}
+
 public final class UnixDomainSocketServer: @unchecked Sendable {
+  /// Holds one of the server's connection slots; the slot is freed by `release()` or on deinit.
+  public final class Lease: @unchecked Sendable {
+    private weak var server: UnixDomainSocketServer?
+    private let lock = NSLock()
+    private var released = false
+    /// `DispatchTime` uptime of the accept, and of the first readable byte (nil if the peer
+    /// hung up without sending). Both are set before the handler runs.
+    public let acceptedAtNs: UInt64
+    public fileprivate(set) var firstByteAtNs: UInt64?
+
+    fileprivate init(server: UnixDomainSocketServer, acceptedAtNs: UInt64) {
+      self.server = server
+      self.acceptedAtNs = acceptedAtNs
+    }
+
+    deinit {
+      release()
+    }
+
+    public func release() {
+      lock.lock()
+      let first = !released
+      released = true
+      lock.unlock()
+      if first {
+        server?.releaseSlot()
+      }
+    }
+  }
+
+  static let firstByteSampleLimit = 64
+
   private let listenFD: Int32
   private let queue: DispatchQueue
+  private let clientQueue: DispatchQueue
   private let lock = NSLock()
   private var _running = true
   private var _stopped = false
+  public let maxConcurrentConnections: Int
+  /// A connection that sends nothing for this long after accept is closed and its slot freed.
+  public let firstByteTimeoutMs: Int
+  private var activeConnections = 0
+  private var peakActiveConnections = 0
+  private var acceptedConnections = 0
+  private var rejectedConnections = 0
+  private var firstByteSamplesMs: [Double] = []
 
   private var running: Bool {
     lock.lock()
@@ -194,21 +245,40 @@ public final class UnixDomainSocketServer: @unchecked Sendable {
     return _running
   }
 
-  public init(socketPath: String) throws {
+  public init(socketPath: String, maxConcurrentConnections: Int = 32, firstByteTimeoutMs: Int = 10_000) throws {
     self.listenFD = try UnixDomainSocket.bindAndListen(path: socketPath)
     self.queue = DispatchQueue(label: "turbodraft.uds.accept")
+    self.clientQueue = DispatchQueue(label: "turbodraft.uds.client", qos: .userInitiated, attributes: .concurrent)
+    self.maxConcurrentConnections = max(1, maxConcurrentConnections)
+    self.firstByteTimeoutMs = max(1, firstByteTimeoutMs)
   }
 
   deinit {
     stop()
   }
 
+  /// Fire-and-forget variant: the connection slot is released as soon as `handler` returns.
   public func start(handler: @escaping @Sendable (Int32) -> Void) {
-    queue.async { [listenFD] in
+    start { fd, _ in handler(fd) }
+  }
+
+  /// Accepts on a dedicated queue and never runs client code there: each accepted socket is
+  /// handed to `handler` on a concurrent client queue once its first byte is readable, so a
+  /// long `session.wait` on one connection can't delay the next accept. No thread waits for
+  /// that byte, and a peer that sends nothing within `firstByteTimeoutMs` is closed without
+  /// reaching `handler`. Connections beyond `maxConcurrentConnections` are closed immediately.
+  /// Keep `lease` alive for as long as the connection is being served.
+  public func start(handler: @escaping @Sendable (Int32, Lease) -> Void) {
+    queue.async { [listenFD, clientQueue] in
       while self.running {
         do {
           let clientFD = try UnixDomainSocket.accept(listenFD: listenFD, requireSameUser: true)
-          handler(clientFD)
+          let acceptedAt = DispatchTime.now().uptimeNanoseconds
+          guard let lease = self.acquireSlot(acceptedAt: acceptedAt) else {
+            close(clientFD)
+            continue
+          }
+          self.awaitFirstByte(fd: clientFD, lease: lease, handler: handler)
         } catch {
           if self.running {
             continue
@@ -219,6 +289,18 @@ public final class UnixDomainSocketServer: @unchecked Sendable {
     }
   }
 
+  public func stats() -> UnixDomainSocketServerStats {
+    lock.lock()
+    defer { lock.unlock() }
+    return UnixDomainSocketServerStats(
+      activeConnections: activeConnections,
+      peakActiveConnections: peakActiveConnections,
+      acceptedConnections: acceptedConnections,
+      rejectedConnections: rejectedConnections,
+      acceptToFirstByteMs: firstByteSamplesMs
+    )
+  }
+
   public func stop() {
     lock.lock()
     let wasRunning = _running
@@ -230,4 +312,69 @@ public final class UnixDomainSocketServer: @unchecked Sendable {
       close(listenFD)
     }
   }
+
+  private func acquireSlot(acceptedAt: UInt64) -> Lease? {
+    lock.lock()
+    defer { lock.unlock() }
+    guard activeConnections < maxConcurrentConnections else {
+      rejectedConnections += 1
+      return nil
+    }
+    activeConnections += 1
+    acceptedConnections += 1
+    peakActiveConnections = max(peakActiveConnections, activeConnections)
+    return Lease(server: self, acceptedAtNs: acceptedAt)
+  }
+
+  fileprivate func releaseSlot() {
+    lock.lock()
+    activeConnections = max(0, activeConnections - 1)
+    lock.unlock()
+  }
+
+  /// Hands `fd` to `handler` once the peer has sent something (or hung up), with the time that
+  /// happened in `lease`; closes it and frees the slot if `firstByteTimeoutMs` passes first.
+  /// The read source and the timer share a serial queue, so exactly one of them wins.
+  private func awaitFirstByte(fd: Int32, lease: Lease, handler: @escaping @Sendable (Int32, Lease) -> Void) {
+    let waitQueue = DispatchQueue(label: "turbodraft.uds.first-byte", target: clientQueue)
+    let readable = DispatchSource.makeReadSource(fileDescriptor: fd, queue: waitQueue)
+    let timeout = DispatchSource.makeTimerSource(queue: waitQueue)
+    let acceptedAt = lease.acceptedAtNs
+
+    readable.setEventHandler { [weak self] in
+      guard !readable.isCancelled else { return }
+      // 0 bytes pending on a readable socket: the peer hung up without sending.
+      let sentData = readable.data > 0
+      timeout.cancel()
+      readable.cancel()
+      lease.firstByteAtNs = sentData ? self?.recordFirstByte(acceptedAt: acceptedAt) : nil
+      handler(fd, lease)
+    }
+    timeout.setEventHandler {
+      guard !readable.isCancelled else { return }
+      timeout.cancel()
+      // The fd is closed once the source lets go of it.
+      readable.setCancelHandler {
+        close(fd)
+        lease.release()
+      }
+      readable.cancel()
+    }
+    timeout.schedule(deadline: .now() + .milliseconds(firstByteTimeoutMs))
+    timeout.resume()
+    readable.resume()
+  }
+
+  /// Records accept → first byte for `stats()`, and returns now.
+  private func recordFirstByte(acceptedAt: UInt64) -> UInt64 {
+    let now = DispatchTime.now().uptimeNanoseconds
+    let ms = Double(now - acceptedAt) / 1_000_000
+    lock.lock()
+    firstByteSamplesMs.append(ms)
+    if firstByteSamplesMs.count > Self.firstByteSampleLimit {
+      firstByteSamplesMs.removeFirst(firstByteSamplesMs.count - Self.firstByteSampleLimit)
+    }
+    lock.unlock()
+    return now
+  }
 }
@@ -0,0 +1,123 @@
+import Foundation
+import TurboDraftAgent
+import XCTest
+
+final class AgentProcessPoolTests: XCTestCase {
+  // Copies stdin to the scratch file and echoes a marker, like `codex exec --output-last-message`.
+  private let spec = AgentProcessSpec(
+    executablePath: "/bin/sh",
+    arguments: ["-c", "cat > \"$1\"; echo ran", "sh", AgentProcessPool.scratchPathPlaceholder]
+  )
+
+  private func waitForIdle(_ pool: AgentProcessPool, count: Int) {
+    let deadline = Date().addingTimeInterval(5)
+    while pool.stats().idleProcesses != count, Date() < deadline {
+      usleep(10_000)
+    }
+    XCTAssertEqual(pool.stats().idleProcesses, count)
+  }
+
+  func testSecondRunTakesPreSpawnedProcess() throws {
+    let pool = AgentProcessPool()
+    defer { pool.drain() }
+
+    let first = try pool.run(spec, stdin: Data("one".utf8), timeoutMs: 5_000, maxOutputBytes: 4096)
+    XCTAssertFalse(first.poolHit)
+    XCTAssertEqual(first.exitCode, 0)
+    XCTAssertEqual(String(decoding: first.output, as: UTF8.self), "ran\n")
+    XCTAssertEqual(first.scratchOutput.map { String(decoding: $0, as: UTF8.self) }, "one")
+
+    waitForIdle(pool, count: 1)
+    let second = try pool.run(spec, stdin: Data("two".utf8), timeoutMs: 5_000, maxOutputBytes: 4096, keepWarm: false)
+    XCTAssertTrue(second.poolHit)
+    XCTAssertEqual(second.scratchOutput.map { String(decoding: $0, as: UTF8.self) }, "two")
+
+    let stats = pool.stats()
+    XCTAssertEqual(stats.hits, 1)
+    XCTAssertEqual(stats.misses, 1)
+    XCTAssertEqual(stats.idleProcesses, 0)
+  }
+
+  func testOtherSpecsAndExpiredProcessesMiss() throws {
+    let pool = AgentProcessPool(idleTTLMs: 0)
+    defer { pool.drain() }
+
+    _ = try pool.run(spec, stdin: Data(), timeoutMs: 5_000, maxOutputBytes: 4096)
+    waitForIdle(pool, count: 1)
+    usleep(2_000)
+    let expired = try pool.run(spec, stdin: Data(), timeoutMs: 5_000, maxOutputBytes: 4096, keepWarm: false)
+    XCTAssertFalse(expired.poolHit)
+
+    let cat = AgentProcessSpec(executablePath: "/bin/cat", arguments: [])
+    let other = try pool.run(cat, stdin: Data("x".utf8), timeoutMs: 5_000, maxOutputBytes: 4096, keepWarm: false)
+    XCTAssertFalse(other.poolHit)
+    XCTAssertEqual(String(decoding: other.output, as: UTF8.self), "x")
+    XCTAssertEqual(pool.stats().misses, 3)
+  }
+
+  func testEvictIdleKeepsPreSpawning() throws {
+    let pool = AgentProcessPool()
+    defer { pool.drain() }
+
+    _ = try pool.run(spec, stdin: Data(), timeoutMs: 5_000, maxOutputBytes: 4096)
+    waitForIdle(pool, count: 1)
+    pool.evictIdle()
+    XCTAssertEqual(pool.stats().idleProcesses, 0)
+
+    let cold = try pool.run(spec, stdin: Data("x".utf8), timeoutMs: 5_000, maxOutputBytes: 4096)
+    XCTAssertFalse(cold.poolHit)
+    XCTAssertEqual(cold.scratchOutput.map { String(decoding: $0, as: UTF8.self) }, "x")
+    waitForIdle(pool, count: 1)
+  }
+
+  func testDrainKillsIdleProcessesWithoutRunningThem() throws {
+    let pool = AgentProcessPool()
+    _ = try pool.run(spec, stdin: Data(), timeoutMs: 5_000, maxOutputBytes: 4096)
+    waitForIdle(pool, count: 1)
+    pool.drain()
+    XCTAssertEqual(pool.stats().idleProcesses, 0)
+  }
+
+  func testDismissedIdleProcessNeverSeesEOFWithoutAPrompt() throws {
+    let marker = FileManager.default.temporaryDirectory.appendingPathComponent("turbodraft-pool-ran-\(UUID().uuidString)")
+    defer { try? FileManager.default.removeItem(at: marker) }
+    // Like the agent CLIs: runs as soon as stdin closes, prompt or not.
+    let eager = AgentProcessSpec(executablePath: "/bin/sh", arguments: ["-c", "cat > /dev/null; touch \"$1\"", "sh", marker.path])
+    let pool = AgentProcessPool()
+    _ = try pool.run(eager, stdin: Data("first".utf8), timeoutMs: 5_000, maxOutputBytes: 4096)
+    XCTAssertTrue(FileManager.default.fileExists(atPath: marker.path))
+    try FileManager.default.removeItem(at: marker)
+
+    waitForIdle(pool, count: 1)
+    pool.drain()
+    usleep(300_000)
+    XCTAssertFalse(FileManager.default.fileExists(atPath: marker.path))
+  }
+
+  func testSpecFilesLiveAsLongAsAProcessThatReadsThem() throws {
+    let url = FileManager.default.temporaryDirectory.appendingPathComponent("turbodraft-pool-file-\(UUID().uuidString).txt")
+    defer { try? FileManager.default.removeItem(at: url) }
+    let reader = AgentProcessSpec(
+      executablePath: "/bin/sh",
+      arguments: ["-c", "cat > /dev/null; cat \"$1\"", "sh", url.path],
+      files: [AgentProcessSpec.File(url: url, contents: Data("preamble".utf8))]
+    )
+    let pool = AgentProcessPool()
+
+    let cold = try pool.run(reader, stdin: Data(), timeoutMs: 5_000, maxOutputBytes: 4096)
+    XCTAssertEqual(String(decoding: cold.output, as: UTF8.self), "preamble")
+    // The pre-spawned replacement still needs it.
+    waitForIdle(pool, count: 1)
+    XCTAssertTrue(FileManager.default.fileExists(atPath: url.path))
+
+    let warm = try pool.run(reader, stdin: Data(), timeoutMs: 5_000, maxOutputBytes: 4096)
+    XCTAssertTrue(warm.poolHit)
+    XCTAssertEqual(String(decoding: warm.output, as: UTF8.self), "preamble")
+    waitForIdle(pool, count: 1)
+    pool.drain()
+    XCTAssertFalse(FileManager.default.fileExists(atPath: url.path))
+
+    _ = try pool.run(reader, stdin: Data(), timeoutMs: 5_000, maxOutputBytes: 4096, keepWarm: false)
+    XCTAssertFalse(FileManager.default.fileExists(atPath: url.path))
+  }
+}
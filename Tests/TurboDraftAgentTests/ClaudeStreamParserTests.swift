@@ -0,0 +1,54 @@
+@testable import TurboDraftAgent
+import XCTest
+
+final class ClaudeStreamParserTests: XCTestCase {
+  func testDeltasArriveAcrossSplitLinesAndResultWins() {
+    let lines = [
+      #"{"type":"system","subtype":"init"}"#,
+      #"{"type":"stream_event","event":{"type":"content_block_delta","index":0,"delta":{"type":"text_delta","text":"## Go"}}}"#,
+      "some stderr noise",
+      #"{"type":"stream_event","event":{"type":"content_block_delta","index":0,"delta":{"type":"text_delta","text":"al\n"}}}"#,
+      #"{"type":"result","subtype":"success","is_error":false,"result":"## Goal\n"}"#,
+    ]
+    let bytes = Data((lines.joined(separator: "\n") + "\n").utf8)
+
+    var parser = ClaudeStreamParser()
+    var deltas: [String] = []
+    var offset = 0
+    while offset < bytes.count {
+      let end = min(bytes.count, offset + 7)
+      deltas += parser.append(bytes.subdata(in: offset..<end))
+      offset = end
+    }
+    XCTAssertEqual(deltas, ["## Go", "al\n"])
+    XCTAssertEqual(parser.text, "## Goal\n")
+    XCTAssertEqual(parser.result, "## Goal\n")
+    XCTAssertFalse(parser.isError)
+  }
+
+  func testLongEventInSmallChunksAndSeveralLinesInOneChunk() {
+    let long = String(repeating: "x", count: 200_000)
+    let event = #"{"type":"stream_event","event":{"type":"content_block_delta","index":0,"delta":{"type":"text_delta","text":""# + long + #""}}}"#
+    var parser = ClaudeStreamParser()
+    var deltas: [String] = []
+    let bytes = Data((event + "\n").utf8)
+    var offset = 0
+    while offset < bytes.count {
+      let end = min(bytes.count, offset + 64)
+      deltas += parser.append(bytes.subdata(in: offset..<end))
+      offset = end
+    }
+    XCTAssertEqual(deltas, [long])
+
+    let tail = [
+      #"{"type":"stream_event","event":{"type":"content_block_delta","index":0,"delta":{"type":"text_delta","text":"a"}}}"#,
+      #"{"type":"stream_event","event":{"type":"content_block_delta","index":0,"delta":{"type":"text_delta","text":"b"}}}"#,
+      #"{"type":"result","subtype":"success","is_error":false,"#,
+    ].joined(separator: "\n")
+    XCTAssertEqual(parser.append(Data(tail.utf8)), ["a", "b"])
+    XCTAssertNil(parser.result)
+    XCTAssertEqual(parser.append(Data((#""result":"done"}"# + "\n").utf8)), [])
+    XCTAssertEqual(parser.result, "done")
+    XCTAssertEqual(parser.text, long + "ab")
+  }
+}
@@ -1,4 +1,5 @@
 import TurboDraftAgent
+import TurboDraftTestSupport
 import XCTest
 
 final class PromptEngineerOutputGuardTests: XCTestCase {
@@ -100,4 +101,40 @@ final class PromptEngineerOutputGuardTests: XCTestCase {
     XCTAssertEqual(PromptEngineerOutputGuard.suggestedRepairEffort("none"), "low")
     XCTAssertEqual(PromptEngineerOutputGuard.suggestedRepairEffort(""), "")
   }
+
+  func testStreamingCheckMatchesCheckForAnyChunking() {
+    let draft = String(repeating: "abc ", count: 60)
+    let outputs = [
+      "## Goal\r\nDo it.\n\n## Steps\n1. One.\n2. Two.\n",
+      "You are TurboDraft, a prompt engineering assistant.\n<BEGIN_PROMPT>\n\(draft)\n<END_PROMPT>",
+      "## Inputs Needed\n- [TODO: paste logs]\n## Implementation Steps\n1. Only one.\n",
+      "   \n\n",
+      "# Plan\nDraft Prompt to Improve: x\n## Task Plan\n   1. a\n   2. b",
+    ]
+    var rng = SeededRandomNumberGenerator()
+    for out in outputs {
+      let expected = PromptEngineerOutputGuard.check(draft: draft, output: out)
+      for _ in 0..<20 {
+        var check = PromptEngineerOutputGuard.StreamingCheck()
+        var rest = Substring(out)
+        while !rest.isEmpty {
+          let n = Int.random(in: 1...8, using: &rng)
+          check.append(String(rest.prefix(n)))
+          rest = rest.dropFirst(n)
+          for reason in check.settledReasons {
+            XCTAssertTrue(expected.reasons.contains(reason), "\(reason), \(rng)")
+          }
+        }
+        XCTAssertEqual(check.finish(draft: draft), expected, "\(rng)")
+      }
+    }
+  }
+
+  func testStreamingCheckSettlesOnLeakedMarkersBeforeTheEnd() {
+    var check = PromptEngineerOutputGuard.StreamingCheck()
+    check.append("Sure. <BEGIN_PROMPT>")
+    XCTAssertTrue(check.settledReasons.isEmpty)
+    check.append("\nmore")
+    XCTAssertEqual(check.settledReasons, ["contains_prompt_markers"])
+  }
 }
@@ -53,6 +53,36 @@ final class EditorWorkflowTests: XCTestCase {
     return vc
   }
 
+  func testReplaceAllKeepsUntouchedLinesStyled() async throws {
+    let vc = try await makeController(initialText: "todo one\n# Heading\n- item\ntodo two\nplain\ntodo three\ntail\n")
+    let before = vc._testingDocumentText() as NSString
+    let heading = before.lineRange(for: before.range(of: "# Heading"))
+    let item = before.lineRange(for: before.range(of: "- item"))
+    let plain = before.lineRange(for: before.range(of: "plain"))
+    XCTAssertTrue(vc._testingIsStyled(NSRange(location: 0, length: before.length)))
+
+    // Same-length replacements, so the untouched lines keep their offsets.
+    vc._testingShowFind(replace: true)
+    vc._testingSetFindQuery("todo")
+    vc._testingSetReplaceText("done")
+    vc._testingReplaceAll()
+    let after = vc._testingDocumentText() as NSString
+    XCTAssertEqual(after as String, "done one\n# Heading\n- item\ndone two\nplain\ndone three\ntail\n")
+    XCTAssertTrue(vc._testingIsStyled(heading))
+    XCTAssertTrue(vc._testingIsStyled(item))
+    XCTAssertTrue(vc._testingIsStyled(plain))
+    XCTAssertFalse(vc._testingIsStyled(after.lineRange(for: after.range(of: "done two"))))
+
+    // A replacement that opens a fence does unstyle the lines it swallows.
+    vc._testingSetFindQuery("done two")
+    vc._testingSetReplaceText("```")
+    vc._testingReplaceAll()
+    let fenced = vc._testingDocumentText() as NSString
+    XCTAssertTrue(vc._testingIsStyled(fenced.lineRange(for: fenced.range(of: "# Heading"))))
+    XCTAssertFalse(vc._testingIsStyled(fenced.lineRange(for: fenced.range(of: "plain"))))
+    XCTAssertFalse(vc._testingIsStyled(fenced.lineRange(for: fenced.range(of: "tail"))))
+  }
+
   func testFindReplaceAndImageSmoke() async throws {
     let pump: (Int) -> Void = { ms in
       RunLoop.main.run(until: Date().addingTimeInterval(Double(ms) / 1_000.0))
@@ -0,0 +1,61 @@
+import Foundation
+import TurboDraftCore
+import XCTest
+@testable import TurboDraftApp
+
+final class IdleWindowPoolSizerTests: XCTestCase {
+  private var calendar: Calendar {
+    var c = Calendar(identifier: .gregorian)
+    c.timeZone = TimeZone(identifier: "UTC")!
+    return c
+  }
+
+  private func date(day: Int, hour: Int, minute: Int = 0) -> Date {
+    calendar.date(from: DateComponents(year: 2026, month: 3, day: day, hour: hour, minute: minute))!
+  }
+
+  private func makeSizer() -> IdleWindowPoolSizer {
+    var sizer = IdleWindowPoolSizer()
+    sizer.calendar = calendar
+    return sizer
+  }
+
+  func testNoHistoryKeepsOneWindow() {
+    XCTAssertEqual(makeSizer().targetIdleCount(at: date(day: 10, hour: 9)), 1)
+  }
+
+  func testRecentConcurrencyRaisesTargetThenDecays() {
+    var sizer = makeSizer()
+    sizer.recordOpen(at: date(day: 10, hour: 14, minute: 0), concurrentWindows: 3)
+    XCTAssertEqual(sizer.targetIdleCount(at: date(day: 10, hour: 14, minute: 20)), 3)
+    // Past the recent window and in an hour with no history of its own.
+    XCTAssertEqual(sizer.targetIdleCount(at: date(day: 10, hour: 17)), 1)
+  }
+
+  func testSameHourOnEarlierDaysPredictsDemand() {
+    var sizer = makeSizer()
+    sizer.recordOpen(at: date(day: 8, hour: 10, minute: 5), concurrentWindows: 2)
+    sizer.recordOpen(at: date(day: 9, hour: 10, minute: 40), concurrentWindows: 9)
+    // The hour before counts too, so the pool is warm when the burst starts; capped at maxIdle.
+    XCTAssertEqual(sizer.targetIdleCount(at: date(day: 12, hour: 9, minute: 50)), 4)
+    XCTAssertEqual(sizer.targetIdleCount(at: date(day: 12, hour: 12)), 1)
+    // Older than the history window.
+    XCTAssertEqual(sizer.targetIdleCount(at: date(day: 28, hour: 10)), 1)
+  }
+
+  func testSeedsFromTelemetryRecords() {
+    var sizer = makeSizer()
+    func record(_ eventID: UInt16, count: Int32, at date: Date) -> TelemetryRecord {
+      TelemetryRecord(eventID: eventID, flags: 0, count: count, value: 3, monotonicNs: 0, date: date)
+    }
+    let records = [
+      record(TelemetryEvent.appSessionOpen.rawValue, count: 2, at: date(day: 9, hour: 16, minute: 10)),
+      record(TelemetryEvent.appSessionOpen.rawValue, count: 0, at: date(day: 9, hour: 16, minute: 20)),
+      record(999, count: 4, at: date(day: 9, hour: 16, minute: 30)),
+      record(TelemetryEvent.appSessionOpen.rawValue, count: 4, at: date(day: 1, hour: 16)),
+    ]
+    sizer.seed(from: records, now: date(day: 20, hour: 16))
+    XCTAssertEqual(sizer.opens.map(\.concurrentWindows), [2, 1])
+    XCTAssertEqual(sizer.targetIdleCount(at: date(day: 20, hour: 16)), 2)
+  }
+}
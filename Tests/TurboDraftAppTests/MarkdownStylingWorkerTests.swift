@@ -0,0 +1,38 @@
+import TurboDraftMarkdown
+import XCTest
+@testable import TurboDraftApp
+
+final class MarkdownStylingWorkerTests: XCTestCase {
+  func testComputesSpansForCurrentVersion() {
+    let worker = MarkdownStylingWorker()
+    let text = "# Title\n```\ncode\n```\n**bold**"
+    let ns = text as NSString
+    let index = MarkdownFenceIndex(text: ns)
+    let lines = ns.lineRange(for: ns.range(of: "code"))
+    let expected = MarkdownHighlighter.highlights(in: text, range: lines, fenceIndex: index)
+    XCTAssertTrue(expected.contains { $0.kind == .codeBlockLine })
+
+    let done = expectation(description: "computed")
+    let job = MarkdownStylingWorker.Job(lines: lines, entryState: index.state(before: lines.location))
+    worker.compute([job], in: text, version: worker.currentVersion) { results in
+      XCTAssertEqual(results.map(\.lines), [lines])
+      XCTAssertEqual(results.first?.spans, expected)
+      done.fulfill()
+    }
+    wait(for: [done], timeout: 2)
+  }
+
+  func testEditBeforeCompletionDropsStaleBatch() {
+    let worker = MarkdownStylingWorker()
+    let version = worker.currentVersion
+    worker.advanceVersion()
+
+    let completed = expectation(description: "stale batch completes")
+    completed.isInverted = true
+    let job = MarkdownStylingWorker.Job(lines: NSRange(location: 0, length: 5), entryState: .outside)
+    worker.compute([job], in: "**a**", version: version) { _ in
+      completed.fulfill()
+    }
+    wait(for: [completed], timeout: 0.3)
+  }
+}
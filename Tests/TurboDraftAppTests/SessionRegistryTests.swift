@@ -0,0 +1,101 @@
+import XCTest
+@testable import TurboDraftApp
+
+final class SessionRegistryTests: XCTestCase {
+  private final class Session {}
+  private final class Window {}
+
+  private let second: UInt64 = 1_000_000_000
+
+  private func makeRegistry() -> SessionRegistry<Session, Window> {
+    SessionRegistry(orphanMaxAgeNs: 120 * second)
+  }
+
+  func testLookupsAndRemoval() {
+    var registry = makeRegistry()
+    let session = Session()
+    let window = Window()
+    registry.register(id: "a", path: "/tmp/a.md", session: session, window: window, nowNs: 0)
+
+    XCTAssertTrue(registry.session("a") === session)
+    XCTAssertTrue(registry.window("a") === window)
+    XCTAssertTrue(registry.entry(forPath: "/tmp/a.md")?.window === window)
+    XCTAssertNil(registry.entry(forPath: "/tmp/b.md"))
+
+    XCTAssertTrue(registry.remove("a") === session)
+    XCTAssertNil(registry.session("a"))
+    XCTAssertTrue(registry.isEmpty)
+  }
+
+  func testSessionWithoutWindowExpiresAfterMaxAgeSinceLastTouch() {
+    var registry = makeRegistry()
+    let session = Session()
+    var window: Window? = Window()
+    registry.register(id: "a", path: "/tmp/a.md", session: session, window: window!, nowNs: 0)
+    window = nil
+    XCTAssertNil(registry.entry(forPath: "/tmp/a.md"))
+
+    registry.touch("a", nowNs: 100 * second)
+    // The first deadline surfaces, but the touch superseded it.
+    XCTAssertEqual(registry.nextDeadlineNs, 120 * second)
+    XCTAssertTrue(registry.popExpired(nowNs: 150 * second).isEmpty)
+    XCTAssertEqual(registry.nextDeadlineNs, 220 * second)
+
+    let expired = registry.popExpired(nowNs: 220 * second)
+    XCTAssertEqual(expired.map { $0.id }, ["a"])
+    XCTAssertTrue(expired.first?.session === session)
+    XCTAssertTrue(registry.isEmpty)
+    XCTAssertNil(registry.nextDeadlineNs)
+  }
+
+  func testSessionWithLiveWindowIsRearmedInsteadOfExpired() {
+    var registry = makeRegistry()
+    let window = Window()
+    registry.register(id: "a", path: "/tmp/a.md", session: Session(), window: window, nowNs: 0)
+
+    XCTAssertTrue(registry.popExpired(nowNs: 130 * second).isEmpty)
+    XCTAssertNotNil(registry.session("a"))
+    XCTAssertEqual(registry.nextDeadlineNs, 250 * second)
+  }
+
+  func testRemovedSessionsNeverExpire() {
+    var registry = makeRegistry()
+    var windows: [Window]? = [Window(), Window()]
+    let kept = Session()
+    registry.register(id: "a", path: "/tmp/a.md", session: Session(), window: windows![0], nowNs: 0)
+    registry.register(id: "b", path: "/tmp/b.md", session: kept, window: windows![1], nowNs: 0)
+    let closed = windows![0]
+    XCTAssertEqual(registry.removeAll { _, window in window === closed }, ["a"])
+    windows = nil
+
+    XCTAssertEqual(registry.popExpired(nowNs: 120 * second).map { $0.id }, ["b"])
+  }
+
+  func testFrequentTouchesKeepTheIndexProportionalToSessions() {
+    var registry = makeRegistry()
+    let windows = (0..<4).map { _ in Window() }
+    for (i, window) in windows.enumerated() {
+      registry.register(id: "s\(i)", path: "/tmp/\(i).md", session: Session(), window: window, nowNs: 0)
+    }
+    // A metrics probe every 8ms for a minute.
+    for tick in 1...7_500 {
+      registry.touch("s\(tick % 4)", nowNs: UInt64(tick) * 8_000_000)
+    }
+    XCTAssertLessThanOrEqual(registry.indexedDeadlineCount, 2 * registry.count + 32)
+    XCTAssertEqual(registry.count, 4)
+    XCTAssertTrue(registry.popExpired(nowNs: 150 * second).isEmpty)
+  }
+
+  func testExpiryOrderFollowsDeadlines() {
+    var registry = makeRegistry()
+    var window: Window? = Window()
+    for (i, id) in ["c", "a", "d", "b"].enumerated() {
+      registry.register(id: id, path: "/tmp/\(id).md", session: Session(), window: window!, nowNs: UInt64(i) * second)
+    }
+    window = nil
+    registry.touch("c", nowNs: 10 * second)
+
+    XCTAssertEqual(registry.popExpired(nowNs: 122 * second).map { $0.id }, ["a", "d"])
+    XCTAssertEqual(registry.popExpired(nowNs: 200 * second).map { $0.id }, ["b", "c"])
+  }
+}
@@ -8,6 +8,16 @@ final class TurboDraftConfigTests: XCTestCase {
     XCTAssertEqual(cfg.theme, .system)
     XCTAssertEqual(cfg.editorMode, .reliable)
     XCTAssertEqual(cfg.autosaveDebounceMs, 50)
+    XCTAssertEqual(cfg.maxClientConnections, 32)
+    XCTAssertEqual(cfg.lazyStylingThreshold, 64_000)
+    XCTAssertEqual(cfg.imageMaxPixelSize, 2_048)
+  }
+
+  func testSanitizesImageMaxPixelSize() throws {
+    let negative = try JSONDecoder().decode(TurboDraftConfig.self, from: Data(#"{"imageMaxPixelSize":-1}"#.utf8)).sanitized()
+    XCTAssertEqual(negative.imageMaxPixelSize, 0)
+    let huge = try JSONDecoder().decode(TurboDraftConfig.self, from: Data(#"{"imageMaxPixelSize":100000}"#.utf8)).sanitized()
+    XCTAssertEqual(huge.imageMaxPixelSize, 16_384)
   }
 
   func testDecodeDefaultsAgentSettings() throws {
@@ -84,4 +94,38 @@ final class TurboDraftConfigTests: XCTestCase {
     ).sanitized()
     XCTAssertEqual(claudeCfg.agent.command, "claude")
   }
+
+  func testSocketPathCacheRoundTripsAndGoesStale() throws {
+    let dir = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+      .appendingPathComponent(UUID().uuidString, isDirectory: true)
+    try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+    defer { try? FileManager.default.removeItem(at: dir) }
+    let configPath = dir.appendingPathComponent("config.json").path
+
+    var cfg = TurboDraftConfig()
+    cfg.socketPath = "/tmp/td-a.sock"
+    try cfg.write(to: configPath)
+    XCTAssertEqual(TurboDraftSocketPathCache.lookup(configPath: configPath), "/tmp/td-a.sock")
+
+    let record = try Data(contentsOf: URL(fileURLWithPath: TurboDraftSocketPathCache.cachePath(forConfigPath: configPath)))
+    XCTAssertEqual(record.count, TurboDraftSocketPathCache.recordBytes)
+
+    // Out-of-band edit (not via write()) must invalidate the record.
+    try Data(#"{"socketPath":"/tmp/td-bb.sock"}"#.utf8).write(to: URL(fileURLWithPath: configPath))
+    XCTAssertNil(TurboDraftSocketPathCache.lookup(configPath: configPath))
+
+    try TurboDraftSocketPathCache.publish(configPath: configPath)
+    XCTAssertEqual(TurboDraftSocketPathCache.lookup(configPath: configPath), "/tmp/td-bb.sock")
+  }
+
+  func testSocketPathCacheCoversMissingConfig() throws {
+    let dir = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+      .appendingPathComponent(UUID().uuidString, isDirectory: true)
+    try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+    defer { try? FileManager.default.removeItem(at: dir) }
+    let configPath = dir.appendingPathComponent("config.json").path
+
+    try TurboDraftSocketPathCache.publish(configPath: configPath)
+    XCTAssertEqual(TurboDraftSocketPathCache.lookup(configPath: configPath), TurboDraftPaths.defaultSocketPath())
+  }
 }
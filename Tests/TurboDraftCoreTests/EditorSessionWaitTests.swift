@@ -24,5 +24,51 @@ final class EditorSessionWaitTests: XCTestCase {
     let completed = await waiter
     XCTAssertTrue(completed)
   }
-}
 
+  private func makeFile(_ text: String) throws -> URL {
+    let dir = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+      .appendingPathComponent(UUID().uuidString, isDirectory: true)
+    try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+    let file = dir.appendingPathComponent("prompt.md")
+    try text.data(using: .utf8)?.write(to: file, options: [.atomic])
+    return file
+  }
+
+  func testRevisionWaiterResolvesWhenAutosaveLands() async throws {
+    let file = try makeFile("before")
+    let session = EditorSession()
+    let opened = try await session.open(fileURL: file)
+
+    async let waited = session.waitUntilRevisionChange(baseRevision: opened.diskRevision, timeoutMs: 2_000)
+    try? await Task.sleep(nanoseconds: 30_000_000)
+    await session.updateBufferContent("after")
+    let saved = try await session.autosave()
+
+    let info = await waited
+    XCTAssertEqual(info?.diskRevision, Revision.sha256(text: "after"))
+    XCTAssertEqual(saved?.diskRevision, info?.diskRevision)
+    XCTAssertEqual(saved?.isDirty, false)
+    // The watcher event for our own write is recognised as ours.
+    let change = try await session.applyExternalDiskChange()
+    XCTAssertNil(change)
+  }
+
+  func testBackToBackAutosavesLeaveLatestContentOnDisk() async throws {
+    let file = try makeFile("v0")
+    let session = EditorSession()
+    _ = try await session.open(fileURL: file)
+
+    try await withThrowingTaskGroup(of: Void.self) { group in
+      for i in 1...8 {
+        await session.updateBufferContent("draft \(i)")
+        group.addTask { _ = try await session.autosave() }
+      }
+      try await group.waitForAll()
+    }
+
+    XCTAssertEqual(try String(contentsOf: file, encoding: .utf8), "draft 8")
+    let info = await session.currentInfo()
+    XCTAssertEqual(info?.isDirty, false)
+    XCTAssertEqual(info?.diskRevision, Revision.sha256(text: "draft 8"))
+  }
+}
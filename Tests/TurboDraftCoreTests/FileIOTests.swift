@@ -0,0 +1,133 @@
+import Foundation
+import TurboDraftCore
+import XCTest
+
+final class FileIOTests: XCTestCase {
+  private var dir: URL!
+
+  override func setUpWithError() throws {
+    dir = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+      .appendingPathComponent(UUID().uuidString, isDirectory: true)
+    try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+  }
+
+  override func tearDownWithError() throws {
+    try? FileManager.default.removeItem(at: dir)
+  }
+
+  func testAtomicWriteKeepsModeAndLeavesNoTempFile() throws {
+    let file = dir.appendingPathComponent("prompt.md")
+    try "old".data(using: .utf8)!.write(to: file)
+    try FileManager.default.setAttributes([.posixPermissions: 0o600], ofItemAtPath: file.path)
+
+    let written = try FileIO.replaceContents(of: file, with: "new é")
+    XCTAssertEqual(written.revision, Revision.sha256(text: "new é"))
+    XCTAssertEqual(written.stamp, FileIO.stamp(at: file))
+    XCTAssertEqual(try String(contentsOf: file, encoding: .utf8), "new é")
+    let mode = try FileManager.default.attributesOfItem(atPath: file.path)[.posixPermissions] as? NSNumber
+    XCTAssertEqual(mode?.intValue, 0o600)
+    XCTAssertEqual(try FileManager.default.contentsOfDirectory(atPath: dir.path), ["prompt.md"])
+    XCTAssertGreaterThan(written.timings.totalNs, 0)
+  }
+
+  func testAtomicWriteCreatesMissingDirectoryAndFollowsSymlink() throws {
+    let nested = dir.appendingPathComponent("a/b/prompt.md")
+    try FileIO.writeTextAtomically("", to: nested)
+    XCTAssertEqual(try String(contentsOf: nested, encoding: .utf8), "")
+
+    let link = dir.appendingPathComponent("link.md")
+    try FileManager.default.createSymbolicLink(at: link, withDestinationURL: nested)
+    try FileIO.writeTextAtomically("through link", to: link)
+    XCTAssertEqual(try FileManager.default.destinationOfSymbolicLink(atPath: link.path), nested.path)
+    XCTAssertEqual(try String(contentsOf: nested, encoding: .utf8), "through link")
+  }
+
+  func testLargeFileIsReadDirectlyAndRepaired() throws {
+    let file = dir.appendingPathComponent("large.md")
+    let unit = Array("## Notes é 中文 🚀\n- item\n".utf8)
+    var data = Data()
+    while data.count < FileIO.directReadThreshold + 4_096 {
+      data.append(contentsOf: unit)
+    }
+    // One invalid byte mid-file (over a `#`): replaced, as the small-file path does.
+    data[unit.count * (data.count / unit.count / 2)] = 0xFF
+    try data.write(to: file)
+
+    let text = try FileIO.readText(at: file)
+    XCTAssertEqual(text, String(decoding: data, as: UTF8.self))
+    XCTAssertEqual(text.unicodeScalars.filter { $0 == "\u{FFFD}" }.count, 1)
+  }
+
+  func testReadRejectsFilesOverTheLimit() throws {
+    let file = dir.appendingPathComponent("big.md")
+    try Data(repeating: 0x61, count: 10_000).write(to: file)
+    XCTAssertThrowsError(try FileIO.readText(at: file, maxBytes: 9_999)) { error in
+      guard case FileIOError.fileTooLarge(10_000) = error else {
+        return XCTFail("unexpected error \(error)")
+      }
+    }
+    XCTAssertEqual(try FileIO.readText(at: file, maxBytes: 10_000).utf8.count, 10_000)
+  }
+
+  func testSessionSkipsWriteWhenBufferMatchesDisk() async throws {
+    let file = dir.appendingPathComponent("prompt.md")
+    try "same".data(using: .utf8)!.write(to: file)
+    let session = EditorSession()
+    _ = try await session.open(fileURL: file)
+
+    await session.updateBufferContent("same")
+    let info = try await session.autosave()
+    XCTAssertEqual(info?.isDirty, false)
+    var stats = await session.currentSaveStats()
+    XCTAssertEqual(stats.writeCount, 0)
+    XCTAssertEqual(stats.skippedWriteCount, 1)
+
+    await session.updateBufferContent("changed")
+    _ = try await session.autosave()
+    stats = await session.currentSaveStats()
+    XCTAssertEqual(stats.writeCount, 1)
+    XCTAssertNotNil(stats.lastWriteTimings)
+  }
+
+  func testSessionWritesMatchingBufferWhenFileChangedUnnoticed() async throws {
+    let file = dir.appendingPathComponent("prompt.md")
+    try "same".data(using: .utf8)!.write(to: file)
+    let session = EditorSession()
+    _ = try await session.open(fileURL: file)
+
+    // Another editor replaces the file before any disk-change check runs.
+    try "theirs".data(using: .utf8)!.write(to: file)
+    await session.updateBufferContent("same")
+    let info = try await session.autosave()
+    XCTAssertEqual(info?.isDirty, false)
+    let stats = await session.currentSaveStats()
+    XCTAssertEqual(stats.skippedWriteCount, 0)
+    XCTAssertEqual(stats.writeCount, 1)
+    XCTAssertEqual(try FileIO.readText(at: file), "same")
+  }
+
+  func testOwnWriteEventsAreSuppressedByStampAndExternalWritesStillApply() async throws {
+    let file = dir.appendingPathComponent("prompt.md")
+    try "start".data(using: .utf8)!.write(to: file)
+    let session = EditorSession()
+    _ = try await session.open(fileURL: file)
+
+    await session.updateBufferContent("ours")
+    _ = try await session.autosave()
+    // A burst of watcher events for our own rename: each is settled by a stat.
+    for _ in 0..<3 {
+      let change = try await session.applyExternalDiskChange()
+      XCTAssertNil(change)
+    }
+    let suppressed = await session.currentSaveStats().suppressedSelfEventCount
+    XCTAssertEqual(suppressed, 3)
+
+    try "theirs".data(using: .utf8)!.write(to: file, options: [.atomic])
+    let info = try await session.applyExternalDiskChange()
+    XCTAssertEqual(info?.content, "theirs")
+    let again = try await session.applyExternalDiskChange()
+    XCTAssertNil(again)
+    let after = await session.currentSaveStats().suppressedSelfEventCount
+    XCTAssertEqual(after, 3)
+  }
+}
@@ -43,4 +43,26 @@ final class HistoryStoreTests: XCTestCase {
     XCTAssertEqual(stats.snapshotCount, 2)
     XCTAssertEqual(stats.totalBytes, 6)
   }
+
+  func testSmallEditsAreStoredAsDeltasAndRebuiltOnDemand() {
+    var store = HistoryStore(maxCount: 20, maxBytes: 1_000_000)
+    var content = String(repeating: "line of a long prompt draft\n", count: 1_000)
+    var expected: [String] = []
+    for i in 0..<40 {
+      content.insert(contentsOf: "edit \(i) ", at: content.index(content.startIndex, offsetBy: i * 7))
+      expected.append(content)
+      store.append(HistorySnapshot(id: "s\(i)", reason: "autosave", content: content))
+    }
+
+    // 20 full copies would be ~570 KB; deltas plus periodic keyframes stay far below that.
+    let stats = store.stats()
+    XCTAssertEqual(stats.snapshotCount, 20)
+    XCTAssertLessThan(stats.totalBytes, 5 * content.utf8.count)
+
+    // Evicting older snapshots re-anchors the oldest survivor as a keyframe.
+    XCTAssertEqual(store.all().map(\.content), Array(expected.suffix(20)))
+    XCTAssertEqual(store.find(id: "s25")?.content, expected[25])
+    XCTAssertEqual(store.find(id: "s39")?.content, expected[39])
+    XCTAssertNil(store.find(id: "s19"))
+  }
 }
@@ -0,0 +1,119 @@
+import CoreGraphics
+import Foundation
+import ImageIO
+import TurboDraftCore
+import UniformTypeIdentifiers
+import XCTest
+
+final class ImageIngestCacheTests: XCTestCase {
+  private var dir: URL!
+
+  override func setUpWithError() throws {
+    dir = FileManager.default.temporaryDirectory
+      .appendingPathComponent("turbodraft-images-\(UUID().uuidString)", isDirectory: true)
+  }
+
+  override func tearDownWithError() throws {
+    try? FileManager.default.removeItem(at: dir)
+  }
+
+  private func encodedImage(width: Int, height: Int, type: UTType = .png, shade: CGFloat = 0.4) throws -> Data {
+    let context = try XCTUnwrap(CGContext(
+      data: nil, width: width, height: height, bitsPerComponent: 8, bytesPerRow: 0,
+      space: CGColorSpaceCreateDeviceRGB(), bitmapInfo: CGImageAlphaInfo.premultipliedLast.rawValue
+    ))
+    context.setFillColor(red: shade, green: 0.6, blue: 0.8, alpha: 1)
+    context.fill(CGRect(x: 0, y: 0, width: width, height: height))
+    let image = try XCTUnwrap(context.makeImage())
+    let out = NSMutableData()
+    let destination = try XCTUnwrap(CGImageDestinationCreateWithData(out as CFMutableData, type.identifier as CFString, 1, nil))
+    CGImageDestinationAddImage(destination, image, nil)
+    XCTAssertTrue(CGImageDestinationFinalize(destination))
+    return out as Data
+  }
+
+  private func pixelSize(of url: URL) throws -> (Int, Int) {
+    let source = try XCTUnwrap(CGImageSourceCreateWithURL(url as CFURL, nil))
+    let properties = try XCTUnwrap(CGImageSourceCopyPropertiesAtIndex(source, 0, nil) as? [CFString: Any])
+    return (properties[kCGImagePropertyPixelWidth] as? Int ?? 0, properties[kCGImagePropertyPixelHeight] as? Int ?? 0)
+  }
+
+  func testLargeImageIsDownsampledAndRepastesHitTheCache() throws {
+    let cache = ImageIngestCache(directory: dir)
+    let tiff = try encodedImage(width: 1_600, height: 800, type: .tiff)
+
+    let first = try cache.ingest(.data(tiff), maxPixelSize: 400)
+    XCTAssertFalse(first.cacheHit)
+    XCTAssertEqual(first.url.pathExtension, "png")
+    let (width, height) = try pixelSize(of: first.url)
+    XCTAssertEqual(width, 400)
+    XCTAssertEqual(height, 200)
+
+    let again = try cache.ingest(.data(tiff), maxPixelSize: 400)
+    XCTAssertTrue(again.cacheHit)
+    XCTAssertEqual(again.url, first.url)
+
+    // Another size is another entry.
+    let full = try cache.ingest(.data(tiff), maxPixelSize: 0)
+    XCTAssertFalse(full.cacheHit)
+    XCTAssertNotEqual(full.url, first.url)
+    XCTAssertEqual(try pixelSize(of: full.url).0, 1_600)
+  }
+
+  func testSmallPNGFileIsStoredAsIs() throws {
+    let png = try encodedImage(width: 64, height: 32)
+    try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+    let file = dir.appendingPathComponent("shot.png")
+    try png.write(to: file)
+
+    let cache = ImageIngestCache(directory: dir.appendingPathComponent("cache", isDirectory: true))
+    let ingested = try cache.ingest(.file(file), maxPixelSize: 2_048)
+    XCTAssertEqual(try Data(contentsOf: ingested.url), png)
+  }
+
+  func testUnreadableSourcesThrow() throws {
+    let cache = ImageIngestCache(directory: dir)
+    XCTAssertThrowsError(try cache.ingest(.data(Data("not an image".utf8)), maxPixelSize: 100)) { error in
+      XCTAssertEqual(error as? ImageIngestCache.IngestError, .unreadable)
+    }
+    XCTAssertThrowsError(try cache.ingest(.file(dir.appendingPathComponent("missing.png")), maxPixelSize: 100)) { error in
+      XCTAssertEqual(error as? ImageIngestCache.IngestError, .unreadable)
+    }
+  }
+
+  func testLeastRecentlyUsedFilesAreTrimmed() throws {
+    let images = try (0..<3).map { try encodedImage(width: 64, height: 64, shade: CGFloat($0) / 4) }
+    let budget = images.map(\.count).max()! * 2
+    let cache = ImageIngestCache(directory: dir, maxCacheBytes: budget, minRetention: 30)
+
+    let oldest = try cache.ingest(.data(images[0]), maxPixelSize: 0)
+    let kept = try cache.ingest(.data(images[1]), maxPixelSize: 0)
+    // Make the first one clearly the least recently used.
+    try FileManager.default.setAttributes([.modificationDate: Date(timeIntervalSinceNow: -60)], ofItemAtPath: oldest.url.path)
+    let newest = try cache.ingest(.data(images[2]), maxPixelSize: 0)
+
+    XCTAssertFalse(FileManager.default.fileExists(atPath: oldest.url.path))
+    XCTAssertTrue(FileManager.default.fileExists(atPath: kept.url.path))
+    XCTAssertTrue(FileManager.default.fileExists(atPath: newest.url.path))
+  }
+
+  func testFilesUsedWithinTheRetentionWindowSurviveOverBudget() throws {
+    let images = try (0..<3).map { try encodedImage(width: 64, height: 64, shade: CGFloat($0) / 4) }
+    let budget = images.map(\.count).max()!
+    let cache = ImageIngestCache(directory: dir, maxCacheBytes: budget, minRetention: 3_600)
+
+    let stale = try cache.ingest(.data(images[0]), maxPixelSize: 0)
+    let referenced = try cache.ingest(.data(images[1]), maxPixelSize: 0)
+    let twoHoursAgo = Date(timeIntervalSinceNow: -7_200)
+    for url in [stale.url, referenced.url] {
+      try FileManager.default.setAttributes([.modificationDate: twoHoursAgo], ofItemAtPath: url.path)
+    }
+    // A session hands the second one to the agent, which may read it long after the paste.
+    cache.markUsed([referenced.url])
+    let newest = try cache.ingest(.data(images[2]), maxPixelSize: 0)
+
+    XCTAssertFalse(FileManager.default.fileExists(atPath: stale.url.path))
+    XCTAssertTrue(FileManager.default.fileExists(atPath: referenced.url.path))
+    XCTAssertTrue(FileManager.default.fileExists(atPath: newest.url.path))
+  }
+}
@@ -0,0 +1,64 @@
+import TurboDraftCore
+import TurboDraftProtocol
+import XCTest
+
+final class OpenTraceTests: XCTestCase {
+  private func span(_ name: String, _ start: Double, _ end: Double) -> TraceSpan {
+    TraceSpan(name: name, startMs: start, endMs: end)
+  }
+
+  func testSnapshotPutsEnclosingSpanFirst() {
+    let trace = OpenTrace(id: "t")
+    trace.add("inner", startMs: 5, endMs: 6)
+    trace.add("outer", startMs: 5, endMs: 9)
+    trace.add("first", startMs: 1, endMs: 2)
+    XCTAssertEqual(trace.snapshot().map(\.name), ["first", "outer", "inner"])
+    XCTAssertTrue(trace.contains("inner"))
+    XCTAssertFalse(trace.contains("missing"))
+  }
+
+  func testCurrentIsBoundOnlyInsideWithValue() {
+    let trace = OpenTrace(id: "bound")
+    XCTAssertNil(OpenTrace.current)
+    OpenTrace.$current.withValue(trace) {
+      OpenTrace.current?.add("work", startMs: 1, endMs: 2)
+    }
+    XCTAssertNil(OpenTrace.current)
+    XCTAssertEqual(trace.snapshot().map(\.name), ["work"])
+  }
+
+  func testSummaryNestsSpansAndReportsPercentiles() {
+    // Absolute starts differ per trace; offsets are from each trace's first span.
+    let traces: [[TraceSpan]] = (1...4).map { i in
+      let base = Double(i) * 1_000
+      let d = Double(i)
+      return [
+        span("client.total", base, base + 20 + d),
+        span("client.connect", base, base + 1),
+        span("server.open", base + 2, base + 10 + d),
+        span("server.session_open", base + 3, base + 8 + d),
+        span("server.recovery_load", base + 4, base + 5),
+        span("ui.first_styling", base + 30, base + 30 + d),
+      ]
+    }
+    let summary = OpenTraceSummary(traces: traces)
+    XCTAssertEqual(summary.traceCount, 4)
+    XCTAssertEqual(summary.rows.map(\.name), [
+      "client.total", "client.connect", "server.open", "server.session_open", "server.recovery_load", "ui.first_styling",
+    ])
+    XCTAssertEqual(summary.rows.map(\.depth), [0, 1, 1, 2, 3, 0])
+
+    let styling = summary.rows.last!
+    XCTAssertEqual(styling.count, 4)
+    XCTAssertEqual(styling.offsetP50Ms, 30)
+    XCTAssertEqual(styling.durationP50Ms, 2)
+    XCTAssertEqual(styling.durationP95Ms, 4)
+  }
+
+  func testSummarySkipsEmptyTraces() {
+    let summary = OpenTraceSummary(traces: [[], [span("a", 1, 3)]])
+    XCTAssertEqual(summary.traceCount, 2)
+    XCTAssertEqual(summary.rows.count, 1)
+    XCTAssertEqual(summary.rows[0].offsetP50Ms, 0)
+  }
+}
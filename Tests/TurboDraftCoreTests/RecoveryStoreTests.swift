@@ -0,0 +1,136 @@
+import Foundation
+import TurboDraftCore
+import XCTest
+
+final class RecoveryStoreTests: XCTestCase {
+  private var dir: URL!
+  private let file = URL(fileURLWithPath: "/tmp/turbodraft-recovery-tests/prompt.md")
+
+  override func setUpWithError() throws {
+    dir = FileManager.default.temporaryDirectory
+      .appendingPathComponent("turbodraft-recovery-\(UUID().uuidString)", isDirectory: true)
+  }
+
+  override func tearDownWithError() throws {
+    try? FileManager.default.removeItem(at: dir)
+  }
+
+  private func journalFiles() throws -> [URL] {
+    try FileManager.default.contentsOfDirectory(at: dir, includingPropertiesForKeys: nil)
+  }
+
+  func testAppendsPersistAndConsecutiveDuplicatesAreSkipped() throws {
+    let store = RecoveryStore(directory: dir)
+    let first = store.appendSnapshot(HistorySnapshot(reason: "autosave", content: "one"), for: file)
+    XCTAssertEqual(store.appendSnapshot(HistorySnapshot(reason: "autosave", content: "one"), for: file), first)
+    store.appendSnapshot(HistorySnapshot(reason: "snapshot", content: "two\nlines é"), for: file)
+
+    let loaded = store.loadSnapshots(for: file)
+    XCTAssertEqual(loaded.map(\.content), ["one", "two\nlines é"])
+    XCTAssertEqual(loaded.map(\.reason), ["autosave", "snapshot"])
+    XCTAssertEqual(loaded.first?.id, first)
+
+    // A second store (next app launch) reads the same journal.
+    let reopened = RecoveryStore(directory: dir)
+    XCTAssertEqual(reopened.loadSnapshots(for: file), loaded)
+  }
+
+  func testExpiredJournalsAreRemovedWithoutBeingOpened() throws {
+    let store = RecoveryStore(ttlDays: 1, directory: dir)
+    let abandoned = URL(fileURLWithPath: "/tmp/turbodraft-recovery-tests/abandoned.md")
+    store.appendSnapshot(HistorySnapshot(reason: "autosave", content: "old"), for: abandoned)
+    XCTAssertEqual(store.loadSnapshots(for: abandoned).count, 1)
+    let abandonedJournal = try XCTUnwrap(journalFiles().first)
+    store.appendSnapshot(HistorySnapshot(reason: "autosave", content: "fresh"), for: file)
+    XCTAssertEqual(store.loadSnapshots(for: file).count, 1)
+    try FileManager.default.setAttributes(
+      [.modificationDate: Date(timeIntervalSinceNow: -3 * 24 * 60 * 60)],
+      ofItemAtPath: abandonedJournal.path
+    )
+
+    // Next launch: nothing opens the abandoned file again.
+    let relaunched = RecoveryStore(ttlDays: 1, directory: dir)
+    XCTAssertEqual(relaunched.removeExpiredJournals(), 1)
+    XCTAssertFalse(FileManager.default.fileExists(atPath: abandonedJournal.path))
+    XCTAssertEqual(try journalFiles().count, 1)
+    XCTAssertEqual(relaunched.loadSnapshots(for: file).map(\.content), ["fresh"])
+  }
+
+  func testSnapshotsOverTheByteLimitAreSkipped() throws {
+    let store = RecoveryStore(maxSnapshotBytes: 8_192, directory: dir)
+    // Bridged, as buffers from the text storage are; UTF-16 length alone rules this out.
+    let bridgedLarge = NSMutableString(string: String(repeating: "a", count: 9_000)) as String
+    store.appendSnapshot(HistorySnapshot(reason: "autosave", content: bridgedLarge), for: file)
+    XCTAssertEqual(store.loadSnapshots(for: file), [])
+
+    // 3,000 UTF-16 units could be up to 9,000 bytes; counted, it is 6,000 and fits.
+    let bridgedSmall = NSMutableString(string: String(repeating: "é", count: 3_000)) as String
+    store.appendSnapshot(HistorySnapshot(reason: "autosave", content: bridgedSmall), for: file)
+    // Native and 2 bytes per character: 10,000 bytes in 5,000 characters.
+    store.appendSnapshot(HistorySnapshot(reason: "autosave", content: String(repeating: "é", count: 5_000)), for: file)
+    XCTAssertEqual(store.loadSnapshots(for: file).map(\.content), [bridgedSmall])
+  }
+
+  func testLoadAppliesCountBudgetAndCompactsJournal() throws {
+    let store = RecoveryStore(maxSnapshotsPerFile: 16, directory: dir)
+    for i in 0..<40 {
+      store.appendSnapshot(HistorySnapshot(reason: "autosave", content: "draft \(i)"), for: file)
+    }
+    XCTAssertEqual(store.loadSnapshots(for: file).map(\.content), (24..<40).map { "draft \($0)" })
+
+    // The load queued a compaction; the next load waits for it.
+    _ = store.loadSnapshots(for: file)
+    let journal = try XCTUnwrap(journalFiles().first)
+    let size = try XCTUnwrap(try journal.resourceValues(forKeys: [.fileSizeKey]).fileSize)
+    // 16 records of ~140 bytes each; all 40 would be ~5.6 KB.
+    XCTAssertLessThan(size, 3_000)
+
+    store.appendSnapshot(HistorySnapshot(reason: "autosave", content: "draft 40"), for: file)
+    _ = store.loadSnapshots(for: file)
+    XCTAssertEqual(RecoveryStore(maxSnapshotsPerFile: 16, directory: dir).loadSnapshots(for: file).last?.content, "draft 40")
+  }
+
+  func testTornTailIsIgnoredAndOverwritten() throws {
+    let store = RecoveryStore(directory: dir)
+    store.appendSnapshot(HistorySnapshot(reason: "autosave", content: "kept"), for: file)
+    _ = store.loadSnapshots(for: file)
+
+    // Simulate a crash partway through the next record.
+    let journal = try XCTUnwrap(journalFiles().first)
+    let handle = try FileHandle(forWritingTo: journal)
+    handle.seekToEndOfFile()
+    handle.write(Data([0xFF, 0x00, 0x00, 0x00, 0x01, 0x02]))
+    handle.closeFile()
+
+    let reopened = RecoveryStore(directory: dir)
+    XCTAssertEqual(reopened.loadSnapshots(for: file).map(\.content), ["kept"])
+    reopened.appendSnapshot(HistorySnapshot(reason: "autosave", content: "next"), for: file)
+    _ = reopened.loadSnapshots(for: file)
+    XCTAssertEqual(RecoveryStore(directory: dir).loadSnapshots(for: file).map(\.content), ["kept", "next"])
+  }
+
+  func testEditedDraftsRoundTripThroughDeltaRecords() throws {
+    let store = RecoveryStore(directory: dir)
+    var content = String(repeating: "draft text é\n", count: 2_000)
+    var expected: [String] = []
+    for i in 0..<30 {
+      content.replaceSubrange(content.startIndex..<content.index(content.startIndex, offsetBy: 5), with: "v\(i)... ")
+      expected.append(content)
+      store.appendSnapshot(HistorySnapshot(reason: "autosave", content: content), for: file)
+    }
+    XCTAssertEqual(store.loadSnapshots(for: file).map(\.content), expected)
+
+    // Two keyframes (one per 16 records) plus small deltas, not 30 full copies.
+    let journal = try XCTUnwrap(journalFiles().first)
+    let size = try XCTUnwrap(try journal.resourceValues(forKeys: [.fileSizeKey]).fileSize)
+    XCTAssertLessThan(size, 3 * content.utf8.count)
+
+    // A reopened store has no cached content, so it rebuilds from the journal and keeps
+    // appending deltas against it.
+    let reopened = RecoveryStore(directory: dir)
+    XCTAssertEqual(reopened.loadSnapshots(for: file, maxCount: 3).map(\.content), Array(expected.suffix(3)))
+    content += "tail"
+    reopened.appendSnapshot(HistorySnapshot(reason: "autosave", content: content), for: file)
+    XCTAssertEqual(reopened.loadSnapshots(for: file, maxCount: 1).map(\.content), [content])
+  }
+}
@@ -9,5 +9,27 @@ final class RevisionTests: XCTestCase {
     XCTAssertNotEqual(a, Revision.sha256(text: "hello2"))
     XCTAssertTrue(a.hasPrefix("sha256:"))
   }
-}
 
+  func testSha256MatchesKnownDigest() {
+    XCTAssertEqual(
+      Revision.sha256(text: "hello"),
+      "sha256:2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824"
+    )
+  }
+
+  func testFingerprintHalvesAreSeededXXH64() {
+    // The low half is plain XXH64 (seed 0), so it matches the published test vectors.
+    XCTAssertEqual(ContentFingerprint(text: "").low, 0xEF46_DB37_51D8_E999)
+    XCTAssertEqual(ContentFingerprint(text: "abc").low, 0x44BC_2CF5_AD77_0999)
+    XCTAssertEqual(
+      ContentFingerprint(text: "Nobody inspects the spammish repetition").description,
+      "fp128:0af5e91cd035543ffbcea83c8a378bf1"
+    )
+    // 80 bytes: stripes plus an 8-byte-word tail.
+    XCTAssertEqual(
+      ContentFingerprint(text: String(repeating: "é", count: 40)).description,
+      "fp128:6441867e44845907b1ec6d9d41a61799"
+    )
+    XCTAssertNotEqual(ContentFingerprint(text: "hello"), ContentFingerprint(text: "hellp"))
+  }
+}
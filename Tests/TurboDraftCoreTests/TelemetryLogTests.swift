@@ -0,0 +1,109 @@
+import Foundation
+import TurboDraftCore
+import XCTest
+
+final class TelemetryLogTests: XCTestCase {
+  private func tempLogURL() throws -> URL {
+    let dir = FileManager.default.temporaryDirectory.appendingPathComponent("turbodraft-telemetry-\(UUID().uuidString)", isDirectory: true)
+    try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+    addTeardownBlock { try? FileManager.default.removeItem(at: dir) }
+    return dir.appendingPathComponent("events.tdlog")
+  }
+
+  func testFlushedRecordsReadBackInOrder() throws {
+    let url = try tempLogURL()
+    let log = TelemetryLog(fileURL: url, flushIntervalMs: 60_000)
+    let before = Date()
+    log.record(.appSessionOpen, count: 2, value: 4.25)
+    log.record(.appSessionOpen, count: 1, value: 1.5, flags: TelemetryRecord.reusedSession)
+    log.flush()
+
+    let records = TelemetryLog.readRecords(at: url)
+    XCTAssertEqual(records.map(\.event), [.appSessionOpen, .appSessionOpen])
+    XCTAssertEqual(records.map(\.count), [2, 1])
+    XCTAssertEqual(records.map(\.value), [4.25, 1.5])
+    XCTAssertEqual(records.map(\.flags), [0, TelemetryRecord.reusedSession])
+    XCTAssertLessThanOrEqual(records[0].monotonicNs, records[1].monotonicNs)
+    for record in records {
+      XCTAssertEqual(record.date.timeIntervalSince(before), 0, accuracy: 5)
+    }
+    XCTAssertEqual(log.stats().flushedBatches, 1)
+  }
+
+  func testFlushesOnItsOwnAfterTheInterval() throws {
+    let url = try tempLogURL()
+    let log = TelemetryLog(fileURL: url, flushIntervalMs: 10)
+    log.record(.appSessionOpen, value: 1)
+    let deadline = Date().addingTimeInterval(5)
+    while TelemetryLog.readRecords(at: url).isEmpty, Date() < deadline {
+      usleep(10_000)
+    }
+    XCTAssertEqual(TelemetryLog.readRecords(at: url).count, 1)
+  }
+
+  func testFullRingDropsNewRecords() throws {
+    let url = try tempLogURL()
+    let log = TelemetryLog(fileURL: url, capacity: 2, flushIntervalMs: 60_000)
+    log.record(.appSessionOpen, value: 1)
+    log.record(.appSessionOpen, value: 2)
+    log.record(.appSessionOpen, value: 3)
+    log.flush()
+    XCTAssertEqual(TelemetryLog.readRecords(at: url).map(\.value), [1, 2])
+    XCTAssertEqual(log.stats().dropped, 1)
+
+    log.record(.appSessionOpen, value: 4)
+    log.flush()
+    XCTAssertEqual(TelemetryLog.readRecords(at: url).map(\.value), [1, 2, 4])
+  }
+
+  func testRotatesAndReadsBothFiles() throws {
+    let url = try tempLogURL()
+    // Room for exactly one single-record batch per file.
+    let log = TelemetryLog(fileURL: url, flushIntervalMs: 60_000, maxFileBytes: 8 + 20 + 24)
+    for value in [1.0, 2.0, 3.0] {
+      log.record(.appSessionOpen, value: value)
+      log.flush()
+    }
+    XCTAssertTrue(FileManager.default.fileExists(atPath: TelemetryLog.rotatedURL(for: url).path))
+    // The first file was replaced by the second rotation.
+    XCTAssertEqual(TelemetryLog.readRecords(at: url).map(\.value), [2, 3])
+  }
+
+  func testTornTailIsIgnored() throws {
+    let url = try tempLogURL()
+    let log = TelemetryLog(fileURL: url, flushIntervalMs: 60_000)
+    log.record(.appSessionOpen, value: 7)
+    log.flush()
+
+    let fh = try FileHandle(forWritingTo: url)
+    try fh.seekToEnd()
+    // A batch header claiming three records, then half of one.
+    try fh.write(contentsOf: Data([3, 0, 0, 0]) + Data(repeating: 0, count: 16 + 12))
+    try fh.close()
+    XCTAssertEqual(TelemetryLog.readRecords(at: url).map(\.value), [7])
+  }
+
+  func testReopeningCutsATornBatchBeforeAppending() throws {
+    let url = try tempLogURL()
+    let log = TelemetryLog(fileURL: url, flushIntervalMs: 60_000)
+    log.record(.appSessionOpen, value: 1)
+    log.flush()
+
+    // A crash halfway through the second batch.
+    let fh = try FileHandle(forWritingTo: url)
+    try fh.seekToEnd()
+    try fh.write(contentsOf: Data([2, 0, 0, 0]) + Data(repeating: 0xAB, count: 16 + 30))
+    try fh.close()
+
+    let reopened = TelemetryLog(fileURL: url, flushIntervalMs: 60_000)
+    reopened.record(.appSessionOpen, count: 3, value: 2)
+    reopened.record(.appSessionOpen, count: 4, value: 3)
+    reopened.flush()
+
+    let records = TelemetryLog.readRecords(at: url)
+    XCTAssertEqual(records.map(\.value), [1, 2, 3])
+    XCTAssertEqual(records.map(\.count), [0, 3, 4])
+    let bytes = try XCTUnwrap(FileManager.default.attributesOfItem(atPath: url.path)[.size] as? Int)
+    XCTAssertEqual(bytes, 8 + (20 + 24) + (20 + 2 * 24))
+  }
+}
@@ -1,5 +1,6 @@
 import XCTest
 @testable import TurboDraftCore
+import TurboDraftTestSupport
 
 final class TextSearchEngineTests: XCTestCase {
   func testMakeRegexLiteralCaseInsensitiveByDefault() {
@@ -95,6 +96,27 @@ final class TextSearchEngineTests: XCTestCase {
     XCTAssertEqual(result?.text, "b1 b2")
   }
 
+  func testReplacementsListEditsThatReplaceAllApplies() {
+    let text = "cost $5, Cost $7\ncosts" as NSString
+    let edits = TextSearchEngine.replacements(in: text, query: "cost", replacementTemplate: "price", options: .init(wholeWord: true))
+    XCTAssertEqual(edits, [
+      TextReplacement(range: NSRange(location: 0, length: 4), replacement: "price"),
+      TextReplacement(range: NSRange(location: 9, length: 4), replacement: "price"),
+    ])
+
+    // Templates expand like NSRegularExpression's, for literal and regex queries alike.
+    for (query, template, options) in [
+      ("cost", "[$0]", TextSearchOptions()),
+      (#"\$(\d)"#, #"\$$1.00"#, TextSearchOptions(regexEnabled: true)),
+      (#"(?m)^"#, "> ", TextSearchOptions(regexEnabled: true)),
+    ] {
+      let re = TextSearchEngine.makeRegex(query: query, options: options)!
+      let expected = NSMutableString(string: text as String)
+      re.replaceMatches(in: expected, range: NSRange(location: 0, length: text.length), withTemplate: template)
+      XCTAssertEqual(TextSearchEngine.replaceAll(in: text as String, query: query, replacementTemplate: template, options: options)?.text, expected as String)
+    }
+  }
+
   func testSummarizeMatchesLargeInputWithinBudget() {
     let line = "alpha beta gamma alpha delta alpha\n"
     let doc = String(repeating: line, count: 20_000)
@@ -129,4 +151,75 @@ final class TextSearchEngineTests: XCTestCase {
     }
     XCTAssertLessThan(elapsed.components.seconds, 1, "replaceAll unexpectedly slow")
   }
+
+  private func regexMatches(_ query: String, _ options: TextSearchOptions, in text: String) -> [NSRange] {
+    guard let re = TextSearchEngine.makeRegex(query: query, options: options) else { return [] }
+    return re.matches(in: text, range: NSRange(location: 0, length: (text as NSString).length)).map(\.range)
+  }
+
+  func testLiteralFastPathAgreesWithRegex() {
+    // U+212A KELVIN SIGN matches "k" case-insensitively, so non-ASCII text takes the regex path.
+    let text = "Kayak kayak KAYAK \u{212A}ayak kay_ak kayaks é kayak\nkayak"
+    for options in [
+      TextSearchOptions(),
+      TextSearchOptions(caseSensitive: true),
+      TextSearchOptions(wholeWord: true),
+      TextSearchOptions(caseSensitive: true, wholeWord: true),
+    ] {
+      for query in ["kayak", "ay", "a", "k kay", "é"] {
+        XCTAssertEqual(
+          TextSearchEngine.summarizeMatches(in: text, query: query, options: options)?.ranges,
+          regexMatches(query, options, in: text),
+          "\(query) \(options)"
+        )
+      }
+    }
+  }
+
+  func testSessionTracksEditsIncrementally() {
+    var rng = SeededRandomNumberGenerator()
+    let pieces = ["ab", "a", "b", " ", "\n", "AB", "_"]
+    let queries: [(String, TextSearchOptions)] = [
+      ("ab", .init()),
+      ("ab", .init(caseSensitive: true, wholeWord: true)),
+      ("b a", .init()),
+      (#"a+b"#, .init(regexEnabled: true)),
+      (#"b\s+a"#, .init(regexEnabled: true)),
+    ]
+    for (query, options) in queries {
+      let storage = NSMutableString(string: "ab ab\nab")
+      let session = TextSearchSession()
+      XCTAssertEqual(session.update(query: query, options: options, in: storage), regexMatches(query, options, in: storage as String), "\(rng)")
+      for _ in 0..<300 {
+        let a = Int.random(in: 0...storage.length, using: &rng)
+        let b = Int.random(in: a...min(storage.length, a + 4), using: &rng)
+        let inserted = (0..<Int.random(in: 0...3, using: &rng)).map { _ in pieces.randomElement(using: &rng)! }.joined()
+        storage.replaceCharacters(in: NSRange(location: a, length: b - a), with: inserted)
+        let insertedLength = (inserted as NSString).length
+        session.applyEdit(
+          in: storage,
+          editedRange: NSRange(location: a, length: insertedLength),
+          changeInLength: insertedLength - (b - a)
+        )
+        XCTAssertEqual(
+          session.update(query: query, options: options, in: storage),
+          regexMatches(query, options, in: storage as String),
+          "\(query) in \((storage as String).debugDescription), \(rng)"
+        )
+      }
+    }
+  }
+
+  func testSessionNavigationWrapsAndExpandsRegexTemplates() {
+    let text = "a1 b2 a3" as NSString
+    let session = TextSearchSession()
+    XCTAssertEqual(session.update(query: #"a(\d)"#, options: .init(regexEnabled: true), in: text)?.count, 2)
+    XCTAssertEqual(session.match(startingAtOrAfter: 1), NSRange(location: 6, length: 2))
+    XCTAssertEqual(session.match(startingAtOrAfter: 7), NSRange(location: 0, length: 2))
+    XCTAssertEqual(session.match(startingBefore: 0), NSRange(location: 6, length: 2))
+    XCTAssertTrue(session.contains(NSRange(location: 6, length: 2)))
+    XCTAssertFalse(session.contains(NSRange(location: 3, length: 2)))
+    XCTAssertEqual(session.replacement(for: NSRange(location: 6, length: 2), in: text, template: "<$1>"), "<3>")
+    XCTAssertNil(session.update(query: "(", options: .init(regexEnabled: true), in: text))
+  }
 }
@@ -0,0 +1,91 @@
+import TurboDraftMarkdown
+import TurboDraftTestSupport
+import XCTest
+
+final class MarkdownFenceIndexTests: XCTestCase {
+  func testStateBeforeLineTracksOpenAndClose() {
+    let text = "intro\n```swift\nlet x = 1\n```\nafter" as NSString
+    let index = MarkdownFenceIndex(text: text)
+    XCTAssertEqual(index.lineCount, 5)
+    XCTAssertFalse(index.state(before: text.range(of: "```swift").location).inFence)
+    XCTAssertTrue(index.state(before: text.range(of: "let x").location).inFence)
+    XCTAssertTrue(index.state(before: text.range(of: "```\nafter").location).inFence)
+    XCTAssertFalse(index.state(before: text.range(of: "after").location).inFence)
+  }
+
+  func testOpeningFenceDirtiesOnlyUntilStatesAgreeAgain() {
+    let storage = NSMutableString(string: "a\nb\n```\ncode\n```\nc\nd")
+    let index = MarkdownFenceIndex(text: storage)
+
+    // A ~~~ fence opened on line "b" swallows the ``` block and everything after it.
+    storage.replaceCharacters(in: NSRange(location: 2, length: 1), with: "~~~")
+    var dirty = index.applyEdit(in: storage, editedRange: NSRange(location: 2, length: 3), changeInLength: 2)
+    XCTAssertEqual(dirty.location, 2)
+    XCTAssertEqual(NSMaxRange(dirty), storage.length)
+
+    // Editing plain text inside a block leaves every other line's state alone.
+    let codeLoc = storage.range(of: "code").location
+    storage.replaceCharacters(in: NSRange(location: codeLoc, length: 4), with: "CODE!")
+    dirty = index.applyEdit(in: storage, editedRange: NSRange(location: codeLoc, length: 5), changeInLength: 1)
+    XCTAssertEqual(storage.substring(with: dirty), "CODE!\n")
+  }
+
+  func testBatchedEditsReportOnlyLinesWhoseStateFlipped() {
+    let storage = NSMutableString(string: "x\na\n```\nb\nx\nc\nx\nd\n")
+    let index = MarkdownFenceIndex(text: storage)
+
+    // Replace each "x" line, the middle one with a closing fence, in one spliced storage edit.
+    let lineEdits: [(range: NSRange, replacementLength: Int)] = [
+      (NSRange(location: 0, length: 2), 2),
+      (NSRange(location: 10, length: 2), 4),
+      (NSRange(location: 14, length: 2), 2),
+    ]
+    storage.replaceCharacters(in: NSRange(location: 0, length: 15), with: "y\na\n```\nb\n```\nc\ny")
+    let flipped = index.applyEdits(
+      in: storage,
+      editedRange: NSRange(location: 0, length: 17),
+      changeInLength: 2,
+      lineEdits: lineEdits
+    )
+
+    // "a" and "b" kept their state; "c" left the fence opened on line 3, "d" is past the span.
+    XCTAssertEqual(flipped.map { storage.substring(with: $0) }, ["c\n", "d\n"])
+    let reference = MarkdownFenceIndex(text: storage)
+    for loc in 0...storage.length {
+      XCTAssertEqual(index.state(before: loc), reference.state(before: loc), "offset \(loc)")
+    }
+  }
+
+  func testIncrementalEditsMatchRebuildAndHighlighter() {
+    var rng = SeededRandomNumberGenerator()
+    let pieces = ["a", "\n", "```", "~~~", "````", " ", "x\n", "\n```\n", "`", "# h\n"]
+    for _ in 0..<200 {
+      let storage = NSMutableString(string: (0..<Int.random(in: 0...20, using: &rng)).map { _ in pieces.randomElement(using: &rng)! }.joined())
+      let index = MarkdownFenceIndex(text: storage)
+      for _ in 0..<10 {
+        let a = Int.random(in: 0...storage.length, using: &rng)
+        let b = Int.random(in: a...min(storage.length, a + 6), using: &rng)
+        let insert = (0..<Int.random(in: 0...3, using: &rng)).map { _ in pieces.randomElement(using: &rng)! }.joined()
+        storage.replaceCharacters(in: NSRange(location: a, length: b - a), with: insert)
+        let insertLen = (insert as NSString).length
+        index.applyEdit(in: storage, editedRange: NSRange(location: a, length: insertLen), changeInLength: insertLen - (b - a))
+
+        let reference = MarkdownFenceIndex(text: storage)
+        XCTAssertEqual(index.lineCount, reference.lineCount, "\(rng)")
+        for loc in 0...storage.length {
+          XCTAssertEqual(index.state(before: loc), reference.state(before: loc), "offset \(loc) in \(storage), \(rng)")
+        }
+
+        // Starting a highlight pass mid-document must agree with the prefix-scan path.
+        let text = storage as String
+        let lineStart = storage.lineRange(for: NSRange(location: min(a, storage.length), length: 0)).location
+        let range = NSRange(location: lineStart, length: storage.length - lineStart)
+        XCTAssertEqual(
+          MarkdownHighlighter.highlights(in: text, range: range, fenceIndex: index),
+          MarkdownHighlighter.highlights(in: text, range: range),
+          "\(rng)"
+        )
+      }
+    }
+  }
+}
@@ -174,4 +174,17 @@ outside
     let hs = MarkdownHighlighter.highlights(in: text, range: insideRange)
     XCTAssertTrue(hs.contains { $0.kind == .codeBlockLine })
   }
+
+  func testEntryStateOverloadMatchesFenceIndex() {
+    let text = "~~~\nlet x = 1\n~~~\n**after**"
+    let ns = text as NSString
+    let index = MarkdownFenceIndex(text: ns)
+    for loc in [0, ns.range(of: "let").location, ns.range(of: "**after").location] {
+      let range = NSRange(location: loc, length: ns.length - loc)
+      XCTAssertEqual(
+        MarkdownHighlighter.highlights(in: text, range: range, entryState: index.state(before: loc)),
+        MarkdownHighlighter.highlights(in: text, range: range, fenceIndex: index)
+      )
+    }
+  }
 }
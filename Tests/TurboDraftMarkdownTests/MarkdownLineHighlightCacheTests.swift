@@ -0,0 +1,79 @@
+import TurboDraftMarkdown
+import TurboDraftTestSupport
+import XCTest
+
+final class MarkdownLineHighlightCacheTests: XCTestCase {
+  func testMatchesHighlighterOnRandomDocumentsThroughEviction() {
+    let pieces = [
+      "a", "word", "snake_case", "é", " ", "\t", "\n", "x\n", "\r\n", "\n\n",
+      "# ", "> ", "- ", "1. ", "- [x] ", "`", "```", "~~~", "\n```\n", "\n~~~~\n", " ``` js",
+      "~~", "==", "**", "_", "|", " | ", "|---|---|", "\n|a|b|\n|-|-|\n", "|-|", "---",
+      "[t](u)", "<http://a.b>", "https://ex.com/p.",
+    ]
+    // Small enough that entries are evicted and recomputed throughout.
+    let cache = MarkdownLineHighlightCache(capacity: 16)
+    var rng = SeededRandomNumberGenerator()
+    for _ in 0..<500 {
+      let text = (0..<Int.random(in: 0...30, using: &rng)).map { _ in pieces.randomElement(using: &rng)! }.joined()
+      let ns = text as NSString
+      let full = NSRange(location: 0, length: ns.length)
+      XCTAssertEqual(cache.highlights(in: ns, range: full), MarkdownHighlighter.highlights(in: text, range: full), "\(text.debugDescription), \(rng)")
+
+      let start = Int.random(in: 0...ns.length, using: &rng)
+      let line = ns.lineRange(for: NSRange(location: start, length: 0))
+      let end = Int.random(in: line.location...ns.length, using: &rng)
+      let range = NSRange(location: line.location, length: end - line.location)
+      let index = MarkdownFenceIndex(text: ns)
+      XCTAssertEqual(
+        cache.highlights(in: ns, range: range, fenceIndex: index),
+        MarkdownHighlighter.highlights(in: text, range: range, fenceIndex: index),
+        "range \(range) of \(text.debugDescription), \(rng)"
+      )
+    }
+    XCTAssertLessThanOrEqual(cache.stats().entryCount, 16)
+  }
+
+  func testEditingOneLineKeepsShiftedLinesWarm() {
+    let cache = MarkdownLineHighlightCache()
+    let lines = (0..<50).map { "- item **\($0)** with `code`" }
+    var text = lines.joined(separator: "\n")
+    _ = cache.highlights(in: text as NSString, range: NSRange(location: 0, length: (text as NSString).length))
+    XCTAssertEqual(cache.stats().misses, 50)
+
+    // Typing on line 3 moves every later line; only the edited line is new.
+    var edited = lines
+    edited[2] += "x"
+    text = edited.joined(separator: "\n")
+    _ = cache.highlights(in: text as NSString, range: NSRange(location: 0, length: (text as NSString).length))
+    let stats = cache.stats()
+    XCTAssertEqual(stats.misses, 51)
+    XCTAssertEqual(stats.hits, 49)
+  }
+
+  func testSameLineInsideAndOutsideAFenceAreSeparateEntries() {
+    let cache = MarkdownLineHighlightCache()
+    let text = "# title\n```\n# title\n```\n" as NSString
+    let spans = cache.highlights(in: text, range: NSRange(location: 0, length: text.length))
+    XCTAssertTrue(spans.contains { $0.kind == .headerText(level: 1) })
+    XCTAssertTrue(spans.contains { $0.kind == .codeBlockLine && $0.range.location == 12 })
+    // Both "# title" lines and both fences differ by entry state: four entries, no hits.
+    let stats = cache.stats()
+    XCTAssertEqual(stats.hits, 0)
+    XCTAssertEqual(stats.entryCount, 4)
+  }
+
+  func testLeastRecentlyUsedLineIsEvictedFirst() {
+    let cache = MarkdownLineHighlightCache(capacity: 2)
+    func style(_ line: String) {
+      _ = cache.highlights(in: line as NSString, range: NSRange(location: 0, length: (line as NSString).length))
+    }
+    style("a")
+    style("b")
+    style("a") // hit; "b" is now the oldest
+    style("c") // evicts "b"
+    style("a")
+    XCTAssertEqual(cache.stats().hits, 2)
+    style("b")
+    XCTAssertEqual(cache.stats().misses, 4)
+  }
+}
@@ -1,3 +1,4 @@
+import Foundation
 import TurboDraftMarkdown
 import XCTest
 
@@ -40,4 +41,46 @@ final class MarkdownOrderedListRenumberingTests: XCTestCase {
     let doc = "- bullet\n- bullet"
     XCTAssertNil(MarkdownOrderedListRenumbering.renumber(document: doc, around: 1))
   }
+
+  func testEditsRewriteOnlyTheNumbersThatAreOff() {
+    let doc = "1. one\n1. two\n3. three\n9. four\n"
+    let edits = MarkdownOrderedListRenumbering.edits(in: doc, around: 0)
+    XCTAssertEqual(edits, [
+      MarkdownTextEdit(range: NSRange(location: 7, length: 1), replacement: "2"),
+      MarkdownTextEdit(range: NSRange(location: 23, length: 1), replacement: "4"),
+    ])
+  }
+
+  func testEditsStopAtTheBlockBoundaries() {
+    let doc = """
+    4. other list
+    9. other list
+
+    2. first
+    5. second
+    - bullet
+    7. unrelated
+    """
+    let ns = doc as NSString
+    let cursor = ns.range(of: "5. second").location
+    let edits = MarkdownOrderedListRenumbering.edits(in: doc, around: cursor)
+    XCTAssertEqual(edits, [MarkdownTextEdit(range: NSRange(location: cursor, length: 1), replacement: "3")])
+  }
+
+  func testEditsHandleWidthChangesAndCursorAfterTrailingNewline() {
+    let doc = "8. a\n9. b\n9. c\n"
+    let edits = MarkdownOrderedListRenumbering.edits(in: doc, around: (doc as NSString).length)
+    XCTAssertEqual(edits, [MarkdownTextEdit(range: NSRange(location: 10, length: 1), replacement: "10")])
+    XCTAssertEqual(
+      MarkdownOrderedListRenumbering.renumber(document: doc, around: (doc as NSString).length),
+      "8. a\n9. b\n10. c\n"
+    )
+  }
+
+  func testCursorOnBlankLineBelowListRenumbersIt() {
+    let doc = "1. a\n3. b\n\nafter"
+    let edits = MarkdownOrderedListRenumbering.edits(in: doc, around: 10)
+    XCTAssertEqual(edits, [MarkdownTextEdit(range: NSRange(location: 5, length: 1), replacement: "2")])
+    XCTAssertTrue(MarkdownOrderedListRenumbering.edits(in: "1. a\n2. b", around: 0).isEmpty)
+  }
 }
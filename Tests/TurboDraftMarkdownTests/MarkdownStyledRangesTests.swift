@@ -0,0 +1,101 @@
+import TurboDraftMarkdown
+import TurboDraftTestSupport
+import XCTest
+
+final class MarkdownStyledRangesTests: XCTestCase {
+  func testInsertMergesAndGapsReportUnstyledParts() {
+    var styled = MarkdownStyledRanges()
+    styled.insert(NSRange(location: 10, length: 5))
+    styled.insert(NSRange(location: 30, length: 5))
+    styled.insert(NSRange(location: 15, length: 3))
+    XCTAssertEqual(styled.ranges, [NSRange(location: 10, length: 8), NSRange(location: 30, length: 5)])
+    XCTAssertEqual(styled.gaps(in: NSRange(location: 0, length: 40)), [
+      NSRange(location: 0, length: 10),
+      NSRange(location: 18, length: 12),
+      NSRange(location: 35, length: 5),
+    ])
+    XCTAssertTrue(styled.contains(NSRange(location: 11, length: 6)))
+
+    styled.remove(NSRange(location: 12, length: 20))
+    XCTAssertEqual(styled.ranges, [NSRange(location: 10, length: 2), NSRange(location: 32, length: 3)])
+  }
+
+  func testEditsShiftTailAndLeaveNewTextUnstyled() {
+    var styled = MarkdownStyledRanges()
+    styled.insert(NSRange(location: 0, length: 20))
+
+    // Typing 3 characters at 5 splits the styled run around them.
+    styled.applyEdit(editedRange: NSRange(location: 5, length: 3), changeInLength: 3)
+    XCTAssertEqual(styled.ranges, [NSRange(location: 0, length: 5), NSRange(location: 8, length: 15)])
+
+    // Deleting 4 characters at 10 drops them and pulls the tail back.
+    styled.applyEdit(editedRange: NSRange(location: 10, length: 0), changeInLength: -4)
+    XCTAssertEqual(styled.gaps(in: NSRange(location: 0, length: 19)), [NSRange(location: 5, length: 3)])
+    XCTAssertEqual(styled.styledLength, 16)
+  }
+
+  func testRandomOperationsMatchPerUnitModel() {
+    var rng = SeededRandomNumberGenerator()
+    for _ in 0..<200 {
+      var model = [Bool](repeating: false, count: Int.random(in: 0...40, using: &rng))
+      var styled = MarkdownStyledRanges()
+      for _ in 0..<30 {
+        let a = Int.random(in: 0...model.count, using: &rng)
+        let b = Int.random(in: a...model.count, using: &rng)
+        switch Int.random(in: 0..<3, using: &rng) {
+        case 0:
+          styled.insert(NSRange(location: a, length: b - a))
+          model.replaceSubrange(a..<b, with: repeatElement(true, count: b - a))
+        case 1:
+          styled.remove(NSRange(location: a, length: b - a))
+          model.replaceSubrange(a..<b, with: repeatElement(false, count: b - a))
+        default:
+          let inserted = Int.random(in: 0...5, using: &rng)
+          styled.applyEdit(editedRange: NSRange(location: a, length: inserted), changeInLength: inserted - (b - a))
+          model.replaceSubrange(a..<b, with: repeatElement(false, count: inserted))
+        }
+
+        let unstyled = styled.gaps(in: NSRange(location: 0, length: model.count))
+          .flatMap { $0.location..<NSMaxRange($0) }
+        XCTAssertEqual(unstyled, model.indices.filter { !model[$0] }, "\(rng)")
+        XCTAssertEqual(styled.styledLength, model.filter { $0 }.count, "\(rng)")
+      }
+    }
+  }
+
+  func testBatchedEditsMatchSequentialEdits() {
+    var rng = SeededRandomNumberGenerator()
+    for _ in 0..<300 {
+      let length = Int.random(in: 0...60, using: &rng)
+      var styled = MarkdownStyledRanges()
+      for _ in 0..<6 {
+        let a = Int.random(in: 0...length, using: &rng)
+        styled.insert(NSRange(location: a, length: Int.random(in: 0...(length - a), using: &rng)))
+      }
+      var edits: [(range: NSRange, replacementLength: Int)] = []
+      var cursor = Int.random(in: 0...6, using: &rng)
+      while cursor <= length {
+        let replaced = Int.random(in: 0...min(4, length - cursor), using: &rng)
+        edits.append((NSRange(location: cursor, length: replaced), Int.random(in: 0...5, using: &rng)))
+        cursor += max(replaced, 1) + Int.random(in: 0...6, using: &rng)
+      }
+
+      var sequential = styled
+      var delta = 0
+      for edit in edits {
+        let change = edit.replacementLength - edit.range.length
+        sequential.applyEdit(
+          editedRange: NSRange(location: edit.range.location + delta, length: edit.replacementLength),
+          changeInLength: change
+        )
+        delta += change
+      }
+      var batched = styled
+      batched.applyEdits(edits)
+
+      let full = NSRange(location: 0, length: length + delta)
+      XCTAssertEqual(batched.gaps(in: full), sequential.gaps(in: full), "\(rng)")
+      XCTAssertEqual(batched.styledLength, sequential.styledLength, "\(rng)")
+    }
+  }
+}
@@ -0,0 +1,92 @@
+import TurboDraftMarkdown
+import TurboDraftTestSupport
+import XCTest
+
+/// Differential tests: the tokenizer behind `MarkdownHighlighter` must reproduce
+/// `MarkdownRegexHighlighter` exactly, for whole documents and for line-aligned subranges.
+final class MarkdownTokenizerTests: XCTestCase {
+  private static var repoRoot: URL {
+    // #filePath points at .../Tests/TurboDraftMarkdownTests/MarkdownTokenizerTests.swift
+    URL(fileURLWithPath: #filePath)
+      .deletingLastPathComponent() // TurboDraftMarkdownTests
+      .deletingLastPathComponent() // Tests
+      .deletingLastPathComponent() // repo root
+  }
+
+  private func assertMatchesReference(
+    _ text: String,
+    _ range: NSRange,
+    seed: SeededRandomNumberGenerator? = nil,
+    file: StaticString = #filePath,
+    line: UInt = #line
+  ) {
+    XCTAssertEqual(
+      MarkdownHighlighter.highlights(in: text, range: range),
+      MarkdownRegexHighlighter.highlights(in: text, range: range),
+      "range \(range) of \(text.debugDescription)" + (seed.map { ", \($0)" } ?? ""),
+      file: file,
+      line: line
+    )
+  }
+
+  private func lineStarts(_ ns: NSString) -> [Int] {
+    var starts = [0]
+    for i in 0..<ns.length where ns.character(at: i) == 0x0A {
+      starts.append(i + 1)
+    }
+    return starts
+  }
+
+  func testMatchesRegexEngineOnRepoMarkdown() throws {
+    let root = Self.repoRoot
+    let preambles = root.appendingPathComponent("bench/preambles")
+    var files = try FileManager.default.contentsOfDirectory(at: preambles, includingPropertiesForKeys: nil)
+      .filter { $0.pathExtension == "md" }
+    files.append(root.appendingPathComponent("README.md"))
+    files.append(root.appendingPathComponent("CHANGELOG.md"))
+    XCTAssertGreaterThanOrEqual(files.count, 3)
+
+    for url in files {
+      let text = try String(contentsOf: url, encoding: .utf8)
+      let ns = text as NSString
+      assertMatchesReference(text, NSRange(location: 0, length: ns.length))
+      // Viewport-sized windows starting mid-document, as the editor requests them.
+      let starts = lineStarts(ns)
+      for i in stride(from: 0, to: starts.count, by: 7) {
+        let end = i + 12 < starts.count ? starts[i + 12] : ns.length
+        assertMatchesReference(text, NSRange(location: starts[i], length: end - starts[i]))
+      }
+    }
+  }
+
+  func testMatchesRegexEngineOnRandomDocuments() {
+    let pieces = [
+      "a", "x", "word", "snake_case", "é", " ", "  ", "\t", "\u{00A0}", "\n", "x\n", "\r\n", "\n\n",
+      "#", "## ", "> ", ">> ", "- ", "* ", "+ ", "1. ", "12) ", "- [ ] ", "- [x] ", "[ ]",
+      "`", "``", "```", "~~~", "\n```\n", "\n~~~~\n", " ``` js", "~~", "==", "**", "__", "*", "_",
+      "|", " | ", "|---|---|", "\n|a|b|\n|-|-|\n", ":--", "--:", "---", "***", "___",
+      "[t](u)", "![a](b)", "[r][id]", "[d]: http://x.y", "<http://a.b>", "https://ex.com/p.", "http://q",
+      "(", ")", "[", "]", "!", "<", ">", ":", ".", "1234567890",
+    ]
+    var rng = SeededRandomNumberGenerator()
+    for _ in 0..<500 {
+      let text = (0..<Int.random(in: 0...25, using: &rng)).map { _ in pieces.randomElement(using: &rng)! }.joined()
+      let ns = text as NSString
+      assertMatchesReference(text, NSRange(location: 0, length: ns.length), seed: rng)
+
+      let starts = lineStarts(ns)
+      let start = starts.randomElement(using: &rng)!
+      let end = Int.random(in: start...ns.length, using: &rng)
+      assertMatchesReference(text, NSRange(location: start, length: end - start), seed: rng)
+    }
+  }
+
+  func testRangeStartingWithNewlineSkipsHeaderCellsBeforeIt() {
+    // The regex engine only looks back for a header row when the separator's newline lies past
+    // the range start; the tokenizer keeps that quirk.
+    let text = "|a|b|\n|-|-|"
+    let range = NSRange(location: 5, length: (text as NSString).length - 5)
+    assertMatchesReference(text, range)
+    XCTAssertFalse(MarkdownHighlighter.highlights(in: text, range: range).contains { $0.kind == .tableHeaderText })
+  }
+}
@@ -17,4 +17,18 @@ final class TurboDraftMessagesTests: XCTestCase {
     let decoded = try JSONDecoder().decode(SessionCloseResult.self, from: data)
     XCTAssertEqual(decoded, SessionCloseResult(ok: true))
   }
+
+  func testSessionOpenAndWaitParamsProjectOpenParams() {
+    let params = SessionOpenAndWaitParams(path: "/tmp/x.md", line: 3, cwd: "/tmp", timeoutMs: 500)
+    XCTAssertEqual(params.protocolVersion, TurboDraftProtocolVersion.current)
+    XCTAssertEqual(params.openParams, SessionOpenParams(path: "/tmp/x.md", line: 3, cwd: "/tmp"))
+  }
+
+  func testSessionOpenedParamsDropsContent() throws {
+    let result = SessionOpenResult(sessionId: "s", path: "/tmp/x.md", content: "body", revision: "r", isDirty: false, serverOpenMs: 1.5)
+    let data = try JSONEncoder().encode(SessionOpenedParams(result))
+    let text = String(decoding: data, as: UTF8.self)
+    XCTAssertFalse(text.contains("content"))
+    XCTAssertEqual(try JSONDecoder().decode(SessionOpenedParams.self, from: data).sessionId, "s")
+  }
 }
@@ -0,0 +1,38 @@
+import Foundation
+
+/// SplitMix64, for randomized tests that have to be reproducible. The seed comes from
+/// `TURBODRAFT_TEST_SEED` (decimal or `0x` hex) when set, else a fixed default, so every run
+/// sees the same sequence until someone asks for another. Put `description` in failure
+/// messages: it is the environment setting that replays the run.
+public struct SeededRandomNumberGenerator: RandomNumberGenerator, CustomStringConvertible {
+  public static let environmentKey = "TURBODRAFT_TEST_SEED"
+  public static let defaultSeed: UInt64 = 0x7D_2026
+
+  public let seed: UInt64
+  private var state: UInt64
+
+  public init(seed: UInt64 = SeededRandomNumberGenerator.environmentSeed()) {
+    self.seed = seed
+    self.state = seed
+  }
+
+  public static func environmentSeed() -> UInt64 {
+    guard let raw = ProcessInfo.processInfo.environment[environmentKey]?.trimmingCharacters(in: .whitespaces),
+          !raw.isEmpty
+    else { return defaultSeed }
+    if raw.lowercased().hasPrefix("0x") {
+      return UInt64(raw.dropFirst(2), radix: 16) ?? defaultSeed
+    }
+    return UInt64(raw) ?? defaultSeed
+  }
+
+  public mutating func next() -> UInt64 {
+    state &+= 0x9E37_79B9_7F4A_7C15
+    var z = state
+    z = (z ^ (z >> 30)) &* 0xBF58_476D_1CE4_E5B9
+    z = (z ^ (z >> 27)) &* 0x94D0_49BB_1331_11EB
+    return z ^ (z >> 31)
+  }
+
+  public var description: String { "\(Self.environmentKey)=\(seed)" }
+}
@@ -45,4 +45,42 @@ final class ContentLengthFramerTests: XCTestCase {
     XCTAssertEqual(String(decoding: frames[0], as: UTF8.self), body1)
     XCTAssertEqual(String(decoding: frames[1], as: UTF8.self), body2)
   }
+
+  func testLargeFrameAcrossManySmallChunks() throws {
+    let framer = ContentLengthFramer()
+    let body = String(repeating: "x", count: 1_000_000)
+    let msg = Data("content-length:  \(body.utf8.count) \r\n\r\n\(body)Content-Length: 2\r\n".utf8)
+
+    var frames: [Data] = []
+    var offset = 0
+    // Byte-at-a-time through the header, then odd-sized chunks through the body.
+    while offset < msg.count {
+      let step = offset < 32 ? 1 : 4093
+      let upper = min(msg.count, offset + step)
+      frames.append(contentsOf: try framer.append(msg.subdata(in: offset..<upper)))
+      offset = upper
+    }
+
+    XCTAssertEqual(frames.count, 1)
+    XCTAssertEqual(frames[0].count, body.utf8.count)
+    XCTAssertEqual(frames[0], Data(body.utf8))
+    XCTAssertEqual(framer.bufferedByteCount, "Content-Length: 2\r\n".utf8.count)
+
+    let tail = try framer.append(Data("\r\n{}".utf8))
+    XCTAssertEqual(tail.map { String(decoding: $0, as: UTF8.self) }, ["{}"])
+    XCTAssertEqual(framer.bufferedByteCount, 0)
+  }
+
+  func testFillWritesIntoFramerArena() throws {
+    let framer = ContentLengthFramer()
+    let msg = Array("Content-Length: 8\r\n\r\n{\"id\":1}".utf8)
+    let n = framer.fill(minimumCapacity: 16) { tail in
+      XCTAssertGreaterThanOrEqual(tail.count, 16)
+      tail.copyBytes(from: msg)
+      return msg.count
+    }
+    XCTAssertEqual(n, msg.count)
+    let frames = try framer.takeFrames()
+    XCTAssertEqual(frames.map { String(decoding: $0, as: UTF8.self) }, [#"{"id":1}"#])
+  }
 }
@@ -30,5 +30,56 @@ final class JSONRPCConnectionTests: XCTestCase {
     XCTAssertEqual(a.method, "a")
     XCTAssertEqual(b.method, "b")
   }
-}
 
+  func testStreamingHandlerNotificationPrecedesResponse() throws {
+    let toServer = Pipe()
+    let toClient = Pipe()
+    let serverConn = JSONRPCConnection(readHandle: toServer.fileHandleForReading, writeHandle: toClient.fileHandleForWriting)
+    let client = JSONRPCConnection(readHandle: toClient.fileHandleForReading, writeHandle: toServer.fileHandleForWriting)
+
+    let server = JSONRPCServerConnection(connection: serverConn) { req, notify in
+      guard let id = req.id else { return nil }
+      notify(JSONRPCRequest(id: nil, method: "opened", params: .object(["sessionId": .string("s1")])))
+      return JSONRPCResponse(id: id, result: .object(["reason": .string("userClosed")]))
+    }
+    server.run()
+
+    try client.sendJSON(JSONRPCRequest(id: .int(1), method: "openAndWait", params: .null))
+    let note = try client.readRequest()
+    XCTAssertNil(note.id)
+    XCTAssertEqual(note.method, "opened")
+    let resp = try client.readResponse()
+    XCTAssertEqual(resp.id, .int(1))
+    XCTAssertEqual(resp.result, .object(["reason": .string("userClosed")]))
+  }
+
+  func testHandlerSeesRequestTimingAndOnlyFirstRequestGetsAccept() throws {
+    let toServer = Pipe()
+    let toClient = Pipe()
+    let serverConn = JSONRPCConnection(readHandle: toServer.fileHandleForReading, writeHandle: toClient.fileHandleForWriting)
+    let client = JSONRPCConnection(readHandle: toClient.fileHandleForReading, writeHandle: toServer.fileHandleForWriting)
+
+    let server = JSONRPCServerConnection(
+      connection: serverConn,
+      streamingHandler: { req, _ in
+        guard let id = req.id, let timing = JSONRPCRequestTiming.current else { return nil }
+        return JSONRPCResponse(id: id, result: .object([
+          "accepted": timing.acceptedNs.map { .int(Int64($0)) } ?? .null,
+          "firstByte": timing.firstByteNs.map { .int(Int64($0)) } ?? .null,
+          "ordered": .bool(timing.frameReadNs <= timing.decodedNs && timing.decodedNs <= DispatchTime.now().uptimeNanoseconds),
+        ]))
+      },
+      acceptedNs: 10,
+      firstByteNs: 20
+    )
+    server.run()
+
+    try client.sendJSON(JSONRPCRequest(id: .int(1), method: "a", params: .null))
+    let first = try client.readResponse()
+    XCTAssertEqual(first.result, .object(["accepted": .int(10), "firstByte": .int(20), "ordered": .bool(true)]))
+
+    try client.sendJSON(JSONRPCRequest(id: .int(2), method: "b", params: .null))
+    let second = try client.readResponse()
+    XCTAssertEqual(second.result, .object(["accepted": .null, "firstByte": .null, "ordered": .bool(true)]))
+  }
+}
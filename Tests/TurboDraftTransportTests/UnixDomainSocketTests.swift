@@ -50,4 +50,100 @@ final class UnixDomainSocketTests: XCTestCase {
     wait(for: [exp], timeout: 2.0)
     server.stop()
   }
+
+  func testServerCapsConcurrentConnectionsAndRecordsFirstByte() throws {
+    let dir = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true).appendingPathComponent(UUID().uuidString, isDirectory: true)
+    try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+    let sock = dir.appendingPathComponent("test.sock").path
+
+    final class LeaseBox: @unchecked Sendable {
+      var lease: UnixDomainSocketServer.Lease?
+      var fd: Int32 = -1
+    }
+    let box = LeaseBox()
+    let server = try UnixDomainSocketServer(socketPath: sock, maxConcurrentConnections: 1)
+    let handled = expectation(description: "first client handed off")
+    server.start { fd, lease in
+      box.fd = fd
+      box.lease = lease
+      handled.fulfill()
+    }
+
+    let first = try UnixDomainSocket.connect(path: sock)
+    defer { close(first) }
+    var byte: UInt8 = 0x7B
+    XCTAssertEqual(write(first, &byte, 1), 1)
+    wait(for: [handled], timeout: 2.0)
+
+    // The only slot is held, so the second client is closed without being handed off.
+    let second = try UnixDomainSocket.connect(path: sock)
+    defer { close(second) }
+    var buf = [UInt8](repeating: 0, count: 1)
+    XCTAssertEqual(read(second, &buf, 1), 0)
+
+    var stats = server.stats()
+    XCTAssertEqual(stats.activeConnections, 1)
+    XCTAssertEqual(stats.acceptedConnections, 1)
+    XCTAssertEqual(stats.rejectedConnections, 1)
+    XCTAssertEqual(stats.acceptToFirstByteMs.count, 1)
+
+    box.lease?.release()
+    close(box.fd)
+    stats = server.stats()
+    XCTAssertEqual(stats.activeConnections, 0)
+    XCTAssertEqual(stats.peakActiveConnections, 1)
+    server.stop()
+  }
+
+  func testSilentPeerIsClosedAndItsSlotFreed() throws {
+    let dir = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true).appendingPathComponent(UUID().uuidString, isDirectory: true)
+    try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
+    let sock = dir.appendingPathComponent("test.sock").path
+
+    let server = try UnixDomainSocketServer(socketPath: sock, maxConcurrentConnections: 1, firstByteTimeoutMs: 100)
+    let handled = expectation(description: "talking client handed off")
+    server.start { fd, lease in
+      var buf = [UInt8](repeating: 0, count: 1)
+      if read(fd, &buf, 1) == 1, buf[0] == 0x7B {
+        handled.fulfill()
+      }
+      lease.release()
+      close(fd)
+    }
+
+    // Connects and never writes: closed once the timeout passes, without reaching the handler.
+    let silent = try UnixDomainSocket.connect(path: sock)
+    defer { close(silent) }
+    var buf = [UInt8](repeating: 0, count: 1)
+    XCTAssertEqual(read(silent, &buf, 1), 0)
+
+    let deadline = Date().addingTimeInterval(2)
+    while server.stats().activeConnections != 0, Date() < deadline {
+      usleep(5_000)
+    }
+    XCTAssertEqual(server.stats().activeConnections, 0)
+
+    let talking = try UnixDomainSocket.connect(path: sock)
+    defer { close(talking) }
+    var byte: UInt8 = 0x7B
+    XCTAssertEqual(write(talking, &byte, 1), 1)
+    wait(for: [handled], timeout: 2.0)
+    XCTAssertEqual(server.stats().rejectedConnections, 0)
+    server.stop()
+  }
+
+  func testLaunchReadinessSignalsAndReleasesInheritedFD() throws {
+    var fds: [Int32] = [0, 0]
+    XCTAssertEqual(pipe(&fds), 0)
+    defer { close(fds[0]) }
+    setenv(LaunchReadiness.environmentKey, "\(fds[1])", 1)
+
+    LaunchReadiness.finish(listening: true)
+    XCTAssertNil(getenv(LaunchReadiness.environmentKey))
+
+    var buf = [UInt8](repeating: 0, count: 4)
+    XCTAssertEqual(read(fds[0], &buf, buf.count), 1)
+    // Write end was closed, so the launcher also observes EOF.
+    XCTAssertEqual(read(fds[0], &buf, buf.count), 0)
+  }
 }
@@ -623,6 +623,109 @@ def collect_ui_probe_cycle(
         return UIProbeCycle(False, None, None, str(ex)), harness_offset
 
 
+# ---------- size sweep ----------
+
+def parse_size(label: str) -> int:
+    text = label.strip().lower()
+    scale = 1
+    if text.endswith("k"):
+        scale, text = 1_000, text[:-1]
+    elif text.endswith("m"):
+        scale, text = 1_000_000, text[:-1]
+    try:
+        value = int(float(text) * scale)
+    except ValueError:
+        raise SystemExit(f"invalid --size-sweep entry: {label!r}")
+    if value <= 0:
+        raise SystemExit(f"invalid --size-sweep entry: {label!r}")
+    return value
+
+
+def write_sized_fixture(seed: str, size_bytes: int, path: pathlib.Path) -> int:
+    """Repeats `seed` to exactly `size_bytes` UTF-8 bytes (less a trailing partial character)."""
+    unit = seed.encode("utf-8") or b"\n"
+    reps = size_bytes // len(unit) + 1
+    data = (unit * reps)[:size_bytes]
+    text = data.decode("utf-8", errors="ignore")
+    path.write_text(text, encoding="utf-8")
+    return len(text.encode("utf-8"))
+
+
+def run_size_sweep(
+    labels: List[str],
+    cycles_per_size: int,
+    seed: str,
+    out_dir: pathlib.Path,
+    turbodraft_bin: pathlib.Path,
+    socket_path: pathlib.Path,
+    telemetry_path: pathlib.Path,
+    open_timeout_s: float,
+    close_timeout_s: float,
+    inter_cycle_delay_s: float,
+) -> List[Dict[str, Any]]:
+    """Open time vs file size: `cycles_per_size` API cycles per size, the first one discarded."""
+    rows: List[Dict[str, Any]] = []
+    for label in labels:
+        fixture = out_dir / f"open-close-fixture-{label}.md"
+        size_bytes = write_sized_fixture(seed, parse_size(label), fixture)
+        cycles: List[Dict[str, Any]] = []
+        errors: List[str] = []
+        for idx in range(1, cycles_per_size + 1):
+            res = run_api_cycle_attempt(
+                cycle_idx=idx,
+                attempt_idx=1,
+                fixture_path=fixture,
+                turbodraft_bin=turbodraft_bin,
+                socket_path=socket_path,
+                telemetry_path=telemetry_path,
+                open_timeout_s=open_timeout_s,
+                close_timeout_s=close_timeout_s,
+            )
+            if res.success:
+                if idx > 1:
+                    cycles.append(res.cycle)
+            else:
+                errors.append(f"cycle {idx}: {res.reason}")
+            time.sleep(max(0.0, inter_cycle_delay_s))
+        rows.append({
+            "label": label,
+            "bytes": size_bytes,
+            "fixture": str(fixture),
+            "apiOpenTotalMs": summarize(metric_samples(cycles, "apiOpenTotalMs")),
+            "apiOpenRpcMs": summarize(metric_samples(cycles, "apiOpenRpcMs")),
+            "apiCloseTriggerToExitMs": summarize(metric_samples(cycles, "apiCloseTriggerToExitMs")),
+            "errors": errors,
+        })
+    return rows
+
+
+def print_size_sweep(rows: List[Dict[str, Any]]) -> None:
+    print("\nOpen time vs file size (ms, first cycle per size discarded)")
+    print("  size     bytes       n    open p50  open p95  rpc p50   close p50")
+    for row in rows:
+        total = row.get("apiOpenTotalMs") or {}
+        rpc = row.get("apiOpenRpcMs") or {}
+        close = row.get("apiCloseTriggerToExitMs") or {}
+
+        def fmt(stats: Dict[str, Any], key: str) -> str:
+            v = numeric(stats.get(key))
+            return f"{v:.1f}" if v is not None else "-"
+
+        print(
+            "  {label:<8} {nbytes:<11} {n:<4} {p50:<9} {p95:<9} {rpc:<9} {close:<9}".format(
+                label=row["label"],
+                nbytes=row["bytes"],
+                n=total.get("n", 0),
+                p50=fmt(total, "median_ms"),
+                p95=fmt(total, "p95_ms"),
+                rpc=fmt(rpc, "median_ms"),
+                close=fmt(close, "median_ms"),
+            )
+        )
+        for err in row.get("errors") or []:
+            print(f"    ! {err}")
+
+
 # ---------- reporting ----------
 
 def metric_samples(cycles: List[Dict[str, Any]], key: str) -> List[float]:
@@ -739,12 +842,23 @@ def main() -> int:
     ap.add_argument("--fixture", default="bench/preambles/core.md")
     ap.add_argument("--out-dir", default="")
     ap.add_argument("--compare", default="", help="Optional previous report JSON for trend deltas")
+    ap.add_argument(
+        "--size-sweep",
+        default="",
+        help="Comma-separated fixture sizes (e.g. 16k,256k,1m,5m): after the main run, report open time per size with --fixture repeated to each size",
+    )
+    ap.add_argument("--size-sweep-cycles", type=int, default=6, help="Cycles per --size-sweep size (the first is discarded)")
     args = ap.parse_args()
 
     if args.cycles <= 0:
         raise SystemExit("--cycles must be > 0")
     if args.warmup < 0 or args.warmup >= args.cycles:
         raise SystemExit("--warmup must be >=0 and < cycles")
+    sweep_labels = [x.strip() for x in args.size_sweep.split(",") if x.strip()]
+    for label in sweep_labels:
+        parse_size(label)
+    if sweep_labels and args.size_sweep_cycles < 2:
+        raise SystemExit("--size-sweep-cycles must be >= 2")
 
     repo = pathlib.Path(__file__).resolve().parents[1]
     bench_bin = repo / ".build" / "release" / "turbodraft-bench"
@@ -839,6 +953,21 @@ def main() -> int:
     finally:
         pass
 
+    size_sweep: List[Dict[str, Any]] = []
+    if sweep_labels:
+        size_sweep = run_size_sweep(
+            labels=sweep_labels,
+            cycles_per_size=int(args.size_sweep_cycles),
+            seed=fixture_src.read_text(encoding="utf-8"),
+            out_dir=out_dir,
+            turbodraft_bin=bench_bin,
+            socket_path=socket_path,
+            telemetry_path=telemetry_path,
+            open_timeout_s=float(args.open_timeout_s),
+            close_timeout_s=float(args.close_timeout_s),
+            inter_cycle_delay_s=float(args.inter_cycle_delay_s),
+        )
+
     # validation & summaries
     successful = [c for c in cycles if c.get("ok")]
     steady = [c for c in successful if not c.get("warmup")]
@@ -937,6 +1066,7 @@ def main() -> int:
         },
         "validation": validation,
         "runValid": run_valid,
+        "sizeSweep": size_sweep,
         "optionalProbeCoverage": {
             "userVisible": {
                 "enabled": False,
@@ -989,6 +1119,8 @@ def main() -> int:
     print_table("Auxiliary: close trigger->wait event observed (ms)", summary_steady.get("apiCloseTriggerToWaitEventMs") or {})
     print_table("Auxiliary: cli_wait payload waitMs (ms)", summary_steady.get("apiCloseWaitMs") or {})
     print_table("Auxiliary: wait-event observation lag (ms)", summary_steady.get("apiCloseWaitObservationLagMs") or {})
+    if size_sweep:
+        print_size_sweep(size_sweep)
 
     return 0 if run_valid else 2
 
@@ -447,6 +447,7 @@ def run_cycle_attempt(
         hist_bytes_peak = None
         styler_entry_peak = None
         styler_limit = None
+        styler_hit_rate = None
 
         cycle["timestamps"]["workload_start_ns"] = time.perf_counter_ns()
         for i in range(max(1, save_iterations)):
@@ -472,6 +473,9 @@ def run_cycle_attempt(
                 styler_entry_peak = max(styler_entry_peak or c_count, c_count)
             if isinstance(c_limit, int):
                 styler_limit = c_limit
+            c_hit_rate = metrics.get("stylerCacheHitRate")
+            if isinstance(c_hit_rate, (int, float)):
+                styler_hit_rate = float(c_hit_rate)
 
             r = rss_bytes(server_pid)
             if r is not None:
@@ -514,6 +518,7 @@ def run_cycle_attempt(
         cycle["historySnapshotBytesPeak"] = hist_bytes_peak
         cycle["stylerCacheEntryPeak"] = styler_entry_peak
         cycle["stylerCacheLimit"] = styler_limit
+        cycle["stylerCacheHitRate"] = styler_hit_rate
         cycle["diagnosticCoverage"] = {
             "history": diag_cov["history"] / float(max(1, save_iterations)),
             "styler": diag_cov["styler"] / float(max(1, save_iterations)),
@@ -576,6 +581,38 @@ def run_cycle_attempt(
         return CycleAttemptResult(False, True, "exception", cycle)
 
 
+def measure_idle_resident_after(
+    socket_path: pathlib.Path,
+    *,
+    idle_after_s: float,
+    idle_settle_ms: float,
+    sample_ms: float,
+    timeout_s: float,
+) -> Dict[str, Any]:
+    """Leaves the app untouched for `idle_after_s`, then samples resident memory like the idle phase."""
+    out: Dict[str, Any] = {"idleAfterS": idle_after_s, "startedAt": now_iso()}
+    try:
+        hello = rpc_hello(socket_path, timeout_s=max(1.0, timeout_s))
+        server_pid = int(hello.get("serverPid") or 0)
+        if server_pid <= 0:
+            raise RuntimeError("invalid_server_pid")
+        out["serverPid"] = server_pid
+        time.sleep(max(0.0, idle_after_s))
+        samples = collect_rss_samples(server_pid, duration_s=max(0.01, idle_settle_ms / 1000.0), sample_ms=sample_ms)
+        if not samples:
+            raise RuntimeError("idle_after_sampling_empty")
+        # The app must have stayed up; a restart would read as a perfect trim.
+        hello_after = rpc_hello(socket_path, timeout_s=max(1.0, timeout_s))
+        if int(hello_after.get("serverPid") or 0) != server_pid:
+            raise RuntimeError("server_restarted_during_idle")
+        out["residentBytes"] = int(statistics.median(samples))
+        out["ok"] = True
+    except Exception as ex:
+        out["ok"] = False
+        out["error"] = str(ex)
+    return out
+
+
 # ---------- main ----------
 
 def print_table(title: str, summary: Dict[str, Any], unit: str = "MiB") -> None:
@@ -623,12 +660,14 @@ def main() -> int:
     ap.add_argument("--out-dir", default=None)
     ap.add_argument("--compare", default=None)
     ap.add_argument("--inject-transient-failure-cycle", type=int, default=0)
+    ap.add_argument("--idle-after-s", type=float, default=0.0, help="idle time before the idle-after probe (600 covers the 5-minute deep trim); 0 skips it")
 
     # Gate thresholds (MiB)
     ap.add_argument("--enforce-gates", action="store_true", default=False)
     ap.add_argument("--max-peak-delta-p95-mib", type=float, default=32.0)
     ap.add_argument("--max-post-close-residual-p95-mib", type=float, default=30.0)
     ap.add_argument("--max-memory-slope-mib-per-cycle", type=float, default=0.8)
+    ap.add_argument("--max-idle-resident-after-delta-mib", type=float, default=30.0)
 
     args = ap.parse_args()
 
@@ -726,6 +765,18 @@ def main() -> int:
         if cycle_idx < args.cycles:
             time.sleep(max(0.0, args.inter_cycle_delay_s))
 
+    idle_after: Optional[Dict[str, Any]] = None
+    if args.idle_after_s > 0:
+        idle_after = measure_idle_resident_after(
+            socket_path,
+            idle_after_s=args.idle_after_s,
+            idle_settle_ms=args.idle_settle_ms,
+            sample_ms=args.sample_ms,
+            timeout_s=args.open_timeout_s,
+        )
+        if not idle_after.get("ok"):
+            unrecovered_failures += 1
+
     cycles_path = out_dir / "cycles.jsonl"
     with cycles_path.open("w", encoding="utf-8") as fh:
         for c in cycles:
@@ -762,6 +813,14 @@ def main() -> int:
         "memorySlopeMiBPerCycle": slope,
     }
 
+    # Long-idle resident, against the short-settle idle baseline: the idle trim should land below it.
+    idle_after_mib = to_mib(idle_after.get("residentBytes")) if idle_after else None
+    idle_baseline_mib = summary["idleResidentMiB"].get("median")
+    summary["idleResidentAfterMiB"] = idle_after_mib
+    summary["idleResidentAfterDeltaMiB"] = (
+        None if idle_after_mib is None or idle_baseline_mib is None else idle_after_mib - float(idle_baseline_mib)
+    )
+
     outliers = {
         "peakDeltaResidentMiB": detect_outliers_iqr([
             (int(c["cycle"]), float(c["peakDeltaBytes"]) / (1024.0 * 1024.0))
@@ -803,6 +862,7 @@ def main() -> int:
         "historySnapshotBytesPeak": coverage_of("historySnapshotBytesPeak"),
         "stylerCacheEntryPeak": coverage_of("stylerCacheEntryPeak"),
         "stylerCacheLimit": coverage_of("stylerCacheLimit"),
+        "stylerCacheHitRate": coverage_of("stylerCacheHitRate"),
     }
 
     # core validity
@@ -838,6 +898,14 @@ def main() -> int:
             "pass": (slope is not None and slope <= float(args.max_memory_slope_mib_per_cycle)),
         },
     }
+    if idle_after is not None:
+        idle_after_delta = summary["idleResidentAfterDeltaMiB"]
+        gate_checks["idle_resident_after_delta"] = {
+            "limit_mib": float(args.max_idle_resident_after_delta_mib),
+            "value_mib": idle_after_delta,
+            "idle_after_s": float(args.idle_after_s),
+            "pass": (idle_after_delta is not None and idle_after_delta <= float(args.max_idle_resident_after_delta_mib)),
+        }
     gate_pass = all(v.get("pass", False) for v in gate_checks.values())
 
     validity_reasons: List[str] = []
@@ -873,11 +941,13 @@ def main() -> int:
             "cleanSlate": args.clean_slate,
             "fixture": str(fixture),
             "injectTransientFailureCycle": args.inject_transient_failure_cycle,
+            "idleAfterS": args.idle_after_s,
             "enforceGates": args.enforce_gates,
             "thresholdsMiB": {
                 "peakDeltaP95": args.max_peak_delta_p95_mib,
                 "postCloseResidualP95": args.max_post_close_residual_p95_mib,
                 "slopePerCycle": args.max_memory_slope_mib_per_cycle,
+                "idleResidentAfterDelta": args.max_idle_resident_after_delta_mib,
             },
         },
         "environment": {
@@ -910,6 +980,8 @@ def main() -> int:
             "cycles": str(cycles_path),
         },
     }
+    if idle_after is not None:
+        report["idleAfter"] = idle_after
 
     if args.compare:
         comp_path = pathlib.Path(args.compare)
@@ -944,6 +1016,9 @@ def main() -> int:
     print_table("Peak resident", summary["peakResidentMiB"])
     print_table("Peak delta (peak-idle)", summary["peakDeltaResidentMiB"])
     print_table("Post-close residual", summary["postCloseResidualMiB"])
+    if idle_after is not None:
+        after_text = "-" if idle_after_mib is None else f"{idle_after_mib:.2f}"
+        print(f"\nIdle resident after {args.idle_after_s:.0f}s (MiB)\t{after_text}")
 
     slope_text = "-" if slope is None else f"{slope:.3f}"
     print(f"\nMemory slope (MiB/cycle)\t{slope_text}")